@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -15,6 +15,7 @@
 #include "app/check_update.h"
 #include "app/cli/app_options.h"
 #include "app/cli/cli_processor.h"
+#include "app/cli/cli_server.h"
 #include "app/cli/default_cli_delegate.h"
 #include "app/cli/preview_cli_delegate.h"
 #include "app/color_spaces.h"
@@ -40,6 +41,7 @@
 #include "app/resource_finder.h"
 #include "app/send_crash.h"
 #include "app/site.h"
+#include "app/startup_profiler.h"
 #include "app/tools/active_tool.h"
 #include "app/tools/tool_box.h"
 #include "app/ui/backup_indicator.h"
@@ -78,8 +80,10 @@
   #include "os/x11/system.h"
 #endif
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 #ifdef ENABLE_SCRIPTING
   #include "app/script/engine.h"
@@ -263,7 +267,10 @@ int App::initialize(const AppOptions& options)
 #endif
 
   m_isShell = options.startShell();
-  m_coreModules = std::make_unique<CoreModules>();
+  {
+    StartupScope scope("Core modules");
+    m_coreModules = std::make_unique<CoreModules>();
+  }
 
   auto& pref = preferences();
 
@@ -311,7 +318,10 @@ int App::initialize(const AppOptions& options)
       break;
   }
 
-  initialize_color_spaces(pref);
+  {
+    StartupScope scope("Color spaces");
+    initialize_color_spaces(pref);
+  }
 
 #ifdef ENABLE_DRM
   LOG("APP: Initializing DRM...\n");
@@ -324,9 +334,18 @@ int App::initialize(const AppOptions& options)
 #endif
 
   // Load modules
-  m_modules = std::make_unique<Modules>(createLogInDesktop, pref);
-  m_legacy = std::make_unique<LegacyModules>(isGui() ? REQUIRE_INTERFACE : 0);
-  m_brushes = std::make_unique<AppBrushes>();
+  {
+    StartupScope scope("Modules");
+    m_modules = std::make_unique<Modules>(createLogInDesktop, pref);
+  }
+  {
+    StartupScope scope("Legacy modules");
+    m_legacy = std::make_unique<LegacyModules>(isGui() ? REQUIRE_INTERFACE : 0);
+  }
+  {
+    StartupScope scope("Brushes");
+    m_brushes = std::make_unique<AppBrushes>();
+  }
 
   // Data recovery is enabled only in GUI mode
   if (isGui() && pref.general.dataRecovery())
@@ -337,11 +356,15 @@ int App::initialize(const AppOptions& options)
 
   // Load or create the default palette, or migrate the default
   // palette from an old format palette to the new one, etc.
-  load_default_palette();
+  {
+    StartupScope scope("Default palette");
+    load_default_palette();
+  }
 
   // Initialize GUI interface
   if (isGui()) {
     LOG("APP: GUI mode\n");
+    StartupScope scope("Main window");
 
     // Set the ClipboardDelegate impl to copy/paste text in the native
     // clipboard from the ui::Entry control.
@@ -393,7 +416,10 @@ int App::initialize(const AppOptions& options)
 #ifdef ENABLE_SCRIPTING
   // Call the init() function from all plugins
   LOG("APP: Initializing scripts...\n");
-  extensions().executeInitActions();
+  {
+    StartupScope scope("Plugins init");
+    extensions().executeInitActions();
+  }
 #endif
 
   // Process options
@@ -406,10 +432,28 @@ int App::initialize(const AppOptions& options)
     else
       delegate.reset(new DefaultCliDelegate);
 
+    StartupScope scope("CLI options");
     CliProcessor cli(delegate.get(), options);
     code = cli.process(context());
   }
 
+  // Print/save the time spent in each phase of the startup
+  if (StartupProfiler::isEnabled())
+    StartupProfiler::finish(options.startupProfile() ? &std::cerr : nullptr,
+                            options.startupTraceFilename());
+
+  // Measure the time spent painting widgets (printed when the GUI
+  // loop finishes)
+  if (isGui() && options.paintProfile())
+    ui::Manager::setPaintProfiling(true);
+
+  // Keep running jobs received from the --server socket
+  if (code == 0 && options.startServer()) {
+    LOG("APP: Starting CLI server...\n");
+    CliServer server(options);
+    code = server.run(context());
+  }
+
   LOG("APP: Finish launching...\n");
   system->finishLaunching();
   return code;
@@ -417,6 +461,27 @@ int App::initialize(const AppOptions& options)
 
 namespace {
 
+// Prints the time spent in kPaintMessages by each type of widget
+// (sorted by total time) when --paint-profile is used.
+void print_paint_stats(std::ostream& os)
+{
+  using Item = std::pair<std::string, ui::Manager::PaintStats>;
+  std::vector<Item> items(ui::Manager::paintStats().begin(), ui::Manager::paintStats().end());
+  std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+    return a.second.seconds > b.second.seconds;
+  });
+
+  os << fmt::format("{:>8} {:>10} {:>8}  {}\n", "paints", "total ms", "avg ms", "widget");
+  for (const auto& item : items) {
+    const auto& stats = item.second;
+    os << fmt::format("{:>8} {:>10.2f} {:>8.3f}  {}\n",
+                      stats.count,
+                      stats.seconds * 1000.0,
+                      stats.count > 0 ? stats.seconds * 1000.0 / stats.count : 0.0,
+                      item.first);
+  }
+}
+
 struct CloseMainWindow {
   std::unique_ptr<MainWindow>& m_win;
   CloseMainWindow(std::unique_ptr<MainWindow>& win) : m_win(win) {}
@@ -549,6 +614,9 @@ void App::run()
     try {
       manager->run();
       set_app_state(AppState::kClosing);
+
+      if (ui::Manager::isPaintProfiling())
+        print_paint_stats(std::cerr);
     }
     catch (...) {
       set_app_state(AppState::kClosingWithException);
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2017  David Capello
 //
 // This program is distributed under the terms of
@@ -22,6 +22,7 @@ AppOptions::AppOptions(int argc, const char* argv[])
   , m_startUI(true)
   , m_startShell(false)
   , m_previewCLI(false)
+  , m_startServer(false)
   , m_showHelp(false)
   , m_showVersion(false)
   , m_verboseLevel(kNoVerbose)
@@ -31,6 +32,19 @@ AppOptions::AppOptions(int argc, const char* argv[])
   , m_batch(m_po.add("batch").mnemonic('b').description("Do not start the UI"))
   , m_preview(m_po.add("preview").mnemonic('p').description(
       "Do not execute actions, just print what will be\ndone"))
+  , m_server(m_po.add("server")
+               .requiresValue("<socket>")
+               .description("Keep running in batch mode executing the\n"
+                            "CLI jobs received from the given Unix\n"
+                            "socket or named pipe"))
+  , m_manifest(m_po.add("manifest")
+                 .requiresValue("<filename>")
+                 .description("Execute in parallel the CLI jobs listed in\n"
+                              "the given file (one job per line)"))
+  , m_jobs(m_po.add("jobs")
+             .requiresValue("<n>")
+             .description("Number of --manifest jobs to execute at\n"
+                          "the same time (0 to use all CPU cores)"))
   , m_saveAs(m_po.add("save-as")
                .requiresValue("<filename>")
                .description("Save the last given sprite with other format"))
@@ -58,6 +72,17 @@ AppOptions::AppOptions(int argc, const char* argv[])
   , m_shrinkTo(m_po.add("shrink-to")
                  .requiresValue("width,height")
                  .description("Shrink each sprite if it is\nlarger than width or height"))
+  , m_pngCompression(m_po.add("png-compression")
+                       .requiresValue("<level>")
+                       .description("Compression level to save PNG files:\n  0-9\n  "
+                                    "fast\n  default\n  best"))
+  , m_pngFilter(m_po.add("png-filter")
+                  .requiresValue("<filter>")
+                  .description("Filter to encode rows of PNG files:\n  adaptive\n  none\n  "
+                               "sub\n  up\n  average\n  paeth"))
+  , m_pngThreads(m_po.add("png-threads")
+                   .requiresValue("<n>")
+                   .description("Threads used to compress PNG files\n(0 to use all CPU cores)"))
   , m_data(m_po.add("data")
              .requiresValue("<filename.json>")
              .description("File to store the sprite sheet metadata"))
@@ -165,6 +190,13 @@ AppOptions::AppOptions(int argc, const char* argv[])
       m_po.add("export-tileset").description("Export only tilesets from visible tilemap layers"))
   , m_verbose(m_po.add("verbose").mnemonic('v').description("Explain what is being done"))
   , m_debug(m_po.add("debug").description("Extreme verbose mode and\ncopy log to desktop"))
+  , m_startupProfile(
+      m_po.add("startup-profile").description("Print the time spent in each phase\nof the startup"))
+  , m_startupTrace(m_po.add("startup-trace")
+                     .requiresValue("<filename.json>")
+                     .description("Save the startup phases in the Chrome\ntrace format"))
+  , m_paintProfile(
+      m_po.add("paint-profile").description("Print the time spent painting each\ntype of widget"))
 #ifdef ENABLE_STEAM
   , m_noInApp(m_po.add("noinapp").description(
       "Disable \"in game\" visibility on Steam\nDoesn't count playtime"))
@@ -187,10 +219,19 @@ AppOptions::AppOptions(int argc, const char* argv[])
     m_startShell = m_po.enabled(m_shell);
 #endif
     m_previewCLI = m_po.enabled(m_preview);
+    m_startServer = m_po.enabled(m_server);
+    if (m_startServer) {
+      for (const auto& value : m_po.values()) {
+        if (value.option() == &m_server)
+          m_serverPath = value.value();
+      }
+    }
+    if (m_po.enabled(m_startupTrace))
+      m_startupTraceFilename = m_po.value_of(m_startupTrace);
     m_showHelp = m_po.enabled(m_help);
     m_showVersion = m_po.enabled(m_version);
 
-    if (m_startShell || m_showHelp || m_showVersion || m_po.enabled(m_batch)) {
+    if (m_startShell || m_startServer || m_showHelp || m_showVersion || m_po.enabled(m_batch)) {
       m_startUI = false;
     }
   }
@@ -206,6 +247,16 @@ bool AppOptions::hasExporterParams() const
   return m_po.enabled(m_data) || m_po.enabled(m_sheet);
 }
 
+bool AppOptions::startupProfile() const
+{
+  return m_po.enabled(m_startupProfile);
+}
+
+bool AppOptions::paintProfile() const
+{
+  return m_po.enabled(m_paintProfile);
+}
+
 #ifdef ENABLE_STEAM
 bool AppOptions::noInApp() const
 {
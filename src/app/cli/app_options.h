@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2017  David Capello
 //
 // This program is distributed under the terms of
@@ -37,12 +37,20 @@ public:
   bool startUI() const { return m_startUI; }
   bool startShell() const { return m_startShell; }
   bool previewCLI() const { return m_previewCLI; }
+  bool startServer() const { return m_startServer; }
+  const std::string& serverPath() const { return m_serverPath; }
   bool showHelp() const { return m_showHelp; }
   bool showVersion() const { return m_showVersion; }
   VerboseLevel verboseLevel() const { return m_verboseLevel; }
+  bool startupProfile() const;
+  const std::string& startupTraceFilename() const { return m_startupTraceFilename; }
+  bool paintProfile() const;
 
   const ValueList& values() const { return m_po.values(); }
 
+  const Option& manifest() const { return m_manifest; }
+  const Option& jobs() const { return m_jobs; }
+
   // Export options
   const Option& saveAs() const { return m_saveAs; }
   const Option& palette() const { return m_palette; }
@@ -51,6 +59,9 @@ public:
   const Option& ditheringMatrix() const { return m_ditheringMatrix; }
   const Option& colorMode() const { return m_colorMode; }
   const Option& shrinkTo() const { return m_shrinkTo; }
+  const Option& pngCompression() const { return m_pngCompression; }
+  const Option& pngFilter() const { return m_pngFilter; }
+  const Option& pngThreads() const { return m_pngThreads; }
   const Option& data() const { return m_data; }
   const Option& format() const { return m_format; }
   const Option& sheet() const { return m_sheet; }
@@ -110,15 +121,21 @@ private:
   bool m_startUI;
   bool m_startShell;
   bool m_previewCLI;
+  bool m_startServer;
+  std::string m_serverPath;
   bool m_showHelp;
   bool m_showVersion;
   VerboseLevel m_verboseLevel;
+  std::string m_startupTraceFilename;
 
 #ifdef ENABLE_SCRIPTING
   Option& m_shell;
 #endif
   Option& m_batch;
   Option& m_preview;
+  Option& m_server;
+  Option& m_manifest;
+  Option& m_jobs;
   Option& m_saveAs;
   Option& m_palette;
   Option& m_scale;
@@ -126,6 +143,9 @@ private:
   Option& m_ditheringMatrix;
   Option& m_colorMode;
   Option& m_shrinkTo;
+  Option& m_pngCompression;
+  Option& m_pngFilter;
+  Option& m_pngThreads;
   Option& m_data;
   Option& m_format;
   Option& m_sheet;
@@ -171,6 +191,9 @@ private:
 
   Option& m_verbose;
   Option& m_debug;
+  Option& m_startupProfile;
+  Option& m_startupTrace;
+  Option& m_paintProfile;
 #ifdef ENABLE_STEAM
   Option& m_noInApp;
 #endif
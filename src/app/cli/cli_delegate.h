@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2022  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2016-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -9,6 +9,8 @@
 #define APP_CLI_CLI_DELEGATE_H_INCLUDED
 #pragma once
 
+#include "app/cli/cli_jobs.h"
+
 #include <string>
 
 namespace app {
@@ -32,6 +34,7 @@ public:
   virtual void saveFile(Context* ctx, const CliOpenFile& cof) {}
   virtual void loadPalette(Context* ctx, const std::string& filename) {}
   virtual void exportFiles(Context* ctx, DocExporter& exporter) {}
+  virtual int runJobs(const CliJobs& jobs, int njobs) { return 0; }
 #ifdef ENABLE_SCRIPTING
   virtual int execScript(const std::string& filename, const Params& params) { return 0; }
 #endif // ENABLE_SCRIPTING
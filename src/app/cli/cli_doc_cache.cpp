@@ -0,0 +1,100 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/cli/cli_doc_cache.h"
+
+#include "app/doc.h"
+#include "app/util/file_key.h"
+#include "doc/sprite.h"
+
+#include <algorithm>
+
+namespace app {
+
+namespace {
+
+// Returns a copy of the document, or nullptr if we cannot create an
+// exact copy of it.
+Doc* copy_doc(const Doc* src)
+{
+  const doc::Sprite* srcSprite = src->sprite();
+
+  // Doc::duplicate() doesn't copy tilesets
+  if (srcSprite->hasTilesets())
+    return nullptr;
+
+  std::unique_ptr<Doc> doc(src->duplicate(DuplicateExactCopy));
+  doc::Sprite* sprite = doc->sprite();
+  sprite->setPixelRatio(srcSprite->pixelRatio());
+  sprite->setGridBounds(srcSprite->gridBounds());
+  sprite->setUserData(srcSprite->userData());
+  doc->setFormatOptions(src->formatOptions());
+  doc->markAsSaved();
+  return doc.release();
+}
+
+} // anonymous namespace
+
+CliDocCache::CliDocCache(std::size_t maxDocs) : m_maxDocs(maxDocs)
+{
+}
+
+CliDocCache::~CliDocCache()
+{
+  clear();
+}
+
+Doc* CliDocCache::copyDoc(const std::string& filename)
+{
+  auto it = m_entries.find(filename);
+  if (it == m_entries.end())
+    return nullptr;
+
+  Entry& entry = it->second;
+  const std::string key = get_file_key(filename);
+  if (key.empty() || key != entry.fileKey) {
+    m_entries.erase(it);
+    return nullptr;
+  }
+
+  entry.lastUse = ++m_useCounter;
+  return copy_doc(entry.doc.get());
+}
+
+void CliDocCache::add(const std::string& filename, const Doc* doc)
+{
+  const std::string key = get_file_key(filename);
+  if (m_maxDocs == 0 || key.empty())
+    return;
+
+  std::unique_ptr<Doc> copy(copy_doc(doc));
+  if (!copy)
+    return;
+
+  // Remove the least recently used document
+  if (m_entries.size() >= m_maxDocs && m_entries.find(filename) == m_entries.end()) {
+    auto lru = std::min_element(m_entries.begin(), m_entries.end(), [](const auto& a, const auto& b) {
+      return a.second.lastUse < b.second.lastUse;
+    });
+    m_entries.erase(lru);
+  }
+
+  Entry& entry = m_entries[filename];
+  entry.fileKey = key;
+  entry.doc = std::move(copy);
+  entry.lastUse = ++m_useCounter;
+}
+
+void CliDocCache::clear()
+{
+  m_entries.clear();
+}
+
+} // namespace app
@@ -0,0 +1,55 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_CLI_CLI_DOC_CACHE_H_INCLUDED
+#define APP_CLI_CLI_DOC_CACHE_H_INCLUDED
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace app {
+
+class Doc;
+
+// Cache of documents loaded from the CLI in a long-running process
+// (see CliServer). Documents are keyed by their file name and
+// invalidated when the file modification time (with sub-second
+// precision) or size change (see get_file_key()). The CLI modifies
+// the loaded documents (e.g. --scale, --crop), so we only give
+// copies of the cached documents.
+class CliDocCache {
+public:
+  explicit CliDocCache(std::size_t maxDocs = 64);
+  ~CliDocCache();
+
+  // Returns a new copy of the document loaded from the given file,
+  // or nullptr if it isn't in the cache (or the file was modified).
+  Doc* copyDoc(const std::string& filename);
+
+  // Saves a copy of the document just loaded from the given file.
+  void add(const std::string& filename, const Doc* doc);
+
+  void clear();
+
+private:
+  struct Entry {
+    std::string fileKey;
+    std::unique_ptr<Doc> doc;
+    uint64_t lastUse;
+  };
+
+  std::size_t m_maxDocs;
+  std::map<std::string, Entry> m_entries;
+  uint64_t m_useCounter = 0;
+};
+
+} // namespace app
+
+#endif
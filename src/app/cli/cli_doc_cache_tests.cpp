@@ -0,0 +1,143 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#include "tests/app_test.h"
+
+#include "app/cli/cli_doc_cache.h"
+#include "app/context.h"
+#include "app/doc.h"
+#include "doc/sprite.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+using namespace app;
+
+namespace {
+
+void write_file(const std::string& filename, const std::string& content)
+{
+  std::ofstream f(filename, std::ios::binary | std::ios::trunc);
+  f << content;
+}
+
+bool is_cached(CliDocCache& cache, const std::string& filename)
+{
+  std::unique_ptr<Doc> copy(cache.copyDoc(filename));
+  return (copy != nullptr);
+}
+
+} // anonymous namespace
+
+TEST(CliDocCache, CopyOfCachedDoc)
+{
+  Context ctx;
+  const std::string fn = "cli_doc_cache_test_1.txt";
+  write_file(fn, "abcd");
+
+  std::unique_ptr<Doc> doc(ctx.documents().add(32, 16, doc::ColorMode::RGB));
+  CliDocCache cache;
+  EXPECT_FALSE(is_cached(cache, fn));
+
+  cache.add(fn, doc.get());
+  std::unique_ptr<Doc> copy(cache.copyDoc(fn));
+  ASSERT_TRUE(copy != nullptr);
+  EXPECT_NE(doc.get(), copy.get());
+  EXPECT_EQ(32, copy->sprite()->width());
+  EXPECT_EQ(16, copy->sprite()->height());
+
+  // Each call returns a new copy
+  std::unique_ptr<Doc> copy2(cache.copyDoc(fn));
+  ASSERT_TRUE(copy2 != nullptr);
+  EXPECT_NE(copy.get(), copy2.get());
+
+  doc->close();
+  std::remove(fn.c_str());
+}
+
+TEST(CliDocCache, FileModifiedWithSameSize)
+{
+  Context ctx;
+  const std::string fn = "cli_doc_cache_test_2.txt";
+  write_file(fn, "abcd");
+
+  std::unique_ptr<Doc> doc(ctx.documents().add(32, 16, doc::ColorMode::RGB));
+  CliDocCache cache;
+  cache.add(fn, doc.get());
+  ASSERT_TRUE(is_cached(cache, fn));
+
+  // Modify the file in the same second with the same size (the
+  // modification time must be compared with sub-second precision)
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  write_file(fn, "efgh");
+  EXPECT_FALSE(is_cached(cache, fn));
+
+  // The entry was removed
+  write_file(fn, "abcd");
+  EXPECT_FALSE(is_cached(cache, fn));
+
+  doc->close();
+  std::remove(fn.c_str());
+}
+
+TEST(CliDocCache, FileRemovedOrResized)
+{
+  Context ctx;
+  const std::string fn = "cli_doc_cache_test_3.txt";
+  write_file(fn, "abcd");
+
+  std::unique_ptr<Doc> doc(ctx.documents().add(32, 16, doc::ColorMode::RGB));
+  CliDocCache cache;
+  cache.add(fn, doc.get());
+  write_file(fn, "abcdef");
+  EXPECT_FALSE(is_cached(cache, fn));
+
+  cache.add(fn, doc.get());
+  std::remove(fn.c_str());
+  EXPECT_FALSE(is_cached(cache, fn));
+
+  // Files that don't exist are not cached
+  cache.add(fn, doc.get());
+  EXPECT_FALSE(is_cached(cache, fn));
+
+  doc->close();
+}
+
+TEST(CliDocCache, LeastRecentlyUsed)
+{
+  Context ctx;
+  const std::string fns[3] = { "cli_doc_cache_test_a.txt",
+                               "cli_doc_cache_test_b.txt",
+                               "cli_doc_cache_test_c.txt" };
+  for (const auto& fn : fns)
+    write_file(fn, fn);
+
+  std::unique_ptr<Doc> doc(ctx.documents().add(32, 16, doc::ColorMode::RGB));
+  CliDocCache cache(2);
+  cache.add(fns[0], doc.get());
+  cache.add(fns[1], doc.get());
+
+  // Use the first document, so the second one is the least recently
+  // used when the third one is added
+  ASSERT_TRUE(is_cached(cache, fns[0]));
+  cache.add(fns[2], doc.get());
+
+  EXPECT_TRUE(is_cached(cache, fns[0]));
+  EXPECT_FALSE(is_cached(cache, fns[1]));
+  EXPECT_TRUE(is_cached(cache, fns[2]));
+
+  // A cache of 0 documents doesn't save anything
+  CliDocCache noCache(0);
+  noCache.add(fns[0], doc.get());
+  EXPECT_FALSE(is_cached(noCache, fns[0]));
+
+  doc->close();
+  for (const auto& fn : fns)
+    std::remove(fn.c_str());
+}
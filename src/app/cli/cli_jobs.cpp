@@ -0,0 +1,408 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/cli/cli_jobs.h"
+
+#include "base/fs.h"
+#include "base/fstream_path.h"
+#include "fmt/format.h"
+
+#include "json11.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+  #include "base/string.h"
+
+  #include <io.h>
+  #include <windows.h>
+#else
+  #include <cerrno>
+  #include <cstdlib>
+  #include <cstring>
+  #include <fcntl.h>
+  #include <spawn.h>
+  #include <sys/wait.h>
+  #include <unistd.h>
+
+extern char** environ;
+#endif
+
+namespace app {
+
+namespace {
+
+using FilePtr = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+std::string read_whole_file(std::FILE* f)
+{
+  std::string content;
+  std::fseek(f, 0, SEEK_END);
+  const long size = std::ftell(f);
+  if (size > 0) {
+    content.resize(size);
+    std::rewind(f);
+    content.resize(std::fread(&content[0], 1, size, f));
+  }
+  return content;
+}
+
+#ifdef _WIN32
+
+FilePtr create_output_file()
+{
+  return FilePtr(std::tmpfile(), std::fclose);
+}
+
+// Quotes the argument so CommandLineToArgvW() gives us the same
+// argument in the child process.
+std::wstring quote_arg(const std::wstring& arg)
+{
+  if (!arg.empty() && arg.find_first_of(L" \t\n\v\"") == std::wstring::npos)
+    return arg;
+
+  std::wstring result = L"\"";
+  for (auto it = arg.begin();; ++it) {
+    int backslashes = 0;
+    for (; it != arg.end() && *it == L'\\'; ++it)
+      ++backslashes;
+
+    if (it == arg.end()) {
+      result.append(backslashes * 2, L'\\');
+      break;
+    }
+    if (*it == L'"')
+      result.append(backslashes * 2 + 1, L'\\');
+    else
+      result.append(backslashes, L'\\');
+    result.push_back(*it);
+  }
+  result.push_back(L'"');
+  return result;
+}
+
+#else
+
+// Creates an anonymous temporary file for the output of a job. The
+// file is opened with O_CLOEXEC so other processes spawned at the
+// same time (by other workers) don't inherit it (dup2() clears this
+// flag in the stdout/stderr of the child).
+FilePtr create_output_file()
+{
+  std::string path = base::join_path(base::get_temp_path(), "aseprite-job-XXXXXX");
+  const int fd = mkostemp(&path[0], O_CLOEXEC);
+  if (fd < 0)
+    return FilePtr(nullptr, std::fclose);
+
+  unlink(path.c_str());
+
+  FilePtr file(fdopen(fd, "w+"), std::fclose);
+  if (!file)
+    close(fd);
+  return file;
+}
+
+#endif
+
+// Executes the program in batch mode with the given arguments,
+// returning its exit code and its stdout/stderr output.
+int run_process(const std::string& exe, const std::vector<std::string>& args, std::string& output)
+{
+  FilePtr file = create_output_file();
+  if (!file)
+    throw std::runtime_error("Cannot create a temporary file for the job output");
+
+  int code;
+#ifdef _WIN32
+  HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file.get()));
+  SetHandleInformation(handle, HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT);
+
+  // Only this file is inherited by the child process (other processes
+  // created at the same time must not inherit it, and this one must
+  // not inherit the files of other jobs).
+  SIZE_T attrSize = 0;
+  InitializeProcThreadAttributeList(nullptr, 1, 0, &attrSize);
+  std::vector<char> attrBuffer(attrSize);
+  auto attrList = (LPPROC_THREAD_ATTRIBUTE_LIST)attrBuffer.data();
+  if (!InitializeProcThreadAttributeList(attrList, 1, 0, &attrSize))
+    throw std::runtime_error(
+      fmt::format("Cannot create the process attributes (error {})", GetLastError()));
+
+  struct DeleteAttrList {
+    LPPROC_THREAD_ATTRIBUTE_LIST list;
+    ~DeleteAttrList() { DeleteProcThreadAttributeList(list); }
+  } deleteAttrList{ attrList };
+
+  HANDLE inheritedHandles[] = { handle };
+  if (!UpdateProcThreadAttribute(attrList,
+                                 0,
+                                 PROC_THREAD_ATTRIBUTE_HANDLE_LIST,
+                                 inheritedHandles,
+                                 sizeof(inheritedHandles),
+                                 nullptr,
+                                 nullptr)) {
+    throw std::runtime_error(
+      fmt::format("Cannot set the inherited handles (error {})", GetLastError()));
+  }
+
+  const std::wstring exeW = base::from_utf8(exe);
+  std::wstring cmdline = quote_arg(exeW) + L" --batch";
+  for (const auto& arg : args)
+    cmdline += L" " + quote_arg(base::from_utf8(arg));
+
+  // Jobs don't read from stdin (it's not in the inherited handles)
+  STARTUPINFOEXW si;
+  ZeroMemory(&si, sizeof(si));
+  si.StartupInfo.cb = sizeof(si);
+  si.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+  si.StartupInfo.hStdInput = nullptr;
+  si.StartupInfo.hStdOutput = handle;
+  si.StartupInfo.hStdError = handle;
+  si.lpAttributeList = attrList;
+
+  PROCESS_INFORMATION pi;
+  ZeroMemory(&pi, sizeof(pi));
+  if (!CreateProcessW(exeW.c_str(),
+                      &cmdline[0],
+                      nullptr,
+                      nullptr,
+                      TRUE,
+                      CREATE_NO_WINDOW | EXTENDED_STARTUPINFO_PRESENT,
+                      nullptr,
+                      nullptr,
+                      &si.StartupInfo,
+                      &pi)) {
+    throw std::runtime_error(fmt::format("Cannot execute {} (error {})", exe, GetLastError()));
+  }
+
+  WaitForSingleObject(pi.hProcess, INFINITE);
+  DWORD exitCode = DWORD(-1);
+  GetExitCodeProcess(pi.hProcess, &exitCode);
+  CloseHandle(pi.hThread);
+  CloseHandle(pi.hProcess);
+  code = int(exitCode);
+#else
+  const int fd = fileno(file.get());
+
+  std::string batch = "--batch";
+  std::vector<char*> argv;
+  argv.push_back(const_cast<char*>(exe.c_str()));
+  argv.push_back(&batch[0]);
+  for (const auto& arg : args)
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  argv.push_back(nullptr);
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, fd, STDOUT_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, fd, STDERR_FILENO);
+
+  pid_t pid;
+  const int res = posix_spawn(&pid, exe.c_str(), &actions, nullptr, argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  if (res != 0)
+    throw std::runtime_error(fmt::format("Cannot execute {}: {}", exe, std::strerror(res)));
+
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR)
+      throw std::runtime_error(fmt::format("Error waiting {}: {}", exe, std::strerror(errno)));
+  }
+  code = (WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+#endif
+
+  output = read_whole_file(file.get());
+  return code;
+}
+
+} // anonymous namespace
+
+bool parse_cli_job(const std::string& line, std::vector<std::string>& args)
+{
+  args.clear();
+
+  const auto i = line.find_first_not_of(" \t\r\n");
+  if (i == std::string::npos || line[i] == '#')
+    return false;
+
+  // JSON array or object
+  if (line[i] == '[' || line[i] == '{') {
+    std::string err;
+    const json11::Json json = json11::Json::parse(line, err);
+    const json11::Json& array = (json.is_array() ? json : json["args"]);
+    if (!err.empty())
+      throw std::runtime_error(err);
+    if (!array.is_array())
+      throw std::runtime_error("Expected an array of arguments");
+
+    for (const auto& arg : array.array_items())
+      args.push_back(arg.is_string() ? arg.string_value() : arg.dump());
+  }
+  // Arguments separated by spaces
+  else {
+    std::string arg;
+    bool inArg = false;
+    char quote = 0;
+    for (const char chr : line.substr(i)) {
+      if (quote) {
+        if (chr == quote)
+          quote = 0;
+        else
+          arg.push_back(chr);
+      }
+      else if (chr == '"' || chr == '\'') {
+        quote = chr;
+        inArg = true;
+      }
+      else if (chr == ' ' || chr == '\t' || chr == '\r' || chr == '\n') {
+        if (inArg) {
+          args.push_back(arg);
+          arg.clear();
+          inArg = false;
+        }
+      }
+      else {
+        arg.push_back(chr);
+        inArg = true;
+      }
+    }
+    if (quote)
+      throw std::runtime_error("Unterminated quoted argument");
+    if (inArg)
+      args.push_back(arg);
+  }
+  return !args.empty();
+}
+
+CliJobs read_cli_jobs(const std::string& manifestFilename)
+{
+  std::ifstream f(FSTREAM_PATH(manifestFilename));
+  if (!f)
+    throw std::runtime_error(fmt::format("Cannot open manifest file {}", manifestFilename));
+
+  CliJobs jobs;
+  std::string line;
+  for (int lineNum = 1; std::getline(f, line); ++lineNum) {
+    CliJob job;
+    job.line = lineNum;
+    try {
+      if (!parse_cli_job(line, job.args))
+        continue;
+    }
+    catch (const std::exception& ex) {
+      throw std::runtime_error(fmt::format("{}:{}: {}", manifestFilename, lineNum, ex.what()));
+    }
+    jobs.push_back(std::move(job));
+  }
+  return jobs;
+}
+
+void run_cli_jobs(const CliJobs& jobs, int njobs, const CliJobResultCallback& onResult)
+{
+  const int n = int(jobs.size());
+  if (n == 0)
+    return;
+
+  struct Result {
+    bool done = false;
+    int code = 0;
+    std::string output;
+  };
+
+  const std::string exe = base::get_app_path();
+  std::vector<Result> results(n);
+  std::mutex mutex;
+  std::condition_variable resultReady;
+  std::atomic<int> next(0);
+
+  auto worker = [&]() {
+    int i;
+    while ((i = next++) < n) {
+      Result result;
+      try {
+        result.code = run_process(exe, jobs[i].args, result.output);
+      }
+      catch (const std::exception& ex) {
+        result.code = -1;
+        result.output += ex.what();
+        result.output += "\n";
+      }
+      result.done = true;
+
+      const std::lock_guard lock(mutex);
+      results[i] = std::move(result);
+      resultReady.notify_one();
+    }
+  };
+
+  if (njobs <= 0)
+    njobs = int(std::thread::hardware_concurrency());
+  njobs = std::clamp(njobs, 1, n);
+
+  // Wait the workers even if "onResult" throws an exception (e.g. a
+  // Lua error in app.parallel()), pending jobs are not executed.
+  struct JoinThreads {
+    std::atomic<int>& next;
+    const int n;
+    std::vector<std::thread> threads;
+    ~JoinThreads()
+    {
+      next = n;
+      for (auto& thread : threads)
+        thread.join();
+    }
+  } workers{ next, n, {} };
+
+  for (int i = 0; i < njobs; ++i)
+    workers.threads.emplace_back(worker);
+
+  // Report the result of each job in order
+  for (int i = 0; i < n; ++i) {
+    Result result;
+    {
+      std::unique_lock lock(mutex);
+      resultReady.wait(lock, [&] { return results[i].done; });
+      result = std::move(results[i]);
+    }
+    onResult(i, result.code, result.output);
+  }
+}
+
+int run_cli_jobs(const CliJobs& jobs, int njobs, std::ostream& out)
+{
+  int code = 0;
+  int failed = 0;
+  run_cli_jobs(jobs, njobs, [&](int i, int jobCode, const std::string& output) {
+    out << output;
+    if (jobCode != 0) {
+      out << fmt::format("Job at line {} failed with exit code {}\n", jobs[i].line, jobCode);
+      if (code == 0)
+        code = jobCode;
+      ++failed;
+    }
+    out.flush();
+  });
+
+  if (failed > 0)
+    out << fmt::format("{} of {} jobs failed\n", failed, int(jobs.size()));
+  return code;
+}
+
+} // namespace app
@@ -0,0 +1,57 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_CLI_CLI_JOBS_H_INCLUDED
+#define APP_CLI_CLI_JOBS_H_INCLUDED
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace app {
+
+// Independent CLI execution listed in a --manifest file.
+struct CliJob {
+  int line = 0; // Line of the job in the manifest file
+  std::vector<std::string> args;
+};
+
+using CliJobs = std::vector<CliJob>;
+
+// Parses one line of a manifest file. Each line can be a JSON array
+// of arguments, a JSON object with an "args" array (the same format
+// used by CliServer), or arguments separated by spaces (quotes can
+// be used for arguments with spaces). Returns false for empty lines
+// and comments (lines starting with '#'), throws an exception if the
+// line is invalid.
+bool parse_cli_job(const std::string& line, std::vector<std::string>& args);
+
+// Reads all jobs from the given manifest file.
+CliJobs read_cli_jobs(const std::string& manifestFilename);
+
+// Executes each job in a new process of the program in batch mode,
+// running up to "njobs" processes at the same time (0 means one
+// process per CPU core). The output of each job is written to "out"
+// in the same order of the manifest (not in the order jobs finish),
+// so the output is deterministic. Returns 0 if all jobs succeeded,
+// or the exit code of the first failed job.
+int run_cli_jobs(const CliJobs& jobs, int njobs, std::ostream& out);
+
+// Called with the index, exit code, and output of each job.
+using CliJobResultCallback = std::function<void(int index, int code, const std::string& output)>;
+
+// Same as the previous run_cli_jobs() but each result is given to
+// the "onResult" callback (in the same order of "jobs", from the
+// calling thread) instead of writing it to a stream. If the callback
+// throws, the jobs that are running are waited and the rest are
+// cancelled before the exception is propagated.
+void run_cli_jobs(const CliJobs& jobs, int njobs, const CliJobResultCallback& onResult);
+
+} // namespace app
+
+#endif
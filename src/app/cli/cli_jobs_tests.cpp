@@ -0,0 +1,71 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#include "tests/app_test.h"
+
+#include "app/cli/cli_jobs.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace app;
+
+using Args = std::vector<std::string>;
+
+TEST(CliJobs, ParseSpaceSeparatedArgs)
+{
+  Args args;
+  EXPECT_TRUE(parse_cli_job("  a.aseprite --save-as \"b c.png\" 'd'  ", args));
+  EXPECT_EQ(Args({ "a.aseprite", "--save-as", "b c.png", "d" }), args);
+
+  EXPECT_TRUE(parse_cli_job("a.aseprite --scale 2\r", args));
+  EXPECT_EQ(Args({ "a.aseprite", "--scale", "2" }), args);
+
+  EXPECT_THROW(parse_cli_job("a.aseprite --save-as \"b.png", args), std::runtime_error);
+}
+
+TEST(CliJobs, ParseJsonArgs)
+{
+  Args args;
+  EXPECT_TRUE(parse_cli_job(R"(["a b.aseprite", "--scale", 2])", args));
+  EXPECT_EQ(Args({ "a b.aseprite", "--scale", "2" }), args);
+
+  EXPECT_TRUE(parse_cli_job(R"({"args": ["a.aseprite", "--save-as", "a.png"]})", args));
+  EXPECT_EQ(Args({ "a.aseprite", "--save-as", "a.png" }), args);
+
+  EXPECT_THROW(parse_cli_job(R"({"file": "a.aseprite"})", args), std::runtime_error);
+  EXPECT_THROW(parse_cli_job(R"(["a.aseprite")", args), std::runtime_error);
+}
+
+TEST(CliJobs, SkipEmptyLinesAndComments)
+{
+  Args args;
+  EXPECT_FALSE(parse_cli_job("", args));
+  EXPECT_FALSE(parse_cli_job("   \t", args));
+  EXPECT_FALSE(parse_cli_job("# a.aseprite --save-as a.png", args));
+  EXPECT_TRUE(args.empty());
+}
+
+TEST(CliJobs, ExceptionInResultCallback)
+{
+  // Each job executes this same test program (which only lists its
+  // tests with this argument)
+  CliJobs jobs(8);
+  for (auto& job : jobs)
+    job.args = { "--gtest_list_tests" };
+
+  int results = 0;
+  EXPECT_THROW(run_cli_jobs(jobs,
+                            3,
+                            [&results](int i, int code, const std::string& output) {
+                              ++results;
+                              if (i == 1)
+                                throw std::runtime_error("error");
+                            }),
+               std::runtime_error);
+  EXPECT_EQ(2, results);
+}
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -13,6 +13,8 @@
 
 #include "app/cli/app_options.h"
 #include "app/cli/cli_delegate.h"
+#include "app/cli/cli_doc_cache.h"
+#include "app/cli/cli_jobs.h"
 #include "app/commands/commands.h"
 #include "app/commands/params.h"
 #include "app/console.h"
@@ -20,7 +22,9 @@
 #include "app/doc_exporter.h"
 #include "app/doc_undo.h"
 #include "app/file/file.h"
+#include "app/file/png_options.h"
 #include "app/filename_formatter.h"
+#include "app/pref/preferences.h"
 #include "app/restore_visible_layers.h"
 #include "app/ui_context.h"
 #include "app/util/layer_utils.h"
@@ -123,6 +127,33 @@ std::string convert_filter_to_layer_path_if_possible(const Sprite* sprite,
     return filter;
 }
 
+// Restores the value of an option when the CLI processing ends, so
+// options modified from the CLI (e.g. --png-compression) are used
+// only to save the files of this batch, and aren't used in the UI or
+// saved in the user preferences.
+template<typename T>
+class RestoreOption {
+public:
+  RestoreOption(Option<T>& option)
+    : m_option(option)
+    , m_value(option())
+    , m_dirty(option.isDirty())
+  {
+  }
+
+  ~RestoreOption()
+  {
+    m_option(m_value);
+    if (!m_dirty)
+      m_option.cleanDirtyFlag();
+  }
+
+private:
+  Option<T>& m_option;
+  T m_value;
+  bool m_dirty;
+};
+
 } // anonymous namespace
 
 // static
@@ -182,6 +213,18 @@ int CliProcessor::process(Context* ctx)
     Doc* lastDoc = nullptr;
     render::DitheringAlgorithm ditheringAlgorithm = render::DitheringAlgorithm::None;
     std::string ditheringMatrix;
+    // --jobs <n> (used by all --manifest options, even if they are
+    // specified before --jobs)
+    int njobs = 0;
+    for (const auto& value : m_options.values()) {
+      if (value.option() == &m_options.jobs())
+        njobs = std::max(0, base::convert_to<int>(value.value()));
+    }
+
+    auto& pref = ctx->preferences();
+    RestoreOption<int> restorePngCompression(pref.png.compression);
+    RestoreOption<int> restorePngFilter(pref.png.filter);
+    RestoreOption<int> restorePngThreads(pref.png.threads);
 
     for (const auto& value : m_options.values()) {
       const AppOptions::Option* opt = value.option();
@@ -528,6 +571,68 @@ int CliProcessor::process(Context* ctx)
             }
           }
         }
+        // --png-compression <level>
+        else if (opt == &m_options.pngCompression()) {
+          if (value.value() == "fast") {
+            pref.png.compression(PngOptions::kFastCompression);
+            pref.png.filter(int(PngOptions::Filter::Sub));
+          }
+          else if (value.value() == "default")
+            pref.png.compression(PngOptions::kDefaultCompression);
+          else if (value.value() == "best")
+            pref.png.compression(PngOptions::kBestCompression);
+          else if (value.value().size() == 1 && value.value()[0] >= '0' &&
+                   value.value()[0] <= '9')
+            pref.png.compression(value.value()[0] - '0');
+          else
+            throw std::runtime_error(
+              "--png-compression needs a valid compression level\n"
+              "Usage: --png-compression <level>\n"
+              "Where <level> can be a number from 0 to 9, fast, default, or best");
+        }
+        // --png-filter <filter>
+        else if (opt == &m_options.pngFilter()) {
+          PngOptions::Filter filter;
+          if (value.value() == "adaptive")
+            filter = PngOptions::Filter::Default;
+          else if (value.value() == "none")
+            filter = PngOptions::Filter::None;
+          else if (value.value() == "sub")
+            filter = PngOptions::Filter::Sub;
+          else if (value.value() == "up")
+            filter = PngOptions::Filter::Up;
+          else if (value.value() == "average")
+            filter = PngOptions::Filter::Average;
+          else if (value.value() == "paeth")
+            filter = PngOptions::Filter::Paeth;
+          else
+            throw std::runtime_error("--png-filter needs a valid filter name\n"
+                                     "Usage: --png-filter <filter>\n"
+                                     "Where <filter> can be adaptive, none, sub, up, average, "
+                                     "or paeth");
+          pref.png.filter(int(filter));
+        }
+        // --png-threads <n>
+        else if (opt == &m_options.pngThreads()) {
+          pref.png.threads(std::max(0, base::convert_to<int>(value.value())));
+        }
+        // --jobs <n>
+        else if (opt == &m_options.jobs()) {
+          // Already processed before this loop
+        }
+        // --manifest <filename>
+        else if (opt == &m_options.manifest()) {
+          int code;
+          try {
+            code = m_delegate->runJobs(read_cli_jobs(value.value()), njobs);
+          }
+          catch (const std::exception& ex) {
+            Console::showException(ex);
+            return -1;
+          }
+          if (code != 0)
+            return code;
+        }
 #ifdef ENABLE_SCRIPTING
         // --script <filename>
         else if (opt == &m_options.script()) {
@@ -635,15 +740,30 @@ bool CliProcessor::openFile(Context* ctx, CliOpenFile& cof)
 
   Doc* oldDoc = ctx->activeDocument();
 
-  m_batch.open(ctx, cof.filename, cof.oneFrame);
+  // Use a copy of the document loaded in a previous execution of a
+  // long-running process (see CliServer)
+  Doc* cachedDoc = nullptr;
+  if (m_docCache && !cof.oneFrame)
+    cachedDoc = m_docCache->copyDoc(cof.filename);
 
-  // Mark used file names as "already processed" so we don't try to
-  // open then again
-  for (const auto& usedFn : m_batch.usedFiles()) {
-    auto fn = base::normalize_path(usedFn);
-    m_usedFiles.insert(fn);
+  if (cachedDoc) {
+    cachedDoc->setContext(ctx);
+    ctx->setActiveDocument(cachedDoc);
 
-    os::instance()->markCliFileAsProcessed(fn);
+    m_usedFiles.insert(cof.filename);
+    os::instance()->markCliFileAsProcessed(cof.filename);
+  }
+  else {
+    m_batch.open(ctx, cof.filename, cof.oneFrame);
+
+    // Mark used file names as "already processed" so we don't try to
+    // open then again
+    for (const auto& usedFn : m_batch.usedFiles()) {
+      auto fn = base::normalize_path(usedFn);
+      m_usedFiles.insert(fn);
+
+      os::instance()->markCliFileAsProcessed(fn);
+    }
   }
 
   Doc* doc = ctx->activeDocument();
@@ -652,6 +772,13 @@ bool CliProcessor::openFile(Context* ctx, CliOpenFile& cof)
   if (doc == oldDoc)
     doc = nullptr;
 
+  // Cache documents loaded from one file (not sequences of files)
+  // before they are modified by other CLI options
+  if (doc && !cachedDoc && m_docCache && !cof.oneFrame && m_batch.usedFiles().size() == 1 &&
+      base::normalize_path(m_batch.usedFiles().front()) == cof.filename) {
+    m_docCache->add(cof.filename, doc);
+  }
+
   cof.document = doc;
 
   if (doc) {
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2020  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2016-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -27,6 +27,7 @@ class Sprite;
 namespace app {
 
 class AppOptions;
+class CliDocCache;
 class Context;
 class DocExporter;
 
@@ -35,6 +36,10 @@ public:
   CliProcessor(CliDelegate* delegate, const AppOptions& options);
   int process(Context* ctx);
 
+  // Documents to reuse between several CLI executions in the same
+  // process (e.g. CliServer)
+  void setDocCache(CliDocCache* docCache) { m_docCache = docCache; }
+
   // Public so it can be tested
   static void FilterLayers(const doc::Sprite* sprite,
                            // By value because these vectors will be modified inside
@@ -56,6 +61,7 @@ private:
   CliDelegate* m_delegate;
   const AppOptions& m_options;
   std::unique_ptr<DocExporter> m_exporter;
+  CliDocCache* m_docCache = nullptr;
 
   // Files already used in the CLI processing (e.g. when used to
   // load a sequence of files) so we don't ask for them again.
@@ -0,0 +1,443 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/cli/cli_server.h"
+
+#include "app/cli/app_options.h"
+#include "app/cli/cli_processor.h"
+#include "app/cli/default_cli_delegate.h"
+#include "app/context.h"
+#include "app/doc.h"
+#include "base/log.h"
+
+#include "json11.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+#ifdef _WIN32
+  #include "base/string.h"
+
+  #include <io.h>
+  #include <windows.h>
+
+  #define posix_dup   _dup
+  #define posix_dup2  _dup2
+  #define posix_close _close
+  #define posix_fileno _fileno
+#else
+  #include <csignal>
+  #include <cstring>
+  #include <errno.h>
+  #include <poll.h>
+  #include <sys/socket.h>
+  #include <sys/stat.h>
+  #include <sys/un.h>
+  #include <unistd.h>
+
+  #define posix_dup   dup
+  #define posix_dup2  dup2
+  #define posix_close close
+  #define posix_fileno fileno
+#endif
+
+namespace app {
+
+namespace {
+
+// Client connected to the server. It can send several jobs (one per
+// line) before closing the connection.
+class Connection {
+public:
+#ifdef _WIN32
+  explicit Connection(HANDLE pipe) : m_pipe(pipe) {}
+  ~Connection()
+  {
+    FlushFileBuffers(m_pipe);
+    DisconnectNamedPipe(m_pipe);
+    CloseHandle(m_pipe);
+  }
+#else
+  explicit Connection(int fd) : m_fd(fd) {}
+  ~Connection() { ::close(m_fd); }
+#endif
+
+  // Reads the next line without the end-of-line characters. Returns
+  // false when the client closes the connection, or when it must be
+  // dropped (it sent a too long line, or it stopped sending data in
+  // the middle of a line).
+  bool readLine(std::string& line)
+  {
+    for (;;) {
+      const auto i = m_buffer.find('\n');
+      if (i != std::string::npos) {
+        line = m_buffer.substr(0, i);
+        m_buffer.erase(0, i + 1);
+        break;
+      }
+
+      if (m_buffer.size() > kMaxLineSize) {
+        LOG(ERROR, "CLI: Client sent a line of more than %d bytes\n", int(kMaxLineSize));
+        return false;
+      }
+
+      // We wait forever for the next job, but not for the rest of a
+      // line, so a stuck client cannot block the server.
+      char buf[4096];
+      const int n = read(buf, sizeof(buf), m_buffer.empty() ? -1 : kLineTimeoutMsecs);
+      if (n == kTimeout) {
+        LOG(ERROR, "CLI: Client was idle in the middle of a line\n");
+        return false;
+      }
+      if (n <= 0) {
+        // Last line without end-of-line
+        if (m_buffer.empty())
+          return false;
+        line.swap(m_buffer);
+        m_buffer.clear();
+        break;
+      }
+      m_buffer.append(buf, n);
+    }
+
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    return true;
+  }
+
+  void write(const std::string& data)
+  {
+    const char* p = data.c_str();
+    std::size_t size = data.size();
+    while (size > 0) {
+#ifdef _WIN32
+      DWORD n = 0;
+      if (!WriteFile(m_pipe, p, DWORD(size), &n, nullptr) || n == 0)
+        return;
+#else
+      const ssize_t n = ::write(m_fd, p, size);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return;
+#endif
+      p += n;
+      size -= n;
+    }
+  }
+
+private:
+  static constexpr std::size_t kMaxLineSize = 1024 * 1024;
+  static constexpr int kLineTimeoutMsecs = 30000;
+  static constexpr int kTimeout = -2;
+
+  // Reads the available data, waiting the given milliseconds at most
+  // (or forever if timeoutMsecs < 0). Returns kTimeout if nothing was
+  // received in that time.
+  int read(char* buf, int size, int timeoutMsecs)
+  {
+#ifdef _WIN32
+    if (timeoutMsecs >= 0) {
+      // The pipe is not overlapped, so we peek it until there is
+      // something to read.
+      const ULONGLONG deadline = GetTickCount64() + timeoutMsecs;
+      DWORD avail = 0;
+      while (PeekNamedPipe(m_pipe, nullptr, 0, nullptr, &avail, nullptr) && avail == 0) {
+        if (GetTickCount64() >= deadline)
+          return kTimeout;
+        Sleep(10);
+      }
+    }
+    DWORD n = 0;
+    if (!ReadFile(m_pipe, buf, DWORD(size), &n, nullptr))
+      return -1;
+    return int(n);
+#else
+    for (;;) {
+      if (timeoutMsecs >= 0) {
+        pollfd pfd;
+        pfd.fd = m_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        const int r = poll(&pfd, 1, timeoutMsecs);
+        if (r < 0 && errno == EINTR)
+          continue;
+        if (r == 0)
+          return kTimeout;
+        if (r < 0)
+          return -1;
+      }
+      const ssize_t n = ::read(m_fd, buf, size);
+      if (n < 0 && errno == EINTR)
+        continue;
+      return int(n);
+    }
+#endif
+  }
+
+#ifdef _WIN32
+  HANDLE m_pipe;
+#else
+  int m_fd;
+#endif
+  std::string m_buffer;
+};
+
+// Waits for clients in the given socket/named pipe path.
+class Listener {
+public:
+#ifdef _WIN32
+  explicit Listener(const std::string& path)
+  {
+    // Named pipes must be created in the \\.\pipe\ namespace
+    const std::string prefix = "\\\\.\\pipe\\";
+    if (path.compare(0, prefix.size(), prefix) == 0)
+      m_path = base::from_utf8(path);
+    else
+      m_path = base::from_utf8(prefix + path);
+  }
+
+  std::unique_ptr<Connection> accept()
+  {
+    HANDLE pipe = CreateNamedPipeW(m_path.c_str(),
+                                   PIPE_ACCESS_DUPLEX,
+                                   PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT,
+                                   PIPE_UNLIMITED_INSTANCES,
+                                   64 * 1024,
+                                   64 * 1024,
+                                   0,
+                                   nullptr);
+    if (pipe == INVALID_HANDLE_VALUE)
+      throw std::runtime_error("Cannot create the named pipe for the CLI server");
+
+    if (!ConnectNamedPipe(pipe, nullptr) && GetLastError() != ERROR_PIPE_CONNECTED) {
+      CloseHandle(pipe);
+      return nullptr;
+    }
+    return std::make_unique<Connection>(pipe);
+  }
+
+private:
+  std::wstring m_path;
+#else
+  explicit Listener(const std::string& path) : m_path(path)
+  {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+      throw std::runtime_error("Invalid socket path for the CLI server: " + path);
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+
+    // Remove the socket of a previous server (but not other kind of
+    // files, we don't want to delete a file given by mistake)
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+      unlink(path.c_str());
+
+    m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_fd < 0)
+      throw std::runtime_error("Cannot create the socket for the CLI server");
+
+    if (bind(m_fd, (const sockaddr*)&addr, sizeof(addr)) < 0 || listen(m_fd, 16) < 0) {
+      const std::string error = std::strerror(errno);
+      ::close(m_fd);
+      throw std::runtime_error("Cannot listen in " + path + ": " + error);
+    }
+  }
+
+  ~Listener()
+  {
+    ::close(m_fd);
+    unlink(m_path.c_str());
+  }
+
+  std::unique_ptr<Connection> accept()
+  {
+    int fd;
+    do {
+      fd = ::accept(m_fd, nullptr, nullptr);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0)
+      return nullptr;
+    return std::make_unique<Connection>(fd);
+  }
+
+private:
+  std::string m_path;
+  int m_fd;
+#endif
+};
+
+// Redirects stdout/stderr to a temporary file to send the output of
+// each job to its client.
+class OutputCapture {
+public:
+  OutputCapture()
+  {
+    flush();
+    m_file = std::tmpfile();
+    if (!m_file)
+      return;
+
+    m_stdout = posix_dup(posix_fileno(stdout));
+    m_stderr = posix_dup(posix_fileno(stderr));
+    posix_dup2(posix_fileno(m_file), posix_fileno(stdout));
+    posix_dup2(posix_fileno(m_file), posix_fileno(stderr));
+  }
+
+  ~OutputCapture() { release(); }
+
+  // Restores stdout/stderr and returns the captured output.
+  std::string release()
+  {
+    if (!m_file)
+      return std::string();
+
+    flush();
+    posix_dup2(m_stdout, posix_fileno(stdout));
+    posix_dup2(m_stderr, posix_fileno(stderr));
+    posix_close(m_stdout);
+    posix_close(m_stderr);
+
+    std::string output;
+    std::fseek(m_file, 0, SEEK_END);
+    const long size = std::ftell(m_file);
+    if (size > 0) {
+      output.resize(size);
+      std::rewind(m_file);
+      output.resize(std::fread(&output[0], 1, size, m_file));
+    }
+    std::fclose(m_file);
+    m_file = nullptr;
+    return output;
+  }
+
+private:
+  static void flush()
+  {
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(stdout);
+    std::fflush(stderr);
+  }
+
+  std::FILE* m_file = nullptr;
+  int m_stdout = -1;
+  int m_stderr = -1;
+};
+
+} // anonymous namespace
+
+CliServer::CliServer(const AppOptions& options) : m_options(options)
+{
+}
+
+int CliServer::run(Context* ctx)
+{
+#ifndef _WIN32
+  // Don't finish the server if a client closes the connection before
+  // reading the reply of its job
+  std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+  Listener listener(m_options.serverPath());
+  LOG("CLI: Server listening on %s\n", m_options.serverPath().c_str());
+
+  while (!m_shutdown) {
+    std::unique_ptr<Connection> conn = listener.accept();
+    if (!conn)
+      continue;
+
+    std::string line;
+    while (!m_shutdown && conn->readLine(line)) {
+      if (!line.empty())
+        conn->write(processJob(ctx, line) + "\n");
+    }
+  }
+
+  LOG("CLI: Server finished\n");
+  return 0;
+}
+
+std::string CliServer::processJob(Context* ctx, const std::string& line)
+{
+  std::string err;
+  const json11::Json job = json11::Json::parse(line, err);
+  json11::Json::object reply;
+
+  const json11::Json& argsJson = (job.is_array() ? job : job["args"]);
+  if (!err.empty() || !argsJson.is_array()) {
+    if (job["shutdown"].bool_value()) {
+      m_shutdown = true;
+      reply["code"] = 0;
+    }
+    else {
+      reply["code"] = -1;
+      reply["output"] = "Invalid CLI job: " + (err.empty() ? line : err) + "\n";
+    }
+  }
+  else {
+    std::vector<std::string> args;
+    for (const auto& arg : argsJson.array_items())
+      args.push_back(arg.is_string() ? arg.string_value() : arg.dump());
+
+    OutputCapture capture;
+    reply["code"] = runCli(ctx, args);
+    reply["output"] = capture.release();
+  }
+
+  if (!job["id"].is_null())
+    reply["id"] = job["id"];
+  return json11::Json(reply).dump();
+}
+
+int CliServer::runCli(Context* ctx, const std::vector<std::string>& args)
+{
+  std::vector<const char*> argv;
+  argv.push_back(m_options.exeName().c_str());
+  argv.push_back("--batch");
+  for (const auto& arg : args)
+    argv.push_back(arg.c_str());
+
+  const AppOptions options(int(argv.size()), argv.data());
+
+  const std::vector<Doc*> oldDocs(ctx->documents().begin(), ctx->documents().end());
+
+  int code;
+  try {
+    DefaultCliDelegate delegate;
+    CliProcessor cli(&delegate, options);
+    cli.setDocCache(&m_docCache);
+    code = cli.process(ctx);
+  }
+  catch (const std::exception& ex) {
+    std::cerr << ex.what() << "\n";
+    code = -1;
+  }
+
+  // Close the documents opened by this job
+  std::vector<Doc*> newDocs;
+  for (Doc* doc : ctx->documents()) {
+    if (std::find(oldDocs.begin(), oldDocs.end(), doc) == oldDocs.end())
+      newDocs.push_back(doc);
+  }
+  for (Doc* doc : newDocs) {
+    doc->close();
+    delete doc;
+  }
+
+  return code;
+}
+
+} // namespace app
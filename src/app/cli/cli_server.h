@@ -0,0 +1,59 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_CLI_CLI_SERVER_H_INCLUDED
+#define APP_CLI_CLI_SERVER_H_INCLUDED
+#pragma once
+
+#include "app/cli/cli_doc_cache.h"
+
+#include <string>
+#include <vector>
+
+namespace app {
+
+class AppOptions;
+class Context;
+
+// Executes the CLI jobs received from a Unix domain socket (or a
+// named pipe on Windows) in the same process, so the program is
+// initialized only once for all jobs (--server <socket>).
+//
+// Each job is one line with a JSON array of CLI arguments:
+//
+//   ["sprite.aseprite", "--save-as", "sprite.png"]
+//
+// or a JSON object with the arguments and an optional "id":
+//
+//   {"id": 1, "args": ["sprite.aseprite", "--save-as", "sprite.png"]}
+//
+// The reply to each job is one line with its exit code and what the
+// job printed to stdout/stderr:
+//
+//   {"id": 1, "code": 0, "output": ""}
+//
+// Jobs are executed one after the other in the main thread (commands,
+// scripts and preferences cannot be used from several threads), the
+// {"shutdown": true} job stops the server.
+class CliServer {
+public:
+  explicit CliServer(const AppOptions& options);
+
+  // Returns the exit code of the program.
+  int run(Context* ctx);
+
+private:
+  std::string processJob(Context* ctx, const std::string& line);
+  int runCli(Context* ctx, const std::vector<std::string>& args);
+
+  const AppOptions& m_options;
+  CliDocCache m_docCache;
+  bool m_shutdown = false;
+};
+
+} // namespace app
+
+#endif
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2019  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2016-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -8,9 +8,13 @@
 #include "tests/app_test.h"
 
 #include "app/cli/app_options.h"
+#include "app/cli/cli_jobs.h"
 #include "app/cli/cli_processor.h"
+#include "app/context.h"
 #include "app/doc_exporter.h"
 
+#include <cstdio>
+#include <fstream>
 #include <initializer_list>
 
 using namespace app;
@@ -24,6 +28,7 @@ public:
     m_uiMode = false;
     m_shellMode = false;
     m_batchMode = false;
+    m_njobs = -1;
   }
 
   void showHelp(const AppOptions& options) override { m_helpWasShown = true; }
@@ -39,8 +44,15 @@ public:
   int execScript(const std::string& filename, const Params& params) override { return 0; }
 #endif
 
+  int runJobs(const CliJobs& jobs, int njobs) override
+  {
+    m_njobs = njobs;
+    return 0;
+  }
+
   bool helpWasShown() const { return m_helpWasShown; }
   bool versionWasShown() const { return m_versionWasShown; }
+  int njobs() const { return m_njobs; }
 
 private:
   bool m_helpWasShown;
@@ -48,6 +60,7 @@ private:
   bool m_uiMode;
   bool m_shellMode;
   bool m_batchMode;
+  int m_njobs;
 };
 
 std::unique_ptr<AppOptions> args(std::initializer_list<const char*> l)
@@ -92,3 +105,21 @@ TEST(Cli, Version)
   p.process(nullptr);
   EXPECT_TRUE(d.versionWasShown());
 }
+
+TEST(Cli, JobsBeforeOrAfterManifest)
+{
+  const char* manifest = "cli_test_manifest.txt";
+  std::ofstream(manifest) << "a.aseprite --save-as a.png\n";
+
+  Context ctx;
+  for (const auto& l : { std::initializer_list<const char*>{ "--jobs", "3", "--manifest", manifest },
+                         std::initializer_list<const char*>{ "--manifest", manifest, "--jobs", "3" } }) {
+    CliTestDelegate d;
+    auto a = args(l);
+    CliProcessor p(&d, *a);
+    p.process(&ctx);
+    EXPECT_EQ(3, d.njobs());
+  }
+
+  std::remove(manifest);
+}
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2016-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -134,6 +134,11 @@ void DefaultCliDelegate::exportFiles(Context* ctx, DocExporter& exporter)
   LOG("APP: Export sprite sheet: Done\n");
 }
 
+int DefaultCliDelegate::runJobs(const CliJobs& jobs, int njobs)
+{
+  return run_cli_jobs(jobs, njobs, std::cout);
+}
+
 #ifdef ENABLE_SCRIPTING
 int DefaultCliDelegate::execScript(const std::string& filename, const Params& params)
 {
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2022  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2016-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -21,6 +21,7 @@ public:
   void saveFile(Context* ctx, const CliOpenFile& cof) override;
   void loadPalette(Context* ctx, const std::string& filename) override;
   void exportFiles(Context* ctx, DocExporter& exporter) override;
+  int runJobs(const CliJobs& jobs, int njobs) override;
 #ifdef ENABLE_SCRIPTING
   int execScript(const std::string& filename, const Params& params) override;
 #endif
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2022  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2016-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -207,6 +207,24 @@ void PreviewCliDelegate::exportFiles(Context* ctx, DocExporter& exporter)
   }
 }
 
+int PreviewCliDelegate::runJobs(const CliJobs& jobs, int njobs)
+{
+  std::cout << "- Run " << jobs.size() << " jobs ";
+  if (njobs > 0)
+    std::cout << "(" << njobs << " at the same time)";
+  else
+    std::cout << "(one per CPU core)";
+  std::cout << ":\n";
+
+  for (const auto& job : jobs) {
+    std::cout << "  - Line " << job.line << ":";
+    for (const auto& arg : job.args)
+      std::cout << " '" << arg << "'";
+    std::cout << "\n";
+  }
+  return 0;
+}
+
 #ifdef ENABLE_SCRIPTING
 int PreviewCliDelegate::execScript(const std::string& filename, const Params& params)
 {
@@ -1,4 +1,5 @@
 // Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -22,11 +23,13 @@ namespace app { namespace cmd {
 
 using namespace doc;
 
-AddFrame::AddFrame(Sprite* sprite, frame_t newFrame)
+AddFrame::AddFrame(Sprite* sprite, frame_t newFrame, frame_t count)
   : WithSprite(sprite)
   , m_newFrame(newFrame)
-  , m_addCel(nullptr)
+  , m_count(count)
+  , m_firstTime(true)
 {
+  ASSERT(count > 0);
 }
 
 void AddFrame::onExecute()
@@ -34,28 +37,33 @@ void AddFrame::onExecute()
   Sprite* sprite = this->sprite();
   auto doc = static_cast<Doc*>(sprite->document());
 
-  sprite->addFrame(m_newFrame);
+  sprite->addFrames(m_newFrame, m_count);
   sprite->incrementVersion();
 
-  if (m_addCel) {
-    m_addCel->redo();
-  }
-  else {
+  if (m_firstTime) {
+    m_firstTime = false;
+
     LayerImage* bglayer = sprite->backgroundLayer();
     if (bglayer) {
-      ImageRef bgimage(Image::create(sprite->pixelFormat(), sprite->width(), sprite->height()));
-      clear_image(bgimage.get(), doc->bgColor(bglayer));
-      Cel* cel = new Cel(m_newFrame, bgimage);
-      m_addCel.reset(new cmd::AddCel(bglayer, cel));
-      m_addCel->execute(context());
+      for (frame_t frame = m_newFrame; frame < m_newFrame + m_count; ++frame) {
+        ImageRef bgimage(Image::create(sprite->pixelFormat(), sprite->width(), sprite->height()));
+        clear_image(bgimage.get(), doc->bgColor(bglayer));
+        m_addCels.add(new cmd::AddCel(bglayer, new Cel(frame, bgimage)));
+      }
     }
+    m_addCels.execute(context());
   }
+  else
+    m_addCels.redo();
 
-  // Notify observers about the new frame.
-  DocEvent ev(doc);
-  ev.sprite(sprite);
-  ev.frame(m_newFrame);
-  doc->notify_observers<DocEvent&>(&DocObserver::onAddFrame, ev);
+  // Notify observers about each new frame (in the same order as if
+  // they were added one by one).
+  for (frame_t frame = m_newFrame; frame < m_newFrame + m_count; ++frame) {
+    DocEvent ev(doc);
+    ev.sprite(sprite);
+    ev.frame(frame);
+    doc->notify_observers<DocEvent&>(&DocObserver::onAddFrame, ev);
+  }
 }
 
 void AddFrame::onUndo()
@@ -63,17 +71,18 @@ void AddFrame::onUndo()
   Sprite* sprite = this->sprite();
   auto doc = static_cast<Doc*>(sprite->document());
 
-  if (m_addCel)
-    m_addCel->undo();
+  m_addCels.undo();
 
-  sprite->removeFrame(m_newFrame);
+  sprite->removeFrames(m_newFrame, m_count);
   sprite->incrementVersion();
 
-  // Notify observers about the new frame.
-  DocEvent ev(doc);
-  ev.sprite(sprite);
-  ev.frame(m_newFrame);
-  doc->notify_observers<DocEvent&>(&DocObserver::onRemoveFrame, ev);
+  // Notify observers about each removed frame (last ones first).
+  for (frame_t frame = m_newFrame + m_count - 1; frame >= m_newFrame; --frame) {
+    DocEvent ev(doc);
+    ev.sprite(sprite);
+    ev.frame(frame);
+    doc->notify_observers<DocEvent&>(&DocObserver::onRemoveFrame, ev);
+  }
 }
 
 }} // namespace app::cmd
@@ -1,4 +1,5 @@
 // Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -9,12 +10,10 @@
 #pragma once
 
 #include "app/cmd.h"
-#include "app/cmd/add_cel.h"
 #include "app/cmd/with_sprite.h"
+#include "app/cmd_sequence.h"
 #include "doc/frame.h"
 
-#include <memory>
-
 namespace doc {
 class Sprite;
 }
@@ -25,18 +24,19 @@ using namespace doc;
 class AddFrame : public Cmd,
                  public WithSprite {
 public:
-  AddFrame(Sprite* sprite, frame_t frame);
+  // Adds "count" empty frames starting at "frame".
+  AddFrame(Sprite* sprite, frame_t frame, frame_t count = 1);
 
 protected:
   void onExecute() override;
   void onUndo() override;
-  size_t onMemSize() const override { return sizeof(*this) + (m_addCel ? m_addCel->memSize() : 0); }
+  size_t onMemSize() const override { return sizeof(*this) + m_addCels.memSize(); }
 
 private:
-  void moveFrames(Layer* layer, frame_t fromThis, frame_t delta);
-
   frame_t m_newFrame;
-  std::unique_ptr<AddCel> m_addCel;
+  frame_t m_count;
+  CmdSequence m_addCels;
+  bool m_firstTime;
 };
 
 }} // namespace app::cmd
@@ -1,4 +1,5 @@
 // Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
 // Copyright (C) 2001-2015  David Capello
 //
 // This program is distributed under the terms of
@@ -27,7 +28,7 @@ void ClearImage::onExecute()
   Image* image = this->image();
 
   ASSERT(!m_copy);
-  m_copy.reset(Image::createCopy(image));
+  m_copy.reset(Image::createCompactCopy(image));
   clear_image(image, m_color);
 
   image->incrementVersion();
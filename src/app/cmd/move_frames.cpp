@@ -0,0 +1,69 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/cmd/move_frames.h"
+
+#include "app/doc.h"
+#include "app/doc_event.h"
+#include "doc/sprite.h"
+
+namespace app { namespace cmd {
+
+using namespace doc;
+
+MoveFrames::MoveFrames(Sprite* sprite, const std::vector<frame_t>& order)
+  : WithSprite(sprite)
+  , m_order(order)
+{
+  ASSERT(frame_t(m_order.size()) == sprite->totalFrames());
+}
+
+void MoveFrames::onExecute()
+{
+  Sprite* sprite = this->sprite();
+  sprite->reorderFrames(m_order);
+  sprite->incrementVersion();
+}
+
+void MoveFrames::onUndo()
+{
+  Sprite* sprite = this->sprite();
+
+  std::vector<frame_t> inverse(m_order.size());
+  for (frame_t i = 0; i < frame_t(m_order.size()); ++i)
+    inverse[m_order[i]] = i;
+
+  sprite->reorderFrames(inverse);
+  sprite->incrementVersion();
+}
+
+void MoveFrames::onFireNotifications()
+{
+  Sprite* sprite = this->sprite();
+  Doc* doc = static_cast<Doc*>(sprite->document());
+  DocEvent ev(doc);
+  ev.sprite(sprite);
+
+  // Range of frames that changed their position
+  frame_t first = 0, last = -1;
+  for (frame_t i = 0; i < frame_t(m_order.size()); ++i) {
+    if (m_order[i] != i) {
+      if (last < first)
+        first = i;
+      last = i;
+    }
+  }
+  ev.frame(first);
+  ev.targetFrame(last);
+
+  doc->notify_observers<DocEvent&>(&DocObserver::onFramesMoved, ev);
+}
+
+}} // namespace app::cmd
@@ -0,0 +1,40 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_CMD_MOVE_FRAMES_H_INCLUDED
+#define APP_CMD_MOVE_FRAMES_H_INCLUDED
+#pragma once
+
+#include "app/cmd.h"
+#include "app/cmd/with_sprite.h"
+#include "doc/frame.h"
+
+#include <vector>
+
+namespace app { namespace cmd {
+using namespace doc;
+
+// Reorders all frames of the sprite (durations and cels of all
+// layers) in one step. "order[i]" is the current frame that will be
+// moved to the position "i".
+class MoveFrames : public Cmd,
+                   public WithSprite {
+public:
+  MoveFrames(Sprite* sprite, const std::vector<frame_t>& order);
+
+protected:
+  void onExecute() override;
+  void onUndo() override;
+  void onFireNotifications() override;
+  size_t onMemSize() const override { return sizeof(*this) + sizeof(frame_t) * m_order.size(); }
+
+private:
+  std::vector<frame_t> m_order;
+};
+
+}} // namespace app::cmd
+
+#endif
@@ -1,4 +1,5 @@
 // Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -20,15 +21,22 @@ namespace app { namespace cmd {
 
 using namespace doc;
 
-RemoveFrame::RemoveFrame(Sprite* sprite, frame_t frame)
+RemoveFrame::RemoveFrame(Sprite* sprite, frame_t frame, frame_t count)
   : WithSprite(sprite)
   , m_frame(frame)
+  , m_count(count)
   , m_firstTime(true)
-  , m_frameRemoved(false)
+  , m_framesRemoved(0)
 {
-  m_frameDuration = sprite->frameDuration(frame);
-  for (Cel* cel : sprite->cels(m_frame))
-    m_seq.add(new cmd::RemoveCel(cel));
+  ASSERT(count > 0);
+  ASSERT(frame + count <= sprite->totalFrames());
+
+  m_frameDurations.resize(count);
+  for (frame_t i = 0; i < count; ++i) {
+    m_frameDurations[i] = sprite->frameDuration(frame + i);
+    for (Cel* cel : sprite->cels(frame + i))
+      m_seq.add(new cmd::RemoveCel(cel));
+  }
 }
 
 void RemoveFrame::onExecute()
@@ -45,19 +53,22 @@ void RemoveFrame::onExecute()
 
   int oldTotalFrames = sprite->totalFrames();
 
-  sprite->removeFrame(m_frame);
+  sprite->removeFrames(m_frame, m_count);
   sprite->incrementVersion();
 
-  // True when the number of total frames changed (e.g. this can be
-  // false only then we try to delete the last frame and only frame in
-  // the sprite).
-  m_frameRemoved = (oldTotalFrames != sprite->totalFrames());
-
-  // Notify observers.
-  DocEvent ev(doc);
-  ev.sprite(sprite);
-  ev.frame(m_frame);
-  doc->notify_observers<DocEvent&>(&DocObserver::onRemoveFrame, ev);
+  // Number of frames that were really removed (e.g. it can be less
+  // than m_count when we try to delete all frames, as a sprite
+  // always keeps at least one frame).
+  m_framesRemoved = oldTotalFrames - sprite->totalFrames();
+
+  // Notify observers about each removed frame (last ones first, in
+  // the same order as if they were removed one by one).
+  for (frame_t frame = m_frame + m_count - 1; frame >= m_frame; --frame) {
+    DocEvent ev(doc);
+    ev.sprite(sprite);
+    ev.frame(frame);
+    doc->notify_observers<DocEvent&>(&DocObserver::onRemoveFrame, ev);
+  }
 }
 
 void RemoveFrame::onUndo()
@@ -65,17 +76,20 @@ void RemoveFrame::onUndo()
   Sprite* sprite = this->sprite();
   Doc* doc = static_cast<Doc*>(sprite->document());
 
-  if (m_frameRemoved)
-    sprite->addFrame(m_frame);
-  sprite->setFrameDuration(m_frame, m_frameDuration);
+  if (m_framesRemoved > 0)
+    sprite->addFrames(m_frame, m_framesRemoved);
+  for (frame_t i = 0; i < m_count; ++i)
+    sprite->setFrameDuration(m_frame + i, m_frameDurations[i]);
   sprite->incrementVersion();
   m_seq.undo();
 
-  // Notify observers about the new frame.
-  DocEvent ev(doc);
-  ev.sprite(sprite);
-  ev.frame(m_frame);
-  doc->notify_observers<DocEvent&>(&DocObserver::onAddFrame, ev);
+  // Notify observers about the new frames.
+  for (frame_t frame = m_frame; frame < m_frame + m_count; ++frame) {
+    DocEvent ev(doc);
+    ev.sprite(sprite);
+    ev.frame(frame);
+    doc->notify_observers<DocEvent&>(&DocObserver::onAddFrame, ev);
+  }
 }
 
 }} // namespace app::cmd
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2023  Igara Studio S.A.
+// Copyright (C) 2023-2025  Igara Studio S.A.
 // Copyright (C) 2001-2015  David Capello
 //
 // This program is distributed under the terms of
@@ -39,7 +39,7 @@ void ReplaceImage::onExecute()
   // modify/re-add this same image ID
   ImageRef oldImage = sprite()->getImageRef(m_oldImageId);
   ASSERT(oldImage);
-  m_copy.reset(Image::createCopy(oldImage.get()));
+  m_copy.reset(Image::createCompactCopy(oldImage.get()));
 
   replaceImage(m_oldImageId, m_newImage);
   m_newImage.reset();
@@ -53,7 +53,7 @@ void ReplaceImage::onUndo()
   m_copy->setId(m_oldImageId);
 
   replaceImage(m_newImageId, m_copy);
-  m_copy.reset(Image::createCopy(newImage.get()));
+  m_copy.reset(Image::createCompactCopy(newImage.get()));
 }
 
 void ReplaceImage::onRedo()
@@ -64,7 +64,7 @@ void ReplaceImage::onRedo()
   m_copy->setId(m_newImageId);
 
   replaceImage(m_oldImageId, m_copy);
-  m_copy.reset(Image::createCopy(oldImage.get()));
+  m_copy.reset(Image::createCompactCopy(oldImage.get()));
 }
 
 void ReplaceImage::replaceImage(ObjectId oldId, const ImageRef& newImage)
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -26,11 +26,16 @@
 #include "app/ui/color_bar.h"
 #include "app/ui/color_button.h"
 #include "app/ui/selection_mode_field.h"
+#include "app/util/range_utils.h"
 #include "base/chrono.h"
 #include "base/convert_to.h"
 #include "base/scoped_value.h"
+#include "doc/algorithm/select_by_color.h"
+#include "doc/cel.h"
 #include "doc/image.h"
+#include "doc/layer.h"
 #include "doc/mask.h"
+#include "doc/primitives.h"
 #include "doc/sprite.h"
 #include "ui/box.h"
 #include "ui/button.h"
@@ -54,13 +59,20 @@ struct MaskByColorParams : public NewParams {
   Param<app::Color> color{ this, app::Color(), "color" };
   Param<int> tolerance{ this, 0, "tolerance" };
   Param<gen::SelectionMode> mode{ this, gen::SelectionMode::DEFAULT, "mode" };
+  // Cels to look for the color: "current" (the active cel), "range"
+  // (the selected cels in the timeline), or "all" (all cels of
+  // visible layers in all frames)
+  Param<std::string> cels{ this, "current", "cels" };
 };
 
+using Sources = std::vector<doc::algorithm::SelectByColorSource>;
+
 class MaskByColorWindow : public ui::Window {
 public:
-  MaskByColorWindow(MaskByColorParams& params, const ContextReader& reader)
+  MaskByColorWindow(MaskByColorParams& params, const ContextReader& reader, const Sources& srcs)
     : Window(Window::WithTitleBar, Strings::mask_by_color_title())
     , m_reader(&reader)
+    , m_srcs(&srcs)
     // Save original mask visibility to process it correctly in
     // ADD/SUBTRACT/INTERSECT Selection Mode
     , m_isOrigMaskVisible(reader.document()->isMaskVisible())
@@ -148,6 +160,7 @@ private:
   void maskPreview();
 
   const ContextReader* m_reader = nullptr;
+  const Sources* m_srcs = nullptr;
   bool m_isOrigMaskVisible;
   Button* m_buttonOk = nullptr;
   ColorButton* m_buttonColor = nullptr;
@@ -158,16 +171,29 @@ private:
 
 static Mask* generateMask(const Mask& origMask,
                           bool isOrigMaskVisible,
-                          const Image* image,
-                          int xpos,
-                          int ypos,
+                          const Sources& srcs,
                           gen::SelectionMode mode,
                           int color,
                           int tolerance)
 {
   std::unique_ptr<Mask> mask(new Mask());
-  mask->byColor(image, color, tolerance);
-  mask->offsetOrigin(xpos, ypos);
+
+  gfx::Rect bounds;
+  for (const auto& src : srcs)
+    bounds |= gfx::Rect(src.position, gfx::Size(src.image->width(), src.image->height()));
+
+  mask->replace(bounds);
+  if (!mask->isEmpty()) {
+    clear_image(mask->bitmap(), 0);
+
+    // Positions relative to the mask bitmap
+    Sources maskSrcs(srcs);
+    for (auto& src : maskSrcs)
+      src.position -= bounds.origin();
+
+    doc::algorithm::select_by_color(mask->bitmap(), maskSrcs, color, tolerance);
+    mask->shrink();
+  }
 
   if (!origMask.isEmpty() && isOrigMaskVisible) {
     switch (mode) {
@@ -228,12 +254,35 @@ void MaskByColorCommand::onExecute(Context* context)
   if (!image)
     return;
 
+  auto& params = this->params();
+
+  // Images where we look for the color
+  Sources srcs;
+  if (params.cels() == "all" ||
+      (params.cels() == "range" && reader.site()->range().enabled())) {
+    CelList cels;
+    if (params.cels() == "all") {
+      for (Cel* cel : sprite->uniqueCels())
+        cels.push_back(cel);
+    }
+    else
+      cels = get_unique_cels(sprite, reader.site()->range());
+
+    for (const Cel* cel : cels) {
+      if (cel->layer()->isVisibleHierarchy() &&
+          cel->image()->pixelFormat() == sprite->pixelFormat()) {
+        srcs.push_back({ cel->image(), cel->position() });
+      }
+    }
+  }
+  else
+    srcs.push_back({ image, gfx::Point(xpos, ypos) });
+
   // Save original mask visibility to process it correctly in
   // ADD/SUBTRACT/INTERSECT Selection Mode
   bool isOrigMaskVisible = reader.document()->isMaskVisible();
 
   bool apply = true;
-  auto& params = this->params();
 
   // If UI is available, set parameters default values from the UI/configuration
   if (context->isUIAvailable()) {
@@ -248,7 +297,7 @@ void MaskByColorCommand::onExecute(Context* context)
   }
 
   if (ui) {
-    MaskByColorWindow window(params, reader);
+    MaskByColorWindow window(params, reader, srcs);
 
     // Load window configuration
     load_window_pos(&window, ConfigSection);
@@ -279,9 +328,7 @@ void MaskByColorCommand::onExecute(Context* context)
     Tx tx(writer, "Mask by Color", DoesntModifyDocument);
     std::unique_ptr<Mask> mask(generateMask(*document->mask(),
                                             isOrigMaskVisible,
-                                            image,
-                                            xpos,
-                                            ypos,
+                                            srcs,
                                             params.mode(),
                                             color,
                                             params.tolerance()));
@@ -299,16 +346,12 @@ void MaskByColorCommand::onExecute(Context* context)
 void MaskByColorWindow::maskPreview()
 {
   if (isPreviewChecked()) {
-    int xpos, ypos;
-    const Image* image = m_reader->image(&xpos, &ypos);
     int color = color_utils::color_for_image(m_buttonColor->getColor(),
                                              m_reader->sprite()->pixelFormat());
     int tolerance = m_sliderTolerance->getValue();
     std::unique_ptr<Mask> mask(generateMask(*m_reader->document()->mask(),
                                             m_isOrigMaskVisible,
-                                            image,
-                                            xpos,
-                                            ypos,
+                                            *m_srcs,
                                             m_selMode->selectionMode(),
                                             color,
                                             tolerance));
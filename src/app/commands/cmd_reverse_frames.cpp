@@ -1,4 +1,5 @@
 // Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -13,7 +14,6 @@
 #include "app/context_access.h"
 #include "app/doc_range_ops.h"
 #include "app/modules/gui.h"
-#include "app/ui/timeline/timeline.h"
 
 namespace app {
 
@@ -32,14 +32,14 @@ ReverseFramesCommand::ReverseFramesCommand() : Command(CommandId::ReverseFrames(
 
 bool ReverseFramesCommand::onEnabled(Context* context)
 {
-  auto range = App::instance()->timeline()->range();
+  const DocRange range = context->activeSite().range();
   return context->checkFlags(ContextFlags::ActiveDocumentIsWritable) && range.enabled() &&
          range.frames() >= 2; // We need at least 2 frames to reverse
 }
 
 void ReverseFramesCommand::onExecute(Context* context)
 {
-  auto range = App::instance()->timeline()->range();
+  const DocRange range = context->activeSite().range();
   if (!range.enabled())
     return; // Nothing to do
 
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2024  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -20,6 +20,7 @@
 #include "app/cmd/copy_frame.h"
 #include "app/cmd/flip_image.h"
 #include "app/cmd/move_cel.h"
+#include "app/cmd/move_frames.h"
 #include "app/cmd/move_layer.h"
 #include "app/cmd/remove_cel.h"
 #include "app/cmd/remove_frame.h"
@@ -53,6 +54,7 @@
 #include "doc/cel.h"
 #include "doc/mask.h"
 #include "doc/palette.h"
+#include "doc/selected_frames.h"
 #include "doc/slice.h"
 #include "doc/tag.h"
 #include "doc/tags.h"
@@ -60,6 +62,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <numeric>
 #include <set>
 #include <vector>
 
@@ -327,10 +330,17 @@ void DocApi::addEmptyFrame(Sprite* sprite, frame_t newFrame)
   adjustTags(sprite, newFrame, +1, kDropBeforeFrame, kDefaultTagsAdjustment);
 }
 
+void DocApi::addEmptyFrames(Sprite* sprite, frame_t newFrame, frame_t count)
+{
+  ASSERT(count > 0);
+  m_transaction.execute(new cmd::AddFrame(sprite, newFrame, count));
+  adjustTags(sprite, newFrame, count, kDropBeforeFrame, kDefaultTagsAdjustment);
+}
+
 void DocApi::addEmptyFramesTo(Sprite* sprite, frame_t newFrame)
 {
-  while (sprite->totalFrames() <= newFrame)
-    addEmptyFrame(sprite, sprite->totalFrames());
+  if (sprite->totalFrames() <= newFrame)
+    addEmptyFrames(sprite, sprite->totalFrames(), newFrame - sprite->totalFrames() + 1);
 }
 
 void DocApi::copyFrame(Sprite* sprite,
@@ -364,6 +374,33 @@ void DocApi::removeFrame(Sprite* sprite, frame_t frame)
   adjustTags(sprite, frame, -1, kDropBeforeFrame, kDefaultTagsAdjustment);
 }
 
+void DocApi::removeFrames(Sprite* sprite, const SelectedFrames& frames)
+{
+  auto removeRange = [this, sprite](const frame_t from, const frame_t count) {
+    m_transaction.execute(new cmd::RemoveFrame(sprite, from, count));
+    adjustTags(sprite, from, -count, kDropBeforeFrame, kDefaultTagsAdjustment);
+  };
+
+  // Remove each range of consecutive frames (from the last one to the
+  // first one, so the previous frames keep their indexes).
+  frame_t from = -1;
+  frame_t count = 0;
+  for (const frame_t frame : frames.reversed()) {
+    if (count > 0 && frame == from - 1) {
+      from = frame;
+      ++count;
+    }
+    else {
+      if (count > 0)
+        removeRange(from, count);
+      from = frame;
+      count = 1;
+    }
+  }
+  if (count > 0)
+    removeRange(from, count);
+}
+
 void DocApi::setTotalFrames(Sprite* sprite, frame_t frames)
 {
   ASSERT(frames >= 1);
@@ -391,27 +428,62 @@ void DocApi::moveFrame(Sprite* sprite,
                        const DropFramePlace dropFramePlace,
                        const TagsHandling tagsHandling)
 {
-  const frame_t beforeFrame = (dropFramePlace == kDropBeforeFrame ? targetFrame : targetFrame + 1);
+  std::vector<frame_t> order(sprite->totalFrames());
+  std::iota(order.begin(), order.end(), 0);
 
-  if (frame >= 0 && frame <= sprite->lastFrame() && beforeFrame >= 0 &&
-      beforeFrame <= sprite->lastFrame() + 1 &&
-      ((frame != beforeFrame) || (!sprite->tags().empty() && tagsHandling != kDontAdjustTags))) {
-    // Change the frame-lengths.
-    int frlen_aux = sprite->frameDuration(frame);
+  moveFrameInOrder(sprite, order, frame, targetFrame, dropFramePlace, tagsHandling);
+  reorderFrames(sprite, order);
+}
 
-    // Moving the frame to the future.
-    if (frame < beforeFrame) {
-      for (frame_t c = frame; c < beforeFrame - 1; ++c)
-        setFrameDuration(sprite, c, sprite->frameDuration(c + 1));
-      setFrameDuration(sprite, beforeFrame - 1, frlen_aux);
+frame_t DocApi::moveFrames(Sprite* sprite,
+                           const SelectedFrames& frames,
+                           frame_t targetFrame,
+                           const DropFramePlace dropFramePlace,
+                           const TagsHandling tagsHandling)
+{
+  // Frames are moved one by one (as moveFrame() does, so tags are
+  // adjusted in the same way) but only in the "order" vector. Then
+  // all frames/cels are reordered with just one command.
+  std::vector<frame_t> order(sprite->totalFrames());
+  std::iota(order.begin(), order.end(), 0);
+
+  frame_t srcDelta = 0;
+  frame_t beforeFrame = (dropFramePlace == kDropBeforeFrame ? targetFrame : targetFrame + 1);
+
+  for (const frame_t srcFrame : frames) {
+    frame_t fromFrame = srcFrame + srcDelta;
+    if (srcFrame >= beforeFrame) {
+      srcDelta = 0;
+      fromFrame = srcFrame;
     }
-    // Moving the frame to the past.
-    else if (beforeFrame < frame) {
-      for (frame_t c = frame; c > beforeFrame; --c)
-        setFrameDuration(sprite, c, sprite->frameDuration(c - 1));
-      setFrameDuration(sprite, beforeFrame, frlen_aux);
+
+    moveFrameInOrder(sprite, order, fromFrame, targetFrame, dropFramePlace, tagsHandling);
+
+    if (fromFrame < beforeFrame - 1) {
+      --srcDelta;
     }
+    else if (fromFrame > beforeFrame - 1) {
+      ++beforeFrame;
+      ++targetFrame;
+    }
+  }
 
+  reorderFrames(sprite, order);
+  return beforeFrame;
+}
+
+void DocApi::moveFrameInOrder(Sprite* sprite,
+                              std::vector<frame_t>& order,
+                              const frame_t frame,
+                              frame_t targetFrame,
+                              const DropFramePlace dropFramePlace,
+                              const TagsHandling tagsHandling)
+{
+  const frame_t beforeFrame = (dropFramePlace == kDropBeforeFrame ? targetFrame : targetFrame + 1);
+
+  if (frame >= 0 && frame <= sprite->lastFrame() && beforeFrame >= 0 &&
+      beforeFrame <= sprite->lastFrame() + 1 &&
+      ((frame != beforeFrame) || (!sprite->tags().empty() && tagsHandling != kDontAdjustTags))) {
     if (tagsHandling != kDontAdjustTags) {
       adjustTags(sprite, frame, -1, dropFramePlace, tagsHandling);
       if (targetFrame >= frame)
@@ -419,60 +491,22 @@ void DocApi::moveFrame(Sprite* sprite,
       adjustTags(sprite, targetFrame, +1, dropFramePlace, tagsHandling);
     }
 
-    // Change cel positions.
-    if (frame != beforeFrame)
-      moveFrameLayer(sprite->root(), frame, beforeFrame);
+    // Moving the frame to the future.
+    if (frame < beforeFrame) {
+      std::rotate(order.begin() + frame, order.begin() + frame + 1, order.begin() + beforeFrame);
+    }
+    // Moving the frame to the past.
+    else if (beforeFrame < frame) {
+      std::rotate(order.begin() + beforeFrame, order.begin() + frame, order.begin() + frame + 1);
+    }
   }
 }
 
-void DocApi::moveFrameLayer(Layer* layer, frame_t frame, frame_t beforeFrame)
+void DocApi::reorderFrames(Sprite* sprite, const std::vector<frame_t>& order)
 {
-  ASSERT(layer);
-
-  switch (layer->type()) {
-    case ObjectType::LayerImage:
-    case ObjectType::LayerTilemap: {
-      LayerImage* imglayer = static_cast<LayerImage*>(layer);
-
-      CelList cels;
-      imglayer->getCels(cels);
-
-      CelIterator it = cels.begin();
-      CelIterator end = cels.end();
-
-      for (; it != end; ++it) {
-        Cel* cel = *it;
-        frame_t celFrame = cel->frame();
-        frame_t newFrame = celFrame;
-
-        // moving the frame to the future
-        if (frame < beforeFrame) {
-          if (celFrame == frame) {
-            newFrame = beforeFrame - 1;
-          }
-          else if (celFrame > frame && celFrame < beforeFrame) {
-            --newFrame;
-          }
-        }
-        // moving the frame to the past
-        else if (beforeFrame < frame) {
-          if (celFrame == frame) {
-            newFrame = beforeFrame;
-          }
-          else if (celFrame >= beforeFrame && celFrame < frame) {
-            ++newFrame;
-          }
-        }
-
-        if (celFrame != newFrame)
-          setCelFramePosition(cel, newFrame);
-      }
-      break;
-    }
-
-    case ObjectType::LayerGroup: {
-      for (Layer* child : static_cast<LayerGroup*>(layer)->layers())
-        moveFrameLayer(child, frame, beforeFrame);
+  for (frame_t i = 0; i < frame_t(order.size()); ++i) {
+    if (order[i] != i) {
+      m_transaction.execute(new cmd::MoveFrames(sprite, order));
       break;
     }
   }
@@ -765,41 +799,47 @@ void DocApi::adjustTags(Sprite* sprite,
 
     TRACE_DOCAPI(" - [from to]=[%d %d] ->", from, to);
 
-    // When delta = +1, frame = beforeFrame
-    if (delta == +1) {
-      switch (tagsHandling) {
-        case kDefaultTagsAdjustment:
-          if (frame <= from) {
-            ++from;
-          }
-          if (frame <= to + 1) {
-            ++to;
-          }
-          break;
-        case kFitInsideTags:
-          if (frame < from) {
-            ++from;
-          }
-          if (frame <= to) {
-            ++to;
-          }
-          break;
-        case kFitOutsideTags:
-          if ((frame < from) || (frame == from && dropFramePlace == kDropBeforeFrame)) {
-            ++from;
-          }
-          if ((frame < to) || (frame == to && dropFramePlace == kDropBeforeFrame)) {
-            ++to;
-          }
-          break;
+    // When delta > 0, frame = beforeFrame (the tag is adjusted as if
+    // each frame was added one by one)
+    if (delta > 0) {
+      for (frame_t f = frame; f < frame + delta; ++f) {
+        switch (tagsHandling) {
+          case kDefaultTagsAdjustment:
+            if (f <= from) {
+              ++from;
+            }
+            if (f <= to + 1) {
+              ++to;
+            }
+            break;
+          case kFitInsideTags:
+            if (f < from) {
+              ++from;
+            }
+            if (f <= to) {
+              ++to;
+            }
+            break;
+          case kFitOutsideTags:
+            if ((f < from) || (f == from && dropFramePlace == kDropBeforeFrame)) {
+              ++from;
+            }
+            if ((f < to) || (f == to && dropFramePlace == kDropBeforeFrame)) {
+              ++to;
+            }
+            break;
+        }
       }
     }
-    else if (delta == -1) {
-      if (frame < from) {
-        --from;
-      }
-      if (frame <= to) {
-        --to;
+    // When delta < 0, the frames [frame, frame-delta) are removed
+    else if (delta < 0) {
+      for (frame_t i = 0; i < -delta; ++i) {
+        if (frame < from) {
+          --from;
+        }
+        if (frame <= to) {
+          --to;
+        }
       }
     }
 
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2024  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -18,6 +18,7 @@
 #include "gfx/rect.h"
 
 #include <map>
+#include <vector>
 
 namespace doc {
 class Cel;
@@ -28,6 +29,7 @@ class LayerGroup;
 class LayerImage;
 class Mask;
 class Palette;
+class SelectedFrames;
 class Sprite;
 } // namespace doc
 
@@ -70,6 +72,7 @@ public:
   // Frames API
   void addFrame(Sprite* sprite, frame_t newFrame);
   void addEmptyFrame(Sprite* sprite, frame_t newFrame);
+  void addEmptyFrames(Sprite* sprite, frame_t newFrame, frame_t count);
   void addEmptyFramesTo(Sprite* sprite, frame_t newFrame);
   void copyFrame(Sprite* sprite,
                  frame_t fromFrame,
@@ -77,6 +80,9 @@ public:
                  const DropFramePlace dropFramePlace,
                  const TagsHandling tagsHandling);
   void removeFrame(Sprite* sprite, frame_t frame);
+  // Removes all the given frames (with one command for each range of
+  // consecutive frames).
+  void removeFrames(Sprite* sprite, const SelectedFrames& frames);
   void setTotalFrames(Sprite* sprite, frame_t frames);
   void setFrameDuration(Sprite* sprite, frame_t frame, int msecs);
   void setFrameRangeDuration(Sprite* sprite, frame_t from, frame_t to, int msecs);
@@ -85,6 +91,17 @@ public:
                  frame_t targetFrame,
                  const DropFramePlace dropFramePlace,
                  const TagsHandling tagsHandling);
+  // Moves all the given frames to the target frame (reordering all
+  // frames/cels with just one command). Returns the frame that is
+  // after the last moved frame in the new order.
+  frame_t moveFrames(Sprite* sprite,
+                     const SelectedFrames& frames,
+                     frame_t targetFrame,
+                     const DropFramePlace dropFramePlace,
+                     const TagsHandling tagsHandling);
+  // Reorders all frames (without adjusting tags), "order[i]" is the
+  // current frame that will be in the position "i".
+  void reorderFrames(Sprite* sprite, const std::vector<frame_t>& order);
 
   // Cels API
   void addCel(LayerImage* layer, Cel* cel);
@@ -130,7 +147,12 @@ private:
   void cropImageLayer(LayerImage* layer, const gfx::Rect& bounds, const bool trimOutside);
   bool cropCel(LayerImage* layer, Cel* cel, const gfx::Rect& bounds, const bool trimOutside);
   void setCelFramePosition(Cel* cel, frame_t frame);
-  void moveFrameLayer(Layer* layer, frame_t frame, frame_t beforeFrame);
+  void moveFrameInOrder(Sprite* sprite,
+                        std::vector<frame_t>& order,
+                        const frame_t frame,
+                        frame_t targetFrame,
+                        const DropFramePlace dropFramePlace,
+                        const TagsHandling tagsHandling);
   void adjustTags(Sprite* sprite,
                   const frame_t frame,
                   const frame_t delta,
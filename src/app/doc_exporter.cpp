@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -18,14 +18,15 @@
 #include "app/doc.h"
 #include "app/file/file.h"
 #include "app/filename_formatter.h"
+#include "app/json_writer.h"
 #include "app/restore_visible_layers.h"
 #include "app/snap_to_grid.h"
 #include "app/util/autocrop.h"
 #include "base/convert_to.h"
 #include "base/fs.h"
 #include "base/fstream_path.h"
-#include "base/replace_string.h"
 #include "base/string.h"
+#include "doc/algorithm/pack_rects.h"
 #include "doc/algorithm/shrink_bounds.h"
 #include "doc/cel.h"
 #include "doc/image.h"
@@ -38,7 +39,7 @@
 #include "doc/slice.h"
 #include "doc/sprite.h"
 #include "doc/tag.h"
-#include "gfx/packing_rects.h"
+#include "fmt/format.h"
 #include "gfx/rect_io.h"
 #include "gfx/size.h"
 #include "render/dithering.h"
@@ -49,7 +50,6 @@
 #include <algorithm>
 #include <cstdio>
 #include <fstream>
-#include <iomanip>
 #include <iostream>
 #include <memory>
 #include <set>
@@ -61,33 +61,35 @@ using namespace doc;
 
 namespace {
 
-std::string escape_for_json(const std::string& path)
-{
-  std::string res = path;
-  base::replace_string(res, "\\", "\\\\");
-  base::replace_string(res, "\"", "\\\"");
-  return res;
-}
-
-std::ostream& operator<<(std::ostream& os, const doc::UserData& data)
+// Adds the "color" and "data" fields of the user data to the current
+// JSON object.
+void write_user_data(app::JsonWriter& json, const doc::UserData& data)
 {
   doc::color_t color = data.color();
   if (doc::rgba_geta(color)) {
-    os << ", \"color\": \"#" << std::hex << std::setfill('0') << std::setw(2)
-       << (int)doc::rgba_getr(color) << std::setw(2) << (int)doc::rgba_getg(color) << std::setw(2)
-       << (int)doc::rgba_getb(color) << std::setw(2) << (int)doc::rgba_geta(color) << std::dec
-       << "\"";
+    json.member("color",
+                fmt::format("#{:02x}{:02x}{:02x}{:02x}",
+                            doc::rgba_getr(color),
+                            doc::rgba_getg(color),
+                            doc::rgba_getb(color),
+                            doc::rgba_geta(color)));
   }
   if (!data.text().empty())
-    os << ", \"data\": \"" << escape_for_json(data.text()) << "\"";
-  return os;
+    json.member("data", data.text());
 }
 
 } // anonymous namespace
 
 namespace app {
 
-typedef std::shared_ptr<gfx::Rect> SharedRectPtr;
+// Bounds of a sample in the texture (shared between linked and
+// duplicated samples)
+struct TextureBounds {
+  gfx::Rect bounds;
+  int page = 0;
+};
+
+typedef std::shared_ptr<TextureBounds> SharedBoundsPtr;
 
 DocExporter::Item::Item(Doc* doc,
                         const doc::Tag* tag,
@@ -164,7 +166,7 @@ public:
     , m_isDuplicated(false)
     , m_originalSize(size)
     , m_trimmedBounds(size)
-    , m_inTextureBounds(std::make_shared<gfx::Rect>(size))
+    , m_inTextureBounds(std::make_shared<TextureBounds>(TextureBounds{ gfx::Rect(size) }))
   {
   }
 
@@ -180,8 +182,9 @@ public:
   std::string filename() const { return m_filename; }
   const gfx::Size& originalSize() const { return m_originalSize; }
   const gfx::Rect& trimmedBounds() const { return m_trimmedBounds; }
-  const gfx::Rect& inTextureBounds() const { return *m_inTextureBounds; }
-  const SharedRectPtr& sharedBounds() const { return m_inTextureBounds; }
+  const gfx::Rect& inTextureBounds() const { return m_inTextureBounds->bounds; }
+  int page() const { return m_inTextureBounds->page; }
+  const SharedBoundsPtr& sharedBounds() const { return m_inTextureBounds; }
 
   gfx::Size requiredSize() const
   {
@@ -208,13 +211,14 @@ public:
     m_trimmedBounds = bounds;
   }
 
-  void setInTextureBounds(const gfx::Rect& bounds)
+  void setInTextureBounds(const gfx::Rect& bounds, const int page = 0)
   {
     ASSERT(!bounds.isEmpty());
-    *m_inTextureBounds = bounds;
+    m_inTextureBounds->bounds = bounds;
+    m_inTextureBounds->page = page;
   }
 
-  void setSharedBounds(const SharedRectPtr& bounds) { m_inTextureBounds = bounds; }
+  void setSharedBounds(const SharedBoundsPtr& bounds) { m_inTextureBounds = bounds; }
 
   bool isLinked() const { return m_isLinked; }
   bool isDuplicated() const { return m_isDuplicated; }
@@ -316,7 +320,7 @@ private:
   bool m_isDuplicated;
   gfx::Size m_originalSize;
   gfx::Rect m_trimmedBounds;
-  SharedRectPtr m_inTextureBounds;
+  SharedBoundsPtr m_inTextureBounds;
 };
 
 class DocExporter::Samples {
@@ -332,6 +336,27 @@ public:
 
   const Sample& operator[](const size_t i) const { return m_samples[i]; }
 
+  // Number of textures needed for these samples (see
+  // BestFitLayoutSamples, when the texture size is fixed)
+  int pages() const
+  {
+    int pages = 1;
+    for (const auto& sample : m_samples)
+      pages = std::max(pages, sample.page() + 1);
+    return pages;
+  }
+
+  // Returns the samples in the given texture page
+  Samples page(const int page) const
+  {
+    Samples result;
+    for (const auto& sample : m_samples) {
+      if (sample.page() == page)
+        result.addSample(sample);
+    }
+    return result;
+  }
+
   iterator begin() { return m_samples.begin(); }
   iterator end() { return m_samples.end(); }
   const_iterator begin() const { return m_samples.begin(); }
@@ -522,7 +547,7 @@ public:
                      int& height,
                      base::task_token& token) override
   {
-    gfx::PackingRects pr(borderPadding, shapePadding);
+    std::vector<gfx::Size> sizes;
     doc::ImagesMap duplicates;
 
     uint32_t i = 0;
@@ -550,29 +575,33 @@ public:
       }
       else {
         duplicates[sampleRender] = i;
-        pr.add(sample.requiredSize());
+        sizes.push_back(sample.requiredSize());
       }
       ++i;
     }
 
+    // When the texture size is fixed, samples that don't fit in the
+    // texture are placed in more pages (textures) of the same size.
     token.set_progress_range(0.3f, 0.4f);
+    const doc::algorithm::PackedRects packed =
+      doc::algorithm::pack_rects(sizes, gfx::Size(width, height), borderPadding, shapePadding, &token);
+    token.set_progress_range(0.0f, 1.0f);
+    if (token.canceled())
+      return;
+
     if (width == 0 || height == 0) {
-      gfx::Size sz = pr.bestFit(token, width, height);
-      width = sz.w;
-      height = sz.h;
+      width = packed.size.w;
+      height = packed.size.h;
     }
-    else {
-      pr.pack(gfx::Size(width, height), token);
-    }
-    token.set_progress_range(0.0f, 1.0f);
 
-    auto it = pr.begin();
+    i = 0;
     for (auto& sample : samples) {
       if (sample.isLinked() || sample.isDuplicated() || sample.isEmpty())
         continue;
 
-      ASSERT(it != pr.end());
-      sample.setInTextureBounds(*(it++));
+      ASSERT(i < packed.bounds.size());
+      sample.setInTextureBounds(packed.bounds[i], packed.page[i]);
+      ++i;
     }
   }
 };
@@ -670,39 +699,75 @@ Doc* DocExporter::exportSheet(Context* ctx, base::task_token& token)
     return nullptr;
   token.set_progress(0.4f);
 
-  // 3) Create and render the texture.
-  std::unique_ptr<Doc> textureDocument(createEmptyTexture(samples, token));
-  if (token.canceled())
-    return nullptr;
-  token.set_progress(0.6f);
+  // 3) Create and render the texture. With a fixed texture size,
+  // samples that don't fit are rendered in more textures/pages. The
+  // pages are saved in different files, or (when there is no texture
+  // filename, e.g. for the UI preview) added as frames of the
+  // returned document, so the "page" of each sample in the data file
+  // is the frame of the document.
+  const int npages = samples.pages();
+  const bool pagesAsFrames = (npages > 1 && m_textureFilename.empty());
+  std::unique_ptr<Doc> textureDocument;
+  // The first page (the returned document) uses m_docBuf, the other
+  // pages can share one buffer as each one is saved (or copied)
+  // before rendering the next one.
+  doc::ImageBufferPtr pagesBuf;
+  if (npages > 1)
+    pagesBuf = std::make_shared<doc::ImageBuffer>();
+  for (int page = 0; page < npages; ++page) {
+    const Samples pageSamples = (npages > 1 ? samples.page(page) : Samples());
+    const Samples& textureSamples = (npages > 1 ? pageSamples : samples);
+
+    // All frames of the document must use the same color mode and
+    // palette, so in that case all samples are used to create each
+    // page.
+    std::unique_ptr<Doc> pageDocument(createEmptyTexture(pagesAsFrames ? samples : textureSamples,
+                                                         page == 0 ? m_docBuf : pagesBuf,
+                                                         token));
+    if (token.canceled())
+      return nullptr;
+    token.set_progress(0.6f);
 
-  Sprite* texture = textureDocument->sprite();
-  Image* textureImage = texture->root()->firstLayer()->cel(frame_t(0))->image();
+    Sprite* texture = pageDocument->sprite();
+    Image* textureImage = texture->root()->firstLayer()->cel(frame_t(0))->image();
 
-  renderTexture(ctx, samples, textureImage, token);
-  if (token.canceled())
-    return nullptr;
-  token.set_progress(0.8f);
+    renderTexture(ctx, textureSamples, textureImage, token);
+    if (token.canceled())
+      return nullptr;
+    token.set_progress(0.8f);
+
+    // Trim texture
+    if (m_trimSprite || m_trimCels)
+      trimTexture(textureSamples, texture);
+    token.set_progress(0.9f);
+
+    // Save the image files.
+    if (!m_textureFilename.empty()) {
+      const std::string filename = pageTextureFilename(page, npages);
+      DX_TRACE("DX: exportSheet", filename);
+      pageDocument->setFilename(filename);
+      int ret = save_document(ctx, pageDocument.get());
+      if (ret == 0)
+        pageDocument->markAsSaved();
+    }
 
-  // Trim texture
-  if (m_trimSprite || m_trimCels)
-    trimTexture(samples, texture);
-  token.set_progress(0.9f);
+    // We return the first page
+    if (page == 0) {
+      textureDocument = std::move(pageDocument);
+    }
+    else if (pagesAsFrames) {
+      Sprite* sprite = textureDocument->sprite();
+      sprite->setTotalFrames(frame_t(page + 1));
+      static_cast<LayerImage*>(sprite->root()->firstLayer())
+        ->addCel(new Cel(frame_t(page), ImageRef(Image::createCopy(textureImage))));
+    }
+  }
 
   // Save the metadata.
   if (osbuf)
-    createDataFile(samples, os, texture);
+    createDataFile(samples, os, textureDocument->sprite());
   token.set_progress(0.95f);
 
-  // Save the image files.
-  if (!m_textureFilename.empty()) {
-    DX_TRACE("DX: exportSheet", m_textureFilename);
-    textureDocument->setFilename(m_textureFilename.c_str());
-    int ret = save_document(ctx, textureDocument.get());
-    if (ret == 0)
-      textureDocument->markAsSaved();
-  }
-
   token.set_progress(1.0f);
 
   return textureDocument.release();
@@ -1060,7 +1125,8 @@ void DocExporter::captureSamples(Samples& samples, base::task_token& token)
           for (pos.x = initPos.x; pos.x + gridBounds.w <= spriteBounds.w; pos.x += gridBounds.w) {
             const gfx::Rect cellBounds(pos, gridBounds.size());
             sample.setTrimmedBounds(cellBounds);
-            sample.setSharedBounds(std::make_shared<gfx::Rect>(sample.inTextureBounds()));
+            sample.setSharedBounds(
+              std::make_shared<TextureBounds>(TextureBounds{ sample.inTextureBounds() }));
             samples.addSample(sample);
           }
         }
@@ -1148,7 +1214,9 @@ gfx::Size DocExporter::calculateSheetSize(const Samples& samples, base::task_tok
                    fullTextureBounds.y + fullTextureBounds.h);
 }
 
-Doc* DocExporter::createEmptyTexture(const Samples& samples, base::task_token& token) const
+Doc* DocExporter::createEmptyTexture(const Samples& samples,
+                                     const doc::ImageBufferPtr& buf,
+                                     base::task_token& token) const
 {
   ColorMode colorMode = ColorMode::INDEXED;
   Palette palette(0, 0);
@@ -1217,7 +1285,7 @@ Doc* DocExporter::createEmptyTexture(const Samples& samples, base::task_token& t
                                     transparentColor,
                                     (colorSpace ? colorSpace : gfx::ColorSpace::MakeNone())),
                           maxColors,
-                          m_docBuf));
+                          buf));
 
   if (palette.size() > 0)
     sprite->setPalette(&palette, false);
@@ -1300,12 +1368,20 @@ void DocExporter::trimTexture(const Samples& samples, doc::Sprite* texture) cons
                    m_textureHeight > 0 ? m_textureHeight : size.h);
 }
 
+std::string DocExporter::pageTextureFilename(const int page, const int npages) const
+{
+  if (npages == 1 || page == 0)
+    return m_textureFilename;
+
+  return base::join_path(base::get_file_path(m_textureFilename),
+                         fmt::format("{}-{}.{}",
+                                     base::get_file_title(m_textureFilename),
+                                     page,
+                                     base::get_file_extension(m_textureFilename)));
+}
+
 void DocExporter::createDataFile(const Samples& samples, std::ostream& os, doc::Sprite* texture)
 {
-  std::string frames_begin;
-  std::string frames_end;
-  bool filename_as_key = false;
-  bool filename_as_attr = false;
   int nonExtrudedPosition = 0;
   int nonExtrudedSize = 0;
 
@@ -1317,84 +1393,115 @@ void DocExporter::createDataFile(const Samples& samples, std::ostream& os, doc::
     nonExtrudedSize -= 2;
   }
 
-  // TODO we should use some string templates system here
-  switch (m_dataFormat) {
-    case SpriteSheetDataFormat::JsonHash:
-      frames_begin = "{";
-      frames_end = "}";
-      filename_as_key = true;
-      filename_as_attr = false;
-      break;
-    case SpriteSheetDataFormat::JsonArray:
-      frames_begin = "[";
-      frames_end = "]";
-      filename_as_key = false;
-      filename_as_attr = true;
-      break;
-  }
+  const bool filenameAsKey = (m_dataFormat == SpriteSheetDataFormat::JsonHash);
+  const int npages = samples.pages();
+
+  // The data is streamed directly to "os" (without creating a tree
+  // of JSON values in memory) as it can be huge for sprites with a
+  // lot of frames/layers/slices.
+  JsonWriter json(os, JsonWriter::Style::Pretty);
+
+  // Keep the same whitespace of previous versions (some tools read
+  // the data file line by line).
+  JsonWriter::Layout rootLayout;
+  rootLayout.firstInSameLine = true;
+  JsonWriter::Layout framesLayout;
+  framesLayout.indent = 2;
+  framesLayout.breakIfEmpty = true;
+  JsonWriter::Layout listLayout;
+  listLayout.breakIfEmpty = true;
+  JsonWriter::Layout inlinedListLayout;
+  inlinedListLayout.inlined = true;
+  inlinedListLayout.padOpen = false;
+  inlinedListLayout.padClose = false;
+  JsonWriter::Layout sliceRectLayout;
+  sliceRectLayout.inlined = true;
+  sliceRectLayout.padOpen = false;
+
+  json.beginObject(rootLayout);
+
+  json.key("frames");
+  if (filenameAsKey)
+    json.beginObject(framesLayout);
+  else
+    json.beginArray(framesLayout);
+
+  for (const Sample& sample : samples) {
+    const gfx::Size srcSize = sample.originalSize();
+    const gfx::Rect spriteSourceBounds = sample.trimmedBounds();
+    const gfx::Rect frameBounds = sample.inTextureBounds();
+
+    if (filenameAsKey) {
+      json.key(sample.filename()).beginObject();
+    }
+    else {
+      json.beginObject();
+      json.member("filename", sample.filename());
+    }
 
-  os << "{ \"frames\": " << frames_begin << "\n";
-  for (Samples::const_iterator it = samples.begin(), end = samples.end(); it != end;) {
-    const Sample& sample = *it;
-    gfx::Size srcSize = sample.originalSize();
-    gfx::Rect spriteSourceBounds = sample.trimmedBounds();
-    gfx::Rect frameBounds = sample.inTextureBounds();
-
-    if (filename_as_key)
-      os << "   \"" << escape_for_json(sample.filename()) << "\": {\n";
-    else if (filename_as_attr)
-      os << "   {\n"
-         << "    \"filename\": \"" << escape_for_json(sample.filename()) << "\",\n";
-
-    os << "    \"frame\": { "
-       << "\"x\": " << frameBounds.x + nonExtrudedPosition << ", "
-       << "\"y\": " << frameBounds.y + nonExtrudedPosition << ", "
-       << "\"w\": " << frameBounds.w + nonExtrudedSize << ", "
-       << "\"h\": " << frameBounds.h + nonExtrudedSize << " },\n"
-       << "    \"rotated\": false,\n"
-       << "    \"trimmed\": " << (sample.trimmed() ? "true" : "false") << ",\n"
-       << "    \"spriteSourceSize\": { "
-       << "\"x\": " << spriteSourceBounds.x << ", "
-       << "\"y\": " << spriteSourceBounds.y << ", "
-       << "\"w\": " << spriteSourceBounds.w << ", "
-       << "\"h\": " << spriteSourceBounds.h << " },\n"
-       << "    \"sourceSize\": { "
-       << "\"w\": " << srcSize.w << ", "
-       << "\"h\": " << srcSize.h << " },\n"
-       << "    \"duration\": " << sample.sprite()->frameDuration(sample.frame()) << "\n"
-       << "   }";
-
-    if (++it != samples.end())
-      os << ",\n";
-    else
-      os << "\n";
+    json.key("frame")
+      .beginObject(true)
+      .member("x", frameBounds.x + nonExtrudedPosition)
+      .member("y", frameBounds.y + nonExtrudedPosition)
+      .member("w", frameBounds.w + nonExtrudedSize)
+      .member("h", frameBounds.h + nonExtrudedSize)
+      .endObject();
+    if (npages > 1)
+      json.member("page", sample.page());
+    json.member("rotated", false);
+    json.member("trimmed", sample.trimmed());
+    json.key("spriteSourceSize")
+      .beginObject(true)
+      .member("x", spriteSourceBounds.x)
+      .member("y", spriteSourceBounds.y)
+      .member("w", spriteSourceBounds.w)
+      .member("h", spriteSourceBounds.h)
+      .endObject();
+    json.key("sourceSize")
+      .beginObject(true)
+      .member("w", srcSize.w)
+      .member("h", srcSize.h)
+      .endObject();
+    json.member("duration", sample.sprite()->frameDuration(sample.frame()));
+    json.endObject();
   }
-  os << " " << frames_end;
+
+  if (filenameAsKey)
+    json.endObject();
+  else
+    json.endArray();
 
   // "meta" property
-  os << ",\n"
-     << " \"meta\": {\n"
-     << "  \"app\": \"" << get_app_url() << "\",\n"
-     << "  \"version\": \"" << get_app_version() << "\",\n";
+  json.key("meta").beginObject();
+  json.member("app", get_app_url());
+  json.member("version", get_app_version());
 
-  if (!m_textureFilename.empty())
-    os << "  \"image\": \"" << escape_for_json(base::get_file_name(m_textureFilename)).c_str()
-       << "\",\n";
+  if (!m_textureFilename.empty()) {
+    json.member("image", base::get_file_name(m_textureFilename));
+
+    // meta.pages (the "page" of each frame is an index of this array)
+    if (npages > 1) {
+      json.key("pages").beginArray(true);
+      for (int page = 0; page < npages; ++page)
+        json.value(base::get_file_name(pageTextureFilename(page, npages)));
+      json.endArray();
+    }
+  }
 
-  os << "  \"format\": \"" << (texture->pixelFormat() == IMAGE_RGB ? "RGBA8888" : "I8") << "\",\n"
-     << "  \"size\": { "
-     << "\"w\": " << texture->width() << ", "
-     << "\"h\": " << texture->height() << " },\n"
-     << "  \"scale\": \"1\"";
+  json.member("format", (texture->pixelFormat() == IMAGE_RGB ? "RGBA8888" : "I8"));
+  json.key("size")
+    .beginObject(true)
+    .member("w", texture->width())
+    .member("h", texture->height())
+    .endObject();
+  json.member("scale", "1");
 
   // meta.frameTags
   if (m_listTags) {
-    os << ",\n"
-       << "  \"frameTags\": ["; // TODO rename this someday in the future
+    json.key("frameTags").beginArray(listLayout); // TODO rename this someday in the future
 
     std::set<doc::ObjectId> includedSprites;
 
-    bool firstTag = true;
     for (auto& item : m_documents) {
       if (item.isOneImageOnly())
         continue;
@@ -1411,11 +1518,6 @@ void DocExporter::createDataFile(const Samples& samples, std::ostream& os, doc::
       includedSprites.insert(sprite->id());
 
       for (Tag* tag : sprite->tags()) {
-        if (firstTag)
-          firstTag = false;
-        else
-          os << ",";
-
         std::string format = m_tagnameFormat;
         if (format.empty()) {
           format = "{tag}";
@@ -1424,19 +1526,19 @@ void DocExporter::createDataFile(const Samples& samples, std::ostream& os, doc::
         FilenameInfo fnInfo;
         fnInfo.filename(doc->filename()).innerTagName(tag->name());
         std::string tagname = filename_formatter(format, fnInfo);
-        os << "\n   { \"name\": \"" << escape_for_json(tagname) << "\","
-           << " \"from\": " << (tag->fromFrame()) << ","
-           << " \"to\": " << (tag->toFrame())
-           << ","
-              " \"direction\": \""
-           << escape_for_json(convert_anidir_to_string(tag->aniDir())) << "\"";
-        if (tag->repeat() > 0) {
-          os << ", \"repeat\": \"" << tag->repeat() << "\"";
-        }
-        os << tag->userData() << " }";
+
+        json.beginObject(true);
+        json.member("name", tagname);
+        json.member("from", tag->fromFrame());
+        json.member("to", tag->toFrame());
+        json.member("direction", convert_anidir_to_string(tag->aniDir()));
+        if (tag->repeat() > 0)
+          json.member("repeat", std::to_string(tag->repeat()));
+        write_user_data(json, tag->userData());
+        json.endObject();
       }
     }
-    os << "\n  ]";
+    json.endArray();
   }
 
   // meta.layers
@@ -1478,24 +1580,19 @@ void DocExporter::createDataFile(const Samples& samples, std::ostream& os, doc::
       }
     }
 
-    bool firstLayer = true;
-    os << ",\n"
-       << "  \"layers\": [";
+    json.key("layers").beginArray(listLayout);
     for (Layer* layer : metaLayers) {
-      if (firstLayer)
-        firstLayer = false;
-      else
-        os << ",";
-      os << "\n   { \"name\": \"" << escape_for_json(layer->name()) << "\"";
+      json.beginObject(true);
+      json.member("name", layer->name());
 
       if (layer->parent() != layer->sprite()->root())
-        os << ", \"group\": \"" << escape_for_json(layer->parent()->name()) << "\"";
+        json.member("group", layer->parent()->name());
 
       if (LayerImage* layerImg = dynamic_cast<LayerImage*>(layer)) {
-        os << ", \"opacity\": " << layerImg->opacity() << ", \"blendMode\": \""
-           << blend_mode_to_string(layerImg->blendMode()) << "\"";
+        json.member("opacity", layerImg->opacity());
+        json.member("blendMode", blend_mode_to_string(layerImg->blendMode()));
       }
-      os << layer->userData();
+      write_user_data(json, layer->userData());
 
       // Cels
       CelList cels;
@@ -1509,45 +1606,33 @@ void DocExporter::createDataFile(const Samples& samples, std::ostream& os, doc::
       }
 
       if (someCelWithData) {
-        bool firstCel = true;
-
-        os << ", \"cels\": [";
+        json.key("cels").beginArray(inlinedListLayout);
         for (const Cel* cel : cels) {
           if (cel->zIndex() != 0 || !cel->data()->userData().isEmpty()) {
-            if (firstCel)
-              firstCel = false;
-            else
-              os << ", ";
-
-            os << "{ \"frame\": " << cel->frame();
-            if (cel->opacity() != 255) {
-              os << ", \"opacity\": " << cel->opacity();
-            }
-            if (cel->zIndex() != 0) {
-              os << ", \"zIndex\": " << cel->zIndex();
-            }
-            if (!cel->data()->userData().isEmpty()) {
-              os << cel->data()->userData();
-            }
-            os << " }";
+            json.beginObject();
+            json.member("frame", cel->frame());
+            if (cel->opacity() != 255)
+              json.member("opacity", cel->opacity());
+            if (cel->zIndex() != 0)
+              json.member("zIndex", cel->zIndex());
+            write_user_data(json, cel->data()->userData());
+            json.endObject();
           }
         }
-        os << "]";
+        json.endArray();
       }
 
-      os << " }";
+      json.endObject();
     }
-    os << "\n  ]";
+    json.endArray();
   }
 
   // meta.slices
   if (m_listSlices) {
-    os << ",\n"
-       << "  \"slices\": [";
+    json.key("slices").beginArray(listLayout);
 
     std::set<doc::ObjectId> includedSprites;
 
-    bool firstSlice = true;
     for (auto& item : m_documents) {
       if (item.isOneImageOnly())
         continue;
@@ -1566,58 +1651,56 @@ void DocExporter::createDataFile(const Samples& samples, std::ostream& os, doc::
       // TODO add possibility to export some slices
 
       for (Slice* slice : sprite->slices()) {
-        if (firstSlice)
-          firstSlice = false;
-        else
-          os << ",";
-        os << "\n   { \"name\": \"" << escape_for_json(slice->name()) << "\"" << slice->userData();
+        json.beginObject(true);
+        json.member("name", slice->name());
+        write_user_data(json, slice->userData());
 
         // Keys
         if (!slice->empty()) {
-          bool firstKey = true;
-
-          os << ", \"keys\": [";
+          json.key("keys").beginArray(inlinedListLayout);
           for (const auto& key : *slice) {
-            if (firstKey)
-              firstKey = false;
-            else
-              os << ", ";
-
             const SliceKey* sliceKey = key.value();
 
-            os << "{ \"frame\": " << key.frame() << ", "
-               << "\"bounds\": {"
-               << "\"x\": " << sliceKey->bounds().x << ", "
-               << "\"y\": " << sliceKey->bounds().y << ", "
-               << "\"w\": " << sliceKey->bounds().w << ", "
-               << "\"h\": " << sliceKey->bounds().h << " }";
+            json.beginObject();
+            json.member("frame", key.frame());
+            json.key("bounds")
+              .beginObject(sliceRectLayout)
+              .member("x", sliceKey->bounds().x)
+              .member("y", sliceKey->bounds().y)
+              .member("w", sliceKey->bounds().w)
+              .member("h", sliceKey->bounds().h)
+              .endObject();
 
             if (!sliceKey->center().isEmpty()) {
-              os << ", \"center\": {"
-                 << "\"x\": " << sliceKey->center().x << ", "
-                 << "\"y\": " << sliceKey->center().y << ", "
-                 << "\"w\": " << sliceKey->center().w << ", "
-                 << "\"h\": " << sliceKey->center().h << " }";
+              json.key("center")
+                .beginObject(sliceRectLayout)
+                .member("x", sliceKey->center().x)
+                .member("y", sliceKey->center().y)
+                .member("w", sliceKey->center().w)
+                .member("h", sliceKey->center().h)
+                .endObject();
             }
 
             if (sliceKey->hasPivot()) {
-              os << ", \"pivot\": {"
-                 << "\"x\": " << sliceKey->pivot().x << ", "
-                 << "\"y\": " << sliceKey->pivot().y << " }";
+              json.key("pivot")
+                .beginObject(sliceRectLayout)
+                .member("x", sliceKey->pivot().x)
+                .member("y", sliceKey->pivot().y)
+                .endObject();
             }
 
-            os << " }";
+            json.endObject();
           }
-          os << "]";
+          json.endArray();
         }
-        os << " }";
+        json.endObject();
       }
     }
-    os << "\n  ]";
+    json.endArray();
   }
 
-  os << "\n }\n"
-     << "}\n";
+  json.endObject(); // meta
+  json.endObject();
 }
 
 } // namespace app
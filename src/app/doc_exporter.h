@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2022  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -110,13 +110,16 @@ private:
   void captureSamples(Samples& samples, base::task_token& token);
   void layoutSamples(Samples& samples, base::task_token& token);
   gfx::Size calculateSheetSize(const Samples& samples, base::task_token& token) const;
-  Doc* createEmptyTexture(const Samples& samples, base::task_token& token) const;
+  Doc* createEmptyTexture(const Samples& samples,
+                          const doc::ImageBufferPtr& buf,
+                          base::task_token& token) const;
   void renderTexture(Context* ctx,
                      const Samples& samples,
                      doc::Image* textureImage,
                      base::task_token& token) const;
   void trimTexture(const Samples& samples, doc::Sprite* texture) const;
   void createDataFile(const Samples& samples, std::ostream& os, doc::Sprite* texture);
+  std::string pageTextureFilename(int page, int npages) const;
 
   class Item {
   public:
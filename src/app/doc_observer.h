@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -71,6 +71,11 @@ public:
 
   virtual void onFrameDurationChanged(DocEvent& ev) {}
 
+  // Several frames (durations and cels) were reordered at once.
+  // ev.frame() and ev.targetFrame() are the first and last frames
+  // that changed their position.
+  virtual void onFramesMoved(DocEvent& ev) {}
+
   virtual void onImagePixelsModified(DocEvent& ev) {}
   virtual void onSpritePixelsModified(DocEvent& ev) {}
   virtual void onExposeSpritePixels(DocEvent& ev) {}
@@ -23,7 +23,10 @@
 #include "doc/layer.h"
 #include "doc/sprite.h"
 
+#include <algorithm>
+#include <numeric>
 #include <stdexcept>
+#include <vector>
 
 #ifdef TRACE_RANGE_OPS
   #include <iostream>
@@ -98,30 +101,41 @@ static DocRange move_or_copy_frames(DocApi& api,
             << " " << dstFrame << "\n";
 #endif
 
+  frame_t dstBeforeFrame = (place == kDocRangeBefore ? dstFrame : dstFrame + 1);
+
+  // All frames are moved at once
+  if (op == Move) {
+    dstBeforeFrame = api.moveFrames(sprite,
+                                    srcFrames,
+                                    dstFrame,
+                                    (place == kDocRangeBefore ? kDropBeforeFrame : kDropAfterFrame),
+                                    tagsHandling);
+
+    DocRange result;
+    if (!srcRange.selectedLayers().empty())
+      result.selectLayers(srcRange.selectedLayers());
+    result.startRange(nullptr, dstBeforeFrame - srcFrames.size(), DocRange::kFrames);
+    result.endRange(nullptr, dstBeforeFrame - 1);
+    return result;
+  }
+
+  // Frames are copied one by one: each new frame needs its own copy
+  // of the cels (CopyCel handles linked cels, tilemaps, etc.), so
+  // there is no single command to copy a whole block of frames yet.
+  ASSERT(op == Copy);
+
   auto srcFrame = srcFrames.begin();
   auto srcFrameEnd = srcFrames.end();
   frame_t srcDelta = 0;
   frame_t firstCopiedBlock = 0;
-  frame_t dstBeforeFrame = (place == kDocRangeBefore ? dstFrame : dstFrame + 1);
 
   for (; srcFrame != srcFrameEnd; ++srcFrame) {
     frame_t fromFrame = (*srcFrame) + srcDelta;
 
-    switch (op) {
-      case Move:
-        if ((*srcFrame) >= dstBeforeFrame) {
-          srcDelta = 0;
-          fromFrame = *srcFrame;
-        }
-        break;
-
-      case Copy:
-        if (fromFrame >= dstBeforeFrame - 1 && firstCopiedBlock) {
-          srcDelta += firstCopiedBlock;
-          fromFrame += firstCopiedBlock;
-          firstCopiedBlock = 0;
-        }
-        break;
+    if (fromFrame >= dstBeforeFrame - 1 && firstCopiedBlock) {
+      srcDelta += firstCopiedBlock;
+      fromFrame += firstCopiedBlock;
+      firstCopiedBlock = 0;
     }
 
 #ifdef TRACE_RANGE_OPS
@@ -129,45 +143,24 @@ static DocRange move_or_copy_frames(DocApi& api,
     for (frame_t i = 0; i <= sprite->lastFrame(); ++i) {
       std::clog << (sprite->frameDuration(i) - 1);
     }
-    std::clog << "] => " << (op == Move ? "Move" : "Copy") << " " << (*srcFrame) << "+"
-              << (srcDelta) << (place == kDocRangeBefore ? " before " : " after ") << dstFrame
-              << " => ";
+    std::clog << "] => Copy " << (*srcFrame) << "+" << (srcDelta)
+              << (place == kDocRangeBefore ? " before " : " after ") << dstFrame << " => ";
 #endif
 
-    switch (op) {
-      case Move:
-        api.moveFrame(sprite,
-                      fromFrame,
-                      dstFrame,
-                      (place == kDocRangeBefore ? kDropBeforeFrame : kDropAfterFrame),
-                      tagsHandling);
+    api.copyFrame(sprite,
+                  fromFrame,
+                  dstFrame,
+                  (place == kDocRangeBefore ? kDropBeforeFrame : kDropAfterFrame),
+                  tagsHandling);
 
-        if (fromFrame < dstBeforeFrame - 1) {
-          --srcDelta;
-        }
-        else if (fromFrame > dstBeforeFrame - 1) {
-          ++dstBeforeFrame;
-          ++dstFrame;
-        }
-        break;
-
-      case Copy:
-        api.copyFrame(sprite,
-                      fromFrame,
-                      dstFrame,
-                      (place == kDocRangeBefore ? kDropBeforeFrame : kDropAfterFrame),
-                      tagsHandling);
-
-        if (fromFrame < dstBeforeFrame - 1) {
-          ++firstCopiedBlock;
-        }
-        else if (fromFrame >= dstBeforeFrame - 1) {
-          ++srcDelta;
-        }
-        ++dstBeforeFrame;
-        ++dstFrame;
-        break;
+    if (fromFrame < dstBeforeFrame - 1) {
+      ++firstCopiedBlock;
     }
+    else if (fromFrame >= dstBeforeFrame - 1) {
+      ++srcDelta;
+    }
+    ++dstBeforeFrame;
+    ++dstFrame;
 
 #ifdef TRACE_RANGE_OPS
     std::clog << " [";
@@ -491,9 +484,10 @@ void reverse_frames(Doc* doc, const DocRange& range)
   }
 
   if (moveFrames) {
-    for (frame_t frameRev = frameEnd + 1; frameRev > frameBegin; --frameRev) {
-      api.moveFrame(sprite, frameBegin, frameRev, kDropBeforeFrame, kDontAdjustTags);
-    }
+    std::vector<frame_t> order(sprite->totalFrames());
+    std::iota(order.begin(), order.end(), 0);
+    std::reverse(order.begin() + frameBegin, order.begin() + frameEnd + 1);
+    api.reorderFrames(sprite, order);
   }
   else if (swapCels) {
     for (Layer* layer : layers) {
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2020-2024  Igara Studio S.A.
+// Copyright (C) 2020-2025  Igara Studio S.A.
 // Copyright (C) 2017-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -20,6 +20,7 @@
 #include "app/load_matrix.h"
 #include "app/pref/preferences.h"
 #include "app/resource_finder.h"
+#include "app/startup_profiler.h"
 #include "base/exception.h"
 #include "base/file_content.h"
 #include "base/file_handle.h"
@@ -776,6 +777,8 @@ void Extension::addScript(const std::string& fn)
 
 Extensions::Extensions()
 {
+  StartupScope scope("Extensions");
+
   // Create and get the user extensions directory
   {
     ResourceFinder rf2;
@@ -814,6 +817,7 @@ Extensions::Extensions()
       }
 
       try {
+        StartupScope scope("Extension ", fn);
         loadExtension(dir, fullFn, isBuiltinExtension);
       }
       catch (const std::exception& ex) {
@@ -831,8 +835,10 @@ Extensions::~Extensions()
 
 void Extensions::executeInitActions()
 {
-  for (auto& ext : m_extensions)
+  for (auto& ext : m_extensions) {
+    StartupScope scope("Plugin ", ext->name(), " init()");
     ext->executeInitActions();
+  }
 
   ScriptsChange(nullptr);
 }
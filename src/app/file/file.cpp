@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -55,6 +55,9 @@ namespace app {
 
 using namespace base;
 
+// Minimum size of an image to try to compact it after loading a file
+static constexpr int kMinCompactImageSize = 1024 * 1024;
+
 class FileOp::FileAbstractImageImpl : public FileAbstractImage {
 public:
   FileAbstractImageImpl(FileOp* fop)
@@ -912,6 +915,20 @@ void FileOp::operate(IFileOpProgress* progress)
         setError("Error loading data file: %s\n", ex.what());
       }
     }
+
+    // Compact big images of cels outside the first frame (the first
+    // frame is displayed just after loading the file), so mostly
+    // transparent cels don't use memory until they are used. This is
+    // done only when the file is opened in the UI, a CLI/script load
+    // usually processes all frames just after loading the file (and
+    // would expand all images again).
+    if (m_document && m_document->sprite() && !m_oneframe && m_context &&
+        m_context->isUIAvailable()) {
+      for (Cel* cel : m_document->sprite()->uniqueCels()) {
+        if (cel->frame() > 0 && cel->image()->getMemSize() >= kMinCompactImageSize)
+          cel->image()->compact();
+      }
+    }
   }
   // Save //////////////////////////////////////////////////////////////////////
   else if (m_type == FileOpSave && m_format != NULL && m_format->support(FILE_SUPPORT_SAVE)) {
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2023  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -12,6 +12,8 @@
 #include "app/doc.h"
 #include "app/file/file.h"
 #include "app/file/file_formats_manager.h"
+#include "app/file/png_options.h"
+#include "app/pref/preferences.h"
 #include "base/base64.h"
 #include "doc/doc.h"
 #include "doc/user_data.h"
@@ -363,3 +365,70 @@ TEST(File, CustomProperties)
     }
   }
 }
+
+TEST(File, PngParallelIdat)
+{
+  app::Context ctx;
+  auto& pref = ctx.preferences();
+  const std::string fn = "test_parallel_idat.png";
+
+  struct TestCase {
+    doc::ColorMode mode;
+    int compression;
+    PngOptions::Filter filter;
+  };
+  const std::vector<TestCase> tests = {
+    { doc::ColorMode::RGB, PngOptions::kDefaultCompression, PngOptions::Filter::Default },
+    { doc::ColorMode::RGB, PngOptions::kFastCompression, PngOptions::Filter::Sub },
+    { doc::ColorMode::RGB, PngOptions::kBestCompression, PngOptions::Filter::Paeth },
+    { doc::ColorMode::INDEXED, 0, PngOptions::Filter::None },
+    { doc::ColorMode::INDEXED, PngOptions::kDefaultCompression, PngOptions::Filter::Default },
+  };
+
+  // Big enough to be compressed in several segments of rows
+  const int w = 700;
+  const int h = 1000;
+
+  for (const auto& test : tests) {
+    pref.png.compression(test.compression);
+    pref.png.filter(int(test.filter));
+    pref.png.threads(3);
+
+    auto pixel = [&test](int x, int y) -> color_t {
+      // Areas of plain colors mixed with noise
+      const int v = ((x / 16) * 7 + (y / 16) * 13 + ((x * y) % 5 == 0 ? x + y : 0)) % 256;
+      if (test.mode == doc::ColorMode::RGB)
+        return rgba(v, 255 - v, (v * 3) % 256, (x + y) % 3 == 0 ? 128 : 255);
+      return v;
+    };
+
+    {
+      std::unique_ptr<Doc> doc(ctx.documents().add(w, h, test.mode, 256));
+      doc->setFilename(fn);
+
+      Image* image = doc->sprite()->root()->firstLayer()->cel(frame_t(0))->image();
+      for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+          put_pixel(image, x, y, pixel(x, y));
+
+      save_document(&ctx, doc.get());
+      doc->close();
+    }
+    {
+      std::unique_ptr<Doc> doc(load_document(&ctx, fn));
+      ASSERT_TRUE(doc != nullptr);
+      ASSERT_EQ(w, doc->sprite()->width());
+      ASSERT_EQ(h, doc->sprite()->height());
+
+      Image* image = doc->sprite()->root()->firstLayer()->cel(frame_t(0))->image();
+      ASSERT_EQ(int(test.mode), int(image->pixelFormat()));
+      for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+          ASSERT_EQ(pixel(x, y), get_pixel(image, x, y)) << x << "," << y;
+
+      doc->close();
+    }
+  }
+
+  std::remove(fn.c_str());
+}
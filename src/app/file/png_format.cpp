@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2022  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -10,20 +10,29 @@
 #endif
 
 #include "app/app.h"
+#include "app/context.h"
 #include "app/doc.h"
 #include "app/file/file.h"
 #include "app/file/file_format.h"
 #include "app/file/format_options.h"
 #include "app/file/png_format.h"
 #include "app/file/png_options.h"
+#include "app/pref/preferences.h"
 #include "base/file_handle.h"
+#include "doc/algorithm/parallel_for.h"
 #include "doc/doc.h"
 #include "gfx/color_space.h"
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <stdio.h>
 #include <stdlib.h>
+#include <thread>
+#include <vector>
 
 #include "png.h"
+#include "zlib.h"
 
 #define PNG_TRACE(...) // TRACE
 
@@ -42,7 +51,8 @@ class PngFormat : public FileFormat {
   {
     return FILE_SUPPORT_LOAD | FILE_SUPPORT_SAVE | FILE_SUPPORT_RGB | FILE_SUPPORT_RGBA |
            FILE_SUPPORT_GRAY | FILE_SUPPORT_GRAYA | FILE_SUPPORT_INDEXED | FILE_SUPPORT_SEQUENCES |
-           FILE_SUPPORT_PALETTE_WITH_ALPHA | FILE_ENCODE_ABSTRACT_IMAGE;
+           FILE_SUPPORT_PALETTE_WITH_ALPHA | FILE_SUPPORT_GET_FORMAT_OPTIONS |
+           FILE_ENCODE_ABSTRACT_IMAGE;
   }
 
   bool onLoad(FileOp* fop) override;
@@ -51,6 +61,7 @@ class PngFormat : public FileFormat {
   bool onSave(FileOp* fop) override;
   void saveColorSpace(png_structp png, png_infop info, const gfx::ColorSpace* colorSpace);
 #endif
+  FormatOptionsPtr onAskUserForFormatOptions(FileOp* fop) override;
 };
 
 FileFormat* CreatePngFormat()
@@ -144,7 +155,6 @@ bool PngFormat::onLoad(FileOp* fop)
   int bit_depth, color_type, interlace_type;
   int num_palette;
   png_colorp palette;
-  png_bytepp rows_pointer;
   PixelFormat pixelFormat;
 
   FileHandle handle(open_file_with_exception(fop->filename(), "rb"));
@@ -227,6 +237,12 @@ bool PngFormat::onLoad(FileOp* fop)
    */
   int number_passes = png_set_interlace_handling(png);
 
+  /* Add an opaque alpha byte to RGB and gray pixels, so each row can
+   * be decoded directly in the doc::Image (RGBA or gray+alpha).
+   */
+  if (color_type == PNG_COLOR_TYPE_RGB || color_type == PNG_COLOR_TYPE_GRAY)
+    png_set_filler(png, 0xff, PNG_FILLER_AFTER);
+
   /* Optional call to gamma correct and add the background to the palette
    * and update info structure.
    */
@@ -289,14 +305,52 @@ bool PngFormat::onLoad(FileOp* fop)
     png_get_tRNS(png, info, nullptr, nullptr, &png_trans_color);
   }
 
-  // Allocate the memory to hold the image using the fields of info.
-  rows_pointer = (png_bytepp)png_malloc(png, sizeof(png_bytep) * height);
-  for (y = 0; y < height; y++)
-    rows_pointer[y] = (png_bytep)png_malloc(png, png_get_rowbytes(png, info));
-
+  // Rows are decoded directly in the image (without intermediate
+  // buffers) as doc::Image pixels have the same memory layout as PNG
+  // pixels: RGBA and gray+alpha pixels are stored as R,G,B,A and V,A
+  // bytes (little-endian), and RGB/gray rows are expanded by libpng
+  // with an opaque alpha filler.
   for (int pass = 0; pass < number_passes; ++pass) {
     for (y = 0; y < height; y++) {
-      png_read_rows(png, rows_pointer + y, nullptr, 1);
+      png_read_row(png, (png_bytep)image->getPixelAddress(0, y), nullptr);
+
+      // Transparent color (only when the row is complete, i.e. in the
+      // last pass of interlaced images)
+      if (png_trans_color && pass == number_passes - 1) {
+        bool transparent = false;
+
+        // RGB
+        if (png_get_color_type(png, info) == PNG_COLOR_TYPE_RGB) {
+          const color_t mask = rgba(png_trans_color->red,
+                                    png_trans_color->green,
+                                    png_trans_color->blue,
+                                    255);
+          auto dst_address = (uint32_t*)image->getPixelAddress(0, y);
+          for (png_uint_32 x = 0; x < width; ++x, ++dst_address) {
+            if (*dst_address == mask) {
+              *dst_address = rgba(png_trans_color->red,
+                                   png_trans_color->green,
+                                   png_trans_color->blue,
+                                   0);
+              transparent = true;
+            }
+          }
+        }
+        // GRAY
+        else if (png_get_color_type(png, info) == PNG_COLOR_TYPE_GRAY) {
+          const color_t mask = graya(png_trans_color->gray, 255);
+          auto dst_address = (uint16_t*)image->getPixelAddress(0, y);
+          for (png_uint_32 x = 0; x < width; ++x, ++dst_address) {
+            if (*dst_address == mask) {
+              *dst_address = graya(png_trans_color->gray, 0);
+              transparent = true;
+            }
+          }
+        }
+
+        if (transparent && !fop->sequenceGetHasAlpha())
+          fop->sequenceSetHasAlpha(true);
+      }
 
       fop->setProgress((double)((double)pass + (double)(y + 1) / (double)(height)) /
                        (double)number_passes);
@@ -306,92 +360,6 @@ bool PngFormat::onLoad(FileOp* fop)
     }
   }
 
-  // Convert rows_pointer into the doc::Image
-  for (y = 0; y < height; y++) {
-    // RGB_ALPHA
-    if (png_get_color_type(png, info) == PNG_COLOR_TYPE_RGB_ALPHA) {
-      uint8_t* src_address = rows_pointer[y];
-      uint32_t* dst_address = (uint32_t*)image->getPixelAddress(0, y);
-      unsigned int x, r, g, b, a;
-
-      for (x = 0; x < width; x++) {
-        r = *(src_address++);
-        g = *(src_address++);
-        b = *(src_address++);
-        a = *(src_address++);
-        *(dst_address++) = rgba(r, g, b, a);
-      }
-    }
-    // RGB
-    else if (png_get_color_type(png, info) == PNG_COLOR_TYPE_RGB) {
-      uint8_t* src_address = rows_pointer[y];
-      uint32_t* dst_address = (uint32_t*)image->getPixelAddress(0, y);
-      unsigned int x, r, g, b, a;
-
-      for (x = 0; x < width; x++) {
-        r = *(src_address++);
-        g = *(src_address++);
-        b = *(src_address++);
-
-        // Transparent color
-        if (png_trans_color && r == png_trans_color->red && g == png_trans_color->green &&
-            b == png_trans_color->blue) {
-          a = 0;
-          if (!fop->sequenceGetHasAlpha())
-            fop->sequenceSetHasAlpha(true);
-        }
-        else
-          a = 255;
-
-        *(dst_address++) = rgba(r, g, b, a);
-      }
-    }
-    // GRAY_ALPHA
-    else if (png_get_color_type(png, info) == PNG_COLOR_TYPE_GRAY_ALPHA) {
-      uint8_t* src_address = rows_pointer[y];
-      uint16_t* dst_address = (uint16_t*)image->getPixelAddress(0, y);
-      unsigned int x, k, a;
-
-      for (x = 0; x < width; x++) {
-        k = *(src_address++);
-        a = *(src_address++);
-        *(dst_address++) = graya(k, a);
-      }
-    }
-    // GRAY
-    else if (png_get_color_type(png, info) == PNG_COLOR_TYPE_GRAY) {
-      uint8_t* src_address = rows_pointer[y];
-      uint16_t* dst_address = (uint16_t*)image->getPixelAddress(0, y);
-      unsigned int x, k, a;
-
-      for (x = 0; x < width; x++) {
-        k = *(src_address++);
-
-        // Transparent color
-        if (png_trans_color && k == png_trans_color->gray) {
-          a = 0;
-          if (!fop->sequenceGetHasAlpha())
-            fop->sequenceSetHasAlpha(true);
-        }
-        else
-          a = 255;
-
-        *(dst_address++) = graya(k, a);
-      }
-    }
-    // PALETTE
-    else if (png_get_color_type(png, info) == PNG_COLOR_TYPE_PALETTE) {
-      uint8_t* src_address = rows_pointer[y];
-      uint8_t* dst_address = (uint8_t*)image->getPixelAddress(0, y);
-      unsigned int x;
-
-      for (x = 0; x < width; x++)
-        *(dst_address++) = *(src_address++);
-    }
-    png_free(png, rows_pointer[y]);
-  }
-  png_free(png, rows_pointer);
-
   // Setup the color space.
   auto colorSpace = PngFormat::loadColorSpace(png, info);
   if (colorSpace)
@@ -484,6 +452,359 @@ gfx::ColorSpaceRef PngFormat::loadColorSpace(png_structp png_ptr, png_infop info
 
 #ifdef ENABLE_SAVE
 
+// Converts the row "y" of the image to save in "dst_address" using
+// the PNG pixel format specified by "color_type".
+static void convert_png_row(FileOp* fop,
+                            const FileAbstractImage* img,
+                            const int color_type,
+                            const png_uint_32 y,
+                            uint8_t* dst_address)
+{
+  const ImageSpec& spec = img->spec();
+  const png_uint_32 width = spec.width();
+  const png_uint_32 height = spec.height();
+
+  if (color_type == PNG_COLOR_TYPE_RGB_ALPHA) {
+    unsigned int x, c, a;
+    bool opaque = true;
+
+    if (spec.colorMode() == ColorMode::RGB) {
+      auto src_address = (const uint32_t*)img->getScanline(y);
+
+      for (x = 0; x < width; ++x) {
+        c = *(src_address++);
+        a = rgba_geta(c);
+
+        if (opaque) {
+          if (a < 255)
+            opaque = false;
+          else if (fix_one_alpha_pixel && x == width - 1 && y == height - 1)
+            a = 254;
+        }
+
+        *(dst_address++) = rgba_getr(c);
+        *(dst_address++) = rgba_getg(c);
+        *(dst_address++) = rgba_getb(c);
+        *(dst_address++) = a;
+      }
+    }
+    // In case that we are converting an indexed image to RGB just
+    // to convert one pixel with alpha=254.
+    else if (spec.colorMode() == ColorMode::INDEXED) {
+      auto src_address = (const uint8_t*)img->getScanline(y);
+      unsigned int x, c;
+      int r, g, b, a;
+      bool opaque = true;
+
+      for (x = 0; x < width; ++x) {
+        c = *(src_address++);
+        fop->sequenceGetColor(c, &r, &g, &b);
+        fop->sequenceGetAlpha(c, &a);
+
+        if (opaque) {
+          if (a < 255)
+            opaque = false;
+          else if (fix_one_alpha_pixel && x == width - 1 && y == height - 1)
+            a = 254;
+        }
+
+        *(dst_address++) = r;
+        *(dst_address++) = g;
+        *(dst_address++) = b;
+        *(dst_address++) = a;
+      }
+    }
+  }
+  else if (color_type == PNG_COLOR_TYPE_RGB) {
+    auto src_address = (const uint32_t*)img->getScanline(y);
+    unsigned int x, c;
+
+    for (x = 0; x < width; ++x) {
+      c = *(src_address++);
+      *(dst_address++) = rgba_getr(c);
+      *(dst_address++) = rgba_getg(c);
+      *(dst_address++) = rgba_getb(c);
+    }
+  }
+  else if (color_type == PNG_COLOR_TYPE_GRAY_ALPHA) {
+    auto src_address = (const uint16_t*)img->getScanline(y);
+    unsigned int x, c, a;
+    bool opaque = true;
+
+    for (x = 0; x < width; x++) {
+      c = *(src_address++);
+      a = graya_geta(c);
+
+      if (opaque) {
+        if (a < 255)
+          opaque = false;
+        else if (fix_one_alpha_pixel && x == width - 1 && y == height - 1)
+          a = 254;
+      }
+
+      *(dst_address++) = graya_getv(c);
+      *(dst_address++) = a;
+    }
+  }
+  else if (color_type == PNG_COLOR_TYPE_GRAY) {
+    auto src_address = (const uint16_t*)img->getScanline(y);
+    unsigned int x, c;
+
+    for (x = 0; x < width; ++x) {
+      c = *(src_address++);
+      *(dst_address++) = graya_getv(c);
+    }
+  }
+  else if (color_type == PNG_COLOR_TYPE_PALETTE) {
+    auto src_address = (const uint8_t*)img->getScanline(y);
+    unsigned int x;
+
+    for (x = 0; x < width; ++x)
+      *(dst_address++) = *(src_address++);
+  }
+}
+
+// Flag for png_set_filter() to use the given filter
+static int png_filter_flag(const PngOptions::Filter filter)
+{
+  switch (filter) {
+    case PngOptions::Filter::None:    return PNG_FILTER_NONE;
+    case PngOptions::Filter::Sub:     return PNG_FILTER_SUB;
+    case PngOptions::Filter::Up:      return PNG_FILTER_UP;
+    case PngOptions::Filter::Average: return PNG_FILTER_AVG;
+    case PngOptions::Filter::Paeth:   return PNG_FILTER_PAETH;
+    default:                          return PNG_ALL_FILTERS;
+  }
+}
+
+static inline int paeth_predictor(const int a, const int b, const int c)
+{
+  const int p = a + b - c;
+  const int pa = std::abs(p - a);
+  const int pb = std::abs(p - b);
+  const int pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc)
+    return a;
+  if (pb <= pc)
+    return b;
+  return c;
+}
+
+// Filters the "row" (with "prev" as the previous unfiltered row) using
+// the PNG filter "type" (PNG_FILTER_VALUE_*). The output includes
+// the filter type byte at the beginning. Returns the sum of absolute
+// values of the filtered bytes (the same heuristic used by libpng to
+// select the filter of each row).
+static int filter_png_row(const int type,
+                          const uint8_t* row,
+                          const uint8_t* prev,
+                          const int rowbytes,
+                          const int bpp,
+                          uint8_t* out)
+{
+  int sum = 0;
+  *(out++) = type;
+  for (int i = 0; i < rowbytes; ++i) {
+    const int a = (i >= bpp ? row[i - bpp] : 0);
+    const int b = prev[i];
+    const int c = (i >= bpp ? prev[i - bpp] : 0);
+    int pred;
+    switch (type) {
+      case PNG_FILTER_VALUE_SUB:   pred = a; break;
+      case PNG_FILTER_VALUE_UP:    pred = b; break;
+      case PNG_FILTER_VALUE_AVG:   pred = (a + b) / 2; break;
+      case PNG_FILTER_VALUE_PAETH: pred = paeth_predictor(a, b, c); break;
+      default:                     pred = 0; break;
+    }
+    const uint8_t v = uint8_t(row[i] - pred);
+    out[i] = v;
+    sum += (v < 128 ? v : 256 - v);
+  }
+  return sum;
+}
+
+namespace {
+
+// A segment of rows of the image deflated in parallel (see
+// save_parallel_idat()).
+struct PngSegment {
+  png_uint_32 y0 = 0, y1 = 0;
+  std::vector<uint8_t> data; // Compressed data
+  uLong adler = 0;           // Adler-32 of the uncompressed data
+  z_off_t size = 0;          // Size of the uncompressed data
+  bool ok = false;
+};
+
+// Feeds the deflate stream with the given input, growing the
+// "out" buffer as needed.
+bool deflate_into(z_stream& zs,
+                  std::vector<uint8_t>& out,
+                  const uint8_t* data,
+                  const uInt size,
+                  const int flush)
+{
+  zs.next_in = (Bytef*)data;
+  zs.avail_in = size;
+  for (;;) {
+    if (zs.avail_out == 0) {
+      out.resize(std::max<size_t>(out.size() * 2, 4096));
+      zs.next_out = out.data() + zs.total_out;
+      zs.avail_out = uInt(out.size() - zs.total_out);
+    }
+    const int ret = deflate(&zs, flush);
+    if (ret == Z_STREAM_ERROR)
+      return false;
+    if (flush == Z_FINISH) {
+      if (ret == Z_STREAM_END)
+        break;
+    }
+    else if (zs.avail_out > 0 && zs.avail_in == 0)
+      break;
+  }
+  return true;
+}
+
+// Filters and compresses the rows of the given segment as a raw
+// deflate stream. All segments (except the last one) end with a
+// Z_SYNC_FLUSH, so they finish in a byte boundary and can be
+// concatenated.
+void deflate_png_segment(FileOp* fop,
+                         const FileAbstractImage* img,
+                         const int color_type,
+                         const int rowbytes,
+                         const int bpp,
+                         const int level,
+                         const PngOptions::Filter filter,
+                         const bool last,
+                         PngSegment& seg)
+{
+  z_stream zs;
+  std::memset(&zs, 0, sizeof(zs));
+  if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return;
+
+  std::vector<uint8_t> prev(rowbytes, 0);
+  std::vector<uint8_t> row(rowbytes);
+  std::vector<uint8_t> best(rowbytes + 1);
+  std::vector<uint8_t> tmp(rowbytes + 1);
+
+  // Filters Up/Average/Paeth need the previous row of the image
+  if (seg.y0 > 0)
+    convert_png_row(fop, img, color_type, seg.y0 - 1, prev.data());
+
+  const int nrows = int(seg.y1 - seg.y0);
+  seg.data.resize(deflateBound(&zs, uLong(nrows) * (rowbytes + 1)) + 16);
+  zs.next_out = seg.data.data();
+  zs.avail_out = uInt(seg.data.size());
+  seg.adler = adler32(0, nullptr, 0);
+  seg.size = 0;
+
+  bool ok = true;
+  for (png_uint_32 y = seg.y0; y < seg.y1 && ok; ++y) {
+    convert_png_row(fop, img, color_type, y, row.data());
+
+    // Same default as libpng: indexed images are not filtered, and
+    // other images use the filter that gives the smallest sum.
+    if (filter == PngOptions::Filter::Default && color_type != PNG_COLOR_TYPE_PALETTE) {
+      int bestSum = std::numeric_limits<int>::max();
+      for (int type = PNG_FILTER_VALUE_NONE; type < PNG_FILTER_VALUE_LAST; ++type) {
+        const int sum = filter_png_row(type, row.data(), prev.data(), rowbytes, bpp, tmp.data());
+        if (sum < bestSum) {
+          bestSum = sum;
+          std::swap(best, tmp);
+        }
+      }
+    }
+    else {
+      const int type = (filter == PngOptions::Filter::Default ? PNG_FILTER_VALUE_NONE :
+                                                                int(filter) - 1);
+      filter_png_row(type, row.data(), prev.data(), rowbytes, bpp, best.data());
+    }
+
+    seg.adler = adler32(seg.adler, best.data(), uInt(best.size()));
+    seg.size += z_off_t(best.size());
+    ok = deflate_into(zs, seg.data, best.data(), uInt(best.size()), Z_NO_FLUSH);
+    std::swap(prev, row);
+  }
+
+  if (ok)
+    ok = deflate_into(zs, seg.data, nullptr, 0, last ? Z_FINISH : Z_SYNC_FLUSH);
+
+  seg.data.resize(zs.total_out);
+  seg.ok = ok;
+  deflateEnd(&zs);
+}
+
+} // anonymous namespace
+
+// Writes the IDAT chunks compressing independent segments of rows
+// in parallel. The result is just one zlib stream (zlib header +
+// concatenated deflate segments + Adler-32 of the whole data) so
+// it's a regular PNG file, a little bigger than the libpng output
+// because the segments don't share the deflate dictionary.
+static bool save_parallel_idat(png_structp png,
+                               FileOp* fop,
+                               const FileAbstractImage* img,
+                               const int color_type,
+                               const int rowbytes,
+                               const int bpp,
+                               const PngOptions& opts,
+                               const int nthreads)
+{
+  const png_uint_32 height = img->spec().height();
+  const int level = (opts.compression() < 0 ? Z_DEFAULT_COMPRESSION :
+                                              std::min(opts.compression(), 9));
+
+  // Segments of ~1MB of uncompressed data
+  const png_uint_32 rowsPerSegment = std::max<png_uint_32>(16, (1 << 20) / (rowbytes + 1));
+  const png_uint_32 nsegments = (height + rowsPerSegment - 1) / rowsPerSegment;
+
+  // zlib header (32K window + compression level hint)
+  const int zlevel = (level == Z_DEFAULT_COMPRESSION ? 6 : level);
+  const int flevel = (zlevel < 2 ? 0 : zlevel < 6 ? 1 : zlevel == 6 ? 2 : 3);
+  uint8_t header[2] = { 0x78, uint8_t(flevel << 6) };
+  header[1] += 31 - ((header[0] << 8) + header[1]) % 31;
+  png_write_chunk(png, (png_const_bytep) "IDAT", header, 2);
+
+  uLong adler = adler32(0, nullptr, 0);
+  std::vector<PngSegment> segs(nthreads);
+
+  // Process batches of "nthreads" segments, so we don't need to
+  // keep the whole compressed image in memory. Segments are
+  // compressed in the worker pool shared with other algorithms.
+  for (png_uint_32 s = 0; s < nsegments; s += nthreads) {
+    const png_uint_32 n = std::min<png_uint_32>(nthreads, nsegments - s);
+    doc::algorithm::parallel_for(int(n), [&](const int i) {
+      PngSegment& seg = segs[i];
+      seg.y0 = (s + i) * rowsPerSegment;
+      seg.y1 = std::min(seg.y0 + rowsPerSegment, height);
+      seg.ok = false;
+      const bool last = (s + i == nsegments - 1);
+      deflate_png_segment(fop, img, color_type, rowbytes, bpp, level, opts.filter(), last, seg);
+    });
+
+    for (png_uint_32 i = 0; i < n; ++i) {
+      PngSegment& seg = segs[i];
+      if (!seg.ok)
+        return false;
+
+      adler = adler32_combine(adler, seg.adler, seg.size);
+
+      // Adler-32 at the end of the zlib stream (big-endian)
+      if (s + i == nsegments - 1) {
+        seg.data.push_back((adler >> 24) & 0xff);
+        seg.data.push_back((adler >> 16) & 0xff);
+        seg.data.push_back((adler >> 8) & 0xff);
+        seg.data.push_back(adler & 0xff);
+      }
+
+      png_write_chunk(png, (png_const_bytep) "IDAT", seg.data.data(), seg.data.size());
+      fop->setProgress(double(seg.y1) / double(height));
+    }
+  }
+  return true;
+}
+
 bool PngFormat::onSave(FileOp* fop)
 {
   png_infop info;
@@ -549,7 +870,7 @@ bool PngFormat::onSave(FileOp* fop)
 
   // User chunks
   auto opts = fop->formatOptionsOfDocument<PngOptions>();
-  if (opts && !opts->isEmpty()) {
+  if (!opts->isEmpty()) {
     int num_unknowns = opts->size();
     ASSERT(num_unknowns > 0);
     std::vector<png_unknown_chunk> unknowns(num_unknowns);
@@ -622,121 +943,51 @@ bool PngFormat::onSave(FileOp* fop)
     png_free(png, trans);
   }
 
+  // Encoder options
+  if (opts->compression() != PngOptions::kDefaultCompression)
+    png_set_compression_level(png, std::clamp(opts->compression(), 0, 9));
+  if (opts->filter() != PngOptions::Filter::Default)
+    png_set_filter(png, PNG_FILTER_TYPE_BASE, png_filter_flag(opts->filter()));
+
   png_write_info(png, info);
   png_set_packing(png);
 
-  row_pointer = (png_bytep)png_malloc(png, png_get_rowbytes(png, info));
-
-  for (png_uint_32 y = 0; y < height; ++y) {
-    uint8_t* dst_address = row_pointer;
-
-    if (png_get_color_type(png, info) == PNG_COLOR_TYPE_RGB_ALPHA) {
-      unsigned int x, c, a;
-      bool opaque = true;
-
-      if (spec.colorMode() == ColorMode::RGB) {
-        auto src_address = (const uint32_t*)img->getScanline(y);
-
-        for (x = 0; x < width; ++x) {
-          c = *(src_address++);
-          a = rgba_geta(c);
-
-          if (opaque) {
-            if (a < 255)
-              opaque = false;
-            else if (fix_one_alpha_pixel && x == width - 1 && y == height - 1)
-              a = 254;
-          }
-
-          *(dst_address++) = rgba_getr(c);
-          *(dst_address++) = rgba_getg(c);
-          *(dst_address++) = rgba_getb(c);
-          *(dst_address++) = a;
-        }
-      }
-      // In case that we are converting an indexed image to RGB just
-      // to convert one pixel with alpha=254.
-      else if (spec.colorMode() == ColorMode::INDEXED) {
-        auto src_address = (const uint8_t*)img->getScanline(y);
-        unsigned int x, c;
-        int r, g, b, a;
-        bool opaque = true;
-
-        for (x = 0; x < width; ++x) {
-          c = *(src_address++);
-          fop->sequenceGetColor(c, &r, &g, &b);
-          fop->sequenceGetAlpha(c, &a);
-
-          if (opaque) {
-            if (a < 255)
-              opaque = false;
-            else if (fix_one_alpha_pixel && x == width - 1 && y == height - 1)
-              a = 254;
-          }
-
-          *(dst_address++) = r;
-          *(dst_address++) = g;
-          *(dst_address++) = b;
-          *(dst_address++) = a;
-        }
-      }
-    }
-    else if (png_get_color_type(png, info) == PNG_COLOR_TYPE_RGB) {
-      auto src_address = (const uint32_t*)img->getScanline(y);
-      unsigned int x, c;
-
-      for (x = 0; x < width; ++x) {
-        c = *(src_address++);
-        *(dst_address++) = rgba_getr(c);
-        *(dst_address++) = rgba_getg(c);
-        *(dst_address++) = rgba_getb(c);
-      }
-    }
-    else if (png_get_color_type(png, info) == PNG_COLOR_TYPE_GRAY_ALPHA) {
-      auto src_address = (const uint16_t*)img->getScanline(y);
-      unsigned int x, c, a;
-      bool opaque = true;
-
-      for (x = 0; x < width; x++) {
-        c = *(src_address++);
-        a = graya_geta(c);
-
-        if (opaque) {
-          if (a < 255)
-            opaque = false;
-          else if (fix_one_alpha_pixel && x == width - 1 && y == height - 1)
-            a = 254;
-        }
-
-        *(dst_address++) = graya_getv(c);
-        *(dst_address++) = a;
-      }
+  const int rowbytes = int(png_get_rowbytes(png, info));
+  const int nthreads = (opts->threads() > 0 ? opts->threads() :
+                                              int(std::thread::hardware_concurrency()));
+
+  // Deflate segments of the image in parallel. Chunks that must go
+  // after the IDAT are handled by png_write_end(), so in that case
+  // we use the regular libpng encoder.
+  const bool chunksAfterIdat = std::any_of(opts->chunks().begin(),
+                                           opts->chunks().end(),
+                                           [](const PngOptions::Chunk& chunk) {
+                                             return (chunk.location & PNG_AFTER_IDAT);
+                                           });
+  if (nthreads > 1 && height > 1 && !chunksAfterIdat) {
+    const int bpp = rowbytes / int(width);
+    if (!save_parallel_idat(png, fop, img, color_type, rowbytes, bpp, *opts, nthreads)) {
+      if (palette)
+        png_free(png, palette);
+      fop->setError("Error compressing PNG image data\n");
+      return false;
     }
-    else if (png_get_color_type(png, info) == PNG_COLOR_TYPE_GRAY) {
-      auto src_address = (const uint16_t*)img->getScanline(y);
-      unsigned int x, c;
+    png_write_chunk(png, (png_const_bytep) "IEND", nullptr, 0);
+  }
+  else {
+    row_pointer = (png_bytep)png_malloc(png, rowbytes);
 
-      for (x = 0; x < width; ++x) {
-        c = *(src_address++);
-        *(dst_address++) = graya_getv(c);
-      }
-    }
-    else if (png_get_color_type(png, info) == PNG_COLOR_TYPE_PALETTE) {
-      auto src_address = (const uint8_t*)img->getScanline(y);
-      unsigned int x;
+    for (png_uint_32 y = 0; y < height; ++y) {
+      convert_png_row(fop, img, color_type, y, row_pointer);
+      png_write_rows(png, &row_pointer, 1);
 
-      for (x = 0; x < width; ++x)
-        *(dst_address++) = *(src_address++);
+      fop->setProgress((double)(y + 1) / (double)(height));
     }
 
-    png_write_rows(png, &row_pointer, 1);
-
-    fop->setProgress((double)(y + 1) / (double)(height));
+    png_free(png, row_pointer);
+    png_write_end(png, info);
   }
 
-  png_free(png, row_pointer);
-  png_write_end(png, info);
-
   if (spec.colorMode() == ColorMode::INDEXED) {
     png_free(png, palette);
     palette = nullptr;
@@ -798,4 +1049,23 @@ void PngFormat::saveColorSpace(png_structp png_ptr,
 
 #endif // ENABLE_SAVE
 
+// There is no dialog for PNG files, the encoder options are taken
+// from the preferences (which can be modified from the CLI with
+// --png-compression/--png-filter/--png-threads or from scripts with
+// app.preferences.png).
+FormatOptionsPtr PngFormat::onAskUserForFormatOptions(FileOp* fop)
+{
+  // Copy the options of the document (with its user chunks) so the
+  // loaded options aren't modified.
+  auto opts = std::make_shared<PngOptions>(*fop->formatOptionsOfDocument<PngOptions>());
+  if (fop->context()) {
+    auto& pref = fop->context()->preferences();
+    opts->setCompression(std::clamp(pref.png.compression(), -1, PngOptions::kBestCompression));
+    opts->setFilter(
+      PngOptions::Filter(std::clamp(pref.png.filter(), 0, int(PngOptions::Filter::Paeth))));
+    opts->setThreads(std::max(0, pref.png.threads()));
+  }
+  return opts;
+}
+
 } // namespace app
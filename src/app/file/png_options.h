@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -25,6 +25,22 @@ public:
 
   using Chunks = std::vector<Chunk>;
 
+  // Filter strategy used to encode rows (same values as the
+  // png.filter preference).
+  enum class Filter {
+    Default, // Let libpng choose the best filter for each row
+    None,
+    Sub,
+    Up,
+    Average,
+    Paeth,
+  };
+
+  // Compression level from 0 to 9 (-1 uses the zlib default level)
+  static constexpr int kDefaultCompression = -1;
+  static constexpr int kFastCompression = 1;
+  static constexpr int kBestCompression = 9;
+
   void addChunk(Chunk&& chunk) { m_userChunks.emplace_back(std::move(chunk)); }
 
   bool isEmpty() const { return m_userChunks.empty(); }
@@ -33,8 +49,30 @@ public:
 
   const Chunks& chunks() const { return m_userChunks; }
 
+  int compression() const { return m_compression; }
+  Filter filter() const { return m_filter; }
+  int threads() const { return m_threads; }
+
+  void setCompression(const int compression) { m_compression = compression; }
+  void setFilter(const Filter filter) { m_filter = filter; }
+
+  // Number of threads to deflate the image data (1 to use libpng
+  // directly, 0 to use all CPU cores).
+  void setThreads(const int threads) { m_threads = threads; }
+
+  // The "fast" preset is the best trade-off to save big images
+  // quickly: the lowest compression level with the Sub filter.
+  void setFastPreset()
+  {
+    m_compression = kFastCompression;
+    m_filter = Filter::Sub;
+  }
+
 private:
   Chunks m_userChunks;
+  int m_compression = kDefaultCompression;
+  Filter m_filter = Filter::Default;
+  int m_threads = 1;
 };
 
 } // namespace app
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2023-2024  Igara Studio S.A.
+// Copyright (C) 2023-2025  Igara Studio S.A.
 // Copyright (C) 2016-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -15,16 +15,60 @@
 #include "app/extensions.h"
 #include "app/pref/preferences.h"
 #include "app/resource_finder.h"
+#include "app/startup_cache.h"
+#include "app/startup_profiler.h"
 #include "app/xml_document.h"
 #include "app/xml_exception.h"
 #include "base/debug.h"
 #include "base/fs.h"
+#include "base/serialization.h"
 #include "cfg/cfg.h"
 
 #include <algorithm>
+#include <sstream>
 
 namespace app {
 
+using namespace base::serialization;
+using namespace base::serialization::little_endian;
+
+namespace {
+
+void write_strings(std::ostream& os, const std::unordered_map<std::string, std::string>& strings)
+{
+  auto write_string = [&os](const std::string& str) {
+    write32(os, uint32_t(str.size()));
+    os.write(str.c_str(), str.size());
+  };
+
+  write32(os, uint32_t(strings.size()));
+  for (const auto& kv : strings) {
+    write_string(kv.first);
+    write_string(kv.second);
+  }
+}
+
+bool read_strings(std::istream& is, std::unordered_map<std::string, std::string>& strings)
+{
+  auto read_string = [&is](std::string& str) {
+    str.resize(read32(is));
+    is.read(str.data(), str.size());
+    return bool(is);
+  };
+
+  strings.clear();
+  const uint32_t n = read32(is);
+  std::string id, value;
+  for (uint32_t i = 0; i < n && is; ++i) {
+    if (!read_string(id) || !read_string(value))
+      return false;
+    strings[id] = value;
+  }
+  return bool(is);
+}
+
+} // anonymous namespace
+
 static Strings* singleton = nullptr;
 
 const char* Strings::kDefLanguage = "en";
@@ -150,37 +194,60 @@ std::string Strings::VFormat(const char* id, const fmt::format_args& vargs)
 
 void Strings::loadLanguage(const std::string& langId)
 {
+  StartupScope scope("Strings ", langId);
+
+  // All the files that can contain strings of this language
+  std::vector<std::string> sources = { findStringsFile(kDefLanguage) };
+  if (langId != kDefLanguage) {
+    sources.push_back(findStringsFile(langId));
+    sources.push_back(m_exts.languagePath(langId));
+  }
+
+  // Use the strings parsed in a previous execution if the files
+  // didn't change
+  const StartupCache cache;
+  const std::string cacheName = "strings-" + langId + "-v1";
+  std::string data;
+  if (cache.load(cacheName, sources, data)) {
+    std::istringstream is(data);
+    if (read_strings(is, m_default) && read_strings(is, m_strings)) {
+      LOG("I18N: %s strings loaded from cache\n", langId.c_str());
+      return;
+    }
+  }
+
   m_strings.clear();
-  loadStringsFromDataDir(kDefLanguage);
+  if (!sources[0].empty())
+    loadStringsFromFile(sources[0]);
   m_default = m_strings;
 
   if (langId != kDefLanguage) {
-    loadStringsFromDataDir(langId);
-    loadStringsFromExtension(langId);
+    for (int i = 1; i < int(sources.size()); ++i) {
+      if (!sources[i].empty() && base::is_file(sources[i]))
+        loadStringsFromFile(sources[i]);
+    }
   }
+
+  std::ostringstream os;
+  write_strings(os, m_default);
+  write_strings(os, m_strings);
+  cache.store(cacheName, sources, os.str());
 }
 
-void Strings::loadStringsFromDataDir(const std::string& langId)
+std::string Strings::findStringsFile(const std::string& langId) const
 {
-  // Load the English language file from the Aseprite data directory (so we have the most update
-  // list of strings)
+  // Find the language file in the Aseprite data directory (so we
+  // have the most update list of strings)
   LOG("I18N: Loading %s.ini file\n", langId.c_str());
   ResourceFinder rf;
   rf.includeDataDir(base::join_path("strings", langId + ".ini").c_str());
   rf.includeDataDir(base::join_path("strings.git", langId + ".ini").c_str());
   if (!rf.findFirst()) {
     LOG("I18N: %s.ini was not found\n", langId.c_str());
-    return;
+    return std::string();
   }
   LOG("I18N: %s found\n", rf.filename().c_str());
-  loadStringsFromFile(rf.filename());
-}
-
-void Strings::loadStringsFromExtension(const std::string& langId)
-{
-  std::string fn = m_exts.languagePath(langId);
-  if (!fn.empty() && base::is_file(fn))
-    loadStringsFromFile(fn);
+  return rf.filename();
 }
 
 void Strings::loadStringsFromFile(const std::string& fn)
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2023-2024  Igara Studio S.A.
+// Copyright (C) 2023-2025  Igara Studio S.A.
 // Copyright (C) 2016-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -64,8 +64,7 @@ private:
   Strings(Preferences& pref, Extensions& exts);
 
   void loadLanguage(const std::string& langId);
-  void loadStringsFromDataDir(const std::string& langId);
-  void loadStringsFromExtension(const std::string& langId);
+  std::string findStringsFile(const std::string& langId) const;
   void loadStringsFromFile(const std::string& fn);
 
   Preferences& m_pref;
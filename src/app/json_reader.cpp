@@ -0,0 +1,301 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/json_reader.h"
+
+#include "fmt/format.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <istream>
+
+namespace app {
+
+static const std::size_t kBufferSize = 64 * 1024;
+
+JsonReader::JsonReader(std::istream& is) : m_is(is), m_buf(kBufferSize)
+{
+}
+
+JsonReader::Token JsonReader::next()
+{
+  skipWhitespace();
+
+  // Root value
+  if (m_stack.empty()) {
+    if (m_started) {
+      if (peek() >= 0)
+        error("unexpected data after the root value");
+      return m_token = Token::End;
+    }
+    m_started = true;
+    return readValue();
+  }
+
+  Container& c = m_stack.back();
+  if (c.afterKey) {
+    c.afterKey = false;
+    return readValue();
+  }
+
+  const char endChr = (c.object ? '}' : ']');
+  int chr = peek();
+  if (chr == endChr) {
+    get();
+    const bool object = c.object;
+    m_stack.pop_back();
+    return m_token = (object ? Token::EndObject : Token::EndArray);
+  }
+
+  if (c.count > 0) {
+    if (chr != ',')
+      error(c.object ? "expected ',' or '}'" : "expected ',' or ']'");
+    get();
+    skipWhitespace();
+    chr = peek();
+    if (chr == endChr)
+      error("unexpected ',' before the end of the object/array");
+  }
+  ++c.count;
+
+  if (c.object) {
+    if (chr != '"')
+      error("expected a string key");
+    readString(m_string);
+    skipWhitespace();
+    expect(':');
+    c.afterKey = true;
+    return m_token = Token::Key;
+  }
+  return readValue();
+}
+
+void JsonReader::skip()
+{
+  if (m_token == Token::Key)
+    next();
+
+  if (m_token == Token::BeginObject || m_token == Token::BeginArray) {
+    const int targetDepth = depth() - 1;
+    while (depth() > targetDepth) {
+      if (next() == Token::End)
+        error("unexpected end of data");
+    }
+  }
+}
+
+JsonReader::Token JsonReader::readValue()
+{
+  switch (peek()) {
+    case '{':
+      get();
+      m_stack.push_back(Container{ true, false, 0 });
+      return m_token = Token::BeginObject;
+    case '[':
+      get();
+      m_stack.push_back(Container{ false, false, 0 });
+      return m_token = Token::BeginArray;
+    case '"': readString(m_string); return m_token = Token::String;
+    case 't':
+      readLiteral("true");
+      m_boolean = true;
+      return m_token = Token::Bool;
+    case 'f':
+      readLiteral("false");
+      m_boolean = false;
+      return m_token = Token::Bool;
+    case 'n': readLiteral("null"); return m_token = Token::Null;
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9': readNumber(); return m_token = Token::Number;
+    case -1:  error("unexpected end of data");
+  }
+  error("expected a value");
+}
+
+void JsonReader::readString(std::string& str)
+{
+  expect('"');
+  str.clear();
+
+  while (true) {
+    int chr = get();
+    if (chr < 0)
+      error("unexpected end of data inside a string");
+    else if (chr == '"')
+      break;
+    else if (chr < 0x20)
+      error("invalid control character inside a string");
+    else if (chr != '\\') {
+      str.push_back(char(chr));
+      continue;
+    }
+
+    // Escape sequences
+    chr = get();
+    switch (chr) {
+      case '"':
+      case '\\':
+      case '/':  str.push_back(char(chr)); break;
+      case 'b':  str.push_back('\b'); break;
+      case 'f':  str.push_back('\f'); break;
+      case 'n':  str.push_back('\n'); break;
+      case 'r':  str.push_back('\r'); break;
+      case 't':  str.push_back('\t'); break;
+      case 'u':  {
+        auto readHex4 = [this]() -> int {
+          int value = 0;
+          for (int i = 0; i < 4; ++i) {
+            const int h = get();
+            value <<= 4;
+            if (h >= '0' && h <= '9')
+              value |= h - '0';
+            else if (h >= 'a' && h <= 'f')
+              value |= h - 'a' + 10;
+            else if (h >= 'A' && h <= 'F')
+              value |= h - 'A' + 10;
+            else
+              error("invalid \\u escape sequence");
+          }
+          return value;
+        };
+
+        int codepoint = readHex4();
+        // UTF-16 surrogate pair
+        if (codepoint >= 0xd800 && codepoint <= 0xdbff) {
+          if (get() != '\\' || get() != 'u')
+            error("expected a low surrogate after a high surrogate");
+          const int low = readHex4();
+          if (low < 0xdc00 || low > 0xdfff)
+            error("invalid low surrogate");
+          codepoint = 0x10000 + ((codepoint - 0xd800) << 10) + (low - 0xdc00);
+        }
+
+        // Encode as UTF-8
+        if (codepoint < 0x80)
+          str.push_back(char(codepoint));
+        else if (codepoint < 0x800) {
+          str.push_back(char(0xc0 | (codepoint >> 6)));
+          str.push_back(char(0x80 | (codepoint & 0x3f)));
+        }
+        else if (codepoint < 0x10000) {
+          str.push_back(char(0xe0 | (codepoint >> 12)));
+          str.push_back(char(0x80 | ((codepoint >> 6) & 0x3f)));
+          str.push_back(char(0x80 | (codepoint & 0x3f)));
+        }
+        else {
+          str.push_back(char(0xf0 | (codepoint >> 18)));
+          str.push_back(char(0x80 | ((codepoint >> 12) & 0x3f)));
+          str.push_back(char(0x80 | ((codepoint >> 6) & 0x3f)));
+          str.push_back(char(0x80 | (codepoint & 0x3f)));
+        }
+        break;
+      }
+      default: error("invalid escape sequence");
+    }
+  }
+}
+
+void JsonReader::readNumber()
+{
+  char buf[64];
+  int n = 0;
+  bool integer = true;
+
+  auto add = [&]() {
+    if (n == int(sizeof(buf)) - 1)
+      error("number too long");
+    buf[n++] = char(get());
+  };
+  auto addDigits = [&]() {
+    if (!std::isdigit(peek()))
+      error("expected a digit");
+    while (std::isdigit(peek()))
+      add();
+  };
+
+  if (peek() == '-')
+    add();
+  if (peek() == '0')
+    add();
+  else
+    addDigits();
+  if (peek() == '.') {
+    integer = false;
+    add();
+    addDigits();
+  }
+  if (peek() == 'e' || peek() == 'E') {
+    integer = false;
+    add();
+    if (peek() == '+' || peek() == '-')
+      add();
+    addDigits();
+  }
+  buf[n] = 0;
+
+  m_number = std::strtod(buf, nullptr);
+  m_isInteger = integer;
+}
+
+void JsonReader::readLiteral(const char* literal)
+{
+  for (const char* p = literal; *p; ++p) {
+    if (get() != *p)
+      error("invalid literal");
+  }
+}
+
+void JsonReader::skipWhitespace()
+{
+  while (true) {
+    const int chr = peek();
+    if (chr == ' ' || chr == '\t' || chr == '\n' || chr == '\r')
+      get();
+    else
+      break;
+  }
+}
+
+void JsonReader::expect(char chr)
+{
+  if (get() != chr)
+    error(fmt::format("expected '{}'", chr).c_str());
+}
+
+void JsonReader::error(const char* msg) const
+{
+  throw Error(fmt::format("{}:{}: {}", m_line, m_column, msg));
+}
+
+bool JsonReader::fill()
+{
+  if (!m_is)
+    return false;
+
+  m_is.read(m_buf.data(), m_buf.size());
+  const std::streamsize n = m_is.gcount();
+  if (n <= 0)
+    return false;
+
+  m_pos = m_buf.data();
+  m_end = m_pos + n;
+  return true;
+}
+
+} // namespace app
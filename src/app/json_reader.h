@@ -0,0 +1,129 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_JSON_READER_H_INCLUDED
+#define APP_JSON_READER_H_INCLUDED
+#pragma once
+
+#include <iosfwd>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace app {
+
+// Pull parser to read JSON data incrementally from a stream (one
+// token each time) without creating the whole tree of values in
+// memory (e.g. to iterate the items of a huge array).
+class JsonReader {
+public:
+  enum class Token {
+    None,
+    BeginObject,
+    EndObject,
+    BeginArray,
+    EndArray,
+    Key,
+    String,
+    Number,
+    Bool,
+    Null,
+    End, // End of the data (after the root value)
+  };
+
+  // Syntax errors (the message includes the line and column)
+  class Error : public std::runtime_error {
+  public:
+    Error(const std::string& msg) : std::runtime_error(msg) {}
+  };
+
+  explicit JsonReader(std::istream& is);
+
+  JsonReader(const JsonReader&) = delete;
+  JsonReader& operator=(const JsonReader&) = delete;
+
+  // Reads the next token. Throws an Error if the data is malformed.
+  Token next();
+
+  // Skips the rest of the value of the current token, i.e. if the
+  // current token is a BeginObject/BeginArray, reads all the tokens
+  // until the matching EndObject/EndArray. If the current token is
+  // a Key, its whole value is skipped.
+  void skip();
+
+  Token token() const { return m_token; }
+
+  // Value of the current Key or String token
+  const std::string& string() const { return m_string; }
+  // Value of the current Number token
+  double number() const { return m_number; }
+  // True if the current Number token doesn't have fraction/exponent
+  bool isInteger() const { return m_isInteger; }
+  // Value of the current Bool token
+  bool boolean() const { return m_boolean; }
+
+  // Number of objects/arrays opened (0 = root level).
+  int depth() const { return int(m_stack.size()); }
+
+private:
+  struct Container {
+    bool object;
+    bool afterKey;
+    int count;
+  };
+
+  Token readValue();
+  void readString(std::string& str);
+  void readNumber();
+  void readLiteral(const char* literal);
+  void skipWhitespace();
+  void expect(char chr);
+  [[noreturn]] void error(const char* msg) const;
+
+  int peek()
+  {
+    if (m_pos == m_end && !fill())
+      return -1;
+    return (unsigned char)*m_pos;
+  }
+
+  int get()
+  {
+    const int chr = peek();
+    if (chr >= 0) {
+      ++m_pos;
+      if (chr == '\n') {
+        ++m_line;
+        m_column = 1;
+      }
+      else
+        ++m_column;
+    }
+    return chr;
+  }
+
+  bool fill();
+
+  std::istream& m_is;
+  std::vector<char> m_buf;
+  const char* m_pos = nullptr;
+  const char* m_end = nullptr;
+  int m_line = 1;
+  int m_column = 1;
+
+  bool m_started = false;
+  std::vector<Container> m_stack;
+
+  Token m_token = Token::None;
+  std::string m_string;
+  double m_number = 0.0;
+  bool m_isInteger = false;
+  bool m_boolean = false;
+};
+
+} // namespace app
+
+#endif
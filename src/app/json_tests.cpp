@@ -0,0 +1,172 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#include "tests/app_test.h"
+
+#include "app/json_reader.h"
+#include "app/json_writer.h"
+
+#include <sstream>
+
+using namespace app;
+
+using Token = JsonReader::Token;
+
+TEST(JsonWriter, Compact)
+{
+  std::ostringstream out;
+  {
+    JsonWriter json(out);
+    json.beginObject();
+    json.member("a", 3);
+    json.key("b").beginArray().value(0).value("hi").null().endArray();
+    json.member("c", false);
+    json.member("d", 0.5);
+    json.endObject();
+  }
+  EXPECT_EQ("{\"a\": 3, \"b\": [0, \"hi\", null], \"c\": false, \"d\": 0.5}", out.str());
+}
+
+TEST(JsonWriter, Pretty)
+{
+  std::ostringstream out;
+  {
+    JsonWriter json(out, JsonWriter::Style::Pretty);
+    json.beginObject();
+    json.key("frame").beginObject(true).member("x", 0).member("y", 2).endObject();
+    json.key("empty").beginArray().endArray();
+    json.endObject();
+  }
+  EXPECT_EQ(
+    "{\n"
+    " \"frame\": { \"x\": 0, \"y\": 2 },\n"
+    " \"empty\": []\n"
+    "}\n",
+    out.str());
+}
+
+TEST(JsonWriter, PrettyLayout)
+{
+  std::ostringstream out;
+  {
+    JsonWriter json(out, JsonWriter::Style::Pretty);
+    JsonWriter::Layout root;
+    root.firstInSameLine = true;
+    JsonWriter::Layout list;
+    list.indent = 2;
+    list.breakIfEmpty = true;
+    JsonWriter::Layout unpadded;
+    unpadded.inlined = true;
+    unpadded.padOpen = false;
+    unpadded.padClose = false;
+
+    json.beginObject(root);
+    json.key("a").beginArray(list);
+    json.beginObject(true).key("b").beginArray(unpadded).value(1).value(2).endArray().endObject();
+    json.endArray();
+    json.key("empty").beginArray(list).endArray();
+    json.endObject();
+  }
+  EXPECT_EQ(
+    "{ \"a\": [\n"
+    "   { \"b\": [1, 2] }\n"
+    " ],\n"
+    " \"empty\": [\n"
+    " ]\n"
+    "}\n",
+    out.str());
+}
+
+TEST(JsonWriter, Escape)
+{
+  std::ostringstream out;
+  {
+    JsonWriter json(out);
+    json.value("a\"b\\c\n\x01");
+  }
+  EXPECT_EQ("\"a\\\"b\\\\c\\n\\u0001\"", out.str());
+}
+
+TEST(JsonReader, Tokens)
+{
+  std::istringstream in("{ \"a\": [1, -2.5e1, true, null], \"b\": \"x\\u00e1\\ud83d\\ude00\" }");
+  JsonReader reader(in);
+  EXPECT_EQ(Token::BeginObject, reader.next());
+  EXPECT_EQ(Token::Key, reader.next());
+  EXPECT_EQ("a", reader.string());
+  EXPECT_EQ(Token::BeginArray, reader.next());
+  EXPECT_EQ(2, reader.depth());
+  EXPECT_EQ(Token::Number, reader.next());
+  EXPECT_EQ(1.0, reader.number());
+  EXPECT_TRUE(reader.isInteger());
+  EXPECT_EQ(Token::Number, reader.next());
+  EXPECT_EQ(-25.0, reader.number());
+  EXPECT_FALSE(reader.isInteger());
+  EXPECT_EQ(Token::Bool, reader.next());
+  EXPECT_TRUE(reader.boolean());
+  EXPECT_EQ(Token::Null, reader.next());
+  EXPECT_EQ(Token::EndArray, reader.next());
+  EXPECT_EQ(Token::Key, reader.next());
+  EXPECT_EQ(Token::String, reader.next());
+  EXPECT_EQ("x\xc3\xa1\xf0\x9f\x98\x80", reader.string());
+  EXPECT_EQ(Token::EndObject, reader.next());
+  EXPECT_EQ(Token::End, reader.next());
+}
+
+TEST(JsonReader, Skip)
+{
+  std::istringstream in("{\"a\": {\"b\": [1, {\"c\": 2}]}, \"d\": 3}");
+  JsonReader reader(in);
+  EXPECT_EQ(Token::BeginObject, reader.next());
+  EXPECT_EQ(Token::Key, reader.next());
+  reader.skip();
+  EXPECT_EQ(Token::Key, reader.next());
+  EXPECT_EQ("d", reader.string());
+  EXPECT_EQ(Token::Number, reader.next());
+  EXPECT_EQ(3.0, reader.number());
+}
+
+TEST(JsonReader, Errors)
+{
+  for (const char* text : { "[1, 2,]", "{\"a\" 1}", "[1 2]", "[tru]", "[01]", "{} {}", "\"abc" }) {
+    std::istringstream in(text);
+    JsonReader reader(in);
+    EXPECT_THROW(
+      {
+        while (reader.next() != Token::End) {}
+      },
+      JsonReader::Error)
+      << text;
+  }
+}
+
+TEST(JsonReader, WriterRoundtrip)
+{
+  std::ostringstream out;
+  {
+    JsonWriter json(out, JsonWriter::Style::Pretty);
+    json.beginArray();
+    for (int i = 0; i < 10000; ++i)
+      json.beginObject(true).member("i", i).member("name", "item\t" + std::to_string(i)).endObject();
+    json.endArray();
+  }
+
+  std::istringstream in(out.str());
+  JsonReader reader(in);
+  EXPECT_EQ(Token::BeginArray, reader.next());
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_EQ(Token::BeginObject, reader.next());
+    EXPECT_EQ(Token::Key, reader.next());
+    EXPECT_EQ(Token::Number, reader.next());
+    EXPECT_EQ(double(i), reader.number());
+    EXPECT_EQ(Token::Key, reader.next());
+    EXPECT_EQ(Token::String, reader.next());
+    EXPECT_EQ("item\t" + std::to_string(i), reader.string());
+    EXPECT_EQ(Token::EndObject, reader.next());
+  }
+  EXPECT_EQ(Token::EndArray, reader.next());
+  EXPECT_EQ(Token::End, reader.next());
+}
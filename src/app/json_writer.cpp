@@ -0,0 +1,246 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/json_writer.h"
+
+#include "base/debug.h"
+
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+
+namespace app {
+
+// Size of the buffer to accumulate the output before writing it to
+// the stream
+static const std::size_t kBufferSize = 64 * 1024;
+
+JsonWriter::JsonWriter(std::ostream& os, Style style, int indent)
+  : m_os(os)
+  , m_style(style)
+  , m_indent(indent)
+{
+  m_buf.reserve(kBufferSize + 256);
+}
+
+JsonWriter::~JsonWriter()
+{
+  flush();
+}
+
+JsonWriter& JsonWriter::beginObject(bool inlined)
+{
+  Layout layout;
+  layout.inlined = inlined;
+  return beginObject(layout);
+}
+
+JsonWriter& JsonWriter::beginObject(const Layout& layout)
+{
+  beginContainer('{', true, layout);
+  return *this;
+}
+
+JsonWriter& JsonWriter::endObject()
+{
+  ASSERT(!m_stack.empty() && m_stack.back().object);
+  endContainer('}');
+  return *this;
+}
+
+JsonWriter& JsonWriter::beginArray(bool inlined)
+{
+  Layout layout;
+  layout.inlined = inlined;
+  return beginArray(layout);
+}
+
+JsonWriter& JsonWriter::beginArray(const Layout& layout)
+{
+  beginContainer('[', false, layout);
+  return *this;
+}
+
+JsonWriter& JsonWriter::endArray()
+{
+  ASSERT(!m_stack.empty() && !m_stack.back().object);
+  endContainer(']');
+  return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view key)
+{
+  ASSERT(!m_stack.empty() && m_stack.back().object);
+  ASSERT(!m_afterKey);
+  beginValue();
+  writeString(key);
+  m_buf += ": ";
+  m_afterKey = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view str)
+{
+  beginValue();
+  writeString(str);
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(bool boolean)
+{
+  beginValue();
+  m_buf += (boolean ? "true" : "false");
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(int64_t number)
+{
+  beginValue();
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%lld", (long long)number);
+  m_buf += buf;
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(double number)
+{
+  beginValue();
+  // JSON doesn't support inf/nan values
+  if (std::isfinite(number)) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", number);
+    m_buf += buf;
+  }
+  else {
+    m_buf += "null";
+  }
+  return *this;
+}
+
+JsonWriter& JsonWriter::null()
+{
+  beginValue();
+  m_buf += "null";
+  return *this;
+}
+
+void JsonWriter::flush()
+{
+  if (!m_buf.empty()) {
+    m_os.write(m_buf.c_str(), m_buf.size());
+    m_buf.clear();
+  }
+}
+
+void JsonWriter::beginValue()
+{
+  if (m_afterKey) {
+    // The key was already written
+    m_afterKey = false;
+  }
+  else if (!m_stack.empty()) {
+    Container& c = m_stack.back();
+    if (c.count > 0)
+      m_buf.push_back(',');
+
+    if (m_style == Style::Compact) {
+      if (c.count > 0)
+        m_buf.push_back(' ');
+    }
+    else if (!c.layout.inlined) {
+      if (c.count == 0 && c.layout.firstInSameLine)
+        m_buf.push_back(' ');
+      else
+        newLine(c.indent);
+    }
+    else if (c.count > 0 || c.layout.padOpen) {
+      m_buf.push_back(' ');
+    }
+
+    ++c.count;
+  }
+
+  if (m_buf.size() >= kBufferSize)
+    flush();
+}
+
+void JsonWriter::beginContainer(char chr, bool object, const Layout& layout)
+{
+  beginValue();
+  m_buf.push_back(chr);
+
+  Container c{ object, layout, 0, 0 };
+  const int parentIndent = (m_stack.empty() ? 0 : m_stack.back().indent);
+  c.indent = parentIndent + (layout.indent >= 0 ? layout.indent : m_indent);
+
+  // Everything inside an inlined container is inlined too
+  if (!m_stack.empty() && m_stack.back().layout.inlined)
+    c.layout.inlined = true;
+  m_stack.push_back(c);
+}
+
+void JsonWriter::endContainer(char chr)
+{
+  ASSERT(!m_afterKey);
+  const Container c = m_stack.back();
+  m_stack.pop_back();
+
+  if (m_style == Style::Pretty) {
+    if (c.layout.inlined) {
+      if (c.count > 0 && c.layout.padClose)
+        m_buf.push_back(' ');
+    }
+    else if (c.count > 0 || c.layout.breakIfEmpty) {
+      newLine(m_stack.empty() ? 0 : m_stack.back().indent);
+    }
+  }
+  m_buf.push_back(chr);
+
+  // Add a new line at the end of the root value
+  if (m_stack.empty() && m_style == Style::Pretty)
+    m_buf.push_back('\n');
+}
+
+void JsonWriter::newLine(int indent)
+{
+  m_buf.push_back('\n');
+  m_buf.append(std::size_t(indent), ' ');
+}
+
+void JsonWriter::writeString(std::string_view str)
+{
+  static const char* kHex = "0123456789abcdef";
+
+  m_buf.push_back('"');
+  for (const char chr : str) {
+    switch (chr) {
+      case '"':  m_buf += "\\\""; break;
+      case '\\': m_buf += "\\\\"; break;
+      case '\b': m_buf += "\\b"; break;
+      case '\f': m_buf += "\\f"; break;
+      case '\n': m_buf += "\\n"; break;
+      case '\r': m_buf += "\\r"; break;
+      case '\t': m_buf += "\\t"; break;
+      default:
+        if (uint8_t(chr) < 0x20) {
+          m_buf += "\\u00";
+          m_buf.push_back(kHex[(chr >> 4) & 0xf]);
+          m_buf.push_back(kHex[chr & 0xf]);
+        }
+        else {
+          m_buf.push_back(chr);
+        }
+        break;
+    }
+  }
+  m_buf.push_back('"');
+}
+
+} // namespace app
@@ -0,0 +1,114 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_JSON_WRITER_H_INCLUDED
+#define APP_JSON_WRITER_H_INCLUDED
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace app {
+
+// Writes JSON data directly to a stream without creating a tree of
+// values in memory (e.g. to write the metadata of huge sprite
+// sheets).
+//
+// Each value inside an object must be preceded by a key() call. The
+// output is buffered, call flush() (or destroy the writer) to write
+// the pending data to the stream.
+class JsonWriter {
+public:
+  enum class Style {
+    // All in one line: {"a": 1, "b": [2, 3]} (same format as json11)
+    Compact,
+    // One element per line, except "inlined" objects/arrays which
+    // are written in one line: { "x": 0, "y": 0 }
+    Pretty,
+  };
+
+  // Whitespace of a container in the Pretty style.
+  struct Layout {
+    // All the elements in one line (containers inside an inlined
+    // container are inlined too).
+    bool inlined = false;
+    // Not inlined: indentation of the elements relative to the parent
+    // (-1 = indentation of the writer), if the first element is in
+    // the same line of the opening bracket, and if the closing
+    // bracket of an empty container goes in a new line.
+    int indent = -1;
+    bool firstInSameLine = false;
+    bool breakIfEmpty = false;
+    // Inlined: spaces after the opening and before the closing bracket.
+    bool padOpen = true;
+    bool padClose = true;
+  };
+
+  explicit JsonWriter(std::ostream& os, Style style = Style::Compact, int indent = 1);
+  ~JsonWriter();
+
+  JsonWriter(const JsonWriter&) = delete;
+  JsonWriter& operator=(const JsonWriter&) = delete;
+
+  JsonWriter& beginObject(bool inlined = false);
+  JsonWriter& beginObject(const Layout& layout);
+  JsonWriter& endObject();
+  JsonWriter& beginArray(bool inlined = false);
+  JsonWriter& beginArray(const Layout& layout);
+  JsonWriter& endArray();
+
+  JsonWriter& key(std::string_view key);
+
+  JsonWriter& value(std::string_view str);
+  JsonWriter& value(const char* str) { return value(std::string_view(str)); }
+  JsonWriter& value(const std::string& str) { return value(std::string_view(str)); }
+  JsonWriter& value(bool boolean);
+  JsonWriter& value(int number) { return value(int64_t(number)); }
+  JsonWriter& value(int64_t number);
+  JsonWriter& value(double number);
+  JsonWriter& null();
+
+  // Shortcut for key(k).value(v)
+  template<typename T>
+  JsonWriter& member(std::string_view k, const T& v)
+  {
+    key(k);
+    return value(v);
+  }
+
+  // Depth of the current object/array (0 = root level).
+  int depth() const { return int(m_stack.size()); }
+
+  void flush();
+
+private:
+  struct Container {
+    bool object;
+    Layout layout;
+    int indent; // Indentation of the elements
+    int count;
+  };
+
+  void beginValue();
+  void beginContainer(char chr, bool object, const Layout& layout);
+  void endContainer(char chr);
+  void newLine(int indent);
+  void writeString(std::string_view str);
+
+  std::ostream& m_os;
+  std::string m_buf;
+  Style m_style;
+  int m_indent;
+  bool m_afterKey = false;
+  std::vector<Container> m_stack;
+};
+
+} // namespace app
+
+#endif
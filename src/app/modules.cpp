@@ -1,4 +1,5 @@
 // Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -12,6 +13,7 @@
 
 #include "app/modules/gui.h"
 #include "app/modules/palettes.h"
+#include "app/startup_profiler.h"
 
 namespace app {
 
@@ -40,6 +42,7 @@ LegacyModules::LegacyModules(int requirements)
   for (int c = 0; c < modules; c++)
     if ((module[c].reqs & requirements) == module[c].reqs) {
       LOG("MODS: Installing module: %s\n", module[c].name);
+      StartupScope scope("Module ", module[c].name);
 
       if ((*module[c].init)() < 0)
         throw base::Exception("Error initializing module: %s",
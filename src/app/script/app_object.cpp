@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2015-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -116,6 +116,11 @@ int App_open(lua_State* L)
   return load_sprite_from_file(L, luaL_checkstring(L, 1), LoadSpriteFromFileParam::FullAniAsSprite);
 }
 
+int App_parallel(lua_State* L)
+{
+  return run_parallel(L);
+}
+
 int App_exit(lua_State* L)
 {
   app::Context* ctx = App::instance()->context();
@@ -814,6 +819,7 @@ const luaL_Reg App_methods[] = {
   { "alert",       App_alert       },
   { "refresh",     App_refresh     },
   { "useTool",     App_useTool     },
+  { "parallel",    App_parallel    },
   { nullptr,       nullptr         }
 };
 
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -203,6 +203,9 @@ doc::Tileset* get_tile_index_from_arg(lua_State* L, int index, doc::tile_index&
 enum class LoadSpriteFromFileParam { FullAniAsSprite, OneFrameAsSprite, OneFrameAsImage };
 int load_sprite_from_file(lua_State* L, const char* filename, const LoadSpriteFromFileParam param);
 
+// Used by app.parallel()
+int run_parallel(lua_State* L);
+
 // close all opened Dialogs before closing the UI
 void close_all_dialogs();
 
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2021-2023  Igara Studio S.A.
+// Copyright (C) 2021-2025  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -9,6 +9,7 @@
 #endif
 
 #include "app/app.h"
+#include "app/cmd_transaction.h"
 #include "app/commands/command.h"
 #include "app/context.h"
 #include "app/context_observer.h"
@@ -23,16 +24,24 @@
 #include "app/script/values.h"
 #include "app/site.h"
 #include "app/ui/main_window.h"
+#include "doc/cel.h"
 #include "doc/document.h"
+#include "doc/layer.h"
+#include "doc/remap.h"
 #include "doc/sprite.h"
+#include "doc/tileset.h"
 #include "ui/app_state.h"
 #include "ui/resize_event.h"
+#include "ui/system.h"
 
 #include <any>
 #include <cstring>
+#include <functional>
 #include <initializer_list>
 #include <map>
 #include <memory>
+#include <set>
+#include <vector>
 
 // This event was disabled because it can be triggered in a background thread
 // when any effect (e.g. like Replace Color or Convolution Matrix) is running.
@@ -48,6 +57,7 @@ namespace {
 
 using EventListener = int;
 
+class Events;
 class AppEvents;
 class WindowEvents;
 class SpriteEvents;
@@ -55,12 +65,24 @@ static std::unique_ptr<AppEvents> g_appEvents;
 static std::unique_ptr<WindowEvents> g_windowEvents;
 static std::map<doc::ObjectId, std::unique_ptr<SpriteEvents>> g_spriteEvents;
 
+// Events with coalesced listeners waiting to be flushed in the next
+// iteration of the UI loop (and the ones that are being flushed right
+// now, so they can be removed if they are deleted in the meantime).
+static std::set<Events*> g_pendingEvents;
+static std::set<Events*>* g_flushingEvents = nullptr;
+static void flush_coalesced_events();
+
 class Events {
 public:
   using EventType = int;
 
   Events() {}
-  virtual ~Events() {}
+  virtual ~Events()
+  {
+    g_pendingEvents.erase(this);
+    if (g_flushingEvents)
+      g_flushingEvents->erase(this);
+  }
   Events(const Events&) = delete;
   Events& operator=(const Events&) = delete;
 
@@ -77,13 +99,18 @@ public:
     return false;
   }
 
-  void add(EventType eventType, EventListener callbackRef)
+  // Coalesced listeners aren't called for each event, they are
+  // called once in the next iteration of the UI loop with a summary
+  // of all the events received until then.
+  void add(EventType eventType, EventListener callbackRef, bool coalesce)
   {
     if (eventType >= m_listeners.size())
       m_listeners.resize(eventType + 1);
 
     auto& listeners = m_listeners[eventType];
     listeners.push_back(callbackRef);
+    if (coalesce)
+      m_coalesced.insert(callbackRef);
     if (listeners.size() == 1)
       onAddFirstListener(eventType);
   }
@@ -107,33 +134,200 @@ public:
       if (removed && listeners.empty())
         onRemoveLastListener(i);
     }
+    m_coalesced.erase(callbackRef);
+  }
+
+  // Calls the coalesced listeners of all the events received since
+  // the last flush. The "ev" argument contains the fields of the
+  // last event, the number of coalesced events in "ev.count", and
+  // the extra summary fields of each kind of event.
+  void flushCoalesced()
+  {
+    const std::map<EventType, Coalesced> pending = std::move(m_pending);
+    m_pending.clear();
+
+    for (const auto& it : pending) {
+      const EventType eventType = it.first;
+      const Coalesced& coalesced = it.second;
+
+      EventListeners listeners;
+      if (eventType < m_listeners.size()) {
+        for (EventListener listener : m_listeners[eventType]) {
+          if (isCoalesced(listener))
+            listeners.push_back(listener);
+        }
+      }
+
+      // The summary is taken before calling the listeners, so changes
+      // made by the listeners themselves are collected for the next
+      // flush.
+      const std::any summary = onTakeCoalescedSummary(eventType);
+
+      callListeners(listeners, [this, eventType, &coalesced, &summary](lua_State* L) {
+        lua_newtable(L);
+        for (const auto& kv : coalesced.args) {
+          push_coalesced_arg(L, kv.second);
+          lua_setfield(L, -2, kv.first.c_str());
+        }
+        lua_pushinteger(L, coalesced.count);
+        lua_setfield(L, -2, "count");
+        onPushCoalescedFields(L, eventType, summary);
+        return 1;
+      });
+    }
   }
 
 protected:
-  void call(EventType eventType,
-            const std::initializer_list<std::pair<const std::string, std::any>>& args = {})
+  using Args = std::initializer_list<std::pair<const std::string, std::any>>;
+
+  void call(EventType eventType, const Args& args = {})
   {
     if (eventType >= m_listeners.size())
       return;
 
+    auto pushArgs = [&args](lua_State* L) -> int {
+      if (args.size() == 0)
+        return 0;
+      lua_newtable(L); // Create "ev" argument with fields about the event
+      for (const auto& kv : args) {
+        push_value_to_lua(L, kv.second);
+        lua_setfield(L, -2, kv.first.c_str());
+      }
+      return 1;
+    };
+
+    if (m_coalesced.empty()) {
+      callListeners(m_listeners[eventType], pushArgs);
+      return;
+    }
+
+    EventListeners immediate;
+    bool coalesce = false;
+    for (EventListener listener : m_listeners[eventType]) {
+      if (isCoalesced(listener))
+        coalesce = true;
+      else
+        immediate.push_back(listener);
+    }
+    callListeners(immediate, pushArgs);
+
+    if (coalesce) {
+      Coalesced& coalesced = m_pending[eventType];
+      coalesced.args.clear();
+      for (const auto& kv : args)
+        coalesced.args.emplace_back(kv.first, make_coalesced_arg(kv.second));
+      ++coalesced.count;
+      schedulePendingFlush();
+    }
+  }
+
+  bool hasCoalescedListeners(EventType eventType) const
+  {
+    if (m_coalesced.empty() || eventType >= m_listeners.size())
+      return false;
+    for (EventListener listener : m_listeners[eventType]) {
+      if (isCoalesced(listener))
+        return true;
+    }
+    return false;
+  }
+
+private:
+  using EventListeners = std::vector<EventListener>;
+
+  struct Coalesced {
+    std::vector<std::pair<std::string, std::any>> args; // Fields of the last event
+    int count = 0;
+  };
+
+  // Objects in the arguments of coalesced events are kept by ID, as
+  // they can be deleted before the listeners are called (in that
+  // case the field will be nil).
+  template<typename T>
+  struct ObjectArg {
+    ObjectId id;
+  };
+
+  static std::any make_coalesced_arg(const std::any& value)
+  {
+    if (auto v = std::any_cast<Sprite*>(&value))
+      return ObjectArg<Sprite>{ *v ? (*v)->id() : NullId };
+    else if (auto v = std::any_cast<Layer*>(&value))
+      return ObjectArg<Layer>{ *v ? (*v)->id() : NullId };
+    else if (auto v = std::any_cast<Tileset*>(&value))
+      return ObjectArg<Tileset>{ *v ? (*v)->id() : NullId };
+    // The remap is a temporary object of the notification
+    else if (auto v = std::any_cast<const Remap*>(&value))
+      return std::make_shared<const Remap>(**v);
+    return value;
+  }
+
+  static void push_coalesced_arg(lua_State* L, const std::any& value)
+  {
+    if (auto v = std::any_cast<ObjectArg<Sprite>>(&value)) {
+      if (doc::get<Sprite>(v->id))
+        push_docobj<Sprite>(L, v->id);
+      else
+        lua_pushnil(L);
+    }
+    else if (auto v = std::any_cast<ObjectArg<Layer>>(&value)) {
+      if (doc::get<Layer>(v->id))
+        push_docobj<Layer>(L, v->id);
+      else
+        lua_pushnil(L);
+    }
+    else if (auto v = std::any_cast<ObjectArg<Tileset>>(&value)) {
+      if (Tileset* tileset = doc::get<Tileset>(v->id))
+        push_tileset(L, tileset);
+      else
+        lua_pushnil(L);
+    }
+    else if (auto v = std::any_cast<std::shared_ptr<const Remap>>(&value))
+      push_value_to_lua(L, **v);
+    else
+      push_value_to_lua(L, value);
+  }
+
+  virtual void onAddFirstListener(EventType eventType) = 0;
+  virtual void onRemoveLastListener(EventType eventType) = 0;
+
+  // Returns (and resets) the extra summary of the coalesced events
+  // of the given type, and adds its fields to the "ev" table (on the
+  // top of the stack) passed to coalesced listeners.
+  virtual std::any onTakeCoalescedSummary(EventType eventType) { return {}; }
+  virtual void onPushCoalescedFields(lua_State* L, EventType eventType, const std::any& summary) {}
+
+  bool isCoalesced(EventListener listener) const
+  {
+    return m_coalesced.find(listener) != m_coalesced.end();
+  }
+
+  void schedulePendingFlush()
+  {
+    // Without UI there are no frames to wait for
+    if (!App::instance()->isGui()) {
+      flushCoalesced();
+      return;
+    }
+    if (g_pendingEvents.empty())
+      ui::execute_from_ui_thread(flush_coalesced_events);
+    g_pendingEvents.insert(this);
+  }
+
+  // "pushArgs" must push the arguments for the callback and return
+  // the number of pushed values.
+  void callListeners(const EventListeners& listeners,
+                     const std::function<int(lua_State*)>& pushArgs)
+  {
     script::Engine* engine = App::instance()->scriptEngine();
     lua_State* L = engine->luaState();
 
     try {
-      for (EventListener callbackRef : m_listeners[eventType]) {
+      for (EventListener callbackRef : listeners) {
         // Get user-defined callback function
         lua_rawgeti(L, LUA_REGISTRYINDEX, callbackRef);
 
-        int callbackArgs = 0;
-        if (args.size() > 0) {
-          ++callbackArgs;
-          lua_newtable(L); // Create "ev" argument with fields about the event
-          for (const auto& kv : args) {
-            push_value_to_lua(L, kv.second);
-            lua_setfield(L, -2, kv.first.c_str());
-          }
-        }
-
+        const int callbackArgs = pushArgs(L);
         if (lua_pcall(L, callbackArgs, 0, 0)) {
           if (const char* s = lua_tostring(L, -1))
             engine->consolePrint(s);
@@ -145,14 +339,27 @@ protected:
     }
   }
 
-private:
-  virtual void onAddFirstListener(EventType eventType) = 0;
-  virtual void onRemoveLastListener(EventType eventType) = 0;
-
-  using EventListeners = std::vector<EventListener>;
   std::vector<EventListeners> m_listeners;
+  std::set<EventListener> m_coalesced;
+  std::map<EventType, Coalesced> m_pending;
 };
 
+static void flush_coalesced_events()
+{
+  std::set<Events*> events;
+  std::swap(events, g_pendingEvents);
+
+  // Listeners can modify sprites again (scheduling a new flush for
+  // the next iteration) or close them (deleting its Events).
+  g_flushingEvents = &events;
+  while (!events.empty()) {
+    Events* evs = *events.begin();
+    events.erase(events.begin());
+    evs->flushCoalesced();
+  }
+  g_flushingEvents = nullptr;
+}
+
 // Used in BeforeCommand
 static bool s_stopPropagationFlag = false;
 
@@ -402,9 +609,34 @@ public:
   }
 #endif
 
+  // Collect the layers/frames modified for coalesced "change"
+  // listeners
+  void onAddLayer(DocEvent& ev) override { addChangedLayer(ev.layer()); }
+  void onBeforeRemoveLayer(DocEvent& ev) override { addChangedLayer(ev.layer()); }
+  void onLayerNameChange(DocEvent& ev) override { addChangedLayer(ev.layer()); }
+  void onLayerOpacityChange(DocEvent& ev) override { addChangedLayer(ev.layer()); }
+  void onLayerBlendModeChange(DocEvent& ev) override { addChangedLayer(ev.layer()); }
+  void onLayerRestacked(DocEvent& ev) override { addChangedLayer(ev.layer()); }
+  void onAddFrame(DocEvent& ev) override { addChangedFrame(ev.frame()); }
+  void onRemoveFrame(DocEvent& ev) override { addChangedFrame(ev.frame()); }
+  void onFrameDurationChanged(DocEvent& ev) override { addChangedFrame(ev.frame()); }
+  void onFramesMoved(DocEvent& ev) override { addChangedFrames(ev.frame(), ev.targetFrame()); }
+  void onAddCel(DocEvent& ev) override { addChangedCel(ev); }
+  void onBeforeRemoveCel(DocEvent& ev) override { addChangedCel(ev); }
+  void onCelFrameChanged(DocEvent& ev) override { addChangedCel(ev); }
+  void onCelPositionChanged(DocEvent& ev) override { addChangedCel(ev); }
+  void onCelOpacityChange(DocEvent& ev) override { addChangedCel(ev); }
+  void onCelZIndexChange(DocEvent& ev) override { addChangedCel(ev); }
+
   // DocUndoObserver impl
   void onAddUndoState(DocUndo* history) override
   {
+    if (collectChanges()) {
+      if (auto cmd = static_cast<CmdTransaction*>(history->lastExecutedCmd())) {
+        addChangedPosition(cmd->spritePositionBeforeExecute());
+        addChangedPosition(cmd->spritePositionAfterExecute());
+      }
+    }
     call(Change,
          {
            { "fromUndo", false }
@@ -412,6 +644,13 @@ public:
   }
   void onCurrentUndoStateChange(DocUndo* history) override
   {
+    if (collectChanges()) {
+      // The undone state is the next redo, and the redone state is
+      // the next undo.
+      addChangedPosition(history->nextUndoSpritePosition());
+      addChangedPosition(history->nextRedoSpritePosition());
+      m_changes.fromUndo = true;
+    }
     call(Change,
          {
            { "fromUndo", true }
@@ -419,6 +658,119 @@ public:
   }
 
 private:
+  // Summary of the changes for the coalesced "change" listeners. The
+  // bounds are the union of the bounds of the cels that might have
+  // been modified (in sprite coordinates).
+  struct Changes {
+    std::set<ObjectId> layers;
+    std::set<frame_t> frames;
+    gfx::Rect bounds;
+    bool fromUndo = false;
+  };
+
+  std::any onTakeCoalescedSummary(EventType eventType) override
+  {
+    if (eventType != Change)
+      return {};
+
+    Changes changes;
+    std::swap(changes, m_changes);
+    return changes;
+  }
+
+  void onPushCoalescedFields(lua_State* L, EventType eventType, const std::any& summary) override
+  {
+    const auto changes = std::any_cast<Changes>(&summary);
+    if (!changes)
+      return;
+
+    Sprite* sprite = doc::get<Sprite>(m_spriteId);
+    if (!sprite)
+      return;
+
+    // Only layers that still exist (they could be removed in the
+    // coalesced changes)
+    doc::ObjectIds layers;
+    for (ObjectId layerId : changes->layers) {
+      if (doc::get<Layer>(layerId))
+        layers.push_back(layerId);
+    }
+    push_layers(L, layers);
+    lua_setfield(L, -2, "layers");
+
+    std::vector<frame_t> frames;
+    for (frame_t frame : changes->frames) {
+      if (frame >= 0 && frame < sprite->totalFrames())
+        frames.push_back(frame);
+    }
+    push_sprite_frames(L, sprite, frames);
+    lua_setfield(L, -2, "frames");
+
+    push_value_to_lua(L, changes->bounds);
+    lua_setfield(L, -2, "bounds");
+
+    // True if some of the coalesced changes was an undo/redo
+    lua_pushboolean(L, changes->fromUndo);
+    lua_setfield(L, -2, "fromUndo");
+  }
+
+  void addChangedLayer(const Layer* layer)
+  {
+    if (layer && collectChanges())
+      m_changes.layers.insert(layer->id());
+  }
+
+  void addChangedFrame(const frame_t frame)
+  {
+    if (collectChanges())
+      m_changes.frames.insert(frame);
+  }
+
+  // All cels in the given range of frames were moved
+  void addChangedFrames(const frame_t first, const frame_t last)
+  {
+    if (!collectChanges())
+      return;
+    Sprite* sprite = doc::get<Sprite>(m_spriteId);
+    if (!sprite)
+      return;
+    for (frame_t frame = first; frame <= last; ++frame) {
+      addChangedFrame(frame);
+      for (const Cel* cel : sprite->cels(frame)) {
+        addChangedLayer(cel->layer());
+        m_changes.bounds |= cel->bounds();
+      }
+    }
+  }
+
+  void addChangedCel(DocEvent& ev)
+  {
+    if (!collectChanges())
+      return;
+    if (const Cel* cel = ev.cel()) {
+      addChangedLayer(cel->layer());
+      addChangedFrame(cel->frame());
+      m_changes.bounds |= cel->bounds();
+    }
+    else {
+      addChangedLayer(ev.layer());
+      addChangedFrame(ev.frame());
+    }
+  }
+
+  void addChangedPosition(const SpritePosition& pos)
+  {
+    Layer* layer = pos.layer();
+    if (!layer)
+      return;
+    addChangedLayer(layer);
+    addChangedFrame(pos.frame());
+    if (const Cel* cel = layer->cel(pos.frame()))
+      m_changes.bounds |= cel->bounds();
+  }
+
+  bool collectChanges() const { return hasCoalescedListeners(Change); }
+
   void onAddFirstListener(EventType eventType) override
   {
     switch (eventType) {
@@ -435,6 +787,7 @@ private:
     switch (eventType) {
       case Change: {
         disconnectFromUndoHistory(doc());
+        m_changes = Changes();
         break;
       }
     }
@@ -459,6 +812,7 @@ private:
 
   ObjectId m_spriteId;
   bool m_observingUndo = false;
+  Changes m_changes;
 };
 
 int Events_on(lua_State* L)
@@ -475,10 +829,19 @@ int Events_on(lua_State* L)
   if (!lua_isfunction(L, 3))
     return luaL_error(L, "second argument must be a function");
 
+  // Optional third argument with options, e.g. { coalesce=true } to
+  // receive all the events of the same UI frame in just one call.
+  bool coalesce = false;
+  if (lua_istable(L, 4)) {
+    if (lua_getfield(L, 4, "coalesce") != LUA_TNIL)
+      coalesce = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+  }
+
   // Copy the callback function to add it to the global registry
   lua_pushvalue(L, 3);
   int callbackRef = luaL_ref(L, LUA_REGISTRYINDEX);
-  evs->add(type, callbackRef);
+  evs->add(type, callbackRef, coalesce);
 
   // Return the callback ref (this is an EventListener easier to use
   // in Events_off())
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2015-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -34,8 +34,15 @@
 #include "doc/cel.h"
 #include "doc/image.h"
 #include "doc/image_ref.h"
+#include "doc/palette_picks.h"
 #include "doc/primitives.h"
 #include "doc/sprite.h"
+#include "filters/brightness_contrast_filter.h"
+#include "filters/filter_indexed_data.h"
+#include "filters/filter_manager.h"
+#include "filters/hue_saturation_filter.h"
+#include "filters/invert_color_filter.h"
+#include "filters/median_filter.h"
 #include "render/render.h"
 
 #include <algorithm>
@@ -99,6 +106,269 @@ void render_sprite(Image* dst, const Sprite* sprite, const frame_t frame, const
   render.renderSprite(dst, sprite, frame, gfx::Clip(x, y, 0, 0, sprite->width(), sprite->height()));
 }
 
+// Returns the image area specified in the given argument index
+// (clipped to the image bounds), or the whole image if there is no
+// argument.
+gfx::Rect get_image_area(lua_State* L, const doc::Image* img, int index)
+{
+  gfx::Rect bounds = img->bounds();
+  if (!lua_isnoneornil(L, index))
+    bounds &= convert_args_into_rect(L, index);
+  return bounds;
+}
+
+// Modifies the given area of the image calling func(dst, origin),
+// where "origin" is the position of "dst" in the image. If func()
+// returns false the modification is discarded. Cel images are
+// modified through a copy of the area with undo information (like
+// Image:drawImage()).
+template<typename Func>
+bool modify_image(lua_State* L, ImageObj* obj, const gfx::Rect& bounds, Func&& func)
+{
+  doc::Image* img = obj->image(L);
+
+  if (auto cel = obj->cel(L)) {
+    ImageRef tmp(crop_image(img, bounds, img->maskColor()));
+    if (!func(tmp.get(), bounds.origin()))
+      return false;
+
+    ImageRef orig(crop_image(img, bounds, img->maskColor()));
+    int x1, y1, x2, y2;
+    if (get_shrink_rect2(&x1, &y1, &x2, &y2, orig.get(), tmp.get())) {
+      Tx tx(cel->sprite());
+      tx(new cmd::CopyRect(
+        img,
+        tmp.get(),
+        gfx::Clip(bounds.x + x1, bounds.y + y1, x1, y1, x2 - x1 + 1, y2 - y1 + 1)));
+      tx.commit();
+    }
+  }
+  else {
+    if (!func(img, gfx::Point(0, 0)))
+      return false;
+
+    // Rehash tileset
+    if (obj->tilesetId) {
+      if (doc::Tileset* ts = obj->tileset(L)) {
+        ts->incrementVersion();
+        ts->notifyTileContentChange(obj->ti);
+      }
+    }
+  }
+  return true;
+}
+
+template<typename ImageTraits>
+void push_pixels_templ(lua_State* L, const doc::Image* img, const gfx::Rect& bounds)
+{
+  const LockImageBits<ImageTraits> bits(img, bounds);
+  lua_Integer i = 0;
+  for (auto it = bits.begin(), end = bits.end(); it != end; ++it) {
+    lua_pushinteger(L, *it);
+    lua_rawseti(L, -2, ++i);
+  }
+}
+
+// Sets the pixels from the table in the "index" argument (all
+// values must be integers, see Image_setPixels()).
+template<typename ImageTraits>
+void set_pixels_templ(lua_State* L, int index, doc::Image* img, const gfx::Rect& bounds)
+{
+  LockImageBits<ImageTraits> bits(img, Image::WriteLock, bounds);
+  lua_Integer i = 0;
+  for (auto it = bits.begin(), end = bits.end(); it != end; ++it) {
+    lua_rawgeti(L, index, ++i);
+    *it = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+  }
+}
+
+// Converts the value on the top of the stack to a pixel value. If
+// it's not an integer, pushes an error message and returns false.
+bool get_mapped_pixel(lua_State* L, color_t& pixel)
+{
+  int isnum = 0;
+  const lua_Integer value = lua_tointegerx(L, -1, &isnum);
+  if (!isnum) {
+    lua_pushfstring(L,
+                    "Image:mapPixels() expects integer pixel values, got a %s",
+                    luaL_typename(L, -1));
+    return false;
+  }
+  pixel = color_t(value);
+  return true;
+}
+
+// Maps each pixel using the table (lookup table) or the function
+// in the "index" argument. The function receives the pixel position
+// in the original image ("origin" is the position of "img" in that
+// image). If the function fails, the error message is left on the
+// stack and it returns false.
+template<typename ImageTraits>
+bool map_pixels_templ(lua_State* L,
+                      int index,
+                      doc::Image* img,
+                      const gfx::Rect& bounds,
+                      const gfx::Point& origin)
+{
+  const bool isTable = lua_istable(L, index);
+  LockImageBits<ImageTraits> bits(img, Image::ReadWriteLock, bounds);
+
+  if (isTable) {
+    // Cache the last converted value as consecutive pixels tend to
+    // have the same color.
+    bool hasLast = false;
+    color_t lastFrom = 0, lastTo = 0;
+    bool lastChange = false;
+
+    for (auto it = bits.begin(), end = bits.end(); it != end; ++it) {
+      const color_t c = *it;
+      if (!hasLast || c != lastFrom) {
+        lastChange = (lua_rawgeti(L, index, c) != LUA_TNIL);
+        if (lastChange && !get_mapped_pixel(L, lastTo))
+          return false; // Error message on the stack
+        lua_pop(L, 1);
+        lastFrom = c;
+        hasLast = true;
+      }
+      if (lastChange)
+        *it = lastTo;
+    }
+  }
+  else {
+    for (auto it = bits.begin(), end = bits.end(); it != end; ++it) {
+      lua_pushvalue(L, index);
+      lua_pushinteger(L, *it);
+      lua_pushinteger(L, origin.x + it.x());
+      lua_pushinteger(L, origin.y + it.y());
+      if (lua_pcall(L, 3, 1, 0) != LUA_OK)
+        return false; // Error message on the stack
+
+      // nil keeps the pixel
+      if (!lua_isnil(L, -1)) {
+        color_t pixel;
+        if (!get_mapped_pixel(L, pixel))
+          return false; // Error message on the stack
+        *it = pixel;
+      }
+      lua_pop(L, 1);
+    }
+  }
+  return true;
+}
+
+#define DISPATCH_LUA_IMAGE(img, func, ...)                                                         \
+  switch (img->pixelFormat()) {                                                                    \
+    case IMAGE_RGB:       return func<doc::RgbTraits>(__VA_ARGS__);                                \
+    case IMAGE_GRAYSCALE: return func<doc::GrayscaleTraits>(__VA_ARGS__);                          \
+    case IMAGE_INDEXED:   return func<doc::IndexedTraits>(__VA_ARGS__);                            \
+    case IMAGE_TILEMAP:   return func<doc::TilemapTraits>(__VA_ARGS__);                            \
+    case IMAGE_BITMAP:    return func<doc::BitmapTraits>(__VA_ARGS__);                             \
+    default:              break;                                                                   \
+  }
+
+void push_pixels(lua_State* L, const doc::Image* img, const gfx::Rect& bounds)
+{
+  DISPATCH_LUA_IMAGE(img, push_pixels_templ, L, img, bounds);
+}
+
+void set_pixels(lua_State* L, int index, doc::Image* img, const gfx::Rect& bounds)
+{
+  DISPATCH_LUA_IMAGE(img, set_pixels_templ, L, index, img, bounds);
+}
+
+bool map_pixels(lua_State* L,
+                int index,
+                doc::Image* img,
+                const gfx::Rect& bounds,
+                const gfx::Point& origin)
+{
+  DISPATCH_LUA_IMAGE(img, map_pixels_templ, L, index, img, bounds, origin);
+  return true;
+}
+
+// Applies a filters::Filter to an image (without selection).
+class ImageFilterManager : public filters::FilterManager,
+                           public filters::FilterIndexedData {
+public:
+  // "dstOrigin" is the position of "dst" in the "src" image.
+  ImageFilterManager(const doc::Image* src,
+                     doc::Image* dst,
+                     const gfx::Point& dstOrigin,
+                     const gfx::Rect& bounds,
+                     const filters::Target target,
+                     const doc::Palette* palette,
+                     const doc::RgbMap* rgbmap)
+    : m_src(src)
+    , m_dst(dst)
+    , m_dstOrigin(dstOrigin)
+    , m_bounds(bounds)
+    , m_target(target)
+    , m_palette(palette)
+    , m_rgbmap(rgbmap)
+    , m_row(bounds.y)
+  {
+  }
+
+  void apply(filters::Filter* filter)
+  {
+    for (m_row = m_bounds.y; m_row < m_bounds.y2(); ++m_row) {
+      switch (m_dst->pixelFormat()) {
+        case IMAGE_RGB:       filter->applyToRgba(this); break;
+        case IMAGE_GRAYSCALE: filter->applyToGrayscale(this); break;
+        case IMAGE_INDEXED:   filter->applyToIndexed(this); break;
+        default:              break;
+      }
+    }
+  }
+
+  // FilterManager impl
+  doc::PixelFormat pixelFormat() const override { return m_dst->pixelFormat(); }
+  const void* getSourceAddress() override { return m_src->getPixelAddress(m_bounds.x, m_row); }
+  void* getDestinationAddress() override
+  {
+    return m_dst->getPixelAddress(m_bounds.x - m_dstOrigin.x, m_row - m_dstOrigin.y);
+  }
+  int getWidth() override { return m_bounds.w; }
+  filters::Target getTarget() override { return m_target; }
+  filters::FilterIndexedData* getIndexedData() override { return this; }
+  bool skipPixel() override { return false; }
+  const doc::Image* getSourceImage() override { return m_src; }
+  int x() const override { return m_bounds.x; }
+  int y() const override { return m_row; }
+  bool isFirstRow() const override { return m_row == m_bounds.y; }
+  bool isMaskActive() const override { return false; }
+  base::task_token& taskToken() const override { return m_token; }
+
+  // FilterIndexedData impl
+  const doc::Palette* getPalette() const override { return m_palette; }
+  const doc::RgbMap* getRgbMap() const override { return m_rgbmap; }
+  doc::Palette* getNewPalette() override { return nullptr; }
+  doc::PalettePicks getPalettePicks() override { return doc::PalettePicks(); }
+
+private:
+  const doc::Image* m_src;
+  doc::Image* m_dst;
+  gfx::Point m_dstOrigin;
+  gfx::Rect m_bounds;
+  filters::Target m_target;
+  const doc::Palette* m_palette;
+  const doc::RgbMap* m_rgbmap;
+  int m_row;
+  mutable base::task_token m_token;
+};
+
+double get_number_field(lua_State* L, int index, const char* field, double defaultValue)
+{
+  double value = defaultValue;
+  if (lua_istable(L, index)) {
+    if (lua_getfield(L, index, field) != LUA_TNIL)
+      value = lua_tonumber(L, -1);
+    lua_pop(L, 1);
+  }
+  return value;
+}
+
 int Image_clone(lua_State* L);
 
 int Image_new(lua_State* L)
@@ -418,6 +688,219 @@ int Image_isPlain(lua_State* L)
   return 1;
 }
 
+int Image_getPixels(lua_State* L)
+{
+  const auto img = get_obj<ImageObj>(L, 1)->image(L);
+  const gfx::Rect bounds = get_image_area(L, img, 2);
+
+  lua_createtable(L, bounds.w * bounds.h, 0);
+  if (!bounds.isEmpty())
+    push_pixels(L, img, bounds);
+  return 1;
+}
+
+int Image_setPixels(lua_State* L)
+{
+  auto obj = get_obj<ImageObj>(L, 1);
+  luaL_checktype(L, 2, LUA_TTABLE);
+  const gfx::Rect bounds = get_image_area(L, obj->image(L), 3);
+  if (bounds.isEmpty())
+    return 0;
+
+  const lua_Integer n = luaL_len(L, 2);
+  if (n != lua_Integer(bounds.w) * bounds.h)
+    return luaL_error(L,
+                      "the table has %d pixels, %d pixels are needed",
+                      int(n),
+                      bounds.w * bounds.h);
+
+  // Check the values before modifying the image
+  for (lua_Integer i = 1; i <= n; ++i) {
+    int isnum = 0;
+    lua_rawgeti(L, 2, i);
+    lua_tointegerx(L, -1, &isnum);
+    lua_pop(L, 1);
+    if (!isnum)
+      return luaL_error(L, "the pixel %d of the table must be an integer", int(i));
+  }
+
+  modify_image(L, obj, bounds, [L, &bounds](doc::Image* img, const gfx::Point& origin) {
+    set_pixels(L, 2, img, gfx::Rect(bounds).offset(-origin));
+    return true;
+  });
+  return 0;
+}
+
+int Image_mapPixels(lua_State* L)
+{
+  auto obj = get_obj<ImageObj>(L, 1);
+  if (!lua_istable(L, 2) && !lua_isfunction(L, 2))
+    return luaL_error(L, "a lookup table or function is expected in Image:mapPixels()");
+
+  const gfx::Rect bounds = get_image_area(L, obj->image(L), 3);
+  if (bounds.isEmpty())
+    return 0;
+
+  const bool ok =
+    modify_image(L, obj, bounds, [L, &bounds](doc::Image* img, const gfx::Point& origin) {
+      return map_pixels(L, 2, img, gfx::Rect(bounds).offset(-origin), origin);
+    });
+
+  // Propagate the error of the callback (once all C++ objects were
+  // destroyed)
+  if (!ok)
+    return lua_error(L);
+  return 0;
+}
+
+int Image_getBytes(lua_State* L)
+{
+  const auto img = get_obj<ImageObj>(L, 1)->image(L);
+  if (img->pixelFormat() == IMAGE_BITMAP)
+    return luaL_error(L, "Image:getBytes() cannot be used with bitmap images");
+
+  const gfx::Rect bounds = get_image_area(L, img, 2);
+  if (bounds.isEmpty()) {
+    lua_pushliteral(L, "");
+    return 1;
+  }
+
+  const std::size_t rowBytes = std::size_t(bounds.w) * img->bytesPerPixel();
+  luaL_Buffer b;
+  char* dst = luaL_buffinitsize(L, &b, rowBytes * bounds.h);
+  for (int y = bounds.y; y < bounds.y2(); ++y, dst += rowBytes)
+    std::memcpy(dst, img->getPixelAddress(bounds.x, y), rowBytes);
+  luaL_pushresultsize(&b, rowBytes * bounds.h);
+  return 1;
+}
+
+int Image_setBytes(lua_State* L)
+{
+  auto obj = get_obj<ImageObj>(L, 1);
+  std::size_t bytesSize;
+  const char* bytes = luaL_checklstring(L, 2, &bytesSize);
+  if (obj->image(L)->pixelFormat() == IMAGE_BITMAP)
+    return luaL_error(L, "Image:setBytes() cannot be used with bitmap images");
+
+  const gfx::Rect bounds = get_image_area(L, obj->image(L), 3);
+  if (bounds.isEmpty())
+    return 0;
+
+  const std::size_t rowBytes = std::size_t(bounds.w) * obj->image(L)->bytesPerPixel();
+  const std::size_t bytesNeeded = rowBytes * bounds.h;
+  if (bytesSize != bytesNeeded)
+    return luaL_error(L,
+                      "Data size does not match: given %d, needed %d.",
+                      int(bytesSize),
+                      int(bytesNeeded));
+
+  modify_image(L, obj, bounds, [&](doc::Image* img, const gfx::Point& origin) {
+    const gfx::Rect area = gfx::Rect(bounds).offset(-origin);
+    const char* src = bytes;
+    for (int y = area.y; y < area.y2(); ++y, src += rowBytes)
+      std::memcpy(img->getPixelAddress(area.x, y), src, rowBytes);
+    return true;
+  });
+  return 0;
+}
+
+int Image_replaceColor(lua_State* L)
+{
+  auto obj = get_obj<ImageObj>(L, 1);
+  const doc::PixelFormat pixelFormat = obj->image(L)->pixelFormat();
+  const doc::color_t from = (lua_isinteger(L, 2) ?
+                               lua_tointeger(L, 2) :
+                               convert_args_into_pixel_color(L, 2, pixelFormat));
+  const doc::color_t to = (lua_isinteger(L, 3) ? lua_tointeger(L, 3) :
+                                                 convert_args_into_pixel_color(L, 3, pixelFormat));
+  const gfx::Rect bounds = get_image_area(L, obj->image(L), 4);
+  if (bounds.isEmpty() || from == to)
+    return 0;
+
+  modify_image(L, obj, bounds, [&bounds, from, to](doc::Image* img, const gfx::Point& origin) {
+    doc::replace_color(img, gfx::Rect(bounds).offset(-origin), from, to);
+    return true;
+  });
+  return 0;
+}
+
+int Image_applyFilter(lua_State* L)
+{
+  auto obj = get_obj<ImageObj>(L, 1);
+  const std::string name = luaL_checkstring(L, 2);
+  const doc::Image* img = obj->image(L);
+  const gfx::Rect bounds = get_image_area(L, img, 4);
+
+  std::unique_ptr<filters::Filter> filter;
+  filters::Target target = TARGET_ALL_CHANNELS;
+
+  if (name == "invert") {
+    filter = std::make_unique<filters::InvertColorFilter>();
+    target = TARGET_RED_CHANNEL | TARGET_GREEN_CHANNEL | TARGET_BLUE_CHANNEL |
+             TARGET_GRAY_CHANNEL;
+  }
+  else if (name == "brightnessContrast") {
+    auto f = std::make_unique<filters::BrightnessContrastFilter>();
+    f->setBrightness(get_number_field(L, 3, "brightness", 0.0) / 100.0);
+    f->setContrast(get_number_field(L, 3, "contrast", 0.0) / 100.0);
+    filter = std::move(f);
+  }
+  else if (name == "hueSaturation") {
+    auto f = std::make_unique<filters::HueSaturationFilter>();
+    f->setHue(get_number_field(L, 3, "hue", 0.0));
+    f->setSaturation(get_number_field(L, 3, "saturation", 0.0) / 100.0);
+    f->setLightness(get_number_field(L, 3, "lightness", 0.0) / 100.0);
+    f->setAlpha(get_number_field(L, 3, "alpha", 0.0) / 100.0);
+    filter = std::move(f);
+  }
+  else if (name == "despeckle") {
+    auto f = std::make_unique<filters::MedianFilter>();
+    f->setSize(int(get_number_field(L, 3, "width", 3)), int(get_number_field(L, 3, "height", 3)));
+    filter = std::move(f);
+  }
+  else
+    return luaL_error(L, "unknown filter '%s' in Image:applyFilter()", name.c_str());
+
+  if (lua_istable(L, 3)) {
+    if (lua_getfield(L, 3, "channels") != LUA_TNIL)
+      target = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+  }
+
+  // Indexed images need the palette/rgbmap of the sprite
+  const doc::Palette* palette = nullptr;
+  const doc::RgbMap* rgbmap = nullptr;
+  if (Cel* cel = obj->cel(L)) {
+    palette = cel->sprite()->palette(cel->frame());
+    rgbmap = cel->sprite()->rgbMap(cel->frame());
+  }
+  else {
+    palette = get_current_palette();
+  }
+
+  if (img->pixelFormat() == IMAGE_INDEXED && !rgbmap)
+    return luaL_error(L, "Image:applyFilter() needs a cel image for indexed images");
+  if (img->pixelFormat() == IMAGE_TILEMAP)
+    return luaL_error(L, "Image:applyFilter() cannot be used with tilemaps");
+  if (bounds.isEmpty())
+    return 0;
+
+  modify_image(L, obj, bounds, [&](doc::Image* dst, const gfx::Point& origin) {
+    // Filters need the original image as source (the whole image,
+    // as some filters read pixels around the area)
+    ImageRef copy;
+    const doc::Image* src = img;
+    if (dst == img) {
+      copy.reset(Image::createCopy(img));
+      src = copy.get();
+    }
+    ImageFilterManager filterMgr(src, dst, origin, bounds, target, palette, rgbmap);
+    filterMgr.apply(filter.get());
+    return true;
+  });
+  return 0;
+}
+
 int Image_saveAs(lua_State* L)
 {
   auto obj = get_obj<ImageObj>(L, 1);
@@ -728,6 +1211,13 @@ const luaL_Reg Image_methods[] = {
   { "drawSprite",   Image_drawSprite   },
   { "putSprite",    Image_drawSprite   }, // TODO putSprite is deprecated
   { "pixels",       Image_pixels       },
+  { "getPixels",    Image_getPixels    },
+  { "setPixels",    Image_setPixels    },
+  { "mapPixels",    Image_mapPixels    },
+  { "getBytes",     Image_getBytes     },
+  { "setBytes",     Image_setBytes     },
+  { "replaceColor", Image_replaceColor },
+  { "applyFilter",  Image_applyFilter  },
   { "isEqual",      Image_isEqual      },
   { "isEmpty",      Image_isEmpty      },
   { "isPlain",      Image_isPlain      },
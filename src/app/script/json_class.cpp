@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2023  Igara Studio S.A.
+// Copyright (C) 2023-2025  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -8,10 +8,21 @@
   #include "config.h"
 #endif
 
+#include "app/json_reader.h"
+#include "app/json_writer.h"
 #include "app/script/luacpp.h"
+#include "app/script/security.h"
 #include "app/script/values.h"
+#include "base/fstream_path.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <utility>
+#include <vector>
 
 #include "json11.hpp"
 
@@ -24,6 +35,17 @@ using JsonObj = json11::Json;
 using JsonArrayIterator = JsonObj::array::const_iterator;
 using JsonObjectIterator = JsonObj::object::const_iterator;
 
+// Maximum nesting of objects/arrays read with read_json_value()
+const int kMaxDepth = 64;
+
+// Object returned by json.reader() to parse JSON data incrementally
+struct JsonReaderObj {
+  std::unique_ptr<std::istream> stream;
+  JsonReader reader;
+
+  JsonReaderObj(std::unique_ptr<std::istream>&& s) : stream(std::move(s)), reader(*stream) {}
+};
+
 void push_json_value(lua_State* L, const JsonObj& value)
 {
   switch (value.type()) {
@@ -82,6 +104,158 @@ JsonObj get_json_value(lua_State* L, int index)
   return JsonObj();
 }
 
+// Writes the Lua value in the given index directly to the JSON
+// writer (without creating an intermediate JsonObj).
+void write_lua_value(JsonWriter& json, lua_State* L, int index)
+{
+  index = lua_absindex(L, index);
+  switch (lua_type(L, index)) {
+    case LUA_TBOOLEAN: json.value(lua_toboolean(L, index) ? true : false); break;
+
+    case LUA_TNUMBER:
+      if (lua_isinteger(L, index))
+        json.value(int64_t(lua_tointeger(L, index)));
+      else
+        json.value(double(lua_tonumber(L, index)));
+      break;
+
+    case LUA_TSTRING: {
+      size_t len = 0;
+      const char* str = lua_tolstring(L, index, &len);
+      json.value(std::string_view(str, len));
+      break;
+    }
+
+    case LUA_TTABLE:
+      if (is_array_table(L, index)) {
+        json.beginArray();
+        const lua_Integer n = luaL_len(L, index);
+        for (lua_Integer i = 1; i <= n; ++i) {
+          lua_geti(L, index, i);
+          write_lua_value(json, L, -1);
+          lua_pop(L, 1);
+        }
+        json.endArray();
+      }
+      else {
+        // Keys are sorted to generate the same output as json11 (the
+        // original keys are stored in a temporary table as they can
+        // be numbers).
+        std::vector<std::pair<std::string, int>> keys;
+        lua_newtable(L);
+        const int keysTable = lua_gettop(L);
+        lua_pushnil(L);
+        while (lua_next(L, index) != 0) {
+          // Convert a copy of the key, lua_tostring() modifies the
+          // value in the stack and would confuse lua_next()
+          lua_pushvalue(L, -2);
+          if (const char* k = lua_tostring(L, -1)) {
+            keys.emplace_back(k, int(keys.size()) + 1);
+            lua_pushvalue(L, -3);
+            lua_rawseti(L, keysTable, keys.size());
+          }
+          lua_pop(L, 2); // Pop the key copy and the value
+        }
+        std::sort(keys.begin(), keys.end());
+
+        json.beginObject();
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+          if (i > 0 && keys[i].first == keys[i - 1].first)
+            continue;
+          json.key(keys[i].first);
+          lua_rawgeti(L, keysTable, keys[i].second);
+          lua_gettable(L, index);
+          write_lua_value(json, L, -1);
+          lua_pop(L, 1);
+        }
+        json.endObject();
+        lua_pop(L, 1); // Pop keysTable
+      }
+      break;
+
+    default:
+      // TODO convert rectangles, point, size, uuids?
+      json.null();
+      break;
+  }
+}
+
+// Creates a JsonObj from the current token of the reader (reading
+// all the tokens of the object/array if it's a BeginObject/BeginArray
+// token). Throws a JsonReader::Error if the value is nested too deep.
+JsonObj read_json_value(JsonReader& reader, const int depth = 0)
+{
+  if ((reader.token() == JsonReader::Token::BeginObject ||
+       reader.token() == JsonReader::Token::BeginArray) &&
+      depth >= kMaxDepth) {
+    throw JsonReader::Error("JSON value nested too deep");
+  }
+
+  switch (reader.token()) {
+    case JsonReader::Token::BeginObject: {
+      JsonObj::object items;
+      while (reader.next() == JsonReader::Token::Key) {
+        std::string key = reader.string();
+        reader.next();
+        items[key] = read_json_value(reader, depth + 1);
+      }
+      return JsonObj(items);
+    }
+    case JsonReader::Token::BeginArray: {
+      JsonObj::array items;
+      while (reader.next() != JsonReader::Token::EndArray)
+        items.push_back(read_json_value(reader, depth + 1));
+      return JsonObj(items);
+    }
+    case JsonReader::Token::String: return JsonObj(reader.string());
+    case JsonReader::Token::Number: return JsonObj(reader.number());
+    case JsonReader::Token::Bool:   return JsonObj(reader.boolean());
+    default:                        return JsonObj();
+  }
+}
+
+// Pushes the value of the current token of the reader, scalars are
+// pushed as Lua values and objects/arrays as JsonObj.
+void push_reader_value(lua_State* L, JsonReader& reader)
+{
+  switch (reader.token()) {
+    case JsonReader::Token::BeginObject:
+    case JsonReader::Token::BeginArray:  push_obj(L, read_json_value(reader)); break;
+    case JsonReader::Token::Key:
+    case JsonReader::Token::String: {
+      const std::string& str = reader.string();
+      lua_pushlstring(L, str.c_str(), str.size());
+      break;
+    }
+    case JsonReader::Token::Number:
+      // Integers are pushed as Lua integers only if they can be
+      // represented exactly
+      if (reader.isInteger() && std::fabs(reader.number()) < 9007199254740992.0)
+        lua_pushinteger(L, lua_Integer(reader.number()));
+      else
+        lua_pushnumber(L, reader.number());
+      break;
+    case JsonReader::Token::Bool: lua_pushboolean(L, reader.boolean()); break;
+    default:                      lua_pushnil(L); break;
+  }
+}
+
+const char* token_name(const JsonReader::Token token)
+{
+  switch (token) {
+    case JsonReader::Token::BeginObject: return "object";
+    case JsonReader::Token::EndObject:   return "endobject";
+    case JsonReader::Token::BeginArray:  return "array";
+    case JsonReader::Token::EndArray:    return "endarray";
+    case JsonReader::Token::Key:         return "key";
+    case JsonReader::Token::String:      return "string";
+    case JsonReader::Token::Number:      return "number";
+    case JsonReader::Token::Bool:        return "boolean";
+    case JsonReader::Token::Null:        return "null";
+    default:                             return nullptr;
+  }
+}
+
 int JsonObj_gc(lua_State* L)
 {
   get_obj<JsonObj>(L, 1)->~JsonObj();
@@ -205,6 +379,118 @@ int JsonArrayIterator_gc(lua_State* L)
   return 0;
 }
 
+int JsonReaderObj_gc(lua_State* L)
+{
+  get_obj<JsonReaderObj>(L, 1)->~JsonReaderObj();
+  return 0;
+}
+
+// Returns the name of the next token ("object", "endobject",
+// "array", "endarray", "key", "string", "number", "boolean", or
+// "null") and its value, or nil at the end of the data.
+int JsonReaderObj_next(lua_State* L)
+{
+  auto obj = get_obj<JsonReaderObj>(L, 1);
+  try {
+    const char* name = token_name(obj->reader.next());
+    if (!name)
+      return 0;
+    lua_pushstring(L, name);
+    push_reader_value(L, obj->reader);
+    return 2;
+  }
+  catch (const JsonReader::Error& ex) {
+    lua_pushstring(L, ex.what());
+  }
+  return lua_error(L);
+}
+
+// Reads the next whole value (e.g. the value of the last read key)
+int JsonReaderObj_value(lua_State* L)
+{
+  auto obj = get_obj<JsonReaderObj>(L, 1);
+  try {
+    switch (obj->reader.next()) {
+      case JsonReader::Token::End:
+      case JsonReader::Token::EndObject:
+      case JsonReader::Token::EndArray:  return 0;
+      case JsonReader::Token::Key:       obj->reader.next(); break;
+      default:                           break;
+    }
+    push_reader_value(L, obj->reader);
+    return 1;
+  }
+  catch (const JsonReader::Error& ex) {
+    lua_pushstring(L, ex.what());
+  }
+  return lua_error(L);
+}
+
+int JsonReaderObj_skip(lua_State* L)
+{
+  auto obj = get_obj<JsonReaderObj>(L, 1);
+  try {
+    obj->reader.skip();
+    return 0;
+  }
+  catch (const JsonReader::Error& ex) {
+    lua_pushstring(L, ex.what());
+  }
+  return lua_error(L);
+}
+
+int JsonReaderObj_items_next(lua_State* L)
+{
+  auto obj = get_obj<JsonReaderObj>(L, lua_upvalueindex(1));
+  const int depth = int(lua_tointeger(L, lua_upvalueindex(2)));
+  const lua_Integer i = lua_tointeger(L, lua_upvalueindex(3)) + 1;
+
+  // The object/array was already iterated
+  if (obj->reader.depth() < depth)
+    return 0;
+
+  try {
+    JsonReader::Token token = obj->reader.next();
+    if (token == JsonReader::Token::EndObject || token == JsonReader::Token::EndArray)
+      return 0;
+
+    lua_pushinteger(L, i);
+    lua_replace(L, lua_upvalueindex(3));
+
+    if (token == JsonReader::Token::Key) {
+      const std::string& key = obj->reader.string();
+      lua_pushlstring(L, key.c_str(), key.size());
+      obj->reader.next();
+    }
+    else {
+      lua_pushinteger(L, i);
+    }
+    push_reader_value(L, obj->reader);
+    return 2;
+  }
+  catch (const JsonReader::Error& ex) {
+    lua_pushstring(L, ex.what());
+  }
+  return lua_error(L);
+}
+
+// Iterates the items of the object/array that was just opened (the
+// last token must be "object" or "array"), returning the key (or
+// the 1-based index for arrays) and the value of each item.
+int JsonReaderObj_items(lua_State* L)
+{
+  auto obj = get_obj<JsonReaderObj>(L, 1);
+  const JsonReader::Token token = obj->reader.token();
+  if (token != JsonReader::Token::BeginObject && token != JsonReader::Token::BeginArray)
+    return luaL_error(L, "items() must be called after reading an object or array");
+
+  lua_pushvalue(L, 1);
+  lua_pushinteger(L, obj->reader.depth());
+  lua_pushinteger(L, 0);
+  lua_pushcclosure(L, JsonReaderObj_items_next, 3);
+  return 1;
+}
+
 int Json_decode(lua_State* L)
 {
   if (const char* s = lua_tostring(L, 1)) {
@@ -227,12 +513,47 @@ int Json_encode(lua_State* L)
   }
   // Encode a Lua table
   else if (lua_istable(L, 1)) {
-    lua_pushstring(L, get_json_value(L, 1).dump().c_str());
+    std::ostringstream out;
+    {
+      JsonWriter json(out);
+      write_lua_value(json, L, 1);
+    }
+    const std::string str = out.str();
+    lua_pushlstring(L, str.c_str(), str.size());
     return 1;
   }
   return 0;
 }
 
+// json.reader(text) or json.reader{ filename=... }
+int Json_reader(lua_State* L)
+{
+  std::unique_ptr<std::istream> stream;
+  if (lua_istable(L, 1)) {
+    if (lua_getfield(L, 1, "filename") == LUA_TSTRING) {
+      const char* fn = lua_tostring(L, -1);
+      if (!ask_access(L, fn, FileAccessMode::Read, ResourceType::File))
+        return luaL_error(L, "the script doesn't have access to read the file '%s'", fn);
+
+      auto file = std::make_unique<std::ifstream>(FSTREAM_PATH(std::string(fn)),
+                                                  std::ifstream::binary);
+      if (!*file)
+        return luaL_error(L, "cannot open file '%s'", fn);
+      stream = std::move(file);
+    }
+    lua_pop(L, 1);
+  }
+  else if (const char* s = lua_tostring(L, 1)) {
+    stream = std::make_unique<std::istringstream>(std::string(s));
+  }
+
+  if (!stream)
+    return luaL_error(L, "json.reader() expects a string or a table with a filename");
+
+  push_new<JsonReaderObj>(L, std::move(stream));
+  return 1;
+}
+
 const luaL_Reg JsonObj_methods[] = {
   { "__gc",       JsonObj_gc       },
   { "__eq",       JsonObj_eq       },
@@ -254,9 +575,19 @@ const luaL_Reg JsonArrayIterator_methods[] = {
   { nullptr, nullptr              }
 };
 
+const luaL_Reg JsonReaderObj_methods[] = {
+  { "__gc",  JsonReaderObj_gc    },
+  { "next",  JsonReaderObj_next  },
+  { "value", JsonReaderObj_value },
+  { "skip",  JsonReaderObj_skip  },
+  { "items", JsonReaderObj_items },
+  { nullptr, nullptr             }
+};
+
 const luaL_Reg Json_methods[] = {
   { "decode", Json_decode },
   { "encode", Json_encode },
+  { "reader", Json_reader },
   { nullptr,  nullptr     }
 };
 
@@ -266,12 +597,14 @@ DEF_MTNAME(Json);
 DEF_MTNAME(JsonObj);
 DEF_MTNAME(JsonObjectIterator);
 DEF_MTNAME(JsonArrayIterator);
+DEF_MTNAME(JsonReaderObj);
 
 void register_json_object(lua_State* L)
 {
   REG_CLASS(L, JsonObj);
   REG_CLASS(L, JsonObjectIterator);
   REG_CLASS(L, JsonArrayIterator);
+  REG_CLASS(L, JsonReaderObj);
   REG_CLASS(L, Json);
 
   lua_newtable(L); // Create a table which will be the "json" object
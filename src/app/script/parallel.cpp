@@ -0,0 +1,498 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/app.h"
+#include "app/cli/cli_jobs.h"
+#include "app/json_reader.h"
+#include "app/script/engine.h"
+#include "app/script/luacpp.h"
+#include "app/script/security.h"
+#include "base/fs.h"
+#include "base/fstream_path.h"
+#include "base/log.h"
+#include "base/process.h"
+#include "fmt/format.h"
+#include "ver/info.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace app { namespace script {
+
+namespace {
+
+// Maximum nesting of tables that can be passed to/from a job
+const int kMaxDepth = 64;
+
+std::atomic<int> g_parallelCounter(0);
+
+void write_lua_string(std::string& out, const char* str, size_t len)
+{
+  out.push_back('"');
+  for (size_t i = 0; i < len; ++i) {
+    const unsigned char chr = str[i];
+    switch (chr) {
+      case '"':  out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      default:
+        if (chr < 0x20 || chr == 0x7f)
+          out += fmt::format("\\{:03d}", int(chr));
+        else
+          out.push_back(char(chr));
+        break;
+    }
+  }
+  out.push_back('"');
+}
+
+void write_lua_string(std::string& out, const std::string& str)
+{
+  write_lua_string(out, str.c_str(), str.size());
+}
+
+// Converts the plain Lua value in the given index to Lua source code
+// so it can be passed to the job process.
+void write_lua_literal(std::string& out, lua_State* L, int index, int depth = 0)
+{
+  index = lua_absindex(L, index);
+  switch (lua_type(L, index)) {
+    case LUA_TNIL:     out += "nil"; break;
+    case LUA_TBOOLEAN: out += (lua_toboolean(L, index) ? "true" : "false"); break;
+
+    case LUA_TNUMBER:
+      if (lua_isinteger(L, index)) {
+        out += fmt::format("{}", lua_tointeger(L, index));
+      }
+      else {
+        const double value = lua_tonumber(L, index);
+        if (std::isnan(value))
+          out += "(0/0)";
+        else if (std::isinf(value))
+          out += (value < 0 ? "(-1/0)" : "(1/0)");
+        else {
+          std::string str = fmt::format("{:.17g}", value);
+          // Keep the value as a float in the job
+          if (str.find_first_of(".e") == std::string::npos)
+            str += ".0";
+          out += str;
+        }
+      }
+      break;
+
+    case LUA_TSTRING: {
+      size_t len = 0;
+      const char* str = lua_tolstring(L, index, &len);
+      write_lua_string(out, str, len);
+      break;
+    }
+
+    case LUA_TTABLE:
+      if (depth >= kMaxDepth)
+        throw std::runtime_error("tables passed to app.parallel() are nested too deep");
+
+      luaL_checkstack(L, 3, nullptr);
+      out.push_back('{');
+      lua_pushnil(L);
+      while (lua_next(L, index) != 0) {
+        out.push_back('[');
+        write_lua_literal(out, L, -2, depth + 1);
+        out += "]=";
+        write_lua_literal(out, L, -1, depth + 1);
+        out.push_back(',');
+        lua_pop(L, 1); // Pop the value, leave the key for lua_next()
+      }
+      out.push_back('}');
+      break;
+
+    default:
+      throw std::runtime_error(
+        fmt::format("a {} cannot be passed to app.parallel(), only plain values can be used",
+                    luaL_typename(L, index)));
+  }
+}
+
+// Pushes the current value of the reader as a plain Lua value
+// (objects and arrays are converted to tables).
+void push_json_as_lua(lua_State* L, JsonReader& reader, int depth = 0)
+{
+  switch (reader.token()) {
+    case JsonReader::Token::BeginObject:
+    case JsonReader::Token::BeginArray:  {
+      if (depth >= kMaxDepth)
+        throw std::runtime_error("the result of the job is nested too deep");
+
+      const bool object = (reader.token() == JsonReader::Token::BeginObject);
+      luaL_checkstack(L, 3, nullptr);
+      lua_newtable(L);
+      for (lua_Integer i = 1;; ++i) {
+        const JsonReader::Token token = reader.next();
+        if (token == JsonReader::Token::EndObject || token == JsonReader::Token::EndArray)
+          break;
+        if (object) {
+          lua_pushlstring(L, reader.string().c_str(), reader.string().size());
+          reader.next();
+          push_json_as_lua(L, reader, depth + 1);
+          lua_settable(L, -3);
+        }
+        else {
+          push_json_as_lua(L, reader, depth + 1);
+          lua_rawseti(L, -2, i);
+        }
+      }
+      break;
+    }
+    case JsonReader::Token::String:
+      lua_pushlstring(L, reader.string().c_str(), reader.string().size());
+      break;
+    case JsonReader::Token::Number:
+      if (reader.isInteger() && std::fabs(reader.number()) < 9007199254740992.0)
+        lua_pushinteger(L, lua_Integer(reader.number()));
+      else
+        lua_pushnumber(L, reader.number());
+      break;
+    case JsonReader::Token::Bool: lua_pushboolean(L, reader.boolean()); break;
+    default:                      lua_pushnil(L); break;
+  }
+}
+
+// Items processed by one job process
+struct Slice {
+  lua_Integer first; // Index of the first item (1-based)
+  lua_Integer last;  // Index of the last item
+  std::string outputFilename;
+
+  // Filled when the job finishes
+  int code = 0;
+  std::string output; // Text printed by the job
+  std::string json;   // Content of the output file (empty if it wasn't written)
+};
+
+// Reads the output file written by a job. Results are given to Lua
+// after all the jobs finish.
+std::string read_job_output(const std::string& filename)
+{
+  std::ifstream f(FSTREAM_PATH(filename), std::ifstream::binary);
+  if (!f)
+    return std::string();
+  return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+// Sets the results/errors of the items in the slice from the JSON
+// written by the job script, where each item is an array with its
+// index, true/false (if the call succeeded or failed), and the
+// result or the error message:
+//
+//   { "results": [ [ index, true, result ], [ index, false, "error" ], ... ] }
+//
+// Throws an exception if the JSON is invalid.
+void push_slice_results(lua_State* L, const Slice& slice, int resultsIndex, int errorsIndex)
+{
+  std::istringstream is(slice.json);
+  JsonReader reader(is);
+  if (reader.next() != JsonReader::Token::BeginObject)
+    throw std::runtime_error("the job didn't finish");
+
+  while (reader.next() == JsonReader::Token::Key) {
+    if (reader.string() != "results") {
+      reader.skip();
+      continue;
+    }
+    reader.next();
+    if (reader.token() == JsonReader::Token::BeginObject) { // Empty table
+      reader.skip();
+      continue;
+    }
+    if (reader.token() != JsonReader::Token::BeginArray)
+      throw std::runtime_error("invalid job results");
+
+    while (reader.next() == JsonReader::Token::BeginArray) {
+      if (reader.next() != JsonReader::Token::Number)
+        throw std::runtime_error("invalid job results");
+      const lua_Integer i = lua_Integer(reader.number());
+      if (i < slice.first || i > slice.last || reader.next() != JsonReader::Token::Bool)
+        throw std::runtime_error("invalid job results");
+
+      const bool ok = reader.boolean();
+      if (reader.next() == JsonReader::Token::EndArray) // nil result
+        continue;
+      if (ok) {
+        push_json_as_lua(L, reader, 1);
+        lua_rawseti(L, resultsIndex, i);
+      }
+      else {
+        lua_pushlstring(L, reader.string().c_str(), reader.string().size());
+        lua_rawseti(L, errorsIndex, i);
+      }
+      if (reader.next() != JsonReader::Token::EndArray)
+        throw std::runtime_error("invalid job results");
+    }
+    if (reader.token() != JsonReader::Token::EndArray)
+      throw std::runtime_error("invalid job results");
+  }
+}
+
+int dump_writer(lua_State* L, const void* p, size_t sz, void* ud)
+{
+  ((std::string*)ud)->append((const char*)p, sz);
+  return 0;
+}
+
+void write_file(const std::string& filename, const std::string& content)
+{
+  std::ofstream f(FSTREAM_PATH(filename), std::ofstream::binary);
+  f.write(content.c_str(), content.size());
+  if (!f)
+    throw std::runtime_error(fmt::format("cannot write {}", filename));
+}
+
+// Removes the temporary files of the jobs when app.parallel() ends
+struct TempDir {
+  std::string path;
+  std::vector<std::string> files;
+
+  ~TempDir()
+  {
+    try {
+      for (const auto& fn : files) {
+        if (base::is_file(fn))
+          base::delete_file(fn);
+      }
+      if (base::is_directory(path))
+        base::remove_directory(path);
+    }
+    catch (const std::exception& ex) {
+      LOG(ERROR, "SCRIPT: Cannot remove temporary files %s: %s\n", path.c_str(), ex.what());
+    }
+  }
+};
+
+} // anonymous namespace
+
+// app.parallel(items, function(item, index) ... end [, { jobs=n }])
+//
+// Calls the function for each item in other processes of the program
+// (in batch mode), using all CPU cores by default. The items are
+// split in one slice for each process, and each process loads the
+// function once and calls it for each item of its slice. Processes
+// have their own documents/context (sprites created by a call are
+// closed after it), so the function cannot access local variables
+// declared outside its body, and only plain values (nil, booleans,
+// numbers, strings, and tables of those) can be used as items and as
+// results.
+//
+// Returns a table with the result of each call, and a table with the
+// error of the calls that failed (indexed by item).
+//
+// Jobs run as --script in batch mode, where scripts are not asked
+// for permissions (they have full access). This doesn't give more
+// access to the caller: it needs the permission to execute programs
+// to run the jobs, which is enough to run any command anyway.
+int run_parallel(lua_State* L)
+{
+  luaL_checktype(L, 1, LUA_TTABLE);
+  luaL_checktype(L, 2, LUA_TFUNCTION);
+
+  int njobs = 0;
+  if (lua_istable(L, 3)) {
+    if (lua_getfield(L, 3, "jobs") != LUA_TNIL)
+      njobs = int(lua_tointeger(L, -1));
+    lua_pop(L, 1);
+  }
+
+  if (lua_iscfunction(L, 2))
+    return luaL_error(L, "app.parallel() needs a Lua function");
+
+  // The function is serialized to be loaded in each job, so it can
+  // only use global variables (the _ENV upvalue).
+  for (int n = 1;; ++n) {
+    const char* name = lua_getupvalue(L, 2, n);
+    if (!name)
+      break;
+    lua_pop(L, 1);
+    if (std::strcmp(name, "_ENV") != 0)
+      return luaL_error(L,
+                        "the app.parallel() function cannot use local variables "
+                        "declared outside its body ('%s')",
+                        name);
+  }
+
+  // Same permission needed to execute the program with os.execute()
+  const std::string exe = base::get_app_path();
+  if (!ask_access(L, exe.c_str(), FileAccessMode::Execute, ResourceType::Command))
+    return luaL_error(L, "the script doesn't have access to execute '%s'", exe.c_str());
+
+  const lua_Integer n = luaL_len(L, 1);
+  if (njobs <= 0)
+    njobs = int(std::max(1u, std::thread::hardware_concurrency()));
+  const int nslices = int(std::min<lua_Integer>(njobs, n));
+
+  // Convert the items of each slice to Lua code before creating any
+  // file, so invalid items are reported as a regular Lua error.
+  std::vector<Slice> slices(nslices);
+  std::vector<std::string> itemsCode(nslices);
+  {
+    std::string error;
+    try {
+      for (int k = 0; k < nslices; ++k) {
+        Slice& slice = slices[k];
+        slice.first = 1 + n * k / nslices;
+        slice.last = n * (k + 1) / nslices;
+
+        std::string& code = itemsCode[k];
+        code = "local items = {\n";
+        for (lua_Integer i = slice.first; i <= slice.last; ++i) {
+          code += fmt::format("[{}]=", i);
+          lua_geti(L, 1, i);
+          write_lua_literal(code, L, -1);
+          lua_pop(L, 1);
+          code += ",\n";
+        }
+        code += "}\n";
+      }
+    }
+    catch (const std::exception& ex) {
+      error = ex.what();
+    }
+    if (!error.empty())
+      return luaL_error(L, "%s", error.c_str());
+  }
+
+  // Run the jobs. Nothing is given to Lua until all the processes
+  // finish and the temporary files are deleted, so a Lua error cannot
+  // skip the cleanup.
+  {
+    TempDir dir;
+    dir.path = base::join_path(base::get_temp_path(),
+                               fmt::format("{}-parallel-{}-{}",
+                                           get_app_name(),
+                                           base::get_current_process_id(),
+                                           g_parallelCounter++));
+    base::make_all_directories(dir.path);
+
+    // Save the bytecode of the function
+    const std::string fnFilename = base::join_path(dir.path, "fn.luac");
+    {
+      std::string bytecode;
+      lua_pushvalue(L, 2);
+      lua_dump(L, dump_writer, &bytecode, 0);
+      lua_pop(L, 1);
+      dir.files.push_back(fnFilename);
+      write_file(fnFilename, bytecode);
+    }
+
+    // Create one script for each slice
+    CliJobs jobs;
+    jobs.reserve(nslices);
+    for (int k = 0; k < nslices; ++k) {
+      Slice& slice = slices[k];
+      const std::string scriptFilename = base::join_path(dir.path, fmt::format("job-{}.lua", k));
+      slice.outputFilename = base::join_path(dir.path, fmt::format("job-{}.json", k));
+
+      std::string code = "local fn = assert(loadfile(";
+      write_lua_string(code, fnFilename);
+      code += ", \"b\"))\n";
+      code += itemsCode[k];
+      code += fmt::format(
+        "local results = {{}}\n"
+        "for i = {}, {} do\n"
+        "  local sprites = {{}}\n"
+        "  for _, spr in ipairs(app.sprites) do sprites[spr] = true end\n"
+        "  local ok, result = pcall(fn, items[i], i)\n"
+        "  if not ok then result = tostring(result) end\n"
+        "  results[#results+1] = {{ i, ok, result }}\n"
+        "  for _, spr in ipairs(app.sprites) do\n"
+        "    if not sprites[spr] then spr:close() end\n"
+        "  end\n"
+        "end\n"
+        "local f = assert(io.open(",
+        slice.first,
+        slice.last);
+      write_lua_string(code, slice.outputFilename);
+      code += ", \"wb\"))\nf:write(json.encode({ results=results }))\nf:close()\n";
+
+      dir.files.push_back(scriptFilename);
+      dir.files.push_back(slice.outputFilename);
+      write_file(scriptFilename, code);
+
+      CliJob job;
+      job.line = k + 1;
+      job.args = { "--script", scriptFilename };
+      jobs.push_back(std::move(job));
+    }
+
+    run_cli_jobs(jobs, njobs, [&slices](int k, int code, const std::string& output) {
+      Slice& slice = slices[k];
+      slice.code = code;
+      slice.output = output;
+      while (!slice.output.empty() &&
+             (slice.output.back() == '\n' || slice.output.back() == '\r'))
+        slice.output.pop_back();
+      if (code == 0)
+        slice.json = read_job_output(slice.outputFilename);
+    });
+  }
+
+  lua_createtable(L, int(n), 0); // Results
+  const int resultsIndex = lua_gettop(L);
+  lua_newtable(L); // Errors
+  const int errorsIndex = lua_gettop(L);
+
+  Engine* engine = App::instance()->scriptEngine();
+  for (const Slice& slice : slices) {
+    std::string error;
+    if (slice.code == 0) {
+      // Messages printed by the job
+      if (!slice.output.empty() && engine)
+        engine->consolePrint(slice.output.c_str());
+
+      const int top = lua_gettop(L);
+      try {
+        push_slice_results(L, slice, resultsIndex, errorsIndex);
+      }
+      catch (const std::exception& ex) {
+        lua_settop(L, top);
+        error = ex.what();
+      }
+    }
+    else {
+      error = slice.output;
+      if (error.empty())
+        error = fmt::format("the job failed with exit code {}", slice.code);
+    }
+
+    // Items of the slice without a result or an error
+    for (lua_Integer i = slice.first; i <= slice.last; ++i) {
+      const bool hasResult = (lua_rawgeti(L, resultsIndex, i) != LUA_TNIL);
+      const bool hasError = (lua_rawgeti(L, errorsIndex, i) != LUA_TNIL);
+      lua_pop(L, 2);
+      if (hasResult || hasError)
+        continue;
+      if (!error.empty()) {
+        lua_pushlstring(L, error.c_str(), error.size());
+        lua_rawseti(L, errorsIndex, i);
+      }
+    }
+  }
+
+  return 2;
+}
+
+}} // namespace app::script
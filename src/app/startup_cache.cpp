@@ -0,0 +1,212 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/startup_cache.h"
+
+#include "app/resource_finder.h"
+#include "app/util/atomic_file.h"
+#include "app/util/file_key.h"
+#include "base/fs.h"
+#include "base/fstream_path.h"
+#include "base/log.h"
+#include "base/serialization.h"
+#include "fmt/format.h"
+
+#include <fstream>
+
+namespace app {
+
+using namespace base::serialization;
+using namespace base::serialization::little_endian;
+
+namespace {
+
+// "STRT" in little-endian
+const uint32_t kMagicNumber = 0x54525453;
+const uint16_t kFileVersion = 1;
+const char* kEntryExtension = ".cache";
+
+uint64_t fnv1a(uint64_t hash, const std::string& str)
+{
+  for (const char chr : str) {
+    hash ^= uint8_t(chr);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// Returns a string that identifies the current state of all the
+// source files.
+std::string sources_key(const std::vector<std::string>& sources)
+{
+  std::string key;
+  for (const auto& fn : sources) {
+    const std::string fileKey = get_file_key(fn);
+    key += fn;
+    key += "|";
+    key += (fileKey.empty() ? "none" : fileKey);
+    key += "\n";
+  }
+  return key;
+}
+
+// Returns true if the sources of the given key were modified (or
+// removed) after the entry was generated.
+bool is_stale_key(const std::string& key)
+{
+  std::size_t i = 0;
+  while (i < key.size()) {
+    std::size_t j = key.find('\n', i);
+    if (j == std::string::npos)
+      j = key.size();
+
+    // Each line is "filename|none" or "filename|size|mtime"
+    const std::string line = key.substr(i, j - i);
+    std::size_t k = line.rfind('|');
+    if (k != std::string::npos && k > 0 && line.compare(k + 1, std::string::npos, "none") != 0)
+      k = line.rfind('|', k - 1);
+    if (k == std::string::npos)
+      return true;
+
+    const std::string fn = line.substr(0, k);
+    if (sources_key({ fn }) != line + "\n")
+      return true;
+
+    i = j + 1;
+  }
+  return false;
+}
+
+// Reads the header of an entry file and the key of its sources.
+bool read_entry_key(std::istream& s, const std::size_t fileSize, std::string& key)
+{
+  if (read32(s) != kMagicNumber || read16(s) != kFileVersion)
+    return false;
+
+  const uint32_t keySize = read32(s);
+  if (!s || keySize > fileSize)
+    return false;
+  key.resize(keySize);
+  s.read(key.data(), keySize);
+  return bool(s);
+}
+
+} // anonymous namespace
+
+StartupCache::StartupCache()
+{
+  ResourceFinder rf;
+  rf.includeUserDir(base::join_path("cache", ".").c_str());
+  m_dir = rf.getFirstOrCreateDefault();
+}
+
+StartupCache::StartupCache(const std::string& dir) : m_dir(dir)
+{
+}
+
+bool StartupCache::load(const std::string& name,
+                        const std::vector<std::string>& sources,
+                        std::string& data) const
+{
+  const std::string fn = entryFilename(name, sources);
+  if (!base::is_file(fn))
+    return false;
+
+  try {
+    const std::size_t fileSize = base::file_size(fn);
+    std::ifstream s(FSTREAM_PATH(fn), std::ifstream::binary);
+    std::string key;
+    if (!read_entry_key(s, fileSize, key))
+      return false;
+    if (key != sources_key(sources)) {
+      // The sources were modified, the entry will be replaced when
+      // the resource is stored again.
+      return false;
+    }
+
+    const uint32_t dataSize = read32(s);
+    if (!s || dataSize > fileSize)
+      return false;
+    data.resize(dataSize);
+    s.read(data.data(), dataSize);
+    return bool(s);
+  }
+  catch (const std::exception& ex) {
+    LOG(ERROR, "CACHE: Error reading %s: %s\n", fn.c_str(), ex.what());
+    return false;
+  }
+}
+
+void StartupCache::store(const std::string& name,
+                         const std::vector<std::string>& sources,
+                         const std::string& data) const
+{
+  const std::string fn = entryFilename(name, sources);
+  try {
+    if (!base::is_directory(m_dir))
+      base::make_all_directories(m_dir);
+    else
+      pruneStaleEntries();
+
+    const std::string key = sources_key(sources);
+    write_file_atomically(fn, [&key, &data](std::ostream& s) {
+      write32(s, kMagicNumber);
+      write16(s, kFileVersion);
+      write32(s, uint32_t(key.size()));
+      s.write(key.c_str(), key.size());
+      write32(s, uint32_t(data.size()));
+      s.write(data.c_str(), data.size());
+    });
+  }
+  catch (const std::exception& ex) {
+    LOG(ERROR, "CACHE: Error storing %s: %s\n", fn.c_str(), ex.what());
+  }
+}
+
+// Deletes the entries generated from source files that were modified
+// or removed (e.g. a resource of an uninstalled extension, or a
+// resource file that was updated), as they will never be valid again.
+void StartupCache::pruneStaleEntries() const
+{
+  for (const auto& item : base::list_files(m_dir, base::ItemType::Files)) {
+    if (base::get_file_extension(item) != kEntryExtension + 1)
+      continue;
+
+    const std::string fn = base::join_path(m_dir, item);
+    try {
+      bool stale;
+      {
+        std::ifstream s(FSTREAM_PATH(fn), std::ifstream::binary);
+        std::string key;
+        stale = (!read_entry_key(s, base::file_size(fn), key) || is_stale_key(key));
+      }
+      if (stale)
+        base::delete_file(fn);
+    }
+    catch (const std::exception& ex) {
+      LOG(ERROR, "CACHE: Error pruning %s: %s\n", fn.c_str(), ex.what());
+    }
+  }
+}
+
+std::string StartupCache::entryFilename(const std::string& name,
+                                        const std::vector<std::string>& sources) const
+{
+  // Different source files (e.g. other language or theme) generate
+  // different entries, so switching between them doesn't invalidate
+  // the cache.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (const auto& fn : sources)
+    hash = fnv1a(hash, fn + "\n");
+
+  return base::join_path(m_dir, fmt::format("{}-{:016x}{}", name, hash, kEntryExtension));
+}
+
+} // namespace app
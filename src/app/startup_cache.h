@@ -0,0 +1,54 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_STARTUP_CACHE_H_INCLUDED
+#define APP_STARTUP_CACHE_H_INCLUDED
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace app {
+
+// Persistent cache of resources that are parsed/decoded on each
+// launch (e.g. the strings of the current language, or the theme
+// sprite sheet). Each entry is identified by a name and the list of
+// source files used to generate it, and it's valid only while those
+// files keep the same size and modification time. So editing a
+// resource, or installing/uninstalling an extension that provides a
+// resource file, regenerates the entry.
+//
+// The data of each entry is an opaque binary blob, the consumer must
+// include its own version/format information in the entry name.
+// Entries whose source files were modified or removed are deleted
+// when a new entry is stored.
+class StartupCache {
+public:
+  // Uses the "cache" directory of the user configuration.
+  StartupCache();
+  explicit StartupCache(const std::string& dir);
+
+  // Returns true and fills "data" if the entry exists and it was
+  // generated from the same source files.
+  bool load(const std::string& name,
+            const std::vector<std::string>& sources,
+            std::string& data) const;
+
+  void store(const std::string& name,
+             const std::vector<std::string>& sources,
+             const std::string& data) const;
+
+private:
+  void pruneStaleEntries() const;
+  std::string entryFilename(const std::string& name,
+                            const std::vector<std::string>& sources) const;
+
+  std::string m_dir;
+};
+
+} // namespace app
+
+#endif
@@ -0,0 +1,158 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#include "tests/app_test.h"
+
+#include "app/startup_cache.h"
+#include "base/fs.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace app;
+
+namespace {
+
+const char* kCacheDir = "startup_cache_test";
+
+void write_file(const std::string& filename, const std::string& content)
+{
+  std::ofstream f(filename, std::ios::binary | std::ios::trunc);
+  f << content;
+}
+
+void remove_cache_dir()
+{
+  if (!base::is_directory(kCacheDir))
+    return;
+  for (const auto& fn : base::list_files(kCacheDir))
+    base::delete_file(base::join_path(kCacheDir, fn));
+  base::remove_directory(kCacheDir);
+}
+
+int count_entries()
+{
+  if (!base::is_directory(kCacheDir))
+    return 0;
+  int n = 0;
+  for (const auto& fn : base::list_files(kCacheDir)) {
+    if (base::get_file_extension(fn) == "cache")
+      ++n;
+  }
+  return n;
+}
+
+} // anonymous namespace
+
+TEST(StartupCache, HitAndMiss)
+{
+  remove_cache_dir();
+  const std::string src1 = "startup_cache_test_1.txt";
+  const std::string src2 = "startup_cache_test_2.txt";
+  write_file(src1, "abcd");
+  write_file(src2, "efgh");
+
+  const StartupCache cache(kCacheDir);
+  std::string data;
+  EXPECT_FALSE(cache.load("res", { src1 }, data));
+
+  // Binary data
+  const std::string stored("a\0b\nc", 5);
+  cache.store("res", { src1 }, stored);
+  ASSERT_TRUE(cache.load("res", { src1 }, data));
+  EXPECT_EQ(stored, data);
+
+  // Other name or other sources are different entries
+  EXPECT_FALSE(cache.load("res2", { src1 }, data));
+  EXPECT_FALSE(cache.load("res", { src2 }, data));
+  EXPECT_FALSE(cache.load("res", { src1, src2 }, data));
+
+  cache.store("res", { src2 }, "other");
+  ASSERT_TRUE(cache.load("res", { src2 }, data));
+  EXPECT_EQ("other", data);
+  ASSERT_TRUE(cache.load("res", { src1 }, data));
+  EXPECT_EQ(stored, data);
+  EXPECT_EQ(2, count_entries());
+
+  remove_cache_dir();
+  std::remove(src1.c_str());
+  std::remove(src2.c_str());
+}
+
+TEST(StartupCache, Invalidation)
+{
+  remove_cache_dir();
+  const std::string src1 = "startup_cache_test_3.txt";
+  const std::string src2 = "startup_cache_test_4.txt";
+  write_file(src1, "abcd");
+  std::remove(src2.c_str());
+
+  // Sources that don't exist are part of the key too (e.g. a
+  // resource file that can be provided by an extension)
+  const StartupCache cache(kCacheDir);
+  cache.store("res", { src1, src2 }, "data");
+  std::string data;
+  ASSERT_TRUE(cache.load("res", { src1, src2 }, data));
+
+  // Modified source
+  write_file(src1, "abcdef");
+  EXPECT_FALSE(cache.load("res", { src1, src2 }, data));
+  cache.store("res", { src1, src2 }, "data2");
+  ASSERT_TRUE(cache.load("res", { src1, src2 }, data));
+  EXPECT_EQ("data2", data);
+  EXPECT_EQ(1, count_entries());
+
+  // New source
+  write_file(src2, "efgh");
+  EXPECT_FALSE(cache.load("res", { src1, src2 }, data));
+
+  // Corrupted entry
+  cache.store("res", { src1, src2 }, "data3");
+  for (const auto& fn : base::list_files(kCacheDir))
+    write_file(base::join_path(kCacheDir, fn), "corrupted");
+  EXPECT_FALSE(cache.load("res", { src1, src2 }, data));
+
+  remove_cache_dir();
+  std::remove(src1.c_str());
+  std::remove(src2.c_str());
+}
+
+TEST(StartupCache, PruneStaleEntries)
+{
+  remove_cache_dir();
+  const std::string src1 = "startup_cache_test_5.txt";
+  const std::string src2 = "startup_cache_test_6.txt";
+  const std::string src3 = "startup_cache_test_7.txt";
+  write_file(src1, "abcd");
+  write_file(src2, "efgh");
+  write_file(src3, "ijkl");
+
+  const StartupCache cache(kCacheDir);
+  cache.store("res", { src1 }, "data1");
+  cache.store("res", { src2 }, "data2");
+  EXPECT_EQ(2, count_entries());
+
+  // Storing other entry removes the entries with modified/removed
+  // sources, but keeps the valid ones
+  write_file(src1, "abcdef");
+  cache.store("res", { src3 }, "data3");
+  EXPECT_EQ(2, count_entries());
+
+  std::remove(src2.c_str());
+  cache.store("other", { src3 }, "data4");
+  EXPECT_EQ(2, count_entries());
+
+  std::string data;
+  ASSERT_TRUE(cache.load("res", { src3 }, data));
+  EXPECT_EQ("data3", data);
+  ASSERT_TRUE(cache.load("other", { src3 }, data));
+  EXPECT_EQ("data4", data);
+
+  remove_cache_dir();
+  std::remove(src1.c_str());
+  std::remove(src3.c_str());
+}
@@ -0,0 +1,217 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/startup_profiler.h"
+
+#include "base/fstream_path.h"
+#include "base/log.h"
+#include "fmt/format.h"
+
+#include "json11.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace app {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Phase {
+  std::string name;
+  // Microseconds since the profiler was started (end == -1 means
+  // that the scope is still running)
+  int64_t begin;
+  int64_t end;
+  int depth;
+  int thread;
+};
+
+struct Profiler {
+  std::mutex mutex;
+  Clock::time_point start;
+  std::vector<Phase> phases;
+  std::vector<std::thread::id> threads;
+
+  int64_t elapsed() const
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+  }
+
+  // Returns a small number to identify the current thread in the
+  // report (0 for the thread that started the profiler).
+  int threadIndex()
+  {
+    const auto id = std::this_thread::get_id();
+    for (int i = 0; i < int(threads.size()); ++i) {
+      if (threads[i] == id)
+        return i;
+    }
+    threads.push_back(id);
+    return int(threads.size()) - 1;
+  }
+};
+
+std::atomic<bool> g_enabled(false);
+Profiler g_profiler;
+thread_local int g_depth = 0;
+
+void print_report(std::ostream& os, const int64_t total)
+{
+  auto ms = [](int64_t us) { return double(us) / 1000.0; };
+
+  os << fmt::format("Startup profile ({:.1f} ms)\n", ms(total));
+
+  int64_t measured = 0;
+  for (const Phase& phase : g_profiler.phases) {
+    const int64_t duration = phase.end - phase.begin;
+    if (phase.depth == 0 && phase.thread == 0)
+      measured += duration;
+
+    os << fmt::format("{:10.1f} ms {:5.1f}%  {}{}",
+                      ms(duration),
+                      total > 0 ? 100.0 * duration / total : 0.0,
+                      std::string(2 * phase.depth, ' '),
+                      phase.name);
+    if (phase.thread != 0)
+      os << fmt::format(" [thread {}]", phase.thread);
+    os << '\n';
+  }
+
+  if (total > measured) {
+    os << fmt::format("{:10.1f} ms {:5.1f}%  (other)\n",
+                      ms(total - measured),
+                      100.0 * (total - measured) / total);
+  }
+  os.flush();
+}
+
+// Exports the phases in the Trace Event Format, so it can be opened
+// with chrome://tracing or https://ui.perfetto.dev/
+void write_trace(const std::string& filename)
+{
+  json11::Json::array events;
+  events.reserve(g_profiler.phases.size());
+  for (const Phase& phase : g_profiler.phases) {
+    json11::Json::object event;
+    event["name"] = phase.name;
+    event["cat"] = "startup";
+    event["ph"] = "X";
+    event["ts"] = double(phase.begin);
+    event["dur"] = double(phase.end - phase.begin);
+    event["pid"] = 1;
+    event["tid"] = phase.thread;
+    events.push_back(event);
+  }
+
+  json11::Json::object json;
+  json["traceEvents"] = events;
+  json["displayTimeUnit"] = "ms";
+
+  std::ofstream f(FSTREAM_PATH(filename), std::ofstream::binary);
+  f << json11::Json(json).dump();
+  if (!f)
+    LOG(ERROR, "APP: Error writing startup trace %s\n", filename.c_str());
+}
+
+} // anonymous namespace
+
+// static
+void StartupProfiler::start()
+{
+  std::lock_guard lock(g_profiler.mutex);
+  g_profiler.start = Clock::now();
+  g_profiler.phases.clear();
+  g_profiler.threads.clear();
+  g_profiler.threadIndex();
+  g_enabled = true;
+}
+
+// static
+bool StartupProfiler::isEnabled()
+{
+  return g_enabled;
+}
+
+// static
+void StartupProfiler::finish(std::ostream* report, const std::string& traceFilename)
+{
+  if (!g_enabled)
+    return;
+
+  std::lock_guard lock(g_profiler.mutex);
+  g_enabled = false;
+
+  // Scopes that are still running (e.g. the whole initialization)
+  // finish now.
+  const int64_t total = g_profiler.elapsed();
+  for (Phase& phase : g_profiler.phases) {
+    if (phase.end < 0)
+      phase.end = total;
+  }
+
+  if (report)
+    print_report(*report, total);
+
+  if (!traceFilename.empty())
+    write_trace(traceFilename);
+
+  g_profiler.phases.clear();
+}
+
+StartupScope::StartupScope(const char* name) : m_index(-1)
+{
+  if (g_enabled)
+    begin(std::string(name));
+}
+
+StartupScope::StartupScope(const char* prefix, std::string_view item, const char* suffix)
+  : m_index(-1)
+{
+  if (g_enabled) {
+    std::string name(prefix);
+    name.append(item);
+    name += suffix;
+    begin(std::move(name));
+  }
+}
+
+void StartupScope::begin(std::string&& name)
+{
+  std::lock_guard lock(g_profiler.mutex);
+  // The profiler could be finished from other thread
+  if (!g_enabled)
+    return;
+
+  m_index = int(g_profiler.phases.size());
+  g_profiler.phases.push_back(
+    Phase{ std::move(name), g_profiler.elapsed(), -1, g_depth++, g_profiler.threadIndex() });
+}
+
+StartupScope::~StartupScope()
+{
+  if (m_index < 0)
+    return;
+
+  --g_depth;
+
+  std::lock_guard lock(g_profiler.mutex);
+  if (g_enabled && m_index < int(g_profiler.phases.size()))
+    g_profiler.phases[m_index].end = g_profiler.elapsed();
+}
+
+} // namespace app
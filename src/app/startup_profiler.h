@@ -0,0 +1,59 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_STARTUP_PROFILER_H_INCLUDED
+#define APP_STARTUP_PROFILER_H_INCLUDED
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+namespace app {
+
+// Measures the time spent in each phase of the program startup
+// (loading preferences, extensions, themes, plugins' init(), etc.)
+// when the --startup-profile or --startup-trace options are used.
+// When it's not enabled, StartupScope objects do nothing.
+class StartupProfiler {
+public:
+  // Starts recording scopes from now on.
+  static void start();
+  static bool isEnabled();
+
+  // Stops recording, prints a report with the time of each phase
+  // (if "report" is not nullptr) and exports the recorded scopes in
+  // the Chrome trace event format (if "traceFilename" is not empty).
+  static void finish(std::ostream* report, const std::string& traceFilename);
+};
+
+// Records the time spent in the current C++ scope as a phase of the
+// startup with the given name. Nested scopes are shown as children
+// of the outer scope in the report.
+//
+// The name of a phase of a specific item (e.g. a widget or an
+// extension) is "prefix + item + suffix", it's concatenated only
+// when the profiler is enabled, so these scopes can be used in code
+// that runs after the startup too (e.g. loading a widget each time
+// a dialog is opened).
+class StartupScope {
+public:
+  explicit StartupScope(const char* name);
+  StartupScope(const char* prefix, std::string_view item, const char* suffix = "");
+  ~StartupScope();
+
+  StartupScope(const StartupScope&) = delete;
+  StartupScope& operator=(const StartupScope&) = delete;
+
+private:
+  void begin(std::string&& name);
+
+  int m_index;
+};
+
+} // namespace app
+
+#endif
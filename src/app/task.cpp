@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2022  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -11,14 +11,15 @@
 #include "app/task.h"
 
 #include "base/task.h"
-#include "base/thread.h"
 #include "base/thread_pool.h"
 
+#include <thread>
+
 namespace app {
 
 static base::thread_pool tasks_pool(4);
 
-Task::Task() : m_token(nullptr)
+Task::Task() : m_token(nullptr), m_done(true)
 {
 }
 
@@ -29,16 +30,39 @@ Task::~Task()
 void Task::run(base::task::func_t&& func)
 {
   const std::lock_guard lock(m_token_mutex);
-  m_task.on_execute(std::move(func));
+  m_done = false;
+  m_task.on_execute([this, func = std::move(func)](base::task_token& token) {
+    // Notify wait() even if the function throws
+    struct Done {
+      Task* task;
+      ~Done() { task->notifyDone(); }
+    } done{ this };
+    func(token);
+  });
   m_token = &m_task.start(tasks_pool);
 }
 
 void Task::wait()
 {
-  // TODO wait a condition variable
-  while (!m_task.completed()) {
-    base::this_thread::sleep_for(0.1);
+  {
+    std::unique_lock lock(m_token_mutex);
+    if (!m_token) // The task was never run
+      return;
+    m_done_cv.wait(lock, [this] { return m_done; });
+  }
+  // The base::task is marked as completed just after our function
+  // returns.
+  while (!m_task.completed())
+    std::this_thread::yield();
+}
+
+void Task::notifyDone()
+{
+  {
+    const std::lock_guard lock(m_token_mutex);
+    m_done = true;
   }
+  m_done_cv.notify_all();
 }
 
 } // namespace app
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2020  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -10,6 +10,7 @@
 
 #include "base/task.h"
 
+#include <condition_variable>
 #include <functional>
 #include <mutex>
 
@@ -21,6 +22,8 @@ public:
   ~Task();
 
   void run(base::task::func_t&& func);
+
+  // Blocks the caller thread until the task is completed.
   void wait();
 
   // Returns true when the task is completed (whether it was
@@ -60,9 +63,13 @@ public:
   }
 
 private:
+  void notifyDone();
+
   base::task m_task;
   mutable std::mutex m_token_mutex;
   base::task_token* m_token;
+  std::condition_variable m_done_cv;
+  bool m_done;
 };
 
 } // namespace app
@@ -0,0 +1,306 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/thumbnail_cache.h"
+
+#include "app/util/atomic_file.h"
+#include "app/util/file_key.h"
+#include "base/debug.h"
+#include "base/fs.h"
+#include "base/fstream_path.h"
+#include "base/log.h"
+#include "base/serialization.h"
+#include "doc/image.h"
+#include "doc/image_io.h"
+#include "doc/palette.h"
+#include "fmt/format.h"
+
+#include <fstream>
+#include <set>
+
+#define THUMBCACHE_TRACE(...)
+
+namespace app {
+
+using namespace base::serialization;
+using namespace base::serialization::little_endian;
+using namespace doc;
+
+namespace {
+
+// "THMB" in little-endian
+const uint32_t kMagicNumber = 0x424d4854;
+const uint16_t kFileVersion = 1;
+const char* kIndexFilename = "index.txt";
+const char* kEntryExtension = ".thumb";
+
+uint64_t fnv1a(uint64_t hash, const std::string& str)
+{
+  for (const char chr : str) {
+    hash ^= uint8_t(chr);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+ImageRef convert_to_rgb(const Image* image, const Palette* palette)
+{
+  if (image->pixelFormat() == IMAGE_RGB)
+    return ImageRef(Image::createCopy(image));
+
+  ImageRef rgb(Image::create(IMAGE_RGB, image->width(), image->height()));
+  for (int y = 0; y < image->height(); ++y) {
+    for (int x = 0; x < image->width(); ++x) {
+      const color_t c = image->getPixel(x, y);
+      switch (image->pixelFormat()) {
+        case IMAGE_GRAYSCALE:
+          rgb->putPixel(x, y, rgba(graya_getv(c), graya_getv(c), graya_getv(c), graya_geta(c)));
+          break;
+        case IMAGE_INDEXED:
+          rgb->putPixel(x, y, palette && int(c) < palette->size() ? palette->getEntry(c) : 0);
+          break;
+        case IMAGE_BITMAP: rgb->putPixel(x, y, c ? rgba(255, 255, 255, 255) : 0); break;
+        default:           rgb->putPixel(x, y, 0); break;
+      }
+    }
+  }
+  return rgb;
+}
+
+} // anonymous namespace
+
+ThumbnailCache::Key::Key(const std::string& filename, int thumbnailSize) : m_filename(filename)
+{
+  const std::string fileKey = get_file_key(filename);
+  if (fileKey.empty())
+    return;
+
+  const std::string id = fmt::format("{}|{}|{}", filename, fileKey, thumbnailSize);
+
+  m_hash = fmt::format("{:016x}", fnv1a(0xcbf29ce484222325ull, id));
+}
+
+ThumbnailCache::ThumbnailCache(const std::string& dir, std::size_t maxBytes)
+  : m_dir(dir)
+  , m_maxBytes(maxBytes)
+{
+  try {
+    if (!base::is_directory(m_dir))
+      base::make_all_directories(m_dir);
+    loadIndex();
+  }
+  catch (const std::exception& ex) {
+    LOG(ERROR, "THUMB: Error loading thumbnail cache index: %s\n", ex.what());
+  }
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+  try {
+    flush();
+  }
+  catch (const std::exception& ex) {
+    LOG(ERROR, "THUMB: Error saving thumbnail cache index: %s\n", ex.what());
+  }
+}
+
+doc::ImageRef ThumbnailCache::lookup(const Key& key)
+{
+  if (!key.isValid())
+    return nullptr;
+
+  {
+    const std::lock_guard lock(m_mutex);
+    if (m_entries.find(key.hash()) == m_entries.end())
+      return nullptr;
+  }
+
+  // Read the file without locking the cache, so the thumbnail
+  // workers can store other entries meanwhile. Entry files are
+  // replaced atomically, so we never read a partially written file.
+  ImageRef image;
+  try {
+    std::ifstream s(FSTREAM_PATH(entryFilename(key.hash())), std::ifstream::binary);
+    if (read32(s) == kMagicNumber && read16(s) == kFileVersion) {
+      // Check that the entry belongs to the same file (hash collision)
+      const uint16_t len = read16(s);
+      std::string filename(len, 0);
+      s.read(filename.data(), len);
+      if (s && filename == key.filename())
+        image.reset(read_image(s, false));
+    }
+  }
+  catch (const std::exception& ex) {
+    THUMBCACHE_TRACE("THUMBCACHE: Error reading %s: %s\n", key.hash().c_str(), ex.what());
+    image.reset();
+  }
+
+  const std::lock_guard lock(m_mutex);
+  // The entry could be evicted while we were reading it
+  auto it = m_entries.find(key.hash());
+  if (it == m_entries.end())
+    return (image && image->pixelFormat() == IMAGE_RGB ? image : nullptr);
+
+  if (image && image->pixelFormat() == IMAGE_RGB) {
+    touch(it->second);
+    THUMBCACHE_TRACE("THUMBCACHE: Hit %s\n", key.filename().c_str());
+    return image;
+  }
+
+  // Invalid entry
+  remove(it->second);
+  return nullptr;
+}
+
+void ThumbnailCache::store(const Key& key, const doc::Image* image, const doc::Palette* palette)
+{
+  if (!key.isValid() || !image || key.filename().size() > 0xffff)
+    return;
+
+  ImageRef rgb = convert_to_rgb(image, palette);
+  const std::string fn = entryFilename(key.hash());
+
+  const std::lock_guard lock(m_mutex);
+  auto it = m_entries.find(key.hash());
+  if (it != m_entries.end())
+    remove(it->second);
+
+  try {
+    write_file_atomically(fn, [&key, &rgb](std::ostream& s) {
+      write32(s, kMagicNumber);
+      write16(s, kFileVersion);
+      write16(s, uint16_t(key.filename().size()));
+      s.write(key.filename().c_str(), key.filename().size());
+      write_image(s, rgb.get());
+    });
+
+    m_lru.push_back(Entry{ key.hash(), base::file_size(fn) });
+    m_entries[key.hash()] = std::prev(m_lru.end());
+    m_totalBytes += m_lru.back().bytes;
+    m_modified = true;
+
+    THUMBCACHE_TRACE("THUMBCACHE: Stored %s (%s)\n", key.filename().c_str(), key.hash().c_str());
+  }
+  catch (const std::exception& ex) {
+    LOG(ERROR, "THUMB: Error storing thumbnail for %s: %s\n", key.filename().c_str(), ex.what());
+  }
+
+  evict();
+}
+
+void ThumbnailCache::flush()
+{
+  const std::lock_guard lock(m_mutex);
+  if (!m_modified)
+    return;
+
+  write_file_atomically(indexFilename(), [this](std::ostream& s) {
+    s << kFileVersion << "\n";
+    for (const Entry& entry : m_lru)
+      s << entry.hash << " " << entry.bytes << "\n";
+  });
+  m_modified = false;
+}
+
+std::string ThumbnailCache::entryFilename(const std::string& hash) const
+{
+  return base::join_path(m_dir, hash + kEntryExtension);
+}
+
+std::string ThumbnailCache::indexFilename() const
+{
+  return base::join_path(m_dir, kIndexFilename);
+}
+
+void ThumbnailCache::loadIndex()
+{
+  std::set<std::string> files;
+  for (const auto& fn : base::list_files(m_dir, base::ItemType::Files)) {
+    const std::string ext = base::get_file_extension(fn);
+    if (ext == kEntryExtension + 1) {
+      files.insert(base::get_file_title(fn));
+    }
+    // Delete temporary files of entries that were not completely
+    // written (e.g. the program crashed while storing them).
+    else if (ext == "tmp") {
+      try {
+        base::delete_file(base::join_path(m_dir, fn));
+      }
+      catch (const std::exception&) {
+        // Ignore errors
+      }
+    }
+  }
+
+  std::ifstream s(FSTREAM_PATH(indexFilename()));
+  int version = 0;
+  if (s >> version && version == kFileVersion) {
+    std::string hash;
+    std::size_t bytes;
+    while (s >> hash >> bytes) {
+      // Ignore entries without file and duplicated entries
+      if (files.erase(hash) == 0)
+        continue;
+
+      m_lru.push_back(Entry{ hash, bytes });
+      m_entries[hash] = std::prev(m_lru.end());
+      m_totalBytes += bytes;
+    }
+  }
+
+  // Delete files that are not referenced by the index (e.g. the
+  // index wasn't saved because the program crashed).
+  for (const auto& hash : files) {
+    const std::string fn = entryFilename(hash);
+    try {
+      base::delete_file(fn);
+    }
+    catch (const std::exception&) {
+      // Ignore errors
+    }
+    m_modified = true;
+  }
+
+  evict();
+}
+
+void ThumbnailCache::touch(Entries::iterator it)
+{
+  m_lru.splice(m_lru.end(), m_lru, it);
+  m_modified = true;
+}
+
+void ThumbnailCache::remove(Entries::iterator it)
+{
+  const std::string fn = entryFilename(it->hash);
+  try {
+    if (base::is_file(fn))
+      base::delete_file(fn);
+  }
+  catch (const std::exception&) {
+    // Ignore errors
+  }
+
+  ASSERT(m_totalBytes >= it->bytes);
+  m_totalBytes -= it->bytes;
+  m_entries.erase(it->hash);
+  m_lru.erase(it);
+  m_modified = true;
+}
+
+void ThumbnailCache::evict()
+{
+  while (m_totalBytes > m_maxBytes && !m_lru.empty()) {
+    THUMBCACHE_TRACE("THUMBCACHE: Evicting %s\n", m_lru.front().hash.c_str());
+    remove(m_lru.begin());
+  }
+}
+
+} // namespace app
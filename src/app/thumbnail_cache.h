@@ -0,0 +1,94 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_THUMBNAIL_CACHE_H_INCLUDED
+#define APP_THUMBNAIL_CACHE_H_INCLUDED
+#pragma once
+
+#include "base/disable_copying.h"
+#include "doc/image_ref.h"
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace doc {
+class Image;
+class Palette;
+} // namespace doc
+
+namespace app {
+
+// Persistent on-disk cache of file selector thumbnails. Each entry
+// is identified by the file path, its size, its modification time
+// and the thumbnail size, so a modified file gets a new entry and
+// the old one is eventually evicted (LRU) when the cache reaches its
+// maximum size.
+//
+// lookup() is called from the GUI thread and store() from the
+// thumbnail workers, so all functions are thread-safe.
+class ThumbnailCache {
+public:
+  class Key {
+  public:
+    Key() {}
+    Key(const std::string& filename, int thumbnailSize);
+
+    bool isValid() const { return !m_hash.empty(); }
+    const std::string& hash() const { return m_hash; }
+    const std::string& filename() const { return m_filename; }
+
+  private:
+    std::string m_filename;
+    std::string m_hash;
+  };
+
+  // maxBytes is the maximum size of all cached files in the disk.
+  ThumbnailCache(const std::string& dir, std::size_t maxBytes);
+  ~ThumbnailCache();
+
+  // Returns the cached thumbnail as an RGB image, or nullptr if the
+  // entry doesn't exist (or it's invalid).
+  doc::ImageRef lookup(const Key& key);
+
+  // Stores the given thumbnail (in any pixel format, using the given
+  // palette for indexed images) in the cache.
+  void store(const Key& key, const doc::Image* image, const doc::Palette* palette);
+
+  // Writes the LRU index to disk.
+  void flush();
+
+private:
+  struct Entry {
+    std::string hash;
+    std::size_t bytes;
+  };
+  using Entries = std::list<Entry>;
+
+  std::string entryFilename(const std::string& hash) const;
+  std::string indexFilename() const;
+  void loadIndex();
+  void touch(Entries::iterator it);
+  void remove(Entries::iterator it);
+  void evict();
+
+  std::string m_dir;
+  std::size_t m_maxBytes;
+  std::size_t m_totalBytes = 0;
+  bool m_modified = false;
+  // Entries from least to most recently used.
+  Entries m_lru;
+  std::unordered_map<std::string, Entries::iterator> m_entries;
+  std::mutex m_mutex;
+
+  DISABLE_COPYING(ThumbnailCache);
+};
+
+} // namespace app
+
+#endif
@@ -0,0 +1,242 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#include "tests/app_test.h"
+
+#include "app/thumbnail_cache.h"
+#include "base/fs.h"
+#include "doc/image.h"
+#include "doc/primitives.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace app;
+using namespace doc;
+
+namespace {
+
+const char* kCacheDir = "thumbnail_cache_test";
+
+void write_file(const std::string& filename, const std::string& content)
+{
+  std::ofstream f(filename, std::ios::binary | std::ios::trunc);
+  f << content;
+}
+
+void remove_cache_dir()
+{
+  if (!base::is_directory(kCacheDir))
+    return;
+  for (const auto& fn : base::list_files(kCacheDir))
+    base::delete_file(base::join_path(kCacheDir, fn));
+  base::remove_directory(kCacheDir);
+}
+
+int count_cache_files(const std::string& ext)
+{
+  int n = 0;
+  for (const auto& fn : base::list_files(kCacheDir)) {
+    if (base::get_file_extension(fn) == ext)
+      ++n;
+  }
+  return n;
+}
+
+ImageRef make_thumbnail(const color_t color)
+{
+  ImageRef image(Image::create(IMAGE_RGB, 8, 8));
+  clear_image(image.get(), color);
+  return image;
+}
+
+// Returns the size in disk of a cache entry of an 8x8 thumbnail
+// (all entries used in these tests have the same size).
+std::size_t entry_bytes(const ThumbnailCache::Key& key)
+{
+  for (const auto& fn : base::list_files(kCacheDir)) {
+    if (base::get_file_title(fn) == key.hash())
+      return base::file_size(base::join_path(kCacheDir, fn));
+  }
+  return 0;
+}
+
+} // anonymous namespace
+
+TEST(ThumbnailCache, HitAndMiss)
+{
+  remove_cache_dir();
+  const std::string fn = "thumbnail_cache_test_1.txt";
+  write_file(fn, "abcd");
+
+  ThumbnailCache cache(kCacheDir, 1024 * 1024);
+  const ThumbnailCache::Key key(fn, 8);
+  ASSERT_TRUE(key.isValid());
+  EXPECT_EQ(nullptr, cache.lookup(key));
+
+  const ImageRef thumb = make_thumbnail(rgba(255, 0, 0, 255));
+  cache.store(key, thumb.get(), nullptr);
+  ImageRef cached = cache.lookup(key);
+  ASSERT_TRUE(cached != nullptr);
+  EXPECT_EQ(IMAGE_RGB, cached->pixelFormat());
+  EXPECT_EQ(8, cached->width());
+  EXPECT_EQ(8, cached->height());
+  EXPECT_EQ(rgba(255, 0, 0, 255), get_pixel(cached.get(), 3, 3));
+
+  // Other thumbnail size is other entry
+  EXPECT_EQ(nullptr, cache.lookup(ThumbnailCache::Key(fn, 16)));
+
+  // Files that don't exist don't have a key
+  EXPECT_FALSE(ThumbnailCache::Key("thumbnail_cache_test_none.txt", 8).isValid());
+
+  std::remove(fn.c_str());
+}
+
+TEST(ThumbnailCache, ModifiedFile)
+{
+  remove_cache_dir();
+  const std::string fn = "thumbnail_cache_test_2.txt";
+  write_file(fn, "abcd");
+
+  ThumbnailCache cache(kCacheDir, 1024 * 1024);
+  const ThumbnailCache::Key key(fn, 8);
+  const ImageRef thumb = make_thumbnail(rgba(255, 0, 0, 255));
+  cache.store(key, thumb.get(), nullptr);
+  ASSERT_TRUE(cache.lookup(key) != nullptr);
+
+  write_file(fn, "abcdef");
+  const ThumbnailCache::Key newKey(fn, 8);
+  EXPECT_NE(key.hash(), newKey.hash());
+  EXPECT_EQ(nullptr, cache.lookup(newKey));
+
+  std::remove(fn.c_str());
+}
+
+TEST(ThumbnailCache, InvalidEntryIsRemoved)
+{
+  remove_cache_dir();
+  const std::string fn = "thumbnail_cache_test_3.txt";
+  write_file(fn, "abcd");
+
+  ThumbnailCache cache(kCacheDir, 1024 * 1024);
+  const ThumbnailCache::Key key(fn, 8);
+  const ImageRef thumb = make_thumbnail(rgba(255, 0, 0, 255));
+  cache.store(key, thumb.get(), nullptr);
+  EXPECT_EQ(1, count_cache_files("thumb"));
+
+  // Corrupt the entry file
+  write_file(base::join_path(kCacheDir, key.hash() + ".thumb"), "corrupted");
+  EXPECT_EQ(nullptr, cache.lookup(key));
+  EXPECT_EQ(0, count_cache_files("thumb"));
+
+  std::remove(fn.c_str());
+}
+
+TEST(ThumbnailCache, LeastRecentlyUsed)
+{
+  remove_cache_dir();
+  const std::string fns[3] = { "thumbnail_cache_test_a.txt",
+                               "thumbnail_cache_test_b.txt",
+                               "thumbnail_cache_test_c.txt" };
+  for (const auto& fn : fns)
+    write_file(fn, fn);
+
+  const ThumbnailCache::Key keys[3] = { ThumbnailCache::Key(fns[0], 8),
+                                        ThumbnailCache::Key(fns[1], 8),
+                                        ThumbnailCache::Key(fns[2], 8) };
+  const ImageRef thumb = make_thumbnail(rgba(0, 0, 255, 255));
+
+  // Calculate the size of one entry to limit the cache to two entries
+  std::size_t bytes;
+  {
+    ThumbnailCache cache(kCacheDir, 1024 * 1024);
+    cache.store(keys[0], thumb.get(), nullptr);
+    bytes = entry_bytes(keys[0]);
+    ASSERT_GT(bytes, 0);
+  }
+  remove_cache_dir();
+
+  ThumbnailCache cache(kCacheDir, 2 * bytes);
+  cache.store(keys[0], thumb.get(), nullptr);
+  cache.store(keys[1], thumb.get(), nullptr);
+
+  // Use the first thumbnail, so the second one is the least recently
+  // used when the third one is stored
+  ASSERT_TRUE(cache.lookup(keys[0]) != nullptr);
+  cache.store(keys[2], thumb.get(), nullptr);
+
+  EXPECT_TRUE(cache.lookup(keys[0]) != nullptr);
+  EXPECT_EQ(nullptr, cache.lookup(keys[1]));
+  EXPECT_TRUE(cache.lookup(keys[2]) != nullptr);
+  EXPECT_EQ(2, count_cache_files("thumb"));
+
+  // A cache smaller than one entry doesn't save anything
+  remove_cache_dir();
+  ThumbnailCache noCache(kCacheDir, bytes - 1);
+  noCache.store(keys[0], thumb.get(), nullptr);
+  EXPECT_EQ(nullptr, noCache.lookup(keys[0]));
+  EXPECT_EQ(0, count_cache_files("thumb"));
+
+  for (const auto& fn : fns)
+    std::remove(fn.c_str());
+}
+
+TEST(ThumbnailCache, Index)
+{
+  remove_cache_dir();
+  const std::string fns[3] = { "thumbnail_cache_test_x.txt",
+                               "thumbnail_cache_test_y.txt",
+                               "thumbnail_cache_test_z.txt" };
+  for (const auto& fn : fns)
+    write_file(fn, fn);
+
+  const ThumbnailCache::Key keys[3] = { ThumbnailCache::Key(fns[0], 8),
+                                        ThumbnailCache::Key(fns[1], 8),
+                                        ThumbnailCache::Key(fns[2], 8) };
+  const ImageRef thumb = make_thumbnail(rgba(0, 255, 0, 255));
+
+  std::size_t bytes;
+  {
+    ThumbnailCache cache(kCacheDir, 1024 * 1024);
+    cache.store(keys[0], thumb.get(), nullptr);
+    cache.store(keys[1], thumb.get(), nullptr);
+    ASSERT_TRUE(cache.lookup(keys[0]) != nullptr);
+    bytes = entry_bytes(keys[0]);
+    // The index is saved when the cache is destroyed
+  }
+
+  // Entry files that are not referenced by the index are deleted
+  write_file(base::join_path(kCacheDir, keys[2].hash() + ".thumb"), "orphan");
+  // Just like temporary files of incomplete entries
+  write_file(base::join_path(kCacheDir, keys[2].hash() + ".thumb.1-1.tmp"), "tmp");
+
+  {
+    // The LRU order is restored from the index: keys[1] is the
+    // least recently used entry and it's evicted first
+    ThumbnailCache cache(kCacheDir, 2 * bytes);
+    EXPECT_EQ(0, count_cache_files("tmp"));
+    EXPECT_EQ(2, count_cache_files("thumb"));
+    EXPECT_EQ(nullptr, cache.lookup(keys[2]));
+
+    cache.store(keys[2], thumb.get(), nullptr);
+    EXPECT_EQ(nullptr, cache.lookup(keys[1]));
+    EXPECT_TRUE(cache.lookup(keys[0]) != nullptr);
+    EXPECT_TRUE(cache.lookup(keys[2]) != nullptr);
+  }
+
+  // Entries are evicted when the cache is loaded with a smaller size
+  {
+    ThumbnailCache cache(kCacheDir, bytes);
+    EXPECT_EQ(1, count_cache_files("thumb"));
+    EXPECT_EQ(nullptr, cache.lookup(keys[0]));
+    EXPECT_TRUE(cache.lookup(keys[2]) != nullptr);
+  }
+
+  remove_cache_dir();
+  for (const auto& fn : fns)
+    std::remove(fn.c_str());
+}
@@ -16,7 +16,10 @@
 #include "app/doc.h"
 #include "app/file/file.h"
 #include "app/file_system.h"
+#include "app/pref/preferences.h"
+#include "app/resource_finder.h"
 #include "app/util/conversion_to_surface.h"
+#include "base/fs.h"
 #include "base/thread.h"
 #include "doc/algorithm/rotate.h"
 #include "doc/image.h"
@@ -38,10 +41,27 @@
 
 namespace app {
 
+static os::SurfaceRef make_thumbnail_surface(const Image* image, const Palette* palette)
+{
+  os::SurfaceRef thumbnail = os::instance()->makeRgbaSurface(image->width(), image->height());
+
+  convert_image_to_surface(image,
+                           palette,
+                           thumbnail.get(),
+                           0,
+                           0,
+                           0,
+                           0,
+                           image->width(),
+                           image->height());
+  return thumbnail;
+}
+
 class ThumbnailGenerator::Worker {
 public:
-  Worker(base::concurrent_queue<ThumbnailGenerator::Item>& queue)
+  Worker(base::concurrent_queue<ThumbnailGenerator::Item>& queue, ThumbnailCache* cache)
     : m_queue(queue)
+    , m_cache(cache)
     , m_fop(nullptr)
     , m_isDone(false)
     , m_thread([this] { loadBgThread(); })
@@ -151,18 +171,11 @@ private:
 
       // Set the thumbnail of the file-item.
       if (thumbnailImage) {
-        os::SurfaceRef thumbnail = os::instance()->makeRgbaSurface(thumbnailImage->width(),
-                                                                   thumbnailImage->height());
-
-        convert_image_to_surface(thumbnailImage.get(),
-                                 palette.get(),
-                                 thumbnail.get(),
-                                 0,
-                                 0,
-                                 0,
-                                 0,
-                                 thumbnailImage->width(),
-                                 thumbnailImage->height());
+        os::SurfaceRef thumbnail = make_thumbnail_surface(thumbnailImage.get(), palette.get());
+
+        // Save the thumbnail in the persistent cache
+        if (m_cache && !m_fop->isStop())
+          m_cache->store(m_item.key, thumbnailImage.get(), palette.get());
 
         {
           const std::lock_guard lock(m_mutex);
@@ -223,6 +236,7 @@ private:
   }
 
   base::concurrent_queue<Item>& m_queue;
+  ThumbnailCache* m_cache;
   app::ThumbnailGenerator::Item m_item;
   FileOp* m_fop;
   mutable std::mutex m_mutex;
@@ -249,6 +263,24 @@ ThumbnailGenerator::ThumbnailGenerator()
   if (n < 1)
     n = 1;
   m_maxWorkers = n;
+
+  const int cacheSize = Preferences::instance().fileSelector.thumbnailCacheSize();
+  if (cacheSize > 0) {
+    ResourceFinder rf;
+    rf.includeUserDir(base::join_path("thumbnails", ".").c_str());
+    m_cache = std::make_unique<ThumbnailCache>(rf.getFirstOrCreateDefault(),
+                                               std::size_t(cacheSize) * 1024 * 1024);
+  }
+}
+
+ThumbnailGenerator::~ThumbnailGenerator()
+{
+  // Workers must be destroyed (joined) before the cache
+  {
+    const std::lock_guard lock(m_workersAccess);
+    m_workers.clear();
+  }
+  m_cache.reset();
 }
 
 bool ThumbnailGenerator::checkWorkers()
@@ -266,6 +298,10 @@ bool ThumbnailGenerator::checkWorkers()
     }
   }
 
+  // Save the cache index when all workers have finished
+  if (doingWork && m_workers.empty() && m_cache)
+    m_cache->flush();
+
   return doingWork;
 }
 
@@ -299,6 +335,17 @@ void ThumbnailGenerator::generateThumbnail(IFileItem* fileitem)
   // Set a starting progress so we don't enqueue the same item two times.
   fileitem->setThumbnailProgress(0.00001);
 
+  // Try to get the thumbnail from the persistent cache
+  ThumbnailCache::Key key;
+  if (m_cache) {
+    key = ThumbnailCache::Key(fileitem->fileName(), MAX_THUMBNAIL_SIZE);
+    if (doc::ImageRef image = m_cache->lookup(key)) {
+      THUMB_TRACE("Cached thumbnail for %s\n", fileitem->fileName().c_str());
+      fileitem->setThumbnail(make_thumbnail_surface(image.get(), nullptr));
+      return;
+    }
+  }
+
   THUMB_TRACE("Queue FOP thumbnail for %s\n", fileitem->fileName().c_str());
 
   std::unique_ptr<FileOp> fop(
@@ -312,7 +359,7 @@ void ThumbnailGenerator::generateThumbnail(IFileItem* fileitem)
     return;
   }
 
-  m_remainingItems.push(Item(fileitem, fop.get()));
+  m_remainingItems.push(Item(fileitem, fop.get(), key));
   fop.release();
 
   startWorker();
@@ -342,7 +389,7 @@ void ThumbnailGenerator::startWorker()
 {
   const std::lock_guard lock(m_workersAccess);
   if (m_workers.size() < m_maxWorkers) {
-    m_workers.push_back(std::make_unique<Worker>(m_remainingItems));
+    m_workers.push_back(std::make_unique<Worker>(m_remainingItems, m_cache.get()));
   }
 }
 
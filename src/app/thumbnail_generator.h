@@ -9,6 +9,7 @@
 #define APP_THUMBNAIL_GENERATOR_H_INCLUDED
 #pragma once
 
+#include "app/thumbnail_cache.h"
 #include "base/concurrent_queue.h"
 
 #include <memory>
@@ -27,6 +28,8 @@ class ThumbnailGenerator {
   ThumbnailGenerator();
 
 public:
+  ~ThumbnailGenerator();
+
   static ThumbnailGenerator* instance();
 
   // Generate a thumbnail for the given file-item.  It must be called
@@ -54,12 +57,21 @@ private:
   struct Item {
     IFileItem* fileitem;
     FileOp* fop;
+    ThumbnailCache::Key key;
     Item() : fileitem(nullptr), fop(nullptr) {}
-    Item(const Item& item) : fileitem(item.fileitem), fop(item.fop) {}
-    Item(IFileItem* fileitem, FileOp* fop) : fileitem(fileitem), fop(fop) {}
+    Item(const Item& item) : fileitem(item.fileitem), fop(item.fop), key(item.key) {}
+    Item(IFileItem* fileitem, FileOp* fop, const ThumbnailCache::Key& key)
+      : fileitem(fileitem)
+      , fop(fop)
+      , key(key)
+    {
+    }
+    Item& operator=(const Item& item) = default;
   };
 
   int m_maxWorkers;
+  // Persistent cache of generated thumbnails (nullptr if it's disabled)
+  std::unique_ptr<ThumbnailCache> m_cache;
   WorkerList m_workers;
   std::mutex m_workersAccess;
   base::concurrent_queue<Item> m_remainingItems;
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2020  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -60,22 +60,20 @@ void Intertwine::doTransformPoint(const Stroke::Pt& pt, ToolLoop* loop)
   loop->getPointShape()->transformPoint(loop, pt);
 }
 
+void Intertwine::doTransformSymmetricalPoints(const Stroke::Pt* pts, int n, ToolLoop* loop)
+{
+  loop->getPointShape()->transformSymmetricalPoints(loop, pts, n);
+}
+
 void Intertwine::doPointshapeStrokePt(const Stroke::Pt& pt, ToolLoop* loop)
 {
   Symmetry* symmetry = loop->getSymmetry();
   if (symmetry) {
-    // Convert the point to the sprite position so we can apply the
-    // symmetry transformation.
-    Stroke main_stroke;
-    main_stroke.addPoint(pt);
-
-    Strokes strokes;
-    symmetry->generateStrokes(main_stroke, strokes, loop);
-    for (const auto& stroke : strokes) {
-      // We call transformPoint() moving back each point to the cel
-      // origin.
-      doTransformPoint(stroke[0], loop);
-    }
+    // Generate the symmetrical points of this point so the point
+    // shape can draw all of them at once.
+    Symmetry::Points pts;
+    const int n = symmetry->generatePoints(pt, pts, loop);
+    doTransformSymmetricalPoints(pts.data(), n, loop);
   }
   else {
     doTransformPoint(pt, loop);
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2021  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -49,6 +49,9 @@ public:
 protected:
   virtual void doTransformPoint(const Stroke::Pt& pt, ToolLoop* loop);
   virtual void doPointshapeStrokePt(const Stroke::Pt& pt, ToolLoop* loop);
+  // Transforms the symmetrical points of one stroke point (see
+  // PointShape::transformSymmetricalPoints()).
+  virtual void doTransformSymmetricalPoints(const Stroke::Pt* pts, int n, ToolLoop* loop);
   // The given point must be relative to the cel origin.
   static void doPointshapePoint(int x, int y, ToolLoop* loop);
   static void doPointshapePointDynamics(int x, int y, LineData* data);
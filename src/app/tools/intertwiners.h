@@ -590,6 +590,13 @@ protected:
       updateTempTileset(loop, pt);
   }
 
+  void doTransformSymmetricalPoints(const Stroke::Pt* pts, int n, ToolLoop* loop) override
+  {
+    // Each point needs its own saved area to be restored
+    for (int i = 0; i < n; ++i)
+      doTransformPoint(pts[i], loop);
+  }
+
 private:
   void clearPointshapeStrokePtAreas() { m_savedAreas.clear(); }
 
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2020  Igara Studio S.A.
+// Copyright (C) 2020-2025  Igara Studio S.A.
 // Copyright (C) 2001-2016  David Capello
 //
 // This program is distributed under the terms of
@@ -27,6 +27,15 @@ public:
 
   // The x, y position must be relative to the cel/src/dst image origin.
   virtual void transformPoint(ToolLoop* loop, const Stroke::Pt& pt) = 0;
+
+  // Transforms the "n" symmetrical points generated from one stroke
+  // point (the first one is the original point). By default each
+  // point is transformed separately.
+  virtual void transformSymmetricalPoints(ToolLoop* loop, const Stroke::Pt* pts, int n)
+  {
+    for (int i = 0; i < n; ++i)
+      transformPoint(loop, pts[i]);
+  }
   virtual void getModifiedArea(ToolLoop* loop, int x, int y, gfx::Rect& area) = 0;
 
 protected:
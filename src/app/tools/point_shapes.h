@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2022  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2017  David Capello
 //
 // This program is distributed under the terms of
@@ -11,8 +11,11 @@
 #include "doc/algorithm/flip_image.h"
 #include "render/gradient.h"
 
+#include <algorithm>
 #include <array>
 #include <memory>
+#include <tuple>
+#include <vector>
 
 namespace app { namespace tools {
 
@@ -67,10 +70,20 @@ public:
 };
 
 class BrushPointShape : public PointShape {
+  struct Span {
+    int y, x1, x2;
+    bool operator<(const Span& other) const
+    {
+      return std::tie(y, x1, x2) < std::tie(other.y, other.x1, other.x2);
+    }
+  };
+
   bool m_firstPoint;
   Brush* m_lastBrush;
   BrushType m_origBrushType;
   std::array<std::shared_ptr<CompressedImage>, 4> m_compressedImages;
+  // Scanlines of all symmetrical stamps (reused between points)
+  std::vector<Span> m_spans;
   // For dynamics
   DynamicsOptions m_dynamics;
   bool m_useDynamics;
@@ -106,9 +119,79 @@ public:
 
   void transformPoint(ToolLoop* loop, const Stroke::Pt& pt) override
   {
+    Ink* ink = loop->getInk();
+    Brush* brush = prepareBrush(loop, pt);
+
     int x = pt.x;
     int y = pt.y;
+    prepareStampOrigin(loop, brush, x, y);
+
+    ink->prepareForPointShape(loop, m_firstPoint, x, y);
+
+    for (auto scanline : getCompressedImage(pt.symmetry)) {
+      int u = x + scanline.x;
+      ink->prepareVForPointShape(loop, y + scanline.y);
+      doInkHline(u, y + scanline.y, u + scanline.w - 1, loop);
+    }
+    m_firstPoint = false;
+  }
 
+  void transformSymmetricalPoints(ToolLoop* loop, const Stroke::Pt* pts, int n) override
+  {
+    // All symmetrical points share the same size/angle/gradient, so
+    // they use the same brush.
+    Ink* ink = loop->getInk();
+    Brush* brush = prepareBrush(loop, pts[0]);
+
+    // The ink of image brushes depends on the position of each
+    // stamp, and stamps can wrap around in tiled mode, so we draw
+    // each stamp separately in these cases.
+    if (brush->type() == kImageBrushType || loop->getTiledMode() != TiledMode::NONE) {
+      PointShape::transformSymmetricalPoints(loop, pts, n);
+      return;
+    }
+
+    int x0 = pts[0].x;
+    int y0 = pts[0].y;
+    prepareStampOrigin(loop, brush, x0, y0);
+
+    // Collect the scanlines of all stamps so pixels covered by
+    // several stamps (e.g. near the symmetry axis) are inked only
+    // once.
+    m_spans.clear();
+    for (int i = 0; i < n; ++i) {
+      const int x = pts[i].x + brush->bounds().x;
+      const int y = pts[i].y + brush->bounds().y;
+      for (auto scanline : getCompressedImage(pts[i].symmetry))
+        m_spans.push_back(Span{ y + scanline.y, x + scanline.x, x + scanline.x + scanline.w - 1 });
+    }
+    std::sort(m_spans.begin(), m_spans.end());
+
+    ink->prepareForPointShape(loop, m_firstPoint, x0, y0);
+
+    for (auto it = m_spans.begin(), end = m_spans.end(); it != end;) {
+      Span span = *it;
+      for (++it; it != end && it->y == span.y && it->x1 <= span.x2 + 1; ++it)
+        span.x2 = std::max(span.x2, it->x2);
+
+      ink->prepareVForPointShape(loop, span.y);
+      doInkHline(span.x1, span.y, span.x2, loop);
+    }
+    m_firstPoint = false;
+  }
+
+  void getModifiedArea(ToolLoop* loop, int x, int y, Rect& area) override
+  {
+    area = loop->getBrush()->bounds();
+    area.x += x;
+    area.y += y;
+  }
+
+private:
+  // Updates the brush for the dynamics of the given point (size,
+  // angle, gradient) and returns the brush to draw the point.
+  Brush* prepareBrush(ToolLoop* loop, const Stroke::Pt& pt)
+  {
     Ink* ink = loop->getInk();
     Brush* brush = loop->getBrush();
 
@@ -206,6 +289,13 @@ public:
       m_compressedImages.fill(nullptr);
     }
 
+    return brush;
+  }
+
+  // Converts the x/y point position to the top-left corner of the
+  // brush stamp, and updates the brush pattern origin.
+  void prepareStampOrigin(ToolLoop* loop, Brush* brush, int& x, int& y)
+  {
     x += brush->bounds().x;
     y += brush->bounds().y;
 
@@ -233,25 +323,8 @@ public:
       brush->setPatternOrigin(gfx::Point(brush->patternOrigin().x, wrappedPatternOriginY));
       y = wrap_value(y, loop->sprite()->height());
     }
-
-    ink->prepareForPointShape(loop, m_firstPoint, x, y);
-
-    for (auto scanline : getCompressedImage(pt.symmetry)) {
-      int u = x + scanline.x;
-      ink->prepareVForPointShape(loop, y + scanline.y);
-      doInkHline(u, y + scanline.y, u + scanline.w - 1, loop);
-    }
-    m_firstPoint = false;
   }
 
-  void getModifiedArea(ToolLoop* loop, int x, int y, Rect& area) override
-  {
-    area = loop->getBrush()->bounds();
-    area.x += x;
-    area.y += y;
-  }
-
-private:
   CompressedImage& getCompressedImage(gen::SymmetryMode symmetryMode)
   {
     auto& compressPtr = m_compressedImages[int(symmetryMode)];
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2021  Igara Studio S.A.
+// Copyright (C) 2021-2025  Igara Studio S.A.
 //
 // This program is distributed under the terms of
 // the End-User License Agreement for Aseprite.
@@ -45,13 +45,49 @@ void Symmetry::generateStrokes(const Stroke& stroke, Strokes& strokes, ToolLoop*
   }
 }
 
+int Symmetry::generatePoints(const Stroke::Pt& pt, Points& pts, ToolLoop* loop)
+{
+  pts[0] = pt;
+  const bool isDynamic = loop->getDynamics().isDynamic();
+  gen::SymmetryMode symmetryMode = loop->getSymmetry()->mode();
+  switch (symmetryMode) {
+    case gen::SymmetryMode::NONE: ASSERT(false); return 1;
+
+    case gen::SymmetryMode::HORIZONTAL:
+    case gen::SymmetryMode::VERTICAL:
+      pts[1] = calculateSymmetricalPoint(pt, loop, symmetryMode, isDynamic);
+      return 2;
+
+    case gen::SymmetryMode::BOTH:
+      pts[1] = calculateSymmetricalPoint(pt, loop, gen::SymmetryMode::HORIZONTAL, isDynamic);
+      pts[2] = calculateSymmetricalPoint(pt, loop, gen::SymmetryMode::VERTICAL, isDynamic);
+      pts[3] = calculateSymmetricalPoint(pts[2], loop, gen::SymmetryMode::BOTH, isDynamic);
+      return 4;
+  }
+  return 1;
+}
+
 void Symmetry::calculateSymmetricalStroke(const Stroke& refStroke,
                                           Stroke& stroke,
                                           ToolLoop* loop,
                                           gen::SymmetryMode symmetryMode)
+{
+  const bool isDynamic = loop->getDynamics().isDynamic();
+  for (const auto& pt : refStroke)
+    stroke.addPoint(calculateSymmetricalPoint(pt, loop, symmetryMode, isDynamic));
+}
+
+Stroke::Pt Symmetry::calculateSymmetricalPoint(const Stroke::Pt& refPt,
+                                               ToolLoop* loop,
+                                               gen::SymmetryMode symmetryMode,
+                                               const bool isDynamic)
 {
   int brushSize, brushCenter;
-  if (loop->getPointShape()->isFloodFill()) {
+  if (isDynamic) {
+    brushSize = refPt.size;
+    brushCenter = (brushSize - brushSize % 2) / 2;
+  }
+  else if (loop->getPointShape()->isFloodFill()) {
     brushSize = 1;
     brushCenter = 0;
   }
@@ -69,20 +105,13 @@ void Symmetry::calculateSymmetricalStroke(const Stroke& refStroke,
     }
   }
 
-  const bool isDynamic = loop->getDynamics().isDynamic();
-  for (const auto& pt : refStroke) {
-    if (isDynamic) {
-      brushSize = pt.size;
-      brushCenter = (brushSize - brushSize % 2) / 2;
-    }
-    Stroke::Pt pt2 = pt;
-    pt2.symmetry = symmetryMode;
-    if (symmetryMode == gen::SymmetryMode::HORIZONTAL || symmetryMode == gen::SymmetryMode::BOTH)
-      pt2.x = 2 * (m_x + brushCenter) - pt2.x - brushSize;
-    else
-      pt2.y = 2 * (m_y + brushCenter) - pt2.y - brushSize;
-    stroke.addPoint(pt2);
-  }
+  Stroke::Pt pt = refPt;
+  pt.symmetry = symmetryMode;
+  if (symmetryMode == gen::SymmetryMode::HORIZONTAL || symmetryMode == gen::SymmetryMode::BOTH)
+    pt.x = 2 * (m_x + brushCenter) - pt.x - brushSize;
+  else
+    pt.y = 2 * (m_y + brushCenter) - pt.y - brushSize;
+  return pt;
 }
 
 }} // namespace app::tools
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2021  Igara Studio S.A.
+// Copyright (C) 2021-2025  Igara Studio S.A.
 // Copyright (C) 2015  David Capello
 //
 // This program is distributed under the terms of
@@ -12,12 +12,18 @@
 #include "app/pref/preferences.h"
 #include "app/tools/stroke.h"
 
+#include <array>
+
 namespace app { namespace tools {
 
 class ToolLoop;
 
 class Symmetry {
 public:
+  // Symmetrical points of one stroke point (the original point
+  // included), 4 points at most (SymmetryMode::BOTH).
+  using Points = std::array<Stroke::Pt, 4>;
+
   Symmetry(gen::SymmetryMode symmetryMode, double x, double y)
     : m_symmetryMode(symmetryMode)
     , m_x(x)
@@ -27,6 +33,10 @@ public:
 
   void generateStrokes(const Stroke& stroke, Strokes& strokes, ToolLoop* loop);
 
+  // Same as generateStrokes() for only one point without allocating
+  // strokes, returns the number of generated points.
+  int generatePoints(const Stroke::Pt& pt, Points& pts, ToolLoop* loop);
+
   gen::SymmetryMode mode() const { return m_symmetryMode; }
 
 private:
@@ -34,6 +44,10 @@ private:
                                   Stroke& stroke,
                                   ToolLoop* loop,
                                   gen::SymmetryMode symmetryMode);
+  Stroke::Pt calculateSymmetricalPoint(const Stroke::Pt& refPt,
+                                       ToolLoop* loop,
+                                       gen::SymmetryMode symmetryMode,
+                                       bool isDynamic);
 
   gen::SymmetryMode m_symmetryMode;
   double m_x, m_y;
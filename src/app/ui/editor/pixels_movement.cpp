@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2024  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -126,6 +126,7 @@ PixelsMovement::PixelsMovement(Context* context,
   , m_canHandleFrameChange(false)
   , m_fastMode(false)
   , m_needsRotSpriteRedraw(false)
+  , m_refineTimer(10)
 {
   // Save and Lock the TilemapMode.
   // TODO: enable TilemapMode exchanges during PixelMovement.
@@ -155,6 +156,7 @@ PixelsMovement::PixelsMovement(Context* context,
   // that someone else is using it (e.g. the editor brush preview),
   // and its owner could destroy our new "extra cel".
   ASSERT(!m_document->extraCel());
+  m_refineTimer.Tick.connect([this] { onRefinementTimer(); });
   redrawExtraImage();
   redrawCurrentMask();
 
@@ -171,6 +173,12 @@ PixelsMovement::PixelsMovement(Context* context,
 
 PixelsMovement::~PixelsMovement()
 {
+  // Running tasks are canceled (they stop after the current RotSprite
+  // tile) and waited, as they use the Refinement objects.
+  cancelRefinement();
+  for (auto& refinement : m_refinements)
+    refinement->task.wait();
+
   if (ColorBar::instance())
     ColorBar::instance()->unlockTilemapMode();
 }
@@ -192,8 +200,9 @@ void PixelsMovement::setFastMode(const bool fastMode)
   bool redraw = (m_fastMode && !fastMode);
   m_fastMode = fastMode;
   if (m_needsRotSpriteRedraw && redraw) {
-    redrawExtraImage();
-    update_screen_for_document(m_document);
+    // Keep the fast preview on the screen until the RotSprite version
+    // is ready.
+    startRefinement();
     m_needsRotSpriteRedraw = false;
   }
 }
@@ -1110,6 +1119,9 @@ void PixelsMovement::redrawExtraImage(Transformation* transformation)
   if (!transformation)
     transformation = &m_currentData;
 
+  // The refinement of the previous preview is not valid anymore
+  cancelRefinement();
+
   int t, opacity =
            (m_site.layer()->isImage() ? static_cast<LayerImage*>(m_site.layer())->opacity() : 255);
   Cel* cel = m_site.cel();
@@ -1162,6 +1174,136 @@ void PixelsMovement::redrawCurrentMask()
   drawMask(m_currentMask.get(), true);
 }
 
+void PixelsMovement::startRefinement()
+{
+  cancelRefinement();
+
+  if (!m_extraCel || !m_extraCel->image() || m_site.tilemapMode() == TilemapMode::Tiles)
+    return;
+
+  const gfx::Rect bounds = m_currentData.transformedBounds();
+  const auto corners = m_currentData.transformedCorners();
+  const gfx::PointF leftTop(bounds.origin());
+
+  // The original layer is rendered in the UI thread, the background
+  // task works only with its own copies of the source image/mask.
+  ImageRef image(Image::create(m_extraCel->image()->spec()));
+  const color_t maskColor = prepareImage(m_currentData, image.get(), leftTop, true);
+
+  ImageRef src(Image::createCopy(m_originalImage.get()));
+  src->setMaskColor(maskColor);
+  std::shared_ptr<Mask> mask(new Mask(*m_initialMask));
+
+  auto refinement = std::make_unique<Refinement>();
+  refinement->generation = m_refineGeneration;
+  refinement->image = image;
+  refinement->bounds = m_extraCel->cel()->bounds();
+
+  // The task only uses data owned by the refinement, so it doesn't
+  // need "this".
+  Refinement* r = refinement.get();
+  r->task.run([r, src, mask, corners, leftTop](base::task_token& token) {
+    try {
+      doc::algorithm::rotsprite_image(r->image.get(),
+                                      src.get(),
+                                      mask->bitmap(),
+                                      int(corners.leftTop().x - leftTop.x),
+                                      int(corners.leftTop().y - leftTop.y),
+                                      int(corners.rightTop().x - leftTop.x),
+                                      int(corners.rightTop().y - leftTop.y),
+                                      int(corners.rightBottom().x - leftTop.x),
+                                      int(corners.rightBottom().y - leftTop.y),
+                                      int(corners.leftBottom().x - leftTop.x),
+                                      int(corners.leftBottom().y - leftTop.y),
+                                      &token);
+    }
+    catch (const std::bad_alloc&) {
+      r->failed = true;
+    }
+  });
+  m_refinements.push_back(std::move(refinement));
+  m_refineTimer.start();
+}
+
+void PixelsMovement::cancelRefinement()
+{
+  // Don't wait the running task, its result will be discarded when
+  // it finishes (see onRefinementTimer()).
+  ++m_refineGeneration;
+  for (auto& refinement : m_refinements)
+    refinement->task.cancel();
+}
+
+void PixelsMovement::onRefinementTimer()
+{
+  std::unique_ptr<Refinement> result;
+  for (auto it = m_refinements.begin(); it != m_refinements.end();) {
+    Refinement* r = it->get();
+    if (!r->task.completed()) {
+      ++it;
+      continue;
+    }
+    if (r->generation == m_refineGeneration && !r->task.canceled())
+      result = std::move(*it);
+    it = m_refinements.erase(it);
+  }
+
+  if (m_refinements.empty())
+    m_refineTimer.stop();
+
+  if (!result)
+    return;
+
+  if (result->failed) {
+    StatusBar::instance()->showTip(1000, Strings::statusbar_tips_not_enough_rotsprite_memory());
+    return;
+  }
+
+  // Replace the fast preview with the refined one (only if the extra
+  // cel wasn't re-created in the meantime)
+  const Image* image = result->image.get();
+  if (m_extraCel && m_extraCel->image() && m_extraCel->cel()->bounds() == result->bounds &&
+      m_extraCel->image()->size() == image->size()) {
+    copy_image(m_extraCel->image(), image, 0, 0);
+    update_screen_for_document(m_document);
+  }
+}
+
+color_t PixelsMovement::prepareImage(const Transformation& transformation,
+                                     doc::Image* dst,
+                                     const gfx::PointF& pt,
+                                     const bool renderOriginalLayer)
+{
+  auto corners = transformation.transformedCorners();
+  gfx::Rect bounds = corners.bounds(transformation.cornerThick());
+
+  dst->setMaskColor(m_site.sprite()->transparentColor());
+  dst->clear(dst->maskColor());
+
+  if (renderOriginalLayer) {
+    render::Render render;
+    render.renderLayer(dst,
+                       m_site.layer(),
+                       m_site.frame(),
+                       gfx::Clip(bounds.x - pt.x, bounds.y - pt.y, bounds),
+                       BlendMode::SRC);
+  }
+
+  color_t maskColor = m_maskColor;
+
+  // In case that Opaque option is enabled, or if we are drawing the
+  // image for the clipboard (renderOriginalLayer is false), we use a
+  // dummy mask color to call drawParallelogram(). In this way all
+  // pixels will be opaqued (all colors are copied)
+  if (m_opaque || !renderOriginalLayer) {
+    if (m_originalImage->pixelFormat() == IMAGE_INDEXED)
+      maskColor = -1;
+    else
+      maskColor = 0;
+  }
+  return maskColor;
+}
+
 void PixelsMovement::drawImage(const Transformation& transformation,
                                doc::Image* dst,
                                const gfx::PointF& pt,
@@ -1184,31 +1326,7 @@ void PixelsMovement::drawImage(const Transformation& transformation,
     drawTransformedTilemap(transformation, dst, m_originalImage.get(), m_initialMask.get());
   }
   else {
-    dst->setMaskColor(m_site.sprite()->transparentColor());
-    dst->clear(dst->maskColor());
-
-    if (renderOriginalLayer) {
-      render::Render render;
-      render.renderLayer(dst,
-                         m_site.layer(),
-                         m_site.frame(),
-                         gfx::Clip(bounds.x - pt.x, bounds.y - pt.y, bounds),
-                         BlendMode::SRC);
-    }
-
-    color_t maskColor = m_maskColor;
-
-    // In case that Opaque option is enabled, or if we are drawing the
-    // image for the clipboard (renderOriginalLayer is false), we use a
-    // dummy mask color to call drawParallelogram(). In this way all
-    // pixels will be opaqued (all colors are copied)
-    if (m_opaque || !renderOriginalLayer) {
-      if (m_originalImage->pixelFormat() == IMAGE_INDEXED)
-        maskColor = -1;
-      else
-        maskColor = 0;
-    }
-    m_originalImage->setMaskColor(maskColor);
+    m_originalImage->setMaskColor(prepareImage(transformation, dst, pt, renderOriginalLayer));
 
     drawParallelogram(transformation, dst, m_originalImage.get(), m_initialMask.get(), corners, pt);
   }
@@ -1311,6 +1429,9 @@ static void merge_tilemaps(Image* dst, const Image* src, gfx::Clip area)
   if (!area.clip(dst->width(), dst->height(), src->width(), src->height()))
     return;
 
+  dst->expand();
+  src->expand();
+
   ImageConstIterator<TilemapTraits> src_it(src, area.srcBounds(), area.src.x, area.src.y);
   ImageIterator<TilemapTraits> dst_it(dst, area.dstBounds(), area.dst.x, area.dst.y);
 
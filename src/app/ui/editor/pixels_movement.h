@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2024  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -12,6 +12,7 @@
 #include "app/context_access.h"
 #include "app/extra_cel.h"
 #include "app/site.h"
+#include "app/task.h"
 #include "app/transformation.h"
 #include "app/tx.h"
 #include "app/ui/editor/handle_type.h"
@@ -20,8 +21,11 @@
 #include "doc/image_ref.h"
 #include "gfx/size.h"
 #include "obs/connection.h"
+#include "ui/timer.h"
 
+#include <atomic>
 #include <memory>
+#include <vector>
 
 namespace doc {
 class Image;
@@ -140,6 +144,13 @@ private:
   void onRotationAlgorithmChange();
   void redrawExtraImage(Transformation* transformation = nullptr);
   void redrawCurrentMask();
+  void startRefinement();
+  void cancelRefinement();
+  void onRefinementTimer();
+  color_t prepareImage(const Transformation& transformation,
+                       doc::Image* dst,
+                       const gfx::PointF& pt,
+                       const bool renderOriginalLayer);
   void drawImage(const Transformation& transformation,
                  doc::Image* dst,
                  const gfx::PointF& pt,
@@ -203,6 +214,23 @@ private:
   bool m_fastMode;
   bool m_needsRotSpriteRedraw;
 
+  // When the fast mode is disabled, the RotSprite version of the
+  // preview is calculated in a background task and replaces the fast
+  // preview when it's ready (checked with m_refineTimer). Any new
+  // redraw cancels the refinement without waiting it: each one is
+  // tagged with a generation number, and the results of old
+  // generations are discarded when their tasks finish.
+  struct Refinement {
+    int generation;
+    app::Task task;
+    doc::ImageRef image;
+    gfx::Rect bounds;
+    std::atomic<bool> failed = { false };
+  };
+  std::vector<std::unique_ptr<Refinement>> m_refinements;
+  int m_refineGeneration = 0;
+  ui::Timer m_refineTimer;
+
   // Commands used in the interaction with the transformed pixels.
   // This is used to re-create the whole interaction on each
   // modified cel when we are modifying multiples cels at the same
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2024  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -18,6 +18,8 @@
 #include "app/modules/gui.h"
 #include "app/pref/preferences.h"
 #include "app/resource_finder.h"
+#include "app/startup_cache.h"
+#include "app/startup_profiler.h"
 #include "app/ui/app_menuitem.h"
 #include "app/ui/keyboard_shortcuts.h"
 #include "app/ui/skin/font_data.h"
@@ -27,6 +29,7 @@
 #include "app/xml_exception.h"
 #include "base/fs.h"
 #include "base/log.h"
+#include "base/serialization.h"
 #include "base/string.h"
 #include "base/utf8_decode.h"
 #include "gfx/border.h"
@@ -45,6 +48,7 @@
 #include <algorithm>
 #include <cstring>
 #include <memory>
+#include <sstream>
 
 #define BGCOLOR (getWidgetBgColor(widget))
 
@@ -338,6 +342,7 @@ void SkinTheme::onRegenerateTheme()
 void SkinTheme::loadFontData()
 {
   LOG("THEME: Loading fonts\n");
+  StartupScope scope("Fonts");
 
   std::string fontsFilename("fonts/fonts.xml");
 
@@ -359,6 +364,7 @@ void SkinTheme::loadFontData()
 void SkinTheme::loadAll(const std::string& themeId, BackwardCompatibility* backward)
 {
   LOG("THEME: Loading theme %s\n", themeId.c_str());
+  StartupScope scope("Theme ", themeId);
 
   if (m_fonts.empty())
     loadFontData();
@@ -371,26 +377,94 @@ void SkinTheme::loadAll(const std::string& themeId, BackwardCompatibility* backw
   loadXml(backward);
 }
 
+namespace {
+
+const char* kSheetCacheName = "theme-sheet-v1";
+
+// The cached sheet contains the size, the position of each color
+// component (to discard the entry if the os backend changes its
+// pixel format), and the raw RGBA pixels.
+std::string write_cached_sheet(os::Surface* sheet)
+{
+  using namespace base::serialization::little_endian;
+
+  os::SurfaceFormatData fd;
+  sheet->getFormat(&fd);
+
+  std::ostringstream out;
+  write32(out, sheet->width());
+  write32(out, sheet->height());
+  out.put(fd.redShift);
+  out.put(fd.greenShift);
+  out.put(fd.blueShift);
+  out.put(fd.alphaShift);
+
+  os::SurfaceLock lock(sheet);
+  for (int y = 0; y < sheet->height(); ++y)
+    out.write((const char*)sheet->getData(0, y), 4 * sheet->width());
+  return out.str();
+}
+
+os::SurfaceRef read_cached_sheet(const std::string& data)
+{
+  using namespace base::serialization::little_endian;
+
+  std::istringstream in(data);
+  const int w = read32(in);
+  const int h = read32(in);
+  if (!in || w <= 0 || h <= 0 || data.size() != 12 + std::size_t(4) * w * h)
+    return nullptr;
+
+  os::SurfaceRef sheet = os::instance()->makeRgbaSurface(w, h);
+  os::SurfaceFormatData fd;
+  sheet->getFormat(&fd);
+  if (in.get() != int(fd.redShift) || in.get() != int(fd.greenShift) ||
+      in.get() != int(fd.blueShift) || in.get() != int(fd.alphaShift)) {
+    return nullptr;
+  }
+
+  os::SurfaceLock lock(sheet.get());
+  for (int y = 0; y < h; ++y)
+    in.read((char*)sheet->getData(0, y), 4 * w);
+  if (!in)
+    return nullptr;
+  return sheet;
+}
+
+} // anonymous namespace
+
 void SkinTheme::loadSheet()
 {
   // Load the skin sheet
   std::string sheet_filename(base::join_path(m_path, "sheet.png"));
   os::SurfaceRef newSheet;
-  try {
-    newSheet = os::instance()->loadRgbaSurface(sheet_filename.c_str());
-  }
-  catch (...) {
-    // Ignore the error, newSheet is nullptr and we will throw our own
-    // exception.
+
+  // Decoding the PNG file is one of the slowest steps of the startup,
+  // so we try to use the pixels decoded in a previous execution.
+  const StartupCache cache;
+  const std::vector<std::string> sources = { sheet_filename };
+  std::string data;
+  if (cache.load(kSheetCacheName, sources, data))
+    newSheet = read_cached_sheet(data);
+
+  if (!newSheet) {
+    try {
+      newSheet = os::instance()->loadRgbaSurface(sheet_filename.c_str());
+    }
+    catch (...) {
+      // Ignore the error, newSheet is nullptr and we will throw our own
+      // exception.
+    }
+    if (!newSheet)
+      throw base::Exception("Error loading %s file", sheet_filename.c_str());
+
+    cache.store(kSheetCacheName, sources, write_cached_sheet(newSheet.get()));
   }
-  if (!newSheet)
-    throw base::Exception("Error loading %s file", sheet_filename.c_str());
-
-  // TODO Change os::Surface::applyScale() to return a new surface,
-  //      avoid loading two times the same file (even more, if there
-  //      is no scale to apply, m_unscaledSheet must reference the
-  //      same m_sheet).
-  m_unscaledSheet = os::instance()->loadRgbaSurface(sheet_filename.c_str());
+
+  // Keep a copy of the original sheet (without the scale) instead of
+  // decoding the same file two times.
+  m_unscaledSheet = os::instance()->makeRgbaSurface(newSheet->width(), newSheet->height());
+  newSheet->blitTo(m_unscaledSheet.get(), 0, 0, 0, 0, newSheet->width(), newSheet->height());
 
   // Replace the sprite sheet
   if (m_sheet)
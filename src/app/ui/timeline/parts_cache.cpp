@@ -0,0 +1,59 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/ui/timeline/parts_cache.h"
+
+#include "os/system.h"
+#include "ui/graphics.h"
+#include "ui/theme.h"
+
+namespace app {
+
+// Parts bigger than this are painted directly (e.g. the background
+// of the whole timeline, which is painted only once anyway).
+static const int kMaxPartArea = 256 * 256;
+
+// Limit of cached surfaces (the cache is cleared when it's reached,
+// e.g. after changing the zoom of the timeline several times).
+static const std::size_t kMaxSurfaces = 512;
+
+void PartsCache::paint(ui::Graphics* g,
+                       ui::Theme* theme,
+                       const ui::Style* style,
+                       const gfx::Rect& bounds,
+                       const int styleFlags)
+{
+  ui::PaintWidgetPartInfo info;
+  info.styleFlags = styleFlags;
+
+  if (bounds.isEmpty() || bounds.w * bounds.h > kMaxPartArea) {
+    theme->paintWidgetPart(g, style, bounds, info);
+    return;
+  }
+
+  const Key key(style, styleFlags, bounds.w, bounds.h);
+  auto it = m_surfaces.find(key);
+  if (it == m_surfaces.end()) {
+    if (m_surfaces.size() >= kMaxSurfaces)
+      m_surfaces.clear();
+
+    os::SurfaceRef surface = os::instance()->makeRgbaSurface(bounds.w, bounds.h);
+    surface->clear();
+    {
+      ui::Graphics sg(nullptr, surface, 0, 0);
+      theme->paintWidgetPart(&sg, style, gfx::Rect(bounds.size()), info);
+    }
+    it = m_surfaces.emplace(key, surface).first;
+  }
+
+  g->drawRgbaSurface(it->second.get(), bounds.x, bounds.y);
+}
+
+} // namespace app
@@ -0,0 +1,50 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_UI_TIMELINE_PARTS_CACHE_H_INCLUDED
+#define APP_UI_TIMELINE_PARTS_CACHE_H_INCLUDED
+#pragma once
+
+#include "gfx/rect.h"
+#include "os/surface.h"
+
+#include <map>
+#include <tuple>
+
+namespace ui {
+class Graphics;
+class Style;
+class Theme;
+} // namespace ui
+
+namespace app {
+
+// Cache of theme parts (styles without text) rendered in surfaces.
+// The timeline paints the same cel box styles thousands of times,
+// with this cache each box is just one blit instead of painting all
+// the layers of the style again.
+class PartsCache {
+public:
+  // Paints the style in the given bounds, rendering it in a cached
+  // surface the first time it's used with the given size/flags.
+  void paint(ui::Graphics* g,
+             ui::Theme* theme,
+             const ui::Style* style,
+             const gfx::Rect& bounds,
+             const int styleFlags);
+
+  // Must be called when the theme or the UI scale changes.
+  void clear() { m_surfaces.clear(); }
+
+private:
+  // Style, flags, width, height
+  using Key = std::tuple<const ui::Style*, int, int, int>;
+  std::map<Key, os::SurfaceRef> m_surfaces;
+};
+
+} // namespace app
+
+#endif
@@ -1597,6 +1597,7 @@ void Timeline::onInitTheme(ui::InitThemeEvent& ev)
   m_vbar.setStyle(theme->styles.transparentScrollbar());
   m_hbar.setThumbStyle(theme->styles.transparentScrollbarThumb());
   m_vbar.setThumbStyle(theme->styles.transparentScrollbarThumb());
+  m_partsCache.clear();
 
   if (m_confPopup)
     m_confPopup->initTheme();
@@ -1655,6 +1656,7 @@ void Timeline::onPaint(ui::PaintEvent& ev)
 
     getDrawableLayers(&firstLayer, &lastLayer);
     getDrawableFrames(&firstFrame, &lastFrame);
+    clipDrawableRange(g->getClipBounds(), firstLayer, lastLayer, firstFrame, lastFrame);
 
     drawTop(g);
 
@@ -1915,7 +1917,9 @@ void Timeline::onAfterRemoveCel(DocEvent& ev)
 
 void Timeline::onLayerNameChange(DocEvent& ev)
 {
-  invalidate();
+  layer_t layerIdx = getLayerIndex(ev.layer());
+  if (validLayer(layerIdx))
+    invalidateRect(getPartBounds(Hit(PART_ROW, layerIdx)).offset(origin()));
 }
 
 void Timeline::onAddTag(DocEvent& ev)
@@ -2066,6 +2070,40 @@ void Timeline::getDrawableFrames(frame_t* firstFrame, frame_t* lastFrame)
     *lastFrame = m_sprite->lastFrame();
 }
 
+// Reduces the range of drawable layers/frames to the ones that
+// intersect the clipping region, so when only some cels are
+// invalidated (e.g. the hot cel or the active frame) we don't paint
+// all visible cels again. One extra row/column is kept on each side
+// for parts that could be painted over their neighbors.
+void Timeline::clipDrawableRange(const gfx::Rect& clipBounds,
+                                 layer_t& firstLayer,
+                                 layer_t& lastLayer,
+                                 frame_t& firstFrame,
+                                 frame_t& lastFrame)
+{
+  if (clipBounds.isEmpty())
+    return;
+
+  // Layers are painted from bottom (firstLayer) to top (lastLayer)
+  while (firstLayer < lastLayer &&
+         getPartBounds(Hit(PART_ROW, firstLayer + 1)).y >= clipBounds.y2()) {
+    ++firstLayer;
+  }
+  while (lastLayer > firstLayer &&
+         getPartBounds(Hit(PART_ROW, lastLayer - 1)).y2() <= clipBounds.y) {
+    --lastLayer;
+  }
+
+  while (firstFrame < lastFrame &&
+         getPartBounds(Hit(PART_HEADER_FRAME, -1, firstFrame + 1)).x2() <= clipBounds.x) {
+    ++firstFrame;
+  }
+  while (lastFrame > firstFrame &&
+         getPartBounds(Hit(PART_HEADER_FRAME, -1, lastFrame - 1)).x >= clipBounds.x2()) {
+    --lastFrame;
+  }
+}
+
 void Timeline::drawPart(ui::Graphics* g,
                         const gfx::Rect& bounds,
                         const std::string* text,
@@ -2086,7 +2124,11 @@ void Timeline::drawPart(ui::Graphics* g,
                     (is_clicked ? ui::Style::Layer::kSelected : 0) |
                     (is_disabled ? ui::Style::Layer::kDisabled : 0);
 
-  theme()->paintWidgetPart(g, style, bounds, info);
+  // Parts without text (cel boxes, icons, etc.) are cached
+  if (!text)
+    m_partsCache.paint(g, theme(), style, bounds, info.styleFlags);
+  else
+    theme()->paintWidgetPart(g, style, bounds, info);
 }
 
 void Timeline::drawClipboardRange(ui::Graphics* g)
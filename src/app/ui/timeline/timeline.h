@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -17,6 +17,7 @@
 #include "app/ui/editor/editor_observer.h"
 #include "app/ui/input_chain_element.h"
 #include "app/ui/timeline/ani_controls.h"
+#include "app/ui/timeline/parts_cache.h"
 #include "app/ui/timeline/timeline_observer.h"
 #include "base/debug.h"
 #include "doc/frame.h"
@@ -259,6 +260,11 @@ private:
   void setCursor(ui::Message* msg, const Hit& hit);
   void getDrawableLayers(layer_t* firstLayer, layer_t* lastLayer);
   void getDrawableFrames(frame_t* firstFrame, frame_t* lastFrame);
+  void clipDrawableRange(const gfx::Rect& clipBounds,
+                         layer_t& firstLayer,
+                         layer_t& lastLayer,
+                         frame_t& firstFrame,
+                         frame_t& lastFrame);
   void drawPart(ui::Graphics* g,
                 const gfx::Rect& bounds,
                 const std::string* text,
@@ -431,6 +437,9 @@ private:
 
   AniControls m_aniControls;
 
+  // Cel boxes and other parts of the theme rendered in surfaces.
+  PartsCache m_partsCache;
+
   // Data used for thumbnails.
   bool m_thumbnailsOverlayVisible;
   gfx::Rect m_thumbnailsOverlayBounds;
@@ -0,0 +1,74 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/util/atomic_file.h"
+
+#include "base/exception.h"
+#include "base/fs.h"
+#include "base/fstream_path.h"
+#include "base/process.h"
+#include "fmt/format.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+
+#ifdef _WIN32
+  #include "base/string.h"
+
+  #include <windows.h>
+#endif
+
+namespace app {
+
+namespace {
+
+void replace_file(const std::string& src, const std::string& dst)
+{
+#ifdef _WIN32
+  if (!MoveFileExW(base::from_utf8(src).c_str(),
+                   base::from_utf8(dst).c_str(),
+                   MOVEFILE_REPLACE_EXISTING)) {
+    throw base::Exception("Error replacing file %s", dst.c_str());
+  }
+#else
+  if (std::rename(src.c_str(), dst.c_str()) != 0)
+    throw base::Exception("Error replacing file %s", dst.c_str());
+#endif
+}
+
+} // anonymous namespace
+
+void write_file_atomically(const std::string& filename,
+                           const std::function<void(std::ostream&)>& write)
+{
+  // Unique name for each process and call
+  static std::atomic<unsigned> counter(0);
+  const std::string tmp =
+    fmt::format("{}.{}-{}.tmp", filename, int(base::get_current_process_id()), ++counter);
+
+  try {
+    {
+      std::ofstream s(FSTREAM_PATH(tmp), std::ofstream::binary);
+      write(s);
+      s.flush();
+      if (!s)
+        throw base::Exception("Error writing file %s", tmp.c_str());
+    }
+    replace_file(tmp, filename);
+  }
+  catch (...) {
+    if (base::is_file(tmp))
+      base::delete_file(tmp);
+    throw;
+  }
+}
+
+} // namespace app
@@ -0,0 +1,27 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_UTIL_ATOMIC_FILE_H_INCLUDED
+#define APP_UTIL_ATOMIC_FILE_H_INCLUDED
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+
+namespace app {
+
+// Creates or replaces the given file with the data written by the
+// "write" function. The data is written in a temporary file (in the
+// same directory) that replaces the file when everything was
+// written, so other threads/processes never read a partially
+// written file. Throws an exception if the file cannot be written.
+void write_file_atomically(const std::string& filename,
+                           const std::function<void(std::ostream&)>& write);
+
+} // namespace app
+
+#endif
@@ -0,0 +1,87 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#include "tests/app_test.h"
+
+#include "app/util/atomic_file.h"
+#include "base/fs.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace app;
+
+namespace {
+
+std::string read_file(const std::string& filename)
+{
+  std::ifstream f(filename, std::ios::binary);
+  std::stringstream s;
+  s << f.rdbuf();
+  return s.str();
+}
+
+int count_tmp_files(const std::string& dir)
+{
+  int n = 0;
+  for (const auto& fn : base::list_files(dir)) {
+    if (base::get_file_extension(fn) == "tmp")
+      ++n;
+  }
+  return n;
+}
+
+} // anonymous namespace
+
+TEST(AtomicFile, CreateAndReplace)
+{
+  const std::string dir = "atomic_file_test";
+  const std::string fn = base::join_path(dir, "file.txt");
+  if (!base::is_directory(dir))
+    base::make_directory(dir);
+
+  write_file_atomically(fn, [](std::ostream& s) { s << "abcd"; });
+  EXPECT_EQ("abcd", read_file(fn));
+
+  write_file_atomically(fn, [](std::ostream& s) { s << "ef"; });
+  EXPECT_EQ("ef", read_file(fn));
+  EXPECT_EQ(0, count_tmp_files(dir));
+
+  base::delete_file(fn);
+  base::remove_directory(dir);
+}
+
+TEST(AtomicFile, ErrorKeepsOldFile)
+{
+  const std::string dir = "atomic_file_test2";
+  const std::string fn = base::join_path(dir, "file.txt");
+  if (!base::is_directory(dir))
+    base::make_directory(dir);
+
+  write_file_atomically(fn, [](std::ostream& s) { s << "abcd"; });
+
+  // An exception while writing the file doesn't modify the old file
+  // and removes the temporary file
+  EXPECT_THROW(write_file_atomically(fn,
+                                     [](std::ostream& s) {
+                                       s << "partial";
+                                       throw std::runtime_error("error");
+                                     }),
+               std::runtime_error);
+  EXPECT_EQ("abcd", read_file(fn));
+  EXPECT_EQ(0, count_tmp_files(dir));
+
+  // Directory that doesn't exist
+  EXPECT_ANY_THROW(
+    write_file_atomically(base::join_path(dir, "none/file.txt"), [](std::ostream& s) { s << "a"; }));
+  EXPECT_EQ(0, count_tmp_files(dir));
+
+  base::delete_file(fn);
+  base::remove_directory(dir);
+}
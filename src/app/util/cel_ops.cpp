@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2024  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -89,6 +89,8 @@ void create_region_with_differences_templ(const Image* a,
                                           const gfx::Rect& bounds,
                                           gfx::Region& output)
 {
+  a->expand();
+  b->expand();
   for (int y = bounds.y; y < bounds.y2(); ++y) {
     for (int x = bounds.x; x < bounds.x2(); ++x) {
       if (get_pixel_fast<ImageTraits>(a, x, y) != get_pixel_fast<ImageTraits>(b, x, y)) {
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2024  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This program is distributed under the terms of
@@ -690,8 +690,11 @@ void Clipboard::paste(Context* ctx, const bool interactive, const gfx::Point* po
           auto srcLayers = srcSpr->allBrowsableLayers();
           auto dstLayers = dstSpr->allBrowsableLayers();
 
+          // Add all the new frames with one command
+          if (!srcRange.selectedFrames().empty())
+            api.addEmptyFrames(dstSpr, dstFrame, frame_t(srcRange.selectedFrames().size()));
+
           for (frame_t srcFrame : srcRange.selectedFrames()) {
-            api.addEmptyFrame(dstSpr, dstFrame);
             api.setFrameDuration(dstSpr, dstFrame, srcSpr->frameDuration(srcFrame));
 
             auto srcIt = srcLayers.begin();
@@ -748,8 +751,7 @@ void Clipboard::paste(Context* ctx, const bool interactive, const gfx::Point* po
             if (lastCel && maxFrame < lastCel->frame())
               maxFrame = lastCel->frame();
           }
-          while (dstSpr->totalFrames() < maxFrame + 1)
-            api.addEmptyFrame(dstSpr, dstSpr->totalFrames());
+          api.addEmptyFramesTo(dstSpr, maxFrame);
 
           for (Layer* srcLayer : srcLayers) {
             Layer* afterThis;
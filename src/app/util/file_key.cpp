@@ -0,0 +1,57 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "app/util/file_key.h"
+
+#include "fmt/format.h"
+
+#include <cstdint>
+
+#ifdef _WIN32
+  #include "base/string.h"
+
+  #include <windows.h>
+#else
+  #include <sys/stat.h>
+#endif
+
+namespace app {
+
+std::string get_file_key(const std::string& filename)
+{
+  uint64_t size, mtime;
+
+#ifdef _WIN32
+  WIN32_FILE_ATTRIBUTE_DATA data;
+  if (!GetFileAttributesExW(base::from_utf8(filename).c_str(), GetFileExInfoStandard, &data) ||
+      (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+    return std::string();
+  }
+  size = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+  // In 100-nanosecond intervals
+  mtime = (uint64_t(data.ftLastWriteTime.dwHighDateTime) << 32) |
+          data.ftLastWriteTime.dwLowDateTime;
+#else
+  struct stat st;
+  if (stat(filename.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+    return std::string();
+  size = uint64_t(st.st_size);
+  // In nanoseconds
+  #ifdef __APPLE__
+  mtime = uint64_t(st.st_mtimespec.tv_sec) * 1000000000ull + st.st_mtimespec.tv_nsec;
+  #else
+  mtime = uint64_t(st.st_mtim.tv_sec) * 1000000000ull + st.st_mtim.tv_nsec;
+  #endif
+#endif
+
+  return fmt::format("{}|{}", size, mtime);
+}
+
+} // namespace app
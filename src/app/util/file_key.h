@@ -0,0 +1,23 @@
+// Aseprite
+// Copyright (C) 2025  Igara Studio S.A.
+//
+// This program is distributed under the terms of
+// the End-User License Agreement for Aseprite.
+
+#ifndef APP_UTIL_FILE_KEY_H_INCLUDED
+#define APP_UTIL_FILE_KEY_H_INCLUDED
+#pragma once
+
+#include <string>
+
+namespace app {
+
+// Returns a string that changes each time the given file is modified
+// (its size and modification time with sub-second precision), so it
+// can be used to invalidate cached data of the file. Returns an
+// empty string if the file doesn't exist.
+std::string get_file_key(const std::string& filename);
+
+} // namespace app
+
+#endif
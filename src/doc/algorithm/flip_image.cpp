@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2023 Igara Studio S.A.
+// Copyright (c) 2023-2025 Igara Studio S.A.
 // Copyright (c) 2001-2018 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -29,6 +29,7 @@ namespace doc { namespace algorithm {
 template<typename ImageTraits>
 void flip_image_with_put_pixel_fast_templ(Image* image, const gfx::Rect& bounds, FlipType flipType)
 {
+  image->expand();
   switch (flipType) {
     case FlipHorizontal:
       for (int y = bounds.y; y < bounds.y2(); ++y) {
@@ -136,6 +137,7 @@ template<typename ImageTraits>
 void flip_image_with_mask_templ(Image* image, const Mask* mask, FlipType flipType, int bgcolor)
 {
   gfx::Rect bounds = mask->bounds();
+  image->expand();
 
   switch (flipType) {
     case FlipHorizontal: {
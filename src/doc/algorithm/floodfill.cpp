@@ -22,11 +22,22 @@
 #include "doc/primitives.h"
 #include "doc/primitives_fast.h"
 
+#include <algorithm>
 #include <climits>
 #include <cmath>
+#include <cstring>
 #include <limits>
 #include <vector>
 
+#if defined(__x86_64__) || defined(_WIN64)
+  #define DOC_FLOODFILL_USE_SSE2 1
+  #include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+  #include <intrin.h>
+#endif
+
 namespace doc { namespace algorithm {
 
 struct FLOODED_LINE { // store segments which have been flooded
@@ -45,11 +56,6 @@ static int flood_count; /* number of flooded segments */
 
 #define FLOOD_LINE(c)    (&flood_buf[c])
 
-static inline bool color_equal_32_raw(color_t c1, color_t c2)
-{
-  return (c1 == c2);
-}
-
 static inline bool color_equal_32(color_t c1, color_t c2, int tolerance)
 {
   if (tolerance == 0)
@@ -97,163 +103,374 @@ static inline bool color_equal_8(color_t c1, color_t c2, int tolerance)
     return ABS((int)c1 - (int)c2) <= tolerance;
 }
 
-template<typename ImageTraits>
-static inline bool color_equal(color_t c1, color_t c2, int tolerance)
+// Index of the lowest/highest bit set in a non-zero value
+static inline int lowest_bit(const uint32_t v)
 {
-  static_assert(false && sizeof(ImageTraits), "Invalid color comparison");
-  return false;
+  ASSERT(v);
+#ifdef _MSC_VER
+  unsigned long i;
+  _BitScanForward(&i, v);
+  return int(i);
+#else
+  return __builtin_ctz(v);
+#endif
 }
 
-template<>
-inline bool color_equal<RgbTraits>(color_t c1, color_t c2, int tolerance)
+static inline int highest_bit(const uint32_t v)
 {
-  return color_equal_32(c1, c2, tolerance);
+  ASSERT(v);
+#ifdef _MSC_VER
+  unsigned long i;
+  _BitScanReverse(&i, v);
+  return int(i);
+#else
+  return 31 - __builtin_clz(v);
+#endif
 }
 
-template<>
-inline bool color_equal<GrayscaleTraits>(color_t c1, color_t c2, int tolerance)
-{
-  return color_equal_16(c1, c2, tolerance);
-}
+// Matchers of pixels in a row of the image similar to the source
+// color. operator()(x) tests one pixel, and block(x) (when kBlock >
+// 0) tests kBlock pixels starting from x returning one bit for each
+// pixel similar to the source color.
+template<typename ImageTraits>
+class RowMatcher;
 
 template<>
-inline bool color_equal<IndexedTraits>(color_t c1, color_t c2, int tolerance)
-{
-  return color_equal_8(c1, c2, tolerance);
-}
+class RowMatcher<RgbTraits> {
+public:
+  RowMatcher(const Image* image, int y, color_t src, int tolerance)
+    : m_address((const uint32_t*)image->getPixelAddress(0, y))
+    , m_src(src)
+    , m_tolerance(tolerance)
+  {
+#ifdef DOC_FLOODFILL_USE_SSE2
+    m_vsrc = _mm_set1_epi32(int(src));
+    m_vtolerance = _mm_set1_epi8(char(std::min(tolerance, 255)));
+    m_transparent = (rgba_geta(src) == 0);
+#endif
+  }
 
-template<>
-inline bool color_equal<TilemapTraits>(color_t c1, color_t c2, int tolerance)
-{
-  return color_equal_32_raw(c1, c2);
-}
+  bool operator()(int x) const { return color_equal_32(m_address[x], m_src, m_tolerance); }
+
+#ifdef DOC_FLOODFILL_USE_SSE2
+  static constexpr int kBlock = 4;
+
+  int block(int x) const
+  {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i v = _mm_loadu_si128((const __m128i*)(m_address + x));
+    // Each channel must be in the tolerance range
+    const __m128i diff = _mm_or_si128(_mm_subs_epu8(v, m_vsrc), _mm_subs_epu8(m_vsrc, v));
+    const __m128i ok = _mm_cmpeq_epi8(_mm_subs_epu8(diff, m_vtolerance), zero);
+    __m128i r = _mm_cmpeq_epi32(ok, _mm_set1_epi32(-1));
+    // Two transparent colors are always equal
+    if (m_transparent) {
+      r = _mm_or_si128(
+        r,
+        _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(int(rgba_a_mask))), zero));
+    }
+    return _mm_movemask_ps(_mm_castsi128_ps(r));
+  }
+#else
+  static constexpr int kBlock = 0;
+  int block(int) const { return 0; }
+#endif
 
-/* flooder:
- *  Fills a horizontal line around the specified position, and adds it
- *  to the list of drawn segments. Returns the first x coordinate after
- *  the part of the line which it has dealt with.
- */
-static int flooder(const Image* image,
-                   const Mask* mask,
-                   int x,
-                   int y,
-                   const gfx::Rect& bounds,
-                   color_t src_color,
-                   int tolerance,
-                   void* data,
-                   AlgoHLine proc)
-{
-#define MASKED(u, v)                                                                               \
-  (mask && (!mask->bounds().contains(u, v) ||                                                      \
-            (mask->bitmap() && !get_pixel_fast<BitmapTraits>(mask->bitmap(),                       \
-                                                             (u) - mask->bounds().x,               \
-                                                             (v) - mask->bounds().y))))
+private:
+  const uint32_t* m_address;
+  color_t m_src;
+  int m_tolerance;
+#ifdef DOC_FLOODFILL_USE_SSE2
+  __m128i m_vsrc;
+  __m128i m_vtolerance;
+  bool m_transparent;
+#endif
+};
 
-  FLOODED_LINE* p;
-  int left = 0, right = 0;
-  int c;
+template<>
+class RowMatcher<GrayscaleTraits> {
+public:
+  RowMatcher(const Image* image, int y, color_t src, int tolerance)
+    : m_address((const uint16_t*)image->getPixelAddress(0, y))
+    , m_src(src)
+    , m_tolerance(tolerance)
+  {
+#ifdef DOC_FLOODFILL_USE_SSE2
+    m_vsrc = _mm_set1_epi16(short(src));
+    m_vtolerance = _mm_set1_epi8(char(std::min(tolerance, 255)));
+    m_transparent = (graya_geta(src) == 0);
+#endif
+  }
 
-  switch (image->pixelFormat()) {
-    case IMAGE_RGB: {
-      uint32_t* address = reinterpret_cast<uint32_t*>(image->getPixelAddress(0, y));
+  bool operator()(int x) const { return color_equal_16(m_address[x], m_src, m_tolerance); }
+
+#ifdef DOC_FLOODFILL_USE_SSE2
+  static constexpr int kBlock = 8;
+
+  int block(int x) const
+  {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i v = _mm_loadu_si128((const __m128i*)(m_address + x));
+    const __m128i diff = _mm_or_si128(_mm_subs_epu8(v, m_vsrc), _mm_subs_epu8(m_vsrc, v));
+    const __m128i ok = _mm_cmpeq_epi8(_mm_subs_epu8(diff, m_vtolerance), zero);
+    __m128i r = _mm_cmpeq_epi16(ok, _mm_set1_epi16(-1));
+    if (m_transparent) {
+      r = _mm_or_si128(
+        r,
+        _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(short(graya_a_mask))), zero));
+    }
+    // One byte per pixel
+    return _mm_movemask_epi8(_mm_packs_epi16(r, zero));
+  }
+#else
+  static constexpr int kBlock = 0;
+  int block(int) const { return 0; }
+#endif
 
-      // Check start pixel
-      if (!color_equal_32((int)*(address + x), src_color, tolerance) || MASKED(x, y))
-        return x + 1;
+private:
+  const uint16_t* m_address;
+  color_t m_src;
+  int m_tolerance;
+#ifdef DOC_FLOODFILL_USE_SSE2
+  __m128i m_vsrc;
+  __m128i m_vtolerance;
+  bool m_transparent;
+#endif
+};
 
-      // Work left from starting point
-      for (left = x - 1; left >= bounds.x; left--) {
-        if (!color_equal_32((int)*(address + left), src_color, tolerance) || MASKED(left, y))
-          break;
-      }
+template<>
+class RowMatcher<IndexedTraits> {
+public:
+  RowMatcher(const Image* image, int y, color_t src, int tolerance)
+    : m_address((const uint8_t*)image->getPixelAddress(0, y))
+    , m_src(src)
+    , m_tolerance(tolerance)
+  {
+#ifdef DOC_FLOODFILL_USE_SSE2
+    m_vsrc = _mm_set1_epi8(char(src));
+    m_vtolerance = _mm_set1_epi8(char(std::min(tolerance, 255)));
+#endif
+  }
 
-      // Work right from starting point
-      for (right = x + 1; right < bounds.x2(); right++) {
-        if (!color_equal_32((int)*(address + right), src_color, tolerance) || MASKED(right, y))
-          break;
-      }
-    } break;
+  bool operator()(int x) const { return color_equal_8(m_address[x], m_src, m_tolerance); }
 
-    case IMAGE_GRAYSCALE: {
-      uint16_t* address = reinterpret_cast<uint16_t*>(image->getPixelAddress(0, y));
+#ifdef DOC_FLOODFILL_USE_SSE2
+  static constexpr int kBlock = 16;
 
-      // Check start pixel
-      if (!color_equal_16((int)*(address + x), src_color, tolerance) || MASKED(x, y))
-        return x + 1;
+  int block(int x) const
+  {
+    const __m128i v = _mm_loadu_si128((const __m128i*)(m_address + x));
+    const __m128i diff = _mm_or_si128(_mm_subs_epu8(v, m_vsrc), _mm_subs_epu8(m_vsrc, v));
+    return _mm_movemask_epi8(
+      _mm_cmpeq_epi8(_mm_subs_epu8(diff, m_vtolerance), _mm_setzero_si128()));
+  }
+#else
+  static constexpr int kBlock = 0;
+  int block(int) const { return 0; }
+#endif
 
-      // Work left from starting point
-      for (left = x - 1; left >= bounds.x; left--) {
-        if (!color_equal_16((int)*(address + left), src_color, tolerance) || MASKED(left, y))
-          break;
-      }
+private:
+  const uint8_t* m_address;
+  color_t m_src;
+  int m_tolerance;
+#ifdef DOC_FLOODFILL_USE_SSE2
+  __m128i m_vsrc;
+  __m128i m_vtolerance;
+#endif
+};
 
-      // Work right from starting point
-      for (right = x + 1; right < bounds.x2(); right++) {
-        if (!color_equal_16((int)*(address + right), src_color, tolerance) || MASKED(right, y))
-          break;
-      }
-    } break;
+// Tiles are compared without tolerance
+template<>
+class RowMatcher<TilemapTraits> {
+public:
+  RowMatcher(const Image* image, int y, color_t src, int)
+    : m_address((const uint32_t*)image->getPixelAddress(0, y))
+    , m_src(src)
+  {
+#ifdef DOC_FLOODFILL_USE_SSE2
+    m_vsrc = _mm_set1_epi32(int(src));
+#endif
+  }
 
-    case IMAGE_INDEXED: {
-      uint8_t* address = image->getPixelAddress(0, y);
+  bool operator()(int x) const { return m_address[x] == m_src; }
 
-      // Check start pixel
-      if (!color_equal_8((int)*(address + x), src_color, tolerance) || MASKED(x, y))
-        return x + 1;
+#ifdef DOC_FLOODFILL_USE_SSE2
+  static constexpr int kBlock = 4;
 
-      // Work left from starting point
-      for (left = x - 1; left >= bounds.x; left--) {
-        if (!color_equal_8((int)*(address + left), src_color, tolerance) || MASKED(left, y))
-          break;
-      }
+  int block(int x) const
+  {
+    const __m128i v = _mm_loadu_si128((const __m128i*)(m_address + x));
+    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, m_vsrc)));
+  }
+#else
+  static constexpr int kBlock = 0;
+  int block(int) const { return 0; }
+#endif
 
-      // Work right from starting point
-      for (right = x + 1; right < bounds.x2(); right++) {
-        if (!color_equal_8((int)*(address + right), src_color, tolerance) || MASKED(right, y))
-          break;
-      }
-    } break;
+private:
+  const uint32_t* m_address;
+  color_t m_src;
+#ifdef DOC_FLOODFILL_USE_SSE2
+  __m128i m_vsrc;
+#endif
+};
 
-    case IMAGE_TILEMAP: {
-      // TODO add support for mask
+// Any other pixel format (compared pixel by pixel)
+template<>
+class RowMatcher<BitmapTraits> {
+public:
+  RowMatcher(const Image* image, int y, color_t src, int)
+    : m_image(image)
+    , m_y(y)
+    , m_src(src)
+  {
+  }
 
-      uint32_t* address = reinterpret_cast<uint32_t*>(image->getPixelAddress(0, y));
+  bool operator()(int x) const { return get_pixel(m_image, x, m_y) == m_src; }
 
-      // Check start pixel
-      if (!color_equal_32_raw((int)*(address + x), src_color))
-        return x + 1;
+  static constexpr int kBlock = 0;
+  int block(int) const { return 0; }
 
-      // Work left from starting point
-      for (left = x - 1; left >= bounds.x; left--) {
-        if (!color_equal_32_raw((int)*(address + left), src_color))
-          break;
-      }
+private:
+  const Image* m_image;
+  int m_y;
+  color_t m_src;
+};
 
-      // Work right from starting point
-      for (right = x + 1; right < bounds.x2(); right++) {
-        if (!color_equal_32_raw((int)*(address + right), src_color))
-          break;
-      }
-    } break;
+// Returns the first x in [x, end) where matcher(x) != match (or end
+// if all pixels in the span are equal to "match").
+template<bool match, typename Matcher>
+static int scan_right(const Matcher& matcher, int x, const int end)
+{
+  if constexpr (Matcher::kBlock > 0) {
+    constexpr int full = (1 << Matcher::kBlock) - 1;
+    for (; x + Matcher::kBlock <= end; x += Matcher::kBlock) {
+      const int bits = (match ? ~matcher.block(x) : matcher.block(x)) & full;
+      if (bits)
+        return x + lowest_bit(bits);
+    }
+  }
+  for (; x < end && matcher(x) == match; ++x)
+    ;
+  return x;
+}
 
-    default:
-      // Check start pixel
-      if (get_pixel(image, x, y) != src_color || MASKED(x, y))
-        return x + 1;
-
-      // Work left from starting point
-      for (left = x - 1; left >= bounds.x; left--) {
-        if (get_pixel(image, left, y) != src_color || MASKED(left, y))
-          break;
-      }
+// Returns the last x in [begin, x] where matcher(x) != match (or
+// begin-1 if all pixels in the span are equal to "match").
+template<bool match, typename Matcher>
+static int scan_left(const Matcher& matcher, int x, const int begin)
+{
+  if constexpr (Matcher::kBlock > 0) {
+    constexpr int full = (1 << Matcher::kBlock) - 1;
+    for (; x - Matcher::kBlock + 1 >= begin; x -= Matcher::kBlock) {
+      const int x0 = x - Matcher::kBlock + 1;
+      const int bits = (match ? ~matcher.block(x0) : matcher.block(x0)) & full;
+      if (bits)
+        return x0 + highest_bit(bits);
+    }
+  }
+  for (; x >= begin && matcher(x) == match; --x)
+    ;
+  return x;
+}
 
-      // Work right from starting point
-      for (right = x + 1; right < bounds.x2(); right++) {
-        if (get_pixel(image, right, y) != src_color || MASKED(right, y))
-          break;
-      }
+// Returns the first unselected pixel in [u, end) of the given row of
+// the mask bitmap (or end if all pixels are selected). Pixels are
+// tested a whole byte/64-bit word at a time.
+static int mask_scan_right(const uint8_t* bits, int u, const int end)
+{
+  for (; u < end && (u & 7); ++u) {
+    if (!(bits[u >> 3] & (1 << (u & 7))))
+      return u;
+  }
+  for (; u + 64 <= end; u += 64) {
+    uint64_t word;
+    std::memcpy(&word, bits + (u >> 3), sizeof(word));
+    if (word != ~uint64_t(0))
       break;
   }
+  for (; u + 8 <= end && bits[u >> 3] == 0xff; u += 8)
+    ;
+  for (; u < end && (bits[u >> 3] & (1 << (u & 7))); ++u)
+    ;
+  return u;
+}
+
+// Returns the last unselected pixel in [begin, u] of the given row of
+// the mask bitmap (or begin-1 if all pixels are selected).
+static int mask_scan_left(const uint8_t* bits, int u, const int begin)
+{
+  for (; u >= begin && (u & 7) != 7; --u) {
+    if (!(bits[u >> 3] & (1 << (u & 7))))
+      return u;
+  }
+  for (; u - 63 >= begin; u -= 64) {
+    uint64_t word;
+    std::memcpy(&word, bits + ((u - 63) >> 3), sizeof(word));
+    if (word != ~uint64_t(0))
+      break;
+  }
+  for (; u - 7 >= begin && bits[u >> 3] == 0xff; u -= 8)
+    ;
+  for (; u >= begin && (bits[u >> 3] & (1 << (u & 7))); --u)
+    ;
+  return u;
+}
+
+/* flooder:
+ *  Fills a horizontal line around the specified position, and adds it
+ *  to the list of drawn segments. Returns the first x coordinate after
+ *  the part of the line which it has dealt with.
+ */
+template<typename ImageTraits>
+static int flooder_templ(const Image* image,
+                         const Mask* mask,
+                         int x,
+                         int y,
+                         const gfx::Rect& bounds,
+                         color_t src_color,
+                         int tolerance,
+                         void* data,
+                         AlgoHLine proc)
+{
+  FLOODED_LINE* p;
+  int left = 0, right = 0;
+  int c;
+
+  // Limits of the span in this row
+  int begin = bounds.x;
+  int end = bounds.x2();
+  const uint8_t* maskBits = nullptr;
+  int maskX = 0;
+  if (mask) {
+    const gfx::Rect& maskBounds = mask->bounds();
+    if (y < maskBounds.y || y >= maskBounds.y2() || x < maskBounds.x || x >= maskBounds.x2())
+      return x + 1;
+
+    begin = std::max(begin, maskBounds.x);
+    end = std::min(end, maskBounds.x2());
+    if (mask->bitmap()) {
+      maskBits = mask->bitmap()->getPixelAddress(0, y - maskBounds.y);
+      maskX = maskBounds.x;
+    }
+  }
+
+  const RowMatcher<ImageTraits> matcher(image, y, src_color, tolerance);
+
+  // Work right from starting point (the first pixel that is not
+  // selected limits the span, so we test the mask first)
+  if (maskBits)
+    end = maskX + mask_scan_right(maskBits, x - maskX, end - maskX);
+  right = scan_right<true>(matcher, x, end);
+
+  // Check start pixel
+  if (right == x)
+    return x + 1;
+
+  // Work left from starting point
+  if (maskBits)
+    begin = maskX + mask_scan_left(maskBits, x - 1 - maskX, begin - maskX) + 1;
+  left = scan_left<true>(matcher, x - 1, begin);
 
   left++;
   right--;
@@ -291,6 +508,63 @@ static int flooder(const Image* image,
   return right + 2;
 }
 
+static int flooder(const Image* image,
+                   const Mask* mask,
+                   int x,
+                   int y,
+                   const gfx::Rect& bounds,
+                   color_t src_color,
+                   int tolerance,
+                   void* data,
+                   AlgoHLine proc)
+{
+  switch (image->pixelFormat()) {
+    case IMAGE_RGB:
+      return flooder_templ<RgbTraits>(image, mask, x, y, bounds, src_color, tolerance, data, proc);
+    case IMAGE_GRAYSCALE:
+      return flooder_templ<GrayscaleTraits>(image,
+                                            mask,
+                                            x,
+                                            y,
+                                            bounds,
+                                            src_color,
+                                            tolerance,
+                                            data,
+                                            proc);
+    case IMAGE_INDEXED:
+      return flooder_templ<IndexedTraits>(image,
+                                          mask,
+                                          x,
+                                          y,
+                                          bounds,
+                                          src_color,
+                                          tolerance,
+                                          data,
+                                          proc);
+    case IMAGE_TILEMAP:
+      // TODO add support for mask
+      return flooder_templ<TilemapTraits>(image,
+                                          nullptr,
+                                          x,
+                                          y,
+                                          bounds,
+                                          src_color,
+                                          tolerance,
+                                          data,
+                                          proc);
+    default:
+      return flooder_templ<BitmapTraits>(image,
+                                         mask,
+                                         x,
+                                         y,
+                                         bounds,
+                                         src_color,
+                                         tolerance,
+                                         data,
+                                         proc);
+  }
+}
+
 /* check_flood_line:
  *  Checks a line segment, using the scratch buffer is to store a list of
  *  segments which have already been drawn in order to minimise the required
@@ -343,24 +617,18 @@ static void replace_color(const Image* image,
                           void* data,
                           AlgoHLine proc)
 {
-  typename ImageTraits::address_t address;
-
   for (int y = bounds.y; y < bounds.y2(); ++y) {
-    address = reinterpret_cast<typename ImageTraits::address_t>(
-      image->getPixelAddress(bounds.x, y));
+    const RowMatcher<ImageTraits> matcher(image, y, src_color, tolerance);
 
-    for (int x = bounds.x; x < bounds.x2(); ++x, ++address) {
-      int right = -1;
+    for (int x = bounds.x; x < bounds.x2();) {
+      // Skip different colors and fill the span of similar colors
+      x = scan_right<false>(matcher, x, bounds.x2());
+      if (x == bounds.x2())
+        break;
 
-      if (color_equal<ImageTraits>((int)(*address), src_color, tolerance)) {
-        ++address;
-        for (right = x + 1; right < bounds.x2(); ++right, ++address) {
-          if (!color_equal<ImageTraits>((int)(*address), src_color, tolerance))
-            break;
-        }
-        (*proc)(x, y, right - 1, data);
-        x = right;
-      }
+      const int right = scan_right<true>(matcher, x, bounds.x2());
+      (*proc)(x, y, right - 1, data);
+      x = right;
     }
   }
 }
@@ -0,0 +1,117 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "gtest/gtest.h"
+
+#include "doc/algorithm/floodfill.h"
+#include "doc/image.h"
+#include "doc/image_ref.h"
+#include "doc/mask.h"
+#include "doc/primitives.h"
+
+using namespace doc;
+using namespace gfx;
+
+static void fill_hline(int x1, int y, int x2, void* data)
+{
+  auto image = (Image*)data;
+  for (int x = x1; x <= x2; ++x)
+    image->putPixel(x, y, image->getPixel(x, y) + 1);
+}
+
+static void expect_filled(const Image* filled, const std::vector<int>& rows)
+{
+  for (int y = 0; y < filled->height(); ++y) {
+    for (int x = 0; x < filled->width(); ++x) {
+      const int expected = ((rows[y] >> (filled->width() - x - 1)) & 1);
+      ASSERT_EQ(expected, int(filled->getPixel(x, y))) << x << "," << y;
+    }
+  }
+}
+
+TEST(FloodFill, ContiguousWithTolerance)
+{
+  // The wall in the 21st column splits the image in two areas
+  ImageRef image(Image::create(IMAGE_RGB, 40, 3));
+  ImageRef filled(Image::create(IMAGE_INDEXED, 40, 3));
+  clear_image(image.get(), rgba(100, 100, 100, 255));
+  clear_image(filled.get(), 0);
+  put_pixel(image.get(), 5, 1, rgba(104, 100, 96, 255));
+  fill_rect(image.get(), 20, 0, 20, 2, rgba(0, 0, 0, 255));
+
+  algorithm::floodfill(image.get(),
+                       nullptr,
+                       2,
+                       1,
+                       image->bounds(),
+                       rgba(100, 100, 100, 255),
+                       4,
+                       true,
+                       false,
+                       filled.get(),
+                       fill_hline);
+
+  for (int y = 0; y < 3; ++y)
+    for (int x = 0; x < 40; ++x)
+      ASSERT_EQ(x < 20 ? 1 : 0, int(get_pixel(filled.get(), x, y))) << x << "," << y;
+}
+
+TEST(FloodFill, Mask)
+{
+  ImageRef image(Image::create(IMAGE_INDEXED, 8, 3));
+  ImageRef filled(Image::create(IMAGE_INDEXED, 8, 3));
+  clear_image(image.get(), 1);
+  clear_image(filled.get(), 0);
+
+  Mask mask;
+  mask.replace(Rect(1, 0, 6, 3));
+  mask.subtract(Rect(4, 1, 1, 1));
+
+  algorithm::floodfill(image.get(),
+                       &mask,
+                       2,
+                       1,
+                       image->bounds(),
+                       1,
+                       0,
+                       true,
+                       false,
+                       filled.get(),
+                       fill_hline);
+
+  expect_filled(filled.get(), { 0b01111110, 0b01110110, 0b01111110 });
+}
+
+TEST(FloodFill, NonContiguous)
+{
+  ImageRef image(Image::create(IMAGE_INDEXED, 40, 2));
+  ImageRef filled(Image::create(IMAGE_INDEXED, 40, 2));
+  clear_image(image.get(), 1);
+  clear_image(filled.get(), 0);
+  fill_rect(image.get(), 3, 0, 30, 1, 2);
+
+  algorithm::floodfill(image.get(),
+                       nullptr,
+                       0,
+                       0,
+                       image->bounds(),
+                       1,
+                       0,
+                       false,
+                       false,
+                       filled.get(),
+                       fill_hline);
+
+  for (int y = 0; y < 2; ++y)
+    for (int x = 0; x < 40; ++x)
+      ASSERT_EQ(x >= 3 && x <= 30 ? 0 : 1, int(get_pixel(filled.get(), x, y))) << x << "," << y;
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
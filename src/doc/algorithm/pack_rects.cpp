@@ -0,0 +1,559 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "doc/algorithm/pack_rects.h"
+
+#include "base/task.h"
+#include "doc/algorithm/parallel_for.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <tuple>
+
+namespace doc { namespace algorithm {
+
+namespace {
+
+// MaxRects keeps a list of free rectangles that grows with the number
+// of packed rectangles, so we use it only for a limited number of
+// rectangles (skyline is always used).
+constexpr int kMaxRectsLimit = 1000;
+
+enum class Method {
+  Skyline,
+  BestShortSideFit,
+  BestLongSideFit,
+  BestAreaFit,
+  BottomLeft,
+};
+
+enum class Order {
+  Area,
+  MaxSide,
+  Height,
+  Width,
+};
+
+// Rectangle to pack (its size includes the shape padding)
+struct Item {
+  int index;
+  int w, h;
+};
+
+struct Candidate {
+  int binW, binH;
+  Method method;
+  Order order;
+};
+
+struct Packing {
+  // Position of each item, x < 0 if the item wasn't placed
+  std::vector<gfx::Point> pos;
+  int64_t placedArea = 0;
+  int usedW = 0;
+  int usedH = 0;
+};
+
+// Skyline bottom-left packer: the top edge of the packed rectangles
+// is a list of horizontal segments, and each new rectangle is placed
+// over the segment where its bottom edge is lower.
+class SkylineBin {
+public:
+  SkylineBin(int w, int h) : m_w(w), m_h(h) { m_nodes.push_back(Node{ 0, 0, w }); }
+
+  bool insert(int w, int h, gfx::Point& pt)
+  {
+    int bestI = -1;
+    int bestY = 0;
+    int bestY2 = INT_MAX;
+    int bestW = INT_MAX;
+    for (int i = 0; i < int(m_nodes.size()); ++i) {
+      int y;
+      if (fit(i, w, h, y) &&
+          (y + h < bestY2 || (y + h == bestY2 && m_nodes[i].w < bestW))) {
+        bestI = i;
+        bestY = y;
+        bestY2 = y + h;
+        bestW = m_nodes[i].w;
+      }
+    }
+    if (bestI < 0)
+      return false;
+
+    pt = gfx::Point(m_nodes[bestI].x, bestY);
+    m_nodes.insert(m_nodes.begin() + bestI, Node{ pt.x, bestY2, w });
+
+    // Shrink/remove the segments covered by the new one
+    for (int i = bestI + 1; i < int(m_nodes.size());) {
+      Node& node = m_nodes[i];
+      const int prevX2 = m_nodes[i - 1].x + m_nodes[i - 1].w;
+      if (node.x >= prevX2)
+        break;
+
+      const int shrink = prevX2 - node.x;
+      node.x += shrink;
+      node.w -= shrink;
+      if (node.w > 0)
+        break;
+      m_nodes.erase(m_nodes.begin() + i);
+    }
+
+    // Merge segments at the same height
+    for (int i = 0; i + 1 < int(m_nodes.size());) {
+      if (m_nodes[i].y == m_nodes[i + 1].y) {
+        m_nodes[i].w += m_nodes[i + 1].w;
+        m_nodes.erase(m_nodes.begin() + i + 1);
+      }
+      else
+        ++i;
+    }
+    return true;
+  }
+
+private:
+  struct Node {
+    int x, y, w;
+  };
+
+  // Returns true if the rectangle fits starting from the i-th
+  // segment, "y" is where it's placed (over all the segments it
+  // covers).
+  bool fit(int i, const int w, const int h, int& y) const
+  {
+    if (m_nodes[i].x + w > m_w)
+      return false;
+
+    y = m_nodes[i].y;
+    for (int widthLeft = w; widthLeft > 0; ++i) {
+      y = std::max(y, m_nodes[i].y);
+      if (y + h > m_h)
+        return false;
+      widthLeft -= m_nodes[i].w;
+    }
+    return true;
+  }
+
+  int m_w, m_h;
+  std::vector<Node> m_nodes;
+};
+
+// MaxRects packer: keeps the list of maximal free rectangles, and
+// places each new rectangle in the free rectangle with the best
+// score for the given heuristic.
+class MaxRectsBin {
+public:
+  MaxRectsBin(int w, int h) { m_free.push_back(gfx::Rect(0, 0, w, h)); }
+
+  bool insert(const int w, const int h, const Method method, gfx::Point& pt)
+  {
+    int bestI = -1;
+    int64_t best1 = INT64_MAX;
+    int64_t best2 = INT64_MAX;
+    for (int i = 0; i < int(m_free.size()); ++i) {
+      const gfx::Rect& rc = m_free[i];
+      if (rc.w < w || rc.h < h)
+        continue;
+
+      const int64_t dw = rc.w - w;
+      const int64_t dh = rc.h - h;
+      int64_t score1, score2;
+      switch (method) {
+        case Method::BestShortSideFit:
+          score1 = std::min(dw, dh);
+          score2 = std::max(dw, dh);
+          break;
+        case Method::BestLongSideFit:
+          score1 = std::max(dw, dh);
+          score2 = std::min(dw, dh);
+          break;
+        case Method::BestAreaFit:
+          score1 = int64_t(rc.w) * rc.h - int64_t(w) * h;
+          score2 = std::min(dw, dh);
+          break;
+        default:
+          score1 = rc.y + h;
+          score2 = rc.x;
+          break;
+      }
+      if (score1 < best1 || (score1 == best1 && score2 < best2)) {
+        bestI = i;
+        best1 = score1;
+        best2 = score2;
+      }
+    }
+    if (bestI < 0)
+      return false;
+
+    const gfx::Rect used(m_free[bestI].x, m_free[bestI].y, w, h);
+    pt = used.origin();
+    splitFreeRects(used);
+    return true;
+  }
+
+private:
+  void splitFreeRects(const gfx::Rect& used)
+  {
+    std::vector<gfx::Rect> oldRects;
+    std::vector<gfx::Rect> newRects;
+    oldRects.reserve(m_free.size());
+
+    for (const gfx::Rect& rc : m_free) {
+      if (!rc.intersects(used)) {
+        oldRects.push_back(rc);
+        continue;
+      }
+      if (used.x > rc.x)
+        newRects.push_back(gfx::Rect(rc.x, rc.y, used.x - rc.x, rc.h));
+      if (used.x2() < rc.x2())
+        newRects.push_back(gfx::Rect(used.x2(), rc.y, rc.x2() - used.x2(), rc.h));
+      if (used.y > rc.y)
+        newRects.push_back(gfx::Rect(rc.x, rc.y, rc.w, used.y - rc.y));
+      if (used.y2() < rc.y2())
+        newRects.push_back(gfx::Rect(rc.x, used.y2(), rc.w, rc.y2() - used.y2()));
+    }
+
+    // Old rectangles are not contained by other old rectangles, so
+    // we only have to compare new rectangles with all the others.
+    std::vector<bool> removedNew(newRects.size(), false);
+    for (size_t i = 0; i < newRects.size(); ++i) {
+      for (size_t j = 0; j < newRects.size() && !removedNew[i]; ++j) {
+        if (i != j && !removedNew[j] && newRects[j].contains(newRects[i]))
+          removedNew[i] = true;
+      }
+      for (size_t j = 0; j < oldRects.size() && !removedNew[i]; ++j) {
+        if (oldRects[j].contains(newRects[i]))
+          removedNew[i] = true;
+      }
+    }
+
+    m_free.clear();
+    for (const gfx::Rect& rc : oldRects) {
+      bool contained = false;
+      for (size_t j = 0; j < newRects.size() && !contained; ++j)
+        contained = (!removedNew[j] && newRects[j].contains(rc));
+      if (!contained)
+        m_free.push_back(rc);
+    }
+    for (size_t i = 0; i < newRects.size(); ++i) {
+      if (!removedNew[i])
+        m_free.push_back(newRects[i]);
+    }
+  }
+
+  std::vector<gfx::Rect> m_free;
+};
+
+std::vector<int> sort_items(const std::vector<Item>& items, const Order order)
+{
+  std::vector<int> indexes(items.size());
+  for (int i = 0; i < int(items.size()); ++i)
+    indexes[i] = i;
+
+  auto key = [&items, order](const int i) {
+    const Item& item = items[i];
+    switch (order) {
+      case Order::Area:    return std::make_pair(int64_t(item.w) * item.h, int64_t(item.h));
+      case Order::MaxSide: return std::make_pair(int64_t(std::max(item.w, item.h)),
+                                                 int64_t(std::min(item.w, item.h)));
+      case Order::Height:  return std::make_pair(int64_t(item.h), int64_t(item.w));
+      default:             return std::make_pair(int64_t(item.w), int64_t(item.h));
+    }
+  };
+  std::stable_sort(indexes.begin(), indexes.end(), [&key](const int a, const int b) {
+    return key(a) > key(b);
+  });
+  return indexes;
+}
+
+Packing pack_candidate(const std::vector<Item>& items, const Candidate& candidate)
+{
+  Packing packing;
+  packing.pos.assign(items.size(), gfx::Point(-1, -1));
+
+  auto place = [&packing, &items](const int i, const gfx::Point& pt) {
+    const Item& item = items[i];
+    packing.pos[i] = pt;
+    packing.placedArea += int64_t(item.w) * item.h;
+    packing.usedW = std::max(packing.usedW, pt.x + item.w);
+    packing.usedH = std::max(packing.usedH, pt.y + item.h);
+  };
+
+  gfx::Point pt;
+  if (candidate.method == Method::Skyline) {
+    SkylineBin bin(candidate.binW, candidate.binH);
+    for (const int i : sort_items(items, candidate.order)) {
+      if (bin.insert(items[i].w, items[i].h, pt))
+        place(i, pt);
+    }
+  }
+  else {
+    MaxRectsBin bin(candidate.binW, candidate.binH);
+    for (const int i : sort_items(items, candidate.order)) {
+      if (bin.insert(items[i].w, items[i].h, candidate.method, pt))
+        place(i, pt);
+    }
+  }
+  return packing;
+}
+
+void add_skyline_candidates(std::vector<Candidate>& candidates, const int binW, const int binH)
+{
+  for (Order order : { Order::Area, Order::MaxSide, Order::Height, Order::Width })
+    candidates.push_back(Candidate{ binW, binH, Method::Skyline, order });
+}
+
+void add_maxrects_candidates(std::vector<Candidate>& candidates, const int binW, const int binH)
+{
+  for (Method method : { Method::BestShortSideFit,
+                         Method::BestLongSideFit,
+                         Method::BestAreaFit,
+                         Method::BottomLeft }) {
+    for (Order order : { Order::Area, Order::MaxSide })
+      candidates.push_back(Candidate{ binW, binH, method, order });
+  }
+}
+
+// Packs the items with each candidate in parallel.
+std::vector<Packing> pack_candidates(const std::vector<Item>& items,
+                                     const std::vector<Candidate>& candidates,
+                                     base::task_token* token)
+{
+  const int n = int(candidates.size());
+  std::vector<Packing> results(n);
+
+  parallel_for(
+    n,
+    [&](int i) { results[i] = pack_candidate(items, candidates[i]); },
+    token);
+  return results;
+}
+
+// Packs all items in a bin of "binW" width (or several widths to
+// choose the best one if binW is 0) and unlimited height.
+Packing pack_best_fit(const std::vector<Item>& items, int binW, base::task_token* token)
+{
+  int64_t area = 0;
+  int64_t sumW = 0;
+  int64_t sumH = 0;
+  int maxW = 0;
+  for (const Item& item : items) {
+    area += int64_t(item.w) * item.h;
+    sumW += item.w;
+    sumH += item.h;
+    maxW = std::max(maxW, item.w);
+  }
+  const int binH = int(std::min<int64_t>(sumH, INT_MAX / 4));
+
+  std::vector<int> widths;
+  if (binW > 0) {
+    widths.push_back(binW);
+  }
+  else {
+    auto addWidth = [&](int64_t w) {
+      w = std::clamp<int64_t>(w, maxW, std::max<int64_t>(maxW, std::min<int64_t>(sumW, INT_MAX / 4)));
+      if (std::find(widths.begin(), widths.end(), int(w)) == widths.end())
+        widths.push_back(int(w));
+    };
+    const double side = std::sqrt(double(area));
+    addWidth(maxW);
+    for (int k = -3; k <= 5; ++k)
+      addWidth(int64_t(side * std::pow(1.15, k)));
+  }
+
+  // All items placed (they can be wider than a given binW), smallest
+  // area, and the most squared texture (ties are resolved with the
+  // candidate order to get a deterministic result)
+  auto score = [](const Packing& p) {
+    return std::make_tuple(-p.placedArea, int64_t(p.usedW) * p.usedH, std::max(p.usedW, p.usedH));
+  };
+  auto best_result = [&score](const std::vector<Packing>& results) {
+    int best = 0;
+    for (int i = 1; i < int(results.size()); ++i) {
+      if (score(results[i]) < score(results[best]))
+        best = i;
+    }
+    return best;
+  };
+
+  // Skyline is fast enough to try all widths
+  std::vector<Candidate> candidates;
+  for (int w : widths)
+    add_skyline_candidates(candidates, w, binH);
+
+  std::vector<Packing> results = pack_candidates(items, candidates, token);
+  if (token && token->canceled())
+    return Packing();
+  int best = best_result(results);
+
+  // MaxRects is tried only with the best width found by skyline
+  if (int(items.size()) <= kMaxRectsLimit) {
+    std::vector<Candidate> maxRectsCandidates;
+    add_maxrects_candidates(maxRectsCandidates, candidates[best].binW, binH);
+
+    std::vector<Packing> maxRectsResults = pack_candidates(items, maxRectsCandidates, token);
+    if (token && token->canceled())
+      return Packing();
+
+    const int i = best_result(maxRectsResults);
+    if (score(maxRectsResults[i]) < score(results[best])) {
+      results = std::move(maxRectsResults);
+      best = i;
+    }
+  }
+
+  Packing packing = std::move(results[best]);
+
+  // Items wider than the given width are placed at the bottom
+  for (int i = 0; i < int(items.size()); ++i) {
+    if (packing.pos[i].x >= 0)
+      continue;
+    packing.pos[i] = gfx::Point(0, packing.usedH);
+    packing.usedW = std::max(packing.usedW, items[i].w);
+    packing.usedH += items[i].h;
+  }
+  return packing;
+}
+
+// Packs the items in pages of binW x binH. Returns the page of each
+// item (and its position in "packing").
+std::vector<int> pack_pages(const std::vector<Item>& items,
+                            const int binW,
+                            const int binH,
+                            Packing& packing,
+                            base::task_token* token)
+{
+  std::vector<int> pages(items.size(), 0);
+  packing.pos.assign(items.size(), gfx::Point(-1, -1));
+
+  // Indexes of "items" that are not placed yet
+  std::vector<int> remaining(items.size());
+  for (int i = 0; i < int(items.size()); ++i)
+    remaining[i] = i;
+
+  for (int page = 0; !remaining.empty(); ++page) {
+    if (token && token->canceled())
+      break;
+
+    std::vector<Item> pageItems;
+    for (int i : remaining)
+      pageItems.push_back(items[i]);
+
+    std::vector<Candidate> candidates;
+    add_skyline_candidates(candidates, binW, binH);
+    if (int(pageItems.size()) <= kMaxRectsLimit)
+      add_maxrects_candidates(candidates, binW, binH);
+    std::vector<Packing> results = pack_candidates(pageItems, candidates, token);
+
+    // The candidate that places more pixels in this page
+    int best = 0;
+    for (int i = 1; i < int(results.size()); ++i) {
+      if (results[i].placedArea > results[best].placedArea)
+        best = i;
+    }
+    const Packing& result = results[best];
+
+    // The first item doesn't fit in a page, so it uses a page for itself
+    if (result.placedArea == 0) {
+      pages[remaining[0]] = page;
+      packing.pos[remaining[0]] = gfx::Point(0, 0);
+      remaining.erase(remaining.begin());
+      continue;
+    }
+
+    std::vector<int> next;
+    for (int j = 0; j < int(remaining.size()); ++j) {
+      const int i = remaining[j];
+      if (result.pos[j].x >= 0) {
+        pages[i] = page;
+        packing.pos[i] = result.pos[j];
+      }
+      else
+        next.push_back(i);
+    }
+    remaining = std::move(next);
+  }
+  return pages;
+}
+
+} // anonymous namespace
+
+PackedRects pack_rects(const std::vector<gfx::Size>& sizes,
+                       const gfx::Size& textureSize,
+                       const int borderPadding,
+                       const int shapePadding,
+                       base::task_token* token)
+{
+  PackedRects result;
+  result.pages = 1;
+  result.bounds.resize(sizes.size());
+  result.page.assign(sizes.size(), 0);
+
+  // We pack columns instead of rows when only the height is given
+  const bool transposed = (textureSize.w == 0 && textureSize.h > 0);
+  const int fixedW = (transposed ? textureSize.h : textureSize.w);
+  const int fixedH = (transposed ? 0 : textureSize.h);
+
+  std::vector<Item> items;
+  for (int i = 0; i < int(sizes.size()); ++i) {
+    const gfx::Size& size = sizes[i];
+    if (size.w <= 0 || size.h <= 0) {
+      result.bounds[i] = gfx::Rect(borderPadding, borderPadding, size.w, size.h);
+      continue;
+    }
+    if (transposed)
+      items.push_back(Item{ i, size.h + shapePadding, size.w + shapePadding });
+    else
+      items.push_back(Item{ i, size.w + shapePadding, size.h + shapePadding });
+  }
+
+  Packing packing;
+  gfx::Size size;
+  if (fixedW > 0 && fixedH > 0) {
+    const std::vector<int> pages = pack_pages(items,
+                                              fixedW - 2 * borderPadding + shapePadding,
+                                              fixedH - 2 * borderPadding + shapePadding,
+                                              packing,
+                                              token);
+    for (int i = 0; i < int(items.size()); ++i) {
+      result.page[items[i].index] = pages[i];
+      result.pages = std::max(result.pages, pages[i] + 1);
+    }
+    size = gfx::Size(fixedW, fixedH);
+  }
+  else if (!items.empty()) {
+    packing = pack_best_fit(items, (fixedW > 0 ? fixedW - 2 * borderPadding + shapePadding : 0), token);
+    size.w = (fixedW > 0 ? fixedW : packing.usedW - shapePadding + 2 * borderPadding);
+    size.h = packing.usedH - shapePadding + 2 * borderPadding;
+  }
+  else {
+    size = gfx::Size(std::max(fixedW, 2 * borderPadding), 2 * borderPadding);
+  }
+
+  if (token && token->canceled())
+    return result;
+
+  for (int i = 0; i < int(items.size()); ++i) {
+    const gfx::Point& pt = packing.pos[i];
+    const gfx::Size& itemSize = sizes[items[i].index];
+    if (transposed)
+      result.bounds[items[i].index] =
+        gfx::Rect(borderPadding + pt.y, borderPadding + pt.x, itemSize.w, itemSize.h);
+    else
+      result.bounds[items[i].index] =
+        gfx::Rect(borderPadding + pt.x, borderPadding + pt.y, itemSize.w, itemSize.h);
+  }
+
+  result.size = (transposed ? gfx::Size(size.h, size.w) : size);
+  return result;
+}
+
+}} // namespace doc::algorithm
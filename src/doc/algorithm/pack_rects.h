@@ -0,0 +1,50 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef DOC_ALGORITHM_PACK_RECTS_H_INCLUDED
+#define DOC_ALGORITHM_PACK_RECTS_H_INCLUDED
+#pragma once
+
+#include "gfx/rect.h"
+#include "gfx/size.h"
+
+#include <vector>
+
+namespace base {
+class task_token;
+}
+
+namespace doc { namespace algorithm {
+
+struct PackedRects {
+  // Size of the texture (of each page)
+  gfx::Size size;
+  int pages = 0;
+  // Bounds and page of each rectangle (in the same order of the
+  // given sizes)
+  std::vector<gfx::Rect> bounds;
+  std::vector<int> page;
+};
+
+// Packs rectangles of the given sizes in a texture. If the width or
+// the height of "textureSize" is 0, that dimension is calculated to
+// get the smallest texture. If both dimensions are given and the
+// rectangles don't fit in one texture, the remaining rectangles are
+// packed in more pages of the same size.
+//
+// Several packers (skyline, and MaxRects with different heuristics
+// when there are not too many rectangles) and texture sizes are
+// evaluated in parallel, the result is deterministic anyway (it
+// doesn't depend on the number of threads).
+PackedRects pack_rects(const std::vector<gfx::Size>& sizes,
+                       const gfx::Size& textureSize,
+                       int borderPadding,
+                       int shapePadding,
+                       base::task_token* token = nullptr);
+
+}} // namespace doc::algorithm
+
+#endif
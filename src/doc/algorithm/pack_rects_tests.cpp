@@ -0,0 +1,84 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "gtest/gtest.h"
+
+#include "doc/algorithm/pack_rects.h"
+
+using namespace doc::algorithm;
+using namespace gfx;
+
+static std::vector<Size> test_sizes(int n)
+{
+  std::vector<Size> sizes;
+  for (int i = 0; i < n; ++i)
+    sizes.push_back(Size(3 + (i * 7) % 29, 2 + (i * 13) % 31));
+  return sizes;
+}
+
+// Checks that all rectangles are inside the texture (with the
+// border) and separated by the shape padding.
+static void expect_valid_packing(const std::vector<Size>& sizes,
+                                 const PackedRects& packed,
+                                 int borderPadding,
+                                 int shapePadding)
+{
+  ASSERT_EQ(sizes.size(), packed.bounds.size());
+  ASSERT_EQ(sizes.size(), packed.page.size());
+
+  const Rect area(borderPadding,
+                  borderPadding,
+                  packed.size.w - 2 * borderPadding,
+                  packed.size.h - 2 * borderPadding);
+
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    const Rect& rc = packed.bounds[i];
+    EXPECT_EQ(sizes[i], rc.size());
+    EXPECT_TRUE(area.contains(rc)) << i;
+    EXPECT_TRUE(packed.page[i] >= 0 && packed.page[i] < packed.pages) << i;
+
+    for (size_t j = i + 1; j < sizes.size(); ++j) {
+      if (packed.page[i] == packed.page[j]) {
+        EXPECT_FALSE(Rect(rc).enlarge(shapePadding).intersects(Rect(packed.bounds[j]))) << i << "," << j;
+      }
+    }
+  }
+}
+
+TEST(PackRects, BestFit)
+{
+  const auto sizes = test_sizes(200);
+  const PackedRects packed = pack_rects(sizes, Size(0, 0), 2, 1);
+  EXPECT_EQ(1, packed.pages);
+  expect_valid_packing(sizes, packed, 2, 1);
+}
+
+TEST(PackRects, FixedWidth)
+{
+  const auto sizes = test_sizes(100);
+  PackedRects packed = pack_rects(sizes, Size(128, 0), 1, 0);
+  EXPECT_EQ(128, packed.size.w);
+  expect_valid_packing(sizes, packed, 1, 0);
+
+  packed = pack_rects(sizes, Size(0, 128), 1, 0);
+  EXPECT_EQ(128, packed.size.h);
+  expect_valid_packing(sizes, packed, 1, 0);
+}
+
+TEST(PackRects, Pages)
+{
+  const auto sizes = test_sizes(300);
+  const PackedRects packed = pack_rects(sizes, Size(64, 64), 0, 2);
+  EXPECT_EQ(Size(64, 64), packed.size);
+  EXPECT_LT(1, packed.pages);
+  expect_valid_packing(sizes, packed, 0, 2);
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,133 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "doc/algorithm/parallel_for.h"
+
+#include "base/task.h"
+#include "base/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace doc { namespace algorithm {
+
+namespace {
+
+std::size_t workers_pool_size()
+{
+  return std::max(1u, std::thread::hardware_concurrency()) - 1;
+}
+
+// Threads shared by all parallel_for() calls (created the first time
+// they are needed).
+base::thread_pool& workers_pool()
+{
+  static base::thread_pool pool(workers_pool_size());
+  return pool;
+}
+
+// State of one parallel_for() call shared with its pool jobs. Jobs
+// can start after the call returns (e.g. if the pool threads were
+// busy), so "func" and "token" are used only by jobs that start
+// before "closed" is true.
+struct ParallelFor {
+  const int n;
+  const std::function<void(int)>* func;
+  base::task_token* token;
+  std::atomic<int> next{ 0 };
+  std::atomic<bool> failed{ false };
+  std::exception_ptr error;
+  std::mutex mutex;
+  std::condition_variable runningCv;
+  int running = 0;
+  bool closed = false;
+
+  ParallelFor(int n, const std::function<void(int)>* func, base::task_token* token)
+    : n(n)
+    , func(func)
+    , token(token)
+  {
+  }
+
+  // Processes items until there are no more items.
+  void work()
+  {
+    try {
+      int i;
+      while (!failed && (i = next++) < n) {
+        if (token && token->canceled())
+          break;
+        (*func)(i);
+      }
+    }
+    catch (...) {
+      const std::lock_guard lock(mutex);
+      if (!error)
+        error = std::current_exception();
+      failed = true;
+    }
+  }
+};
+
+} // anonymous namespace
+
+void parallel_for(const int n, const std::function<void(int)>& func, base::task_token* token)
+{
+  if (n <= 0)
+    return;
+
+  auto state = std::make_shared<ParallelFor>(n, &func, token);
+
+  const int njobs = std::min(int(workers_pool_size()), n - 1);
+  for (int i = 0; i < njobs; ++i) {
+    try {
+      workers_pool().execute([state]() {
+        {
+          const std::lock_guard lock(state->mutex);
+          if (state->closed)
+            return;
+          ++state->running;
+        }
+        state->work();
+        {
+          const std::lock_guard lock(state->mutex);
+          if (--state->running == 0)
+            state->runningCv.notify_all();
+        }
+      });
+    }
+    catch (...) {
+      // The job wasn't queued, the caller will process its items.
+      break;
+    }
+  }
+
+  state->work();
+
+  // Wait the jobs that are still processing items (jobs that didn't
+  // start yet will do nothing).
+  {
+    std::unique_lock lock(state->mutex);
+    state->closed = true;
+    state->runningCv.wait(lock, [&state] { return state->running == 0; });
+  }
+
+  // Re-throw the first error (e.g. std::bad_alloc) in the caller
+  // thread.
+  if (state->error)
+    std::rethrow_exception(state->error);
+}
+
+}} // namespace doc::algorithm
@@ -0,0 +1,30 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef DOC_ALGORITHM_PARALLEL_FOR_H_INCLUDED
+#define DOC_ALGORITHM_PARALLEL_FOR_H_INCLUDED
+#pragma once
+
+#include <functional>
+
+namespace base {
+class task_token;
+}
+
+namespace doc { namespace algorithm {
+
+// Calls func(i) for each i in [0, n) from the caller thread and from
+// a pool of threads shared by all algorithms. The pool is only a
+// helper: if its threads are busy, the caller processes all the
+// items anyway. Returns when all calls have finished. Pending items
+// are skipped if the optional "token" is canceled or if func() throws
+// an exception, and the first exception is re-thrown in the caller
+// thread.
+void parallel_for(int n, const std::function<void(int)>& func, base::task_token* token = nullptr);
+
+}} // namespace doc::algorithm
+
+#endif
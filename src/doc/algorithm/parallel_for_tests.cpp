@@ -0,0 +1,60 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "gtest/gtest.h"
+
+#include "base/task.h"
+#include "doc/algorithm/parallel_for.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace doc::algorithm;
+
+TEST(ParallelFor, CallsEachItemOnce)
+{
+  std::vector<std::atomic<int>> calls(1000);
+  parallel_for(int(calls.size()), [&](int i) { ++calls[i]; });
+  for (const auto& c : calls)
+    ASSERT_EQ(1, c.load());
+
+  parallel_for(0, [](int) { FAIL(); });
+}
+
+TEST(ParallelFor, NestedCalls)
+{
+  // Calls from the pool threads cannot wait the pool itself
+  std::atomic<int> total(0);
+  parallel_for(64, [&](int) { parallel_for(64, [&](int) { ++total; }); });
+  EXPECT_EQ(64 * 64, total.load());
+}
+
+TEST(ParallelFor, RethrowsException)
+{
+  EXPECT_THROW(parallel_for(1000,
+                            [](int i) {
+                              if (i == 10)
+                                throw std::runtime_error("error");
+                            }),
+               std::runtime_error);
+}
+
+TEST(ParallelFor, Canceled)
+{
+  base::task_token token;
+  token.cancel();
+
+  std::atomic<int> calls(0);
+  parallel_for(1000, [&](int) { ++calls; }, &token);
+  EXPECT_EQ(0, calls.load());
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2019  Igara Studio S.A.
+// Copyright (c) 2019-2025  Igara Studio S.A.
 // Copyright (c) 2001-2018 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -29,6 +29,7 @@ void resize_image_nearest(const Image* src, Image* dst)
   double y_ratio = double(src->height()) / double(dst->height());
   double px, py;
 
+  src->expand();
   LockImageBits<ImageTraits> dstBits(dst);
   auto dstIt = dstBits.begin();
 
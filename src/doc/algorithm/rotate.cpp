@@ -789,6 +789,12 @@ static void ase_parallelogram_map_standard(Image* bmp,
                                            fixed xs[4],
                                            fixed ys[4])
 {
+  // The scanline drawers use get_pixel_fast()
+  bmp->expand();
+  sprite->expand();
+  if (mask)
+    mask->expand();
+
   switch (bmp->pixelFormat()) {
     case IMAGE_RGB: {
       RgbDelegate delegate(sprite->maskColor());
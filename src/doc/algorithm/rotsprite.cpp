@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2020-2023  Igara Studio S.A.
+// Copyright (c) 2020-2025  Igara Studio S.A.
 // Copyright (c) 2001-2018 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -9,12 +9,19 @@
   #include "config.h"
 #endif
 
-#include "doc/algorithm/rotate.h"
+#include "doc/algorithm/rotsprite.h"
+
+#include "doc/algorithm/parallel_for.h"
+#include "doc/blend_funcs.h"
 #include "doc/image_impl.h"
+#include "doc/image_ref.h"
 #include "doc/primitives.h"
+#include "doc/primitives_fast.h"
 
 #include <algorithm>
-#include <memory>
+#include <cmath>
+#include <type_traits>
+#include <vector>
 
 namespace doc { namespace algorithm {
 
@@ -163,6 +170,250 @@ static void image_scale2x(Image* dst, const Image* src, int src_w, int src_h)
   }
 }
 
+namespace {
+
+// The source is upscaled 8x (three scale2x passes) before sampling it.
+constexpr int kScale = 8;
+
+// Maximum size of each destination tile (in pixels). Each tile
+// upscales only the part of the source that it samples.
+constexpr int kTileSize = 64;
+
+// Maximum width/height of the source area sampled by a tile (without
+// the margins). When the sprite is scaled down, each destination
+// pixel covers several source pixels, so smaller tiles are used to
+// keep the upscaled source area of each tile bounded (~100x100
+// source pixels, ~800x800 upscaled pixels).
+constexpr int kMaxTileSource = 96;
+
+// Extra source pixels around the area needed by a tile. The result
+// of scale2x in a pixel depends on its neighbors, so the pixels near
+// the border of a cropped source are different from the pixels
+// upscaled with the whole source. After three scale2x passes the
+// affected border is less than 2 source pixels wide.
+constexpr int kMargin = 2;
+
+// Maps destination points to source points (the inverse of the
+// parallelogram transformation).
+class InverseTransform {
+public:
+  InverseTransform(const Image* spr,
+                   const gfx::Rect& box,
+                   int x1,
+                   int y1,
+                   int x2,
+                   int y2,
+                   int x4,
+                   int y4)
+    : m_x1(x1)
+    , m_y1(y1)
+    , m_box(box)
+    , m_subDx(sub_pixel_delta(box.w))
+    , m_subDy(sub_pixel_delta(box.h))
+  {
+    // Destination vectors for one source pixel in each axis
+    const double ux = double(x2 - x1) / spr->width();
+    const double uy = double(y2 - y1) / spr->width();
+    const double vx = double(x4 - x1) / spr->height();
+    const double vy = double(y4 - y1) / spr->height();
+    const double det = ux * vy - uy * vx;
+
+    m_valid = (std::fabs(det) > 1e-9);
+    if (m_valid) {
+      m_a = vy / det;
+      m_b = -vx / det;
+      m_c = -uy / det;
+      m_d = ux / det;
+    }
+  }
+
+  bool isValid() const { return m_valid; }
+
+  void map(double x, double y, double& u, double& v) const
+  {
+    x -= m_x1;
+    y -= m_y1;
+    u = m_a * x + m_b * y;
+    v = m_c * x + m_d * y;
+  }
+
+  // Maps the sampled point of the destination pixel (x, y) to the
+  // source.
+  //
+  // The previous implementation drew the parallelogram in a 8x
+  // destination and scaled it down with scale_image(), which takes
+  // the sub-pixel round(i*(8n-1)/(n-1)) (instead of 8*i) for the
+  // pixel "i" of the box of size "n". The same sub-pixels are sampled
+  // here to get the same results.
+  void mapPixel(int x, int y, double& u, double& v) const
+  {
+    map(m_box.x + (sub_pixel(x - m_box.x, m_subDx) + 0.5) / kScale,
+        m_box.y + (sub_pixel(y - m_box.y, m_subDy) + 0.5) / kScale,
+        u,
+        v);
+  }
+
+  // Returns the size of the destination tiles, so the source area
+  // sampled by each one is not bigger than kMaxTileSource.
+  int tileSize() const
+  {
+    // Maximum source pixels between two destination pixels
+    const double step = std::max(std::fabs(m_a) + std::fabs(m_b), std::fabs(m_c) + std::fabs(m_d));
+    if (step * kTileSize <= kMaxTileSource)
+      return kTileSize;
+    return std::clamp(int(kMaxTileSource / step), 1, kTileSize);
+  }
+
+  // Returns the source bounds that are sampled by the pixels of the
+  // given destination bounds (the sampled points of the corner
+  // pixels are the extremes as the transformation is affine).
+  gfx::Rect sourceBounds(const gfx::Rect& bounds) const
+  {
+    double umin = 0, vmin = 0, umax = 0, vmax = 0;
+    const int xs[2] = { bounds.x, bounds.x2() - 1 };
+    const int ys[2] = { bounds.y, bounds.y2() - 1 };
+    for (int i = 0; i < 4; ++i) {
+      double u, v;
+      mapPixel(xs[i & 1], ys[i >> 1], u, v);
+      if (i == 0) {
+        umin = umax = u;
+        vmin = vmax = v;
+      }
+      else {
+        umin = std::min(umin, u);
+        umax = std::max(umax, u);
+        vmin = std::min(vmin, v);
+        vmax = std::max(vmax, v);
+      }
+    }
+    return gfx::Rect(
+      gfx::Point(int(std::floor(umin)) - kMargin, int(std::floor(vmin)) - kMargin),
+      gfx::Point(int(std::floor(umax)) + 1 + kMargin, int(std::floor(vmax)) + 1 + kMargin));
+  }
+
+private:
+  // Fixed point (16.16) distance between the sampled sub-pixels.
+  static int64_t sub_pixel_delta(int n)
+  {
+    return (n > 1 ? std::llround(65536.0 * (kScale * n - 1) / (n - 1)) : 0);
+  }
+
+  static int sub_pixel(int i, int64_t delta) { return int((i * delta + 0x8000) >> 16); }
+
+  int m_x1, m_y1;
+  gfx::Rect m_box;
+  int64_t m_subDx, m_subDy;
+  double m_a = 0, m_b = 0, m_c = 0, m_d = 0;
+  bool m_valid;
+};
+
+template<typename ImageTraits>
+bool is_transparent_pixel(color_t c, color_t maskColor)
+{
+  if constexpr (std::is_same_v<ImageTraits, RgbTraits>)
+    return (rgba_geta(maskColor) != 0) && ((c & rgba_rgb_mask) == (maskColor & rgba_rgb_mask));
+  else if constexpr (std::is_same_v<ImageTraits, GrayscaleTraits>)
+    return (graya_geta(maskColor) != 0) && ((c & graya_v_mask) == (maskColor & graya_v_mask));
+  else if constexpr (std::is_same_v<ImageTraits, BitmapTraits>)
+    return (c == 0);
+  else
+    return (c == maskColor);
+}
+
+template<typename ImageTraits>
+color_t blend_pixel(color_t back, color_t front)
+{
+  if constexpr (std::is_same_v<ImageTraits, RgbTraits>)
+    return rgba_blender_normal(back, front);
+  else if constexpr (std::is_same_v<ImageTraits, GrayscaleTraits>)
+    return graya_blender_normal(back, front, 255);
+  else
+    return front;
+}
+
+// Draws the "tile" area of "bmp" upscaling only the needed part of
+// the "spr" image.
+template<typename ImageTraits>
+void rotsprite_tile(Image* bmp,
+                    const Image* spr,
+                    const Image* mask,
+                    const InverseTransform& transform,
+                    const gfx::Rect& tile)
+{
+  const gfx::Rect srcBounds = transform.sourceBounds(tile) & spr->bounds();
+  if (srcBounds.isEmpty())
+    return;
+
+  const color_t maskColor = spr->maskColor();
+
+  // Upscale the source area
+  ImageRef scaled(crop_image(spr, srcBounds, maskColor));
+  for (int i = 0; i < 3; ++i) {
+    ImageRef tmp(Image::create(spr->pixelFormat(), scaled->width() * 2, scaled->height() * 2));
+    tmp->setMaskColor(maskColor);
+    image_scale2x(tmp.get(), scaled.get(), scaled->width(), scaled->height());
+    scaled = tmp;
+  }
+
+  const gfx::Rect scaledBounds = scaled->bounds();
+  const gfx::Rect maskBounds = (mask ? mask->bounds() : gfx::Rect());
+  const int w = spr->width() * kScale;
+  const int h = spr->height() * kScale;
+
+  LockImageBits<ImageTraits> bits(bmp, Image::ReadWriteLock, tile);
+  auto it = bits.begin();
+  for (int y = tile.y; y < tile.y2(); ++y) {
+    for (int x = tile.x; x < tile.x2(); ++x, ++it) {
+      double u, v;
+      transform.mapPixel(x, y, u, v);
+      u *= kScale;
+      v *= kScale;
+      if (u < 0.0 || v < 0.0 || u >= w || v >= h)
+        continue;
+
+      const int su = int(u);
+      const int sv = int(v);
+
+      if (mask && !(maskBounds.contains(su / kScale, sv / kScale) &&
+                    get_pixel_fast<BitmapTraits>(mask, su / kScale, sv / kScale)))
+        continue;
+
+      const int px = su - srcBounds.x * kScale;
+      const int py = sv - srcBounds.y * kScale;
+      if (!scaledBounds.contains(px, py))
+        continue;
+
+      const color_t c = get_pixel_fast<ImageTraits>(scaled.get(), px, py);
+      if (!is_transparent_pixel<ImageTraits>(c, maskColor))
+        *it = blend_pixel<ImageTraits>(*it, c);
+    }
+  }
+}
+
+template<typename ImageTraits>
+void rotsprite_image_templ(Image* bmp,
+                           const Image* spr,
+                           const Image* mask,
+                           const InverseTransform& transform,
+                           const gfx::Rect& bounds,
+                           base::task_token* token)
+{
+  const int tileSize = transform.tileSize();
+  std::vector<gfx::Rect> tiles;
+  for (int y = bounds.y; y < bounds.y2(); y += tileSize)
+    for (int x = bounds.x; x < bounds.x2(); x += tileSize)
+      tiles.push_back(gfx::Rect(x, y, tileSize, tileSize) & bounds);
+
+  // Tiles write disjoint areas of "bmp", so they can be processed in
+  // parallel.
+  parallel_for(
+    int(tiles.size()),
+    [&](int i) { rotsprite_tile<ImageTraits>(bmp, spr, mask, transform, tiles[i]); },
+    token);
+}
+
+} // anonymous namespace
+
 void rotsprite_image(Image* bmp,
                      const Image* spr,
                      const Image* mask,
@@ -173,88 +424,37 @@ void rotsprite_image(Image* bmp,
                      int x3,
                      int y3,
                      int x4,
-                     int y4)
+                     int y4,
+                     base::task_token* token)
 {
-  static ImageBufferPtr buf[3]; // TODO non-thread safe
-
-  for (int i = 0; i < 3; ++i)
-    if (!buf[i])
-      buf[i].reset(new ImageBuffer(1));
-
   int xmin = std::min(x1, std::min(x2, std::min(x3, x4)));
   int xmax = std::max(x1, std::max(x2, std::max(x3, x4)));
   int ymin = std::min(y1, std::min(y2, std::min(y3, y4)));
   int ymax = std::max(y1, std::max(y2, std::max(y3, y4)));
-  int rot_width = xmax - xmin;
-  int rot_height = ymax - ymin;
 
-  if (rot_width == 0 || rot_height == 0)
+  const gfx::Rect box(xmin, ymin, xmax - xmin, ymax - ymin);
+  const gfx::Rect bounds = box & bmp->bounds();
+  if (bounds.isEmpty() || spr->width() == 0 || spr->height() == 0)
     return;
 
-  int scale = 8;
-  std::unique_ptr<Image> bmp_copy(
-    Image::create(bmp->pixelFormat(), rot_width * scale, rot_height * scale, buf[0]));
-  std::unique_ptr<Image> tmp_copy(
-    Image::create(spr->pixelFormat(), spr->width() * scale, spr->height() * scale, buf[1]));
-  std::unique_ptr<Image> spr_copy(
-    Image::create(spr->pixelFormat(), spr->width() * scale, spr->height() * scale, buf[2]));
-  std::unique_ptr<Image> msk_copy;
-
-  color_t maskColor = spr->maskColor();
-
-  bmp_copy->setMaskColor(maskColor);
-  tmp_copy->setMaskColor(maskColor);
-  spr_copy->setMaskColor(maskColor);
-
-  spr_copy->clear(maskColor);
-  spr_copy->copy(spr, gfx::Clip(spr->bounds()));
-
-  for (int i = 0; i < 3; ++i) {
-    // clear_image(tmp_copy, maskColor);
-    image_scale2x(tmp_copy.get(), spr_copy.get(), spr->width() * (1 << i), spr->height() * (1 << i));
-    spr_copy->copy(tmp_copy.get(), gfx::Clip(tmp_copy->bounds()));
-  }
+  const InverseTransform transform(spr, box, x1, y1, x2, y2, x4, y4);
+  if (!transform.isValid())
+    return;
 
-  if (mask) {
-    // Same ImageBuffer than tmp_copy
-    msk_copy.reset(
-      Image::create(IMAGE_BITMAP, mask->width() * scale, mask->height() * scale, buf[1]));
-    clear_image(msk_copy.get(), 0);
-    scale_image(msk_copy.get(),
-                mask,
-                0,
-                0,
-                msk_copy->width(),
-                msk_copy->height(),
-                0,
-                0,
-                mask->width(),
-                mask->height());
+  switch (bmp->pixelFormat()) {
+    case IMAGE_RGB:
+      rotsprite_image_templ<RgbTraits>(bmp, spr, mask, transform, bounds, token);
+      break;
+    case IMAGE_GRAYSCALE:
+      rotsprite_image_templ<GrayscaleTraits>(bmp, spr, mask, transform, bounds, token);
+      break;
+    case IMAGE_INDEXED:
+      rotsprite_image_templ<IndexedTraits>(bmp, spr, mask, transform, bounds, token);
+      break;
+    case IMAGE_BITMAP:
+      rotsprite_image_templ<BitmapTraits>(bmp, spr, mask, transform, bounds, token);
+      break;
   }
-
-  clear_image(bmp_copy.get(), maskColor);
-  parallelogram(bmp_copy.get(),
-                spr_copy.get(),
-                msk_copy.get(),
-                (x1 - xmin) * scale,
-                (y1 - ymin) * scale,
-                (x2 - xmin) * scale,
-                (y2 - ymin) * scale,
-                (x3 - xmin) * scale,
-                (y3 - ymin) * scale,
-                (x4 - xmin) * scale,
-                (y4 - ymin) * scale);
-
-  scale_image(bmp,
-              bmp_copy.get(),
-              std::max(0, xmin),
-              std::max(0, ymin),
-              std::clamp(rot_width, 0, std::max(0, bmp->width() - std::max(0, xmin))),
-              std::clamp(rot_height, 0, std::max(0, bmp->height() - std::max(0, ymin))),
-              0,
-              0,
-              bmp_copy->width(),
-              bmp_copy->height());
 }
 
 }} // namespace doc::algorithm
@@ -8,11 +8,19 @@
 #define DOC_ALGORITHM_ROTSPRITE_H_INCLUDED
 #pragma once
 
+namespace base {
+class task_token;
+}
+
 namespace doc {
 class Image;
 
 namespace algorithm {
 
+// Draws "src" transformed into the given parallelogram of "dst"
+// using the RotSprite algorithm. The processing can be canceled
+// through the optional "token" (in that case "dst" is partially
+// drawn).
 void rotsprite_image(Image* dst,
                      const Image* src,
                      const Image* mask,
@@ -23,7 +31,8 @@ void rotsprite_image(Image* dst,
                      int x3,
                      int y3,
                      int x4,
-                     int y4);
+                     int y4,
+                     base::task_token* token = nullptr);
 
 } // namespace algorithm
 } // namespace doc
@@ -0,0 +1,326 @@
+// Aseprite Document Library
+// Copyright (c) 2025  Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "gtest/gtest.h"
+
+#include "doc/algorithm/rotsprite.h"
+
+#include "base/pi.h"
+#include "doc/algorithm/random_image.h"
+#include "doc/algorithm/rotate.h"
+#include "doc/image.h"
+#include "doc/image_impl.h"
+#include "doc/image_ref.h"
+#include "doc/primitives.h"
+#include "doc/primitives_fast.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace doc;
+using namespace gfx;
+
+namespace {
+
+// Previous implementation of rotsprite_image() (before processing
+// the destination in tiles), used as the reference result.
+
+template<typename ImageTraits>
+void ref_scale2x_tpl(Image* dst, const Image* src, int src_w, int src_h)
+{
+  for (int y = 0; y < src_h; ++y) {
+    for (int x = 0; x < src_w; ++x) {
+      const color_t P = get_pixel_fast<ImageTraits>(src, x, y);
+      const color_t A = (y > 0 ? get_pixel_fast<ImageTraits>(src, x, y - 1) : P);
+      const color_t B = (x < src_w - 1 ? get_pixel_fast<ImageTraits>(src, x + 1, y) : P);
+      const color_t C = (x > 0 ? get_pixel_fast<ImageTraits>(src, x - 1, y) : P);
+      const color_t D = (y < src_h - 1 ? get_pixel_fast<ImageTraits>(src, x, y + 1) : P);
+
+      put_pixel_fast<ImageTraits>(dst, 2 * x, 2 * y, C == A && C != D && A != B ? A : P);
+      put_pixel_fast<ImageTraits>(dst, 2 * x + 1, 2 * y, A == B && A != C && B != D ? B : P);
+      put_pixel_fast<ImageTraits>(dst, 2 * x, 2 * y + 1, D == C && D != B && C != A ? C : P);
+      put_pixel_fast<ImageTraits>(dst, 2 * x + 1, 2 * y + 1, B == D && B != A && D != C ? D : P);
+    }
+  }
+}
+
+void ref_scale2x(Image* dst, const Image* src, int src_w, int src_h)
+{
+  src->expand();
+  switch (src->pixelFormat()) {
+    case IMAGE_RGB:       ref_scale2x_tpl<RgbTraits>(dst, src, src_w, src_h); break;
+    case IMAGE_GRAYSCALE: ref_scale2x_tpl<GrayscaleTraits>(dst, src, src_w, src_h); break;
+    case IMAGE_INDEXED:   ref_scale2x_tpl<IndexedTraits>(dst, src, src_w, src_h); break;
+  }
+}
+
+void ref_rotsprite_image(Image* bmp,
+                         const Image* spr,
+                         const Image* mask,
+                         int x1,
+                         int y1,
+                         int x2,
+                         int y2,
+                         int x3,
+                         int y3,
+                         int x4,
+                         int y4)
+{
+  int xmin = std::min(x1, std::min(x2, std::min(x3, x4)));
+  int xmax = std::max(x1, std::max(x2, std::max(x3, x4)));
+  int ymin = std::min(y1, std::min(y2, std::min(y3, y4)));
+  int ymax = std::max(y1, std::max(y2, std::max(y3, y4)));
+  int rot_width = xmax - xmin;
+  int rot_height = ymax - ymin;
+
+  if (rot_width == 0 || rot_height == 0)
+    return;
+
+  int scale = 8;
+  ImageRef bmp_copy(Image::create(bmp->pixelFormat(), rot_width * scale, rot_height * scale));
+  ImageRef tmp_copy(Image::create(spr->pixelFormat(), spr->width() * scale, spr->height() * scale));
+  ImageRef spr_copy(Image::create(spr->pixelFormat(), spr->width() * scale, spr->height() * scale));
+  ImageRef msk_copy;
+
+  color_t maskColor = spr->maskColor();
+
+  bmp_copy->setMaskColor(maskColor);
+  tmp_copy->setMaskColor(maskColor);
+  spr_copy->setMaskColor(maskColor);
+
+  spr_copy->clear(maskColor);
+  spr_copy->copy(spr, gfx::Clip(spr->bounds()));
+
+  for (int i = 0; i < 3; ++i) {
+    ref_scale2x(tmp_copy.get(), spr_copy.get(), spr->width() * (1 << i), spr->height() * (1 << i));
+    spr_copy->copy(tmp_copy.get(), gfx::Clip(tmp_copy->bounds()));
+  }
+
+  if (mask) {
+    msk_copy.reset(Image::create(IMAGE_BITMAP, mask->width() * scale, mask->height() * scale));
+    clear_image(msk_copy.get(), 0);
+    algorithm::scale_image(msk_copy.get(),
+                           mask,
+                           0,
+                           0,
+                           msk_copy->width(),
+                           msk_copy->height(),
+                           0,
+                           0,
+                           mask->width(),
+                           mask->height());
+  }
+
+  clear_image(bmp_copy.get(), maskColor);
+  algorithm::parallelogram(bmp_copy.get(),
+                           spr_copy.get(),
+                           msk_copy.get(),
+                           (x1 - xmin) * scale,
+                           (y1 - ymin) * scale,
+                           (x2 - xmin) * scale,
+                           (y2 - ymin) * scale,
+                           (x3 - xmin) * scale,
+                           (y3 - ymin) * scale,
+                           (x4 - xmin) * scale,
+                           (y4 - ymin) * scale);
+
+  algorithm::scale_image(bmp,
+                         bmp_copy.get(),
+                         std::max(0, xmin),
+                         std::max(0, ymin),
+                         std::clamp(rot_width, 0, std::max(0, bmp->width() - std::max(0, xmin))),
+                         std::clamp(rot_height, 0, std::max(0, bmp->height() - std::max(0, ymin))),
+                         0,
+                         0,
+                         bmp_copy->width(),
+                         bmp_copy->height());
+}
+
+// Returns the number of pixels that are different in both images.
+int count_different_pixels(const Image* a, const Image* b)
+{
+  int n = 0;
+  for (int y = 0; y < a->height(); ++y)
+    for (int x = 0; x < a->width(); ++x)
+      if (get_pixel(a, x, y) != get_pixel(b, x, y))
+        ++n;
+  return n;
+}
+
+} // anonymous namespace
+
+TEST(RotSprite, PlainImageInSeveralTiles)
+{
+  for (auto pf : { IMAGE_RGB, IMAGE_GRAYSCALE, IMAGE_INDEXED }) {
+    const color_t c = (pf == IMAGE_RGB ? rgba(255, 0, 0, 255) :
+                       pf == IMAGE_GRAYSCALE ? graya(128, 255) :
+                                               1);
+    ImageRef src(Image::create(pf, 200, 150));
+    ImageRef dst(Image::create(pf, 200, 150));
+    clear_image(src.get(), c);
+    clear_image(dst.get(), 0);
+
+    // Identity transformation
+    algorithm::rotsprite_image(dst.get(), src.get(), nullptr, 0, 0, 200, 0, 200, 150, 0, 150);
+    EXPECT_TRUE(is_plain_image(dst.get(), c)) << "Pixel format=" << pf;
+  }
+}
+
+TEST(RotSprite, Mask)
+{
+  ImageRef src(Image::create(IMAGE_INDEXED, 100, 100));
+  ImageRef dst(Image::create(IMAGE_INDEXED, 100, 100));
+  ImageRef mask(Image::create(IMAGE_BITMAP, 100, 100));
+  clear_image(src.get(), 1);
+  clear_image(dst.get(), 0);
+  clear_image(mask.get(), 0);
+  fill_rect(mask.get(), 0, 0, 49, 99, 1);
+
+  algorithm::rotsprite_image(dst.get(), src.get(), mask.get(), 0, 0, 100, 0, 100, 100, 0, 100);
+
+  for (int y = 0; y < 100; ++y) {
+    for (int x = 0; x < 100; ++x) {
+      ASSERT_EQ(x < 50 ? 1 : 0, get_pixel(dst.get(), x, y)) << x << "," << y;
+    }
+  }
+}
+
+// Compares the result with the previous implementation rotating
+// images with odd sizes in several angles. Both implementations
+// round the edges of the parallelogram in a different way, so a few
+// pixels in the edges of the rotated sprite can be different.
+TEST(RotSprite, SameResultAsPreviousImplementation)
+{
+  for (auto pf : { IMAGE_RGB, IMAGE_GRAYSCALE, IMAGE_INDEXED }) {
+    for (const gfx::Size size : { gfx::Size(7, 5), gfx::Size(33, 17), gfx::Size(81, 131) }) {
+      ImageRef src(Image::create(pf, size.w, size.h));
+      algorithm::random_image(src.get());
+      if (pf == IMAGE_INDEXED) {
+        // Use a mask color that is in the image
+        src->setMaskColor(get_pixel(src.get(), size.w / 2, size.h / 2));
+      }
+      else {
+        // Make some pixels transparent
+        src->setMaskColor(0);
+        fill_rect(src.get(), 0, 0, size.w / 3, size.h / 3, 0);
+      }
+
+      for (const double angle : { 0.0, 15.0, 45.0, 90.0, 133.0, 180.0, 270.0, 301.0 }) {
+        // Parallelogram of the image rotated around the center of a
+        // destination image big enough to contain it.
+        const int dstSize = 2 * std::max(size.w, size.h) + 4;
+        const double a = angle * PI / 180.0;
+        const double ca = std::cos(a), sa = std::sin(a);
+        const int ux = int(std::round(size.w * ca)), uy = int(std::round(size.w * sa));
+        const int vx = int(std::round(-size.h * sa)), vy = int(std::round(size.h * ca));
+        int xs[4], ys[4];
+        xs[0] = dstSize / 2 - (ux + vx) / 2;
+        ys[0] = dstSize / 2 - (uy + vy) / 2;
+        xs[1] = xs[0] + ux;
+        ys[1] = ys[0] + uy;
+        xs[2] = xs[0] + ux + vx;
+        ys[2] = ys[0] + uy + vy;
+        xs[3] = xs[0] + vx;
+        ys[3] = ys[0] + vy;
+
+        ImageRef expected(Image::create(pf, dstSize, dstSize));
+        ImageRef result(Image::create(pf, dstSize, dstSize));
+        clear_image(expected.get(), 0);
+        clear_image(result.get(), 0);
+
+        ref_rotsprite_image(expected.get(),
+                            src.get(),
+                            nullptr,
+                            xs[0],
+                            ys[0],
+                            xs[1],
+                            ys[1],
+                            xs[2],
+                            ys[2],
+                            xs[3],
+                            ys[3]);
+        algorithm::rotsprite_image(result.get(),
+                                   src.get(),
+                                   nullptr,
+                                   xs[0],
+                                   ys[0],
+                                   xs[1],
+                                   ys[1],
+                                   xs[2],
+                                   ys[2],
+                                   xs[3],
+                                   ys[3]);
+
+        // Only a few pixels of the edges can be different
+        const int maxDiffs = 1 + (size.w + size.h) / 8;
+        EXPECT_LE(count_different_pixels(expected.get(), result.get()), maxDiffs)
+          << "Pixel format=" << pf << " size=" << size.w << "x" << size.h << " angle=" << angle;
+      }
+    }
+  }
+}
+
+// Scaling down a big sprite uses smaller tiles (each destination
+// pixel samples several source pixels). The result must be the same
+// as sampling the whole upscaled sprite.
+TEST(RotSprite, LargeDownscale)
+{
+  const int w = 640, h = 480;
+  ImageRef src(Image::create(IMAGE_INDEXED, w, h));
+  algorithm::random_image(src.get());
+  src->setMaskColor(get_pixel(src.get(), w / 2, h / 2));
+
+  // The sprite rotated ~30 degrees and scaled down ~16x
+  const int x1 = 10, y1 = 2, x2 = 45, y2 = 22, x3 = 30, y3 = 48, x4 = -5, y4 = 28;
+
+  ImageRef result(Image::create(IMAGE_INDEXED, 50, 50));
+  clear_image(result.get(), 0);
+  algorithm::rotsprite_image(result.get(), src.get(), nullptr, x1, y1, x2, y2, x3, y3, x4, y4);
+
+  // Upscale the whole sprite 8x
+  ImageRef scaled(Image::create(IMAGE_INDEXED, w * 8, h * 8));
+  ImageRef tmp(Image::create(IMAGE_INDEXED, w * 8, h * 8));
+  scaled->copy(src.get(), gfx::Clip(src->bounds()));
+  for (int i = 0; i < 3; ++i) {
+    ref_scale2x(tmp.get(), scaled.get(), w * (1 << i), h * (1 << i));
+    std::swap(scaled, tmp);
+  }
+
+  // Sample the same sub-pixels that rotsprite_image() samples
+  const int xmin = std::min({ x1, x2, x3, x4 }), ymin = std::min({ y1, y2, y3, y4 });
+  const int bw = std::max({ x1, x2, x3, x4 }) - xmin, bh = std::max({ y1, y2, y3, y4 }) - ymin;
+  const double ux = double(x2 - x1) / w, uy = double(y2 - y1) / w;
+  const double vx = double(x4 - x1) / h, vy = double(y4 - y1) / h;
+  const double det = ux * vy - uy * vx;
+  const double a = vy / det, b = -vx / det, c = -uy / det, d = ux / det;
+  const int64_t dx = std::llround(65536.0 * (8 * bw - 1) / (bw - 1));
+  const int64_t dy = std::llround(65536.0 * (8 * bh - 1) / (bh - 1));
+
+  ImageRef expected(Image::create(IMAGE_INDEXED, 50, 50));
+  clear_image(expected.get(), 0);
+  const gfx::Rect bounds = gfx::Rect(xmin, ymin, bw, bh) & expected->bounds();
+  for (int y = bounds.y; y < bounds.y2(); ++y) {
+    for (int x = bounds.x; x < bounds.x2(); ++x) {
+      const double px = xmin + (int(((x - xmin) * dx + 0x8000) >> 16) + 0.5) / 8 - x1;
+      const double py = ymin + (int(((y - ymin) * dy + 0x8000) >> 16) + 0.5) / 8 - y1;
+      const double u = (a * px + b * py) * 8;
+      const double v = (c * px + d * py) * 8;
+      if (u < 0.0 || v < 0.0 || u >= w * 8 || v >= h * 8)
+        continue;
+      const color_t color = get_pixel(scaled.get(), int(u), int(v));
+      if (color != src->maskColor())
+        put_pixel(expected.get(), x, y, color);
+    }
+  }
+
+  EXPECT_EQ(0, count_different_pixels(expected.get(), result.get()));
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
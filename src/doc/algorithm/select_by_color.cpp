@@ -0,0 +1,299 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "doc/algorithm/select_by_color.h"
+
+#include "base/debug.h"
+#include "doc/algorithm/parallel_for.h"
+#include "doc/image.h"
+#include "doc/image_traits.h"
+#include "gfx/rect.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(_WIN64)
+  #define DOC_SELECT_BY_COLOR_USE_SSE2 1
+  #include <emmintrin.h>
+#endif
+
+namespace doc { namespace algorithm {
+
+namespace {
+
+// Matchers of pixels similar to the given color. operator()(c) tests
+// one pixel, and block16(p) tests 16 pixels starting from "p"
+// returning one bit for each pixel similar to the color.
+template<typename ImageTraits>
+class ColorMatcher;
+
+template<>
+class ColorMatcher<RgbTraits> {
+public:
+  ColorMatcher(color_t color, int tolerance) : m_color(color), m_tolerance(tolerance)
+  {
+#ifdef DOC_SELECT_BY_COLOR_USE_SSE2
+    m_vcolor = _mm_set1_epi32(int(color));
+    m_vtolerance = _mm_set1_epi8(char(std::min(tolerance, 255)));
+#endif
+  }
+
+  bool operator()(color_t c) const
+  {
+    return ((std::abs(int(rgba_getr(c)) - int(rgba_getr(m_color))) <= m_tolerance) &&
+            (std::abs(int(rgba_getg(c)) - int(rgba_getg(m_color))) <= m_tolerance) &&
+            (std::abs(int(rgba_getb(c)) - int(rgba_getb(m_color))) <= m_tolerance) &&
+            (std::abs(int(rgba_geta(c)) - int(rgba_geta(m_color))) <= m_tolerance));
+  }
+
+  uint32_t block16(const uint32_t* p) const
+  {
+#ifdef DOC_SELECT_BY_COLOR_USE_SSE2
+    return (block4(p) | (block4(p + 4) << 4) | (block4(p + 8) << 8) | (block4(p + 12) << 12));
+#else
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; ++i)
+      if ((*this)(p[i]))
+        bits |= (1 << i);
+    return bits;
+#endif
+  }
+
+private:
+#ifdef DOC_SELECT_BY_COLOR_USE_SSE2
+  uint32_t block4(const uint32_t* p) const
+  {
+    const __m128i v = _mm_loadu_si128((const __m128i*)p);
+    // Each channel must be in the tolerance range
+    const __m128i diff = _mm_or_si128(_mm_subs_epu8(v, m_vcolor), _mm_subs_epu8(m_vcolor, v));
+    const __m128i ok = _mm_cmpeq_epi8(_mm_subs_epu8(diff, m_vtolerance), _mm_setzero_si128());
+    const __m128i r = _mm_cmpeq_epi32(ok, _mm_set1_epi32(-1));
+    return uint32_t(_mm_movemask_ps(_mm_castsi128_ps(r)));
+  }
+
+  __m128i m_vcolor;
+  __m128i m_vtolerance;
+#endif
+  color_t m_color;
+  int m_tolerance;
+};
+
+template<>
+class ColorMatcher<GrayscaleTraits> {
+public:
+  ColorMatcher(color_t color, int tolerance) : m_color(color), m_tolerance(tolerance)
+  {
+#ifdef DOC_SELECT_BY_COLOR_USE_SSE2
+    m_vcolor = _mm_set1_epi16(short(color));
+    m_vtolerance = _mm_set1_epi8(char(std::min(tolerance, 255)));
+#endif
+  }
+
+  bool operator()(color_t c) const
+  {
+    return ((std::abs(int(graya_getv(c)) - int(graya_getv(m_color))) <= m_tolerance) &&
+            (std::abs(int(graya_geta(c)) - int(graya_geta(m_color))) <= m_tolerance));
+  }
+
+  uint32_t block16(const uint16_t* p) const
+  {
+#ifdef DOC_SELECT_BY_COLOR_USE_SSE2
+    return (block8(p) | (block8(p + 8) << 8));
+#else
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; ++i)
+      if ((*this)(p[i]))
+        bits |= (1 << i);
+    return bits;
+#endif
+  }
+
+private:
+#ifdef DOC_SELECT_BY_COLOR_USE_SSE2
+  uint32_t block8(const uint16_t* p) const
+  {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i v = _mm_loadu_si128((const __m128i*)p);
+    const __m128i diff = _mm_or_si128(_mm_subs_epu8(v, m_vcolor), _mm_subs_epu8(m_vcolor, v));
+    const __m128i ok = _mm_cmpeq_epi8(_mm_subs_epu8(diff, m_vtolerance), zero);
+    const __m128i r = _mm_cmpeq_epi16(ok, _mm_set1_epi16(-1));
+    return uint32_t(_mm_movemask_epi8(_mm_packs_epi16(r, zero)));
+  }
+
+  __m128i m_vcolor;
+  __m128i m_vtolerance;
+#endif
+  color_t m_color;
+  int m_tolerance;
+};
+
+template<>
+class ColorMatcher<IndexedTraits> {
+public:
+  ColorMatcher(color_t color, int tolerance)
+    : m_min(int(color) > tolerance ? int(color) - tolerance : 0)
+    , m_max(int(color) + tolerance)
+  {
+#ifdef DOC_SELECT_BY_COLOR_USE_SSE2
+    m_vmin = _mm_set1_epi8(char(std::min(m_min, 255)));
+    m_vmax = _mm_set1_epi8(char(std::min(m_max, 255)));
+#endif
+  }
+
+  bool operator()(color_t c) const { return (int(c) >= m_min && int(c) <= m_max); }
+
+  uint32_t block16(const uint8_t* p) const
+  {
+    // Nothing can match (m_min is out of the range of 8-bit indexes)
+    if (m_min > 255)
+      return 0;
+
+#ifdef DOC_SELECT_BY_COLOR_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i v = _mm_loadu_si128((const __m128i*)p);
+    // min <= v <= max
+    const __m128i r = _mm_and_si128(_mm_cmpeq_epi8(_mm_subs_epu8(m_vmin, v), zero),
+                                    _mm_cmpeq_epi8(_mm_subs_epu8(v, m_vmax), zero));
+    return uint32_t(_mm_movemask_epi8(r));
+#else
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; ++i)
+      if ((*this)(p[i]))
+        bits |= (1 << i);
+    return bits;
+#endif
+  }
+
+private:
+#ifdef DOC_SELECT_BY_COLOR_USE_SSE2
+  __m128i m_vmin;
+  __m128i m_vmax;
+#endif
+  int m_min;
+  int m_max;
+};
+
+// Adds the given bits (one bit for each pixel starting from the "x"
+// pixel) to the bitmap row.
+inline void or_bits(uint8_t* row, const int x, uint32_t bits)
+{
+  if (!bits)
+    return;
+
+  uint8_t* p = row + (x >> 3);
+  for (bits <<= (x & 7); bits; bits >>= 8, ++p)
+    *p |= uint8_t(bits);
+}
+
+template<typename ImageTraits>
+void select_row(uint8_t* dstRow,
+                const int dstX,
+                const typename ImageTraits::pixel_t* src,
+                const int w,
+                const ColorMatcher<ImageTraits>& match)
+{
+  int x = 0;
+  for (; x + 16 <= w; x += 16)
+    or_bits(dstRow, dstX + x, match.block16(src + x));
+
+  uint32_t bits = 0;
+  for (int i = 0; x + i < w; ++i)
+    if (match(src[x + i]))
+      bits |= (1 << i);
+  or_bits(dstRow, dstX + x, bits);
+}
+
+// Selects the pixels of "src" only in the [y1, y2) rows of "dst".
+template<typename ImageTraits>
+void select_rows(Image* dst,
+                 const Image* src,
+                 const gfx::Point& pos,
+                 const ColorMatcher<ImageTraits>& match,
+                 const int y1,
+                 const int y2)
+{
+  ASSERT(src->pixelFormat() == ImageTraits::pixel_format);
+  if (src->pixelFormat() != ImageTraits::pixel_format)
+    return;
+
+  const gfx::Rect rc = gfx::Rect(pos.x, pos.y, src->width(), src->height()) &
+                       gfx::Rect(0, y1, dst->width(), y2 - y1);
+  if (rc.isEmpty())
+    return;
+
+  for (int y = rc.y; y < rc.y2(); ++y) {
+    select_row<ImageTraits>(
+      dst->getPixelAddress(0, y),
+      rc.x,
+      (const typename ImageTraits::pixel_t*)src->getPixelAddress(rc.x - pos.x, y - pos.y),
+      rc.w,
+      match);
+  }
+}
+
+template<typename ImageTraits>
+void select_by_color_templ(Image* dst,
+                           const std::vector<SelectByColorSource>& srcs,
+                           const color_t color,
+                           const int tolerance)
+{
+  const ColorMatcher<ImageTraits> match(color, tolerance);
+
+  // Bands of rows are disjoint areas of "dst", so they can be
+  // processed in parallel.
+  constexpr int kBandHeight = 32;
+  const int nbands = (dst->height() + kBandHeight - 1) / kBandHeight;
+
+  auto selectBand = [&](int i) {
+    const int y1 = i * kBandHeight;
+    const int y2 = std::min(y1 + kBandHeight, dst->height());
+    for (const auto& src : srcs)
+      select_rows<ImageTraits>(dst, src.image, src.position, match, y1, y2);
+  };
+
+  // Don't use other threads to process one small image
+  if (srcs.size() == 1 && dst->width() * dst->height() < 512 * 512) {
+    for (int i = 0; i < nbands; ++i)
+      selectBand(i);
+  }
+  else {
+    parallel_for(nbands, selectBand);
+  }
+}
+
+} // anonymous namespace
+
+void select_by_color(Image* dst,
+                     const Image* src,
+                     const gfx::Point& pos,
+                     const color_t color,
+                     const int tolerance)
+{
+  select_by_color(dst, std::vector<SelectByColorSource>{ { src, pos } }, color, tolerance);
+}
+
+void select_by_color(Image* dst,
+                     const std::vector<SelectByColorSource>& srcs,
+                     const color_t color,
+                     const int tolerance)
+{
+  ASSERT(dst->pixelFormat() == IMAGE_BITMAP);
+  if (srcs.empty() || tolerance < 0)
+    return;
+
+  switch (srcs[0].image->pixelFormat()) {
+    case IMAGE_RGB:       select_by_color_templ<RgbTraits>(dst, srcs, color, tolerance); break;
+    case IMAGE_GRAYSCALE: select_by_color_templ<GrayscaleTraits>(dst, srcs, color, tolerance); break;
+    case IMAGE_INDEXED:   select_by_color_templ<IndexedTraits>(dst, srcs, color, tolerance); break;
+    default:              break;
+  }
+}
+
+}} // namespace doc::algorithm
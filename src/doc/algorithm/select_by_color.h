@@ -0,0 +1,49 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef DOC_ALGORITHM_SELECT_BY_COLOR_H_INCLUDED
+#define DOC_ALGORITHM_SELECT_BY_COLOR_H_INCLUDED
+#pragma once
+
+#include "doc/color.h"
+#include "gfx/point.h"
+
+#include <vector>
+
+namespace doc {
+class Image;
+
+namespace algorithm {
+
+struct SelectByColorSource {
+  const Image* image;
+  // Position of the image in the destination bitmap
+  gfx::Point position;
+};
+
+// Sets to 1 the pixels of the "dst" bitmap where the "src" image has
+// a color similar to "color" (each channel in the [color-tolerance,
+// color+tolerance] range, or the index in that range for indexed
+// images). The pixel (x, y) of "src" is mapped to (x+pos.x, y+pos.y)
+// in "dst", other pixels of "dst" are not modified.
+void select_by_color(Image* dst,
+                     const Image* src,
+                     const gfx::Point& pos,
+                     const color_t color,
+                     const int tolerance);
+
+// Same as the previous function for several images (e.g. the cels
+// of several frames). All the images must have the same pixel
+// format. The "dst" rows are distributed between several threads.
+void select_by_color(Image* dst,
+                     const std::vector<SelectByColorSource>& srcs,
+                     const color_t color,
+                     const int tolerance);
+
+} // namespace algorithm
+} // namespace doc
+
+#endif
@@ -0,0 +1,89 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "gtest/gtest.h"
+
+#include "doc/algorithm/select_by_color.h"
+#include "doc/image.h"
+#include "doc/image_ref.h"
+#include "doc/mask.h"
+#include "doc/primitives.h"
+
+using namespace doc;
+using namespace gfx;
+
+TEST(SelectByColor, RgbTolerance)
+{
+  ImageRef image(Image::create(IMAGE_RGB, 37, 3));
+  clear_image(image.get(), rgba(0, 0, 0, 255));
+  fill_rect(image.get(), 3, 0, 30, 1, rgba(100, 100, 100, 255));
+  put_pixel(image.get(), 10, 1, rgba(104, 100, 96, 255));
+  put_pixel(image.get(), 11, 1, rgba(105, 100, 100, 255));
+
+  Mask mask;
+  mask.byColor(image.get(), rgba(100, 100, 100, 255), 4);
+  EXPECT_EQ(Rect(3, 0, 28, 2), mask.bounds());
+
+  for (int y = 0; y < 3; ++y)
+    for (int x = 0; x < 37; ++x) {
+      const bool expected = (x >= 3 && x <= 30 && y <= 1 && !(x == 11 && y == 1));
+      ASSERT_EQ(expected, mask.containsPoint(x, y)) << x << "," << y;
+    }
+}
+
+TEST(SelectByColor, SeveralImages)
+{
+  ImageRef a(Image::create(IMAGE_INDEXED, 20, 2));
+  ImageRef b(Image::create(IMAGE_INDEXED, 20, 2));
+  ImageRef bmp(Image::create(IMAGE_BITMAP, 40, 4));
+  clear_image(a.get(), 1);
+  clear_image(b.get(), 2);
+  clear_image(bmp.get(), 0);
+  put_pixel(a.get(), 0, 0, 3);
+  put_pixel(b.get(), 19, 1, 1);
+
+  algorithm::select_by_color(bmp.get(),
+                             { { a.get(), Point(-1, 0) }, { b.get(), Point(20, 2) } },
+                             1,
+                             0);
+
+  for (int y = 0; y < 4; ++y)
+    for (int x = 0; x < 40; ++x) {
+      const bool expected = ((y < 2 && x < 19) || (x == 39 && y == 3));
+      ASSERT_EQ(expected ? 1 : 0, int(get_pixel(bmp.get(), x, y))) << x << "," << y;
+    }
+}
+
+TEST(SelectByColor, BigImage)
+{
+  // Big enough to be processed in parallel
+  ImageRef image(Image::create(IMAGE_INDEXED, 600, 600));
+  clear_image(image.get(), 1);
+  fill_rect(image.get(), 100, 50, 399, 549, 2);
+
+  Mask mask;
+  mask.byColor(image.get(), 2, 0);
+  EXPECT_EQ(Rect(100, 50, 300, 500), mask.bounds());
+  EXPECT_TRUE(mask.containsPoint(399, 549));
+  EXPECT_FALSE(mask.containsPoint(400, 549));
+}
+
+TEST(SelectByColor, TilemapSelectsWholeImage)
+{
+  // Tilemaps cannot be selected by color
+  ImageRef image(Image::create(IMAGE_TILEMAP, 4, 3));
+  clear_image(image.get(), 1);
+
+  Mask mask;
+  mask.byColor(image.get(), 2, 0);
+  EXPECT_EQ(Rect(0, 0, 4, 3), mask.bounds());
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
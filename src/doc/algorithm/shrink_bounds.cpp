@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2019-2023 Igara Studio S.A.
+// Copyright (c) 2019-2025 Igara Studio S.A.
 // Copyright (c) 2001-2016 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -340,6 +340,7 @@ bool shrink_bounds(const Image* image,
                    gfx::Rect& bounds)
 {
   bounds = (startBounds & image->bounds());
+  image->expand();
   switch (image->pixelFormat()) {
     case IMAGE_RGB:       return shrink_bounds_templ<RgbTraits>(image, bounds, refpixel);
     case IMAGE_GRAYSCALE: return shrink_bounds_templ<GrayscaleTraits>(image, bounds, refpixel);
@@ -385,6 +386,8 @@ bool shrink_bounds2(const Image* a, const Image* b, const gfx::Rect& startBounds
   ASSERT(a->bounds() == b->bounds());
 
   bounds = (startBounds & a->bounds());
+  a->expand();
+  b->expand();
 
   switch (a->pixelFormat()) {
     case IMAGE_RGB:       return shrink_bounds_templ2<RgbTraits>(a, b, bounds);
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2019-2024 Igara Studio S.A.
+// Copyright (c) 2019-2025 Igara Studio S.A.
 // Copyright (c) 2001-2016 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -77,6 +77,10 @@ public:
 private:
   void fixupImage();
 
+  // LayerImage can change the frame of its own cels directly when it
+  // keeps them sorted (displaceFrames() and remapFrames()).
+  friend class LayerImage;
+
   LayerImage* m_layer;
   frame_t m_frame; // Frame position
   CelDataRef m_data;
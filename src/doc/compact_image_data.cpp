@@ -0,0 +1,103 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "doc/compact_image_data.h"
+
+#include "base/debug.h"
+#include "doc/image.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace doc {
+
+// static
+std::shared_ptr<const CompactImageData> CompactImageData::create(const Image* image,
+                                                                 std::size_t maxBytes)
+{
+  const std::size_t rowBytes = image->rowBytes();
+  const int height = image->height();
+
+  std::shared_ptr<CompactImageData> data(new CompactImageData(rowBytes));
+  data->m_rows.reserve(height + 1);
+
+  for (int y = 0; y < height; ++y) {
+    const uint8_t* row = image->getPixelAddress(0, y);
+    const uint8_t* const rowEnd = row + rowBytes;
+
+    data->m_rows.push_back(Row{ uint32_t(data->m_runs.size()), data->m_data.size() });
+
+    const uint8_t* p = row;
+    while (p < rowEnd) {
+      // Skip zeros
+      p = std::find_if(p, rowEnd, [](uint8_t v) { return v != 0; });
+      if (p == rowEnd)
+        break;
+
+      // Find the end of the run, a run finishes when we find a gap
+      // of kMinGap zeros (or the end of the row).
+      const uint8_t* runBegin = p;
+      const uint8_t* runEnd = p;
+      while (p < rowEnd) {
+        if (*p) {
+          runEnd = ++p;
+        }
+        else if (std::size_t(p - runEnd) >= kMinGap)
+          break;
+        else
+          ++p;
+      }
+
+      data->m_runs.push_back(Run{ uint32_t(runBegin - row), uint32_t(runEnd - runBegin) });
+      data->m_data.insert(data->m_data.end(), runBegin, runEnd);
+      p = runEnd;
+    }
+
+    if (sizeof(CompactImageData) + (y + 1) * sizeof(Row) + data->m_runs.size() * sizeof(Run) +
+          data->m_data.size() >
+        maxBytes)
+      return nullptr;
+  }
+
+  data->m_rows.push_back(Row{ uint32_t(data->m_runs.size()), data->m_data.size() });
+
+  // Release the extra capacity of the vectors
+  data->m_runs.shrink_to_fit();
+  data->m_data.shrink_to_fit();
+  return data;
+}
+
+std::size_t CompactImageData::memSize() const
+{
+  return sizeof(CompactImageData) + m_rows.capacity() * sizeof(Row) +
+         m_runs.capacity() * sizeof(Run) + m_data.capacity();
+}
+
+void CompactImageData::decodeRow(int y, uint8_t* dst) const
+{
+  ASSERT(y >= 0 && y < height());
+
+  const Row& row = m_rows[y];
+  const Row& nextRow = m_rows[y + 1];
+  const uint8_t* src = m_data.data() + row.data;
+  std::size_t x = 0;
+
+  for (uint32_t i = row.firstRun; i < nextRow.firstRun; ++i) {
+    const Run& run = m_runs[i];
+    std::memset(dst + x, 0, run.offset - x);
+    std::memcpy(dst + run.offset, src, run.size);
+    src += run.size;
+    x = run.offset + run.size;
+  }
+
+  std::memset(dst + x, 0, m_rowBytes - x);
+}
+
+} // namespace doc
@@ -0,0 +1,76 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifndef DOC_COMPACT_IMAGE_DATA_H_INCLUDED
+#define DOC_COMPACT_IMAGE_DATA_H_INCLUDED
+#pragma once
+
+#include "base/ints.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace doc {
+
+class Image;
+
+// Immutable scanline-run representation of the pixels of an image.
+// Each row is stored as a list of runs of bytes that are not zero
+// (the value used by ImageImpl to initialize new images), so big
+// empty areas of mostly transparent images don't use memory.
+//
+// It works at byte level, so the same representation is valid for
+// all pixel formats.
+class CompactImageData {
+public:
+  // Creates the compact representation of the given image pixels.
+  // Returns nullptr if the compact representation would use more
+  // than "maxBytes" bytes.
+  static std::shared_ptr<const CompactImageData> create(const Image* image,
+                                                        std::size_t maxBytes);
+
+  int height() const { return int(m_rows.size()) - 1; }
+  std::size_t rowBytes() const { return m_rowBytes; }
+
+  // Approximate number of bytes used by this representation.
+  std::size_t memSize() const;
+
+  // Copies the row "y" to "dst" (which must have rowBytes() bytes)
+  // filling the gaps between runs with zeros.
+  void decodeRow(int y, uint8_t* dst) const;
+
+private:
+  struct Run {
+    uint32_t offset; // Byte offset inside the row
+    uint32_t size;   // Number of bytes
+  };
+
+  // Runs separated by less zeros than the size of a Run are joined
+  // (it's cheaper to store the zeros).
+  static constexpr std::size_t kMinGap = sizeof(Run);
+
+  struct Row {
+    uint32_t firstRun; // Index of the first run of this row in m_runs
+    std::size_t data;  // Position of the first byte of this row in m_data
+  };
+
+  CompactImageData(std::size_t rowBytes) : m_rowBytes(rowBytes) {}
+
+  std::size_t m_rowBytes;
+  // One entry per row plus one extra entry at the end, so the runs
+  // of the row y are in the [m_rows[y].firstRun, m_rows[y+1].firstRun)
+  // range.
+  std::vector<Row> m_rows;
+  std::vector<Run> m_runs;
+  std::vector<uint8_t> m_data;
+};
+
+using CompactImageDataPtr = std::shared_ptr<const CompactImageData>;
+
+} // namespace doc
+
+#endif
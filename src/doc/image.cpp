@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2018-2020 Igara Studio S.A.
+// Copyright (c) 2018-2025 Igara Studio S.A.
 // Copyright (c) 2001-2016 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -20,6 +20,23 @@
 
 namespace doc {
 
+// Minimum number of pixels to try to create a compact version of the
+// pixels in Image::createCompactCopy() (for small images a regular
+// copy is faster and the saved memory is not worth it).
+static constexpr int kMinCompactCopyPixels = 256 * 256;
+
+static Image* create_compact(const ImageSpec& spec, const CompactImageDataPtr& data)
+{
+  switch (spec.colorMode()) {
+    case ColorMode::RGB:       return new ImageImpl<RgbTraits>(spec, data);
+    case ColorMode::GRAYSCALE: return new ImageImpl<GrayscaleTraits>(spec, data);
+    case ColorMode::INDEXED:   return new ImageImpl<IndexedTraits>(spec, data);
+    case ColorMode::BITMAP:    return new ImageImpl<BitmapTraits>(spec, data);
+    case ColorMode::TILEMAP:   return new ImageImpl<TilemapTraits>(spec, data);
+  }
+  return nullptr;
+}
+
 Image::Image(const ImageSpec& spec) : Object(ObjectType::Image), m_spec(spec)
 {
 }
@@ -60,7 +77,34 @@ Image* Image::create(const ImageSpec& spec, const ImageBufferPtr& buffer)
 Image* Image::createCopy(const Image* image, const ImageBufferPtr& buffer)
 {
   ASSERT(image);
+
+  if (!buffer) {
+    if (CompactImageDataPtr data = image->compactData()) {
+      return create_compact(
+        ImageSpec(image->colorMode(), image->width(), image->height(), image->maskColor()),
+        data);
+    }
+  }
+
   return crop_image(image, 0, 0, image->width(), image->height(), image->maskColor(), buffer);
 }
 
+// static
+Image* Image::createCompactCopy(const Image* image)
+{
+  ASSERT(image);
+
+  if (!image->isCompact() && image->width() * image->height() >= kMinCompactCopyPixels) {
+    CompactImageDataPtr data =
+      CompactImageData::create(image, image->rowBytes() * image->height() / 2);
+    if (data) {
+      return create_compact(
+        ImageSpec(image->colorMode(), image->width(), image->height(), image->maskColor()),
+        data);
+    }
+  }
+
+  return createCopy(image);
+}
+
 } // namespace doc
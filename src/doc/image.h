@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2018-2023 Igara Studio S.A.
+// Copyright (c) 2018-2025 Igara Studio S.A.
 // Copyright (c) 2001-2016 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -11,6 +11,7 @@
 
 #include "doc/color.h"
 #include "doc/color_mode.h"
+#include "doc/compact_image_data.h"
 #include "doc/image_buffer.h"
 #include "doc/image_spec.h"
 #include "doc/object.h"
@@ -40,8 +41,20 @@ public:
                        int height,
                        const ImageBufferPtr& buffer = ImageBufferPtr());
   static Image* create(const ImageSpec& spec, const ImageBufferPtr& buffer = ImageBufferPtr());
+  // Creates a copy of the given image. If the image is compact, and
+  // a buffer is not specified, the copy shares the compact
+  // representation of the pixels with the original image, and the
+  // pixels are decompressed on the first access to the copy
+  // (copy-on-write).
   static Image* createCopy(const Image* image, const ImageBufferPtr& buffer = ImageBufferPtr());
 
+  // Creates a copy to be stored for a long time without accessing
+  // its pixels (e.g. in the undo history). Big mostly empty images
+  // are converted to the compact representation, which is slower
+  // than a regular copy, so it shouldn't be used for temporary
+  // copies.
+  static Image* createCompactCopy(const Image* image);
+
   virtual ~Image();
 
   const ImageSpec& spec() const { return m_spec; }
@@ -73,6 +86,29 @@ public:
 
   virtual int getMemSize() const override;
 
+  // Converts the pixels to a compact representation (where empty
+  // areas don't use memory) if it saves enough memory. The pixels
+  // are decompressed automatically on the first access, so this is
+  // useful for big and mostly transparent images that are not being
+  // used (e.g. cels in other frames). Returns true if the image is
+  // compact. It cannot be called while other thread is accessing the
+  // image pixels.
+  virtual bool compact() = 0;
+  virtual bool isCompact() const = 0;
+
+  // Returns the compact representation of the pixels, or nullptr if
+  // the image is not compact.
+  virtual CompactImageDataPtr compactData() const = 0;
+
+  // Decompresses the pixels if the image is compact. It's called
+  // once at the boundaries where the pixels are accessed
+  // (getPixelAddress(), getPixel()/putPixel(), lockBits(), copy(),
+  // etc.), so the rows can be used directly after that. Code that
+  // uses get_pixel_fast()/put_pixel_fast() (see primitives_fast.h) on
+  // an image that could be compact must call this before the loop.
+  // The image keeps the expanded pixels until it's compacted again.
+  virtual void expand() const = 0;
+
   template<typename ImageTraits>
   ImageBits<ImageTraits> lockBits(LockType lockType, const gfx::Rect& bounds)
   {
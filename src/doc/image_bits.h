@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (C) 2019  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2014  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -34,6 +34,9 @@ public:
   {
     ASSERT(bounds.x >= 0 && bounds.x + bounds.w <= image->width() && bounds.y >= 0 &&
            bounds.y + bounds.h <= image->height());
+
+    // Iterators access the rows directly
+    image->expand();
   }
 
   ImageBits& operator=(const ImageBits& other)
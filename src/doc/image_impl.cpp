@@ -15,6 +15,12 @@
 
 namespace doc {
 
+std::mutex& compact_images_mutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
 void copy_bitmaps(Image* dst, const Image* src, gfx::Clip area)
 {
   if (!area.clip(dst->width(), dst->height(), src->width(), src->height()))
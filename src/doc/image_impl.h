@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (C) 2018-2023  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2016  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -10,10 +10,13 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
 
 #include "doc/blend_funcs.h"
+#include "doc/compact_image_data.h"
 #include "doc/image.h"
 #include "doc/image_bits.h"
 #include "doc/image_iterator.h"
@@ -24,6 +27,9 @@ namespace doc {
 template<typename ImageTraits>
 class LockImageBits;
 
+// Mutex used to expand compact images (see Image::compact()).
+std::mutex& compact_images_mutex();
+
 template<class Traits>
 class ImageImpl : public Image {
 public:
@@ -32,22 +38,74 @@ public:
   using const_address_t = typename traits_t::const_address_t;
 
 private:
-  ImageBufferPtr m_buffer;
-  address_t* m_rows;
-  address_t m_bits;
-
+  mutable ImageBufferPtr m_buffer;
+  // Table of rows. It's nullptr when the image is compact, in that
+  // case the pixels are in m_compact and the rows are created again
+  // by expand().
+  mutable address_t* m_rows;
+  mutable CompactImageDataPtr m_compact;
+  mutable std::atomic<bool> m_isCompact;
+
+  // The image must be expanded (see Image::expand()), rows are
+  // accessed directly without checking if the image is compact.
   inline address_t getLineAddress(int y)
   {
     ASSERT(y >= 0 && y < height());
+    ASSERT(m_rows);
     return m_rows[y];
   }
 
   inline const_address_t getLineAddress(int y) const
   {
     ASSERT(y >= 0 && y < height());
+    ASSERT(m_rows);
     return m_rows[y];
   }
 
+  // Creates the table of rows and the pixels in the given buffer.
+  address_t* createRows(ImageBufferPtr& buffer) const
+  {
+    const std::size_t for_rows = doc_align_size(sizeof(address_t) * height());
+    const std::size_t for_pixels = m_rowBytes * height();
+    const std::size_t required_size = for_pixels + for_rows;
+
+    if (!buffer)
+      buffer = std::make_shared<ImageBuffer>(required_size);
+    else
+      buffer->resizeIfNecessary(required_size);
+
+    std::fill(buffer->buffer(), buffer->buffer() + required_size, 0);
+
+    auto rows = (address_t*)buffer->buffer();
+    auto addr = buffer->buffer() + for_rows;
+    for (int y = 0; y < height(); ++y) {
+      rows[y] = (address_t)addr;
+      addr += m_rowBytes;
+    }
+    return rows;
+  }
+
+  // Decompresses the pixels of a compact image.
+  void expandCompact() const
+  {
+    const std::lock_guard lock(compact_images_mutex());
+
+    // Other thread could have expanded the image
+    if (!m_isCompact.load(std::memory_order_relaxed))
+      return;
+
+    ASSERT(m_compact);
+    ImageBufferPtr buffer;
+    address_t* rows = createRows(buffer);
+    for (int y = 0; y < height(); ++y)
+      m_compact->decodeRow(y, (uint8_t*)rows[y]);
+
+    m_buffer = buffer;
+    m_compact.reset();
+    m_rows = rows;
+    m_isCompact.store(false, std::memory_order_release);
+  }
+
 public:
   inline address_t address(int x, int y) const
   {
@@ -64,26 +122,70 @@ public:
     ASSERT(Traits::color_mode == spec.colorMode());
 
     m_rowBytes = Traits::rowstride_bytes(width());
+    m_rows = createRows(m_buffer);
+    m_isCompact = false;
+  }
 
-    const std::size_t for_rows = doc_align_size(sizeof(address_t) * height());
-    const std::size_t for_pixels = m_rowBytes * height();
-    const std::size_t required_size = for_pixels + for_rows;
+  // Creates a compact image with the given pixels (the data can be
+  // shared with other images).
+  ImageImpl(const ImageSpec& spec, const CompactImageDataPtr& data)
+    : Image(spec)
+    , m_rows(nullptr)
+    , m_compact(data)
+    , m_isCompact(true)
+  {
+    ASSERT(Traits::color_mode == spec.colorMode());
+    ASSERT(data);
 
-    if (!m_buffer)
-      m_buffer = std::make_shared<ImageBuffer>(required_size);
-    else
-      m_buffer->resizeIfNecessary(required_size);
+    m_rowBytes = Traits::rowstride_bytes(width());
 
-    std::fill(m_buffer->buffer(), m_buffer->buffer() + required_size, 0);
+    ASSERT(data->rowBytes() == m_rowBytes);
+    ASSERT(data->height() == height());
+  }
 
-    m_rows = (address_t*)m_buffer->buffer();
-    m_bits = (address_t)(m_buffer->buffer() + for_rows);
+  int getMemSize() const override
+  {
+    const std::lock_guard lock(compact_images_mutex());
+    if (m_compact)
+      return sizeof(ImageImpl) + int(m_compact->memSize());
+    return Image::getMemSize();
+  }
 
-    auto addr = (uint8_t*)m_bits;
-    for (int y = 0; y < height(); ++y) {
-      m_rows[y] = (address_t)addr;
-      addr += m_rowBytes;
-    }
+  bool compact() override
+  {
+    if (isCompact())
+      return true;
+
+    // We cannot release a buffer that is shared with other images
+    // (e.g. buffers used for temporary images).
+    if (m_buffer.use_count() > 1)
+      return false;
+
+    // It's worth only if we can save at least half of the memory
+    CompactImageDataPtr data = CompactImageData::create(this, m_rowBytes * height() / 2);
+    if (!data)
+      return false;
+
+    const std::lock_guard lock(compact_images_mutex());
+    m_compact = data;
+    m_rows = nullptr;
+    m_buffer.reset();
+    m_isCompact.store(true, std::memory_order_release);
+    return true;
+  }
+
+  bool isCompact() const override { return m_isCompact.load(std::memory_order_acquire); }
+
+  void expand() const override
+  {
+    if (m_isCompact.load(std::memory_order_acquire))
+      expandCompact();
+  }
+
+  CompactImageDataPtr compactData() const override
+  {
+    const std::lock_guard lock(compact_images_mutex());
+    return m_compact;
   }
 
   uint8_t* getPixelAddress(int x, int y) const override
@@ -91,6 +193,7 @@ public:
     ASSERT(x >= 0 && x < width());
     ASSERT(y >= 0 && y < height());
 
+    expand();
     return (uint8_t*)address(x, y);
   }
 
@@ -99,6 +202,7 @@ public:
     ASSERT(x >= 0 && x < width());
     ASSERT(y >= 0 && y < height());
 
+    expand();
     return *address(x, y);
   }
 
@@ -107,6 +211,7 @@ public:
     ASSERT(x >= 0 && x < width());
     ASSERT(y >= 0 && y < height());
 
+    expand();
     *address(x, y) = color;
   }
 
@@ -114,6 +219,7 @@ public:
   {
     const int w = width();
     const int h = height();
+    expand();
     for (int y = 0; y < h; ++y) {
       address_t p = address(0, y);
       std::fill(p, p + w, color);
@@ -129,6 +235,8 @@ public:
     if (!area.clip(width(), height(), src->width(), src->height()))
       return;
 
+    expand();
+    src->expand();
     for (int end_y = area.dst.y + area.size.h; area.dst.y < end_y; ++area.dst.y, ++area.src.y) {
       src_address = src->address(area.src.x, area.src.y);
       dst_address = address(area.dst.x, area.dst.y);
@@ -149,6 +257,8 @@ public:
 
   void fillRect(int x1, int y1, int x2, int y2, color_t color) override
   {
+    expand();
+
     // Fill the first line
     ImageImpl<Traits>::drawHLine(x1, y1, x2, color);
 
@@ -227,6 +337,7 @@ private:
 template<>
 inline void ImageImpl<IndexedTraits>::clear(color_t color)
 {
+  expand();
   uint8_t* p = address(0, 0);
   std::fill(p, p + rowBytes() * height(), color);
 }
@@ -234,6 +345,7 @@ inline void ImageImpl<IndexedTraits>::clear(color_t color)
 template<>
 inline void ImageImpl<BitmapTraits>::clear(color_t color)
 {
+  expand();
   uint8_t* p = address(0, 0);
   std::fill(p, p + rowBytes() * height(), (color ? 0xff : 0x00));
 }
@@ -244,6 +356,7 @@ inline color_t ImageImpl<BitmapTraits>::getPixel(int x, int y) const
   ASSERT(x >= 0 && x < width());
   ASSERT(y >= 0 && y < height());
 
+  expand();
   std::div_t d = std::div(x, 8);
   return ((*(getLineAddress(y) + d.quot)) & (1 << d.rem)) ? 1 : 0;
 }
@@ -254,6 +367,7 @@ inline void ImageImpl<BitmapTraits>::putPixel(int x, int y, color_t color)
   ASSERT(x >= 0 && x < width());
   ASSERT(y >= 0 && y < height());
 
+  expand();
   std::div_t d = std::div(x, 8);
   if (color)
     (*(getLineAddress(y) + d.quot)) |= (1 << d.rem);
@@ -292,6 +406,8 @@ void copy_bitmaps(Image* dst, const Image* src, gfx::Clip area);
 template<>
 inline void ImageImpl<BitmapTraits>::copy(const Image* src, gfx::Clip area)
 {
+  expand();
+  src->expand();
   copy_bitmaps(this, src, area);
 }
 
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2018 Igara Studio S.A.
+// Copyright (c) 2018-2025 Igara Studio S.A.
 // Copyright (c) 2001-2018 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -220,6 +220,132 @@ TYPED_TEST(ImageAllTypes, FillRect)
   }
 }
 
+TYPED_TEST(ImageAllTypes, CompactAndExpand)
+{
+  typedef TypeParam ImageTraits;
+
+  const int w = 1024;
+  const int h = 128;
+  std::unique_ptr<Image> image(Image::create(ImageTraits::pixel_format, w, h));
+  image->clear(0);
+
+  // A mostly empty image
+  for (int c = 0; c < 100; ++c) {
+    color_t color = (rand() % ImageTraits::max_value);
+    put_pixel(image.get(), rand() % w, rand() % h, color ? color : 1);
+  }
+  fill_rect(image.get(), 10, 10, 40, 20, 1);
+
+  // Regular (non-compact) copy
+  std::unique_ptr<Image> copy(crop_image(image.get(), 0, 0, w, h, 0));
+  EXPECT_TRUE(image->compact());
+  EXPECT_TRUE(image->isCompact());
+  EXPECT_LT(image->getMemSize(), copy->getMemSize());
+
+  // The first access expands the image again
+  {
+    const LockImageBits<ImageTraits> bits((const Image*)image.get());
+    EXPECT_EQ(get_pixel(copy.get(), 0, 0), *bits.begin());
+    EXPECT_FALSE(image->isCompact());
+  }
+  EXPECT_TRUE(is_same_image(image.get(), copy.get()));
+
+  // expand() decompresses the pixels once so the rows can be used
+  // directly with the *_fast() functions
+  EXPECT_TRUE(image->compact());
+  image->expand();
+  EXPECT_FALSE(image->isCompact());
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x)
+      ASSERT_EQ(get_pixel(copy.get(), x, y), get_pixel_fast<ImageTraits>(image.get(), x, y));
+  }
+
+  // A full image cannot be compacted
+  image->clear(1);
+  EXPECT_FALSE(image->compact());
+  EXPECT_FALSE(image->isCompact());
+}
+
+TYPED_TEST(ImageAllTypes, CompactIterators)
+{
+  typedef TypeParam ImageTraits;
+
+  const int w = 1024;
+  const int h = 128;
+  std::unique_ptr<Image> image(Image::create(ImageTraits::pixel_format, w, h));
+  image->clear(0);
+  fill_rect(image.get(), 20, 10, 60, 30, 1);
+  std::unique_ptr<Image> copy(crop_image(image.get(), 0, 0, w, h, 0));
+
+  // Iterators access the rows with get_pixel_address_fast(), so
+  // LockImageBits must expand the image before creating them (even
+  // for a region that doesn't start in the first row).
+  const gfx::Rect bounds(8, 5, 100, 40);
+  EXPECT_TRUE(image->compact());
+  {
+    LockImageBits<ImageTraits> bits(image.get(), bounds);
+    EXPECT_FALSE(image->isCompact());
+
+    auto it = bits.begin();
+    for (int y = bounds.y; y < bounds.y2(); ++y) {
+      for (int x = bounds.x; x < bounds.x2(); ++x, ++it) {
+        ASSERT_EQ(get_pixel(copy.get(), x, y), *it);
+        *it = (x + y) % 2;
+      }
+    }
+    EXPECT_TRUE(it == bits.end());
+  }
+
+  // The same for read-only iterators over the whole image
+  EXPECT_TRUE(image->compact());
+  {
+    const LockImageBits<ImageTraits> bits((const Image*)image.get());
+    EXPECT_FALSE(image->isCompact());
+
+    auto it = bits.begin();
+    for (int y = 0; y < h; ++y) {
+      for (int x = 0; x < w; ++x, ++it) {
+        const color_t expected = (bounds.contains(gfx::Point(x, y)) ? (x + y) % 2 :
+                                                                      get_pixel(copy.get(), x, y));
+        ASSERT_EQ(expected, *it);
+      }
+    }
+  }
+}
+
+TYPED_TEST(ImageAllTypes, CopyOnWrite)
+{
+  typedef TypeParam ImageTraits;
+
+  const int w = 512;
+  const int h = 256;
+  std::unique_ptr<Image> image(Image::create(ImageTraits::pixel_format, w, h));
+  image->clear(0);
+  fill_rect(image.get(), 100, 100, 200, 120, 1);
+
+  // A regular copy is never compacted
+  std::unique_ptr<Image> regular(Image::createCopy(image.get()));
+  EXPECT_FALSE(regular->isCompact());
+
+  // The compact copy of a big mostly empty image is compact
+  std::unique_ptr<Image> copy(Image::createCompactCopy(image.get()));
+  EXPECT_TRUE(copy->isCompact());
+  EXPECT_FALSE(image->isCompact());
+
+  // The copy of a compact image shares the same data
+  std::unique_ptr<Image> copy2(Image::createCopy(copy.get()));
+  EXPECT_TRUE(copy2->isCompact());
+  EXPECT_EQ(copy->compactData(), copy2->compactData());
+
+  // Modifying a copy doesn't modify the others
+  put_pixel(copy2.get(), 0, 0, 1);
+  EXPECT_FALSE(copy2->isCompact());
+  EXPECT_TRUE(copy->isCompact());
+  EXPECT_EQ(0, get_pixel(copy.get(), 0, 0));
+  EXPECT_EQ(1, get_pixel(copy2.get(), 0, 0));
+  EXPECT_TRUE(is_same_image(image.get(), copy.get()));
+}
+
 int main(int argc, char** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (C) 2019-2021  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -381,20 +381,34 @@ void LayerImage::configureAsBackground()
 
 void LayerImage::displaceFrames(frame_t fromThis, frame_t delta)
 {
-  Sprite* sprite = this->sprite();
+  // All cels after "fromThis" are displaced by the same delta, so
+  // they keep their order in m_cels and we can modify them in place
+  // (instead of removing/inserting each cel).
+  auto it = findFirstCelIteratorAfter(fromThis - 1);
+  ASSERT(delta > 0 || it == m_cels.begin() || it == m_cels.end() ||
+         (*(it - 1))->frame() < (*it)->frame() + delta);
 
-  if (delta > 0) {
-    for (frame_t c = sprite->lastFrame(); c >= fromThis; --c) {
-      if (Cel* cel = this->cel(c))
-        moveCel(cel, c + delta);
-    }
+  for (auto end = m_cels.end(); it != end; ++it) {
+    Cel* cel = *it;
+    cel->m_frame += delta;
+    cel->incrementVersion(); // TODO this should be in app::cmd module
   }
-  else {
-    for (frame_t c = fromThis; c <= sprite->lastFrame(); ++c) {
-      if (Cel* cel = this->cel(c))
-        moveCel(cel, c + delta);
+}
+
+void LayerImage::remapFrames(const std::vector<frame_t>& newFrames)
+{
+  for (Cel* cel : m_cels) {
+    ASSERT(cel->frame() >= 0 && cel->frame() < frame_t(newFrames.size()));
+    const frame_t newFrame = newFrames[cel->frame()];
+    if (cel->frame() != newFrame) {
+      cel->m_frame = newFrame;
+      cel->incrementVersion(); // TODO this should be in app::cmd module
     }
   }
+
+  std::sort(m_cels.begin(), m_cels.end(), [](const Cel* a, const Cel* b) {
+    return a->frame() < b->frame();
+  });
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -584,4 +598,10 @@ void LayerGroup::displaceFrames(frame_t fromThis, frame_t delta)
     layer->displaceFrames(fromThis, delta);
 }
 
+void LayerGroup::remapFrames(const std::vector<frame_t>& newFrames)
+{
+  for (Layer* layer : m_layers)
+    layer->remapFrames(newFrames);
+}
+
 } // namespace doc
@@ -17,6 +17,7 @@
 #include "doc/with_user_data.h"
 
 #include <string>
+#include <vector>
 
 namespace doc {
 
@@ -126,6 +127,9 @@ public:
   virtual Cel* cel(frame_t frame) const;
   virtual void getCels(CelList& cels) const = 0;
   virtual void displaceFrames(frame_t fromThis, frame_t delta) = 0;
+  // Moves each cel in the frame "f" to the frame "newFrames[f]"
+  // ("newFrames" must be a permutation of all sprite frames).
+  virtual void remapFrames(const std::vector<frame_t>& newFrames) = 0;
 
 private:
   std::string m_name;   // layer name
@@ -161,6 +165,7 @@ public:
   Cel* cel(frame_t frame) const override;
   void getCels(CelList& cels) const override;
   void displaceFrames(frame_t fromThis, frame_t delta) override;
+  void remapFrames(const std::vector<frame_t>& newFrames) override;
 
   Cel* getLastCel() const;
   CelConstIterator findCelIterator(frame_t frame) const;
@@ -216,6 +221,7 @@ public:
 
   void getCels(CelList& cels) const override;
   void displaceFrames(frame_t fromThis, frame_t delta) override;
+  void remapFrames(const std::vector<frame_t>& newFrames) override;
 
   bool isBrowsable() const override { return isGroup() && isExpanded() && !m_layers.empty(); }
 
@@ -1,4 +1,5 @@
 // Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
 // Copyright (c) 2001-2015 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -11,6 +12,9 @@
 #include "doc/mask_boundaries.h"
 
 #include "doc/image_impl.h"
+#include "doc/mask.h"
+
+#include <algorithm>
 
 namespace doc {
 
@@ -19,6 +23,13 @@ void MaskBoundaries::reset()
   m_segs.clear();
   if (!m_path.isEmpty())
     m_path.rewind();
+  resetCache();
+}
+
+void MaskBoundaries::resetCache()
+{
+  m_cacheBitmap.reset();
+  m_cacheBounds = gfx::Rect();
 }
 
 void MaskBoundaries::regen(const Image* bitmap)
@@ -347,12 +358,300 @@ void MaskBoundaries::regen(const Image* bitmap)
   ASSERT(prevIt == bits.end());
 }
 
+// Returns the 8 pixels of the bitmap row starting from the "x"
+// pixel (pixels outside the [0, w) range are unselected).
+static inline int get_bits8(const uint8_t* row, const int x, const int w)
+{
+  if (!row)
+    return 0;
+
+  if (x >= 0 && x + 8 <= w) {
+    const int i = (x >> 3);
+    const int s = (x & 7);
+    int bits = (row[i] >> s);
+    if (s)
+      bits |= (row[i + 1] << (8 - s));
+    return (bits & 0xff);
+  }
+
+  int bits = 0;
+  for (int i = 0; i < 8; ++i) {
+    const int u = x + i;
+    if (u >= 0 && u < w && (row[u >> 3] & (1 << (u & 7))))
+      bits |= (1 << i);
+  }
+  return bits;
+}
+
+static inline const uint8_t* get_row(const Image* bitmap, const gfx::Rect& bounds, const int y)
+{
+  if (y >= bounds.y && y < bounds.y2())
+    return bitmap->getPixelAddress(0, y - bounds.y);
+  return nullptr;
+}
+
+// Returns the bounds of the pixels (in sprite coordinates) that are
+// different between the two given bitmaps, comparing 8 pixels at a
+// time.
+static gfx::Rect diff_bitmaps(const Image* a,
+                              const gfx::Rect& aBounds,
+                              const Image* b,
+                              const gfx::Rect& bBounds)
+{
+  const gfx::Rect u = aBounds.createUnion(bBounds);
+  int x1 = u.x2(), y1 = u.y2(), x2 = u.x, y2 = u.y;
+
+  for (int y = u.y; y < u.y2(); ++y) {
+    const uint8_t* aRow = get_row(a, aBounds, y);
+    const uint8_t* bRow = get_row(b, bBounds, y);
+
+    for (int x = u.x; x < u.x2(); x += 8) {
+      int diff = (get_bits8(aRow, x - aBounds.x, aBounds.w) ^
+                  get_bits8(bRow, x - bBounds.x, bBounds.w));
+      if (x + 8 > u.x2())
+        diff &= (1 << (u.x2() - x)) - 1;
+      if (diff) {
+        int i = 0, j = 7;
+        while (!(diff & (1 << i)))
+          ++i;
+        while (!(diff & (1 << j)))
+          --j;
+        x1 = std::min(x1, x + i);
+        x2 = std::max(x2, x + j + 1);
+        y1 = std::min(y1, y);
+        y2 = y + 1;
+      }
+    }
+  }
+
+  if (x1 < x2)
+    return gfx::Rect(x1, y1, x2 - x1, y2 - y1);
+  return gfx::Rect();
+}
+
+void MaskBoundaries::regen(const Mask* mask)
+{
+  if (!mask || mask->isEmpty()) {
+    reset();
+    return;
+  }
+
+  const Image* bitmap = mask->bitmap();
+  const gfx::Rect& bounds = mask->bounds();
+
+  if (m_cacheBitmap) {
+    const gfx::Rect area = diff_bitmaps(m_cacheBitmap.get(), m_cacheBounds, bitmap, bounds);
+
+    // Nothing to do, these are the same boundaries
+    if (area.isEmpty())
+      return;
+
+    // Recalculate only the modified area if it's small enough
+    if (area.w * area.h < bounds.w * bounds.h / 2) {
+      regenArea(mask, area);
+      m_cacheBitmap.reset(Image::createCopy(bitmap));
+      m_cacheBounds = bounds;
+      return;
+    }
+  }
+
+  regen(bitmap);
+  offset(bounds.x, bounds.y);
+
+  m_cacheBitmap.reset(Image::createCopy(bitmap));
+  m_cacheBounds = bounds;
+}
+
+// Segments are maximal runs of edges between selected and unselected
+// pixels with the same orientation (open or closed). Here we keep all
+// segments outside the modified "area" (splitting the ones that cross
+// it), add the new segments of the edges that can change inside the
+// area, and join the segments that continue in both sides of the area
+// border.
+void MaskBoundaries::regenArea(const Mask* mask, const gfx::Rect& area)
+{
+  const Image* bitmap = mask->bitmap();
+  const gfx::Rect& bounds = mask->bounds();
+  auto selected = [bitmap, &bounds](int x, int y) -> bool {
+    x -= bounds.x;
+    y -= bounds.y;
+    return (x >= 0 && y >= 0 && x < bounds.w && y < bounds.h &&
+            (*(bitmap->getPixelAddress(0, y) + (x >> 3)) & (1 << (x & 7))));
+  };
+
+  // Horizontal edges that can change are in rows [area.y, area.y2()]
+  // and vertical edges in columns [area.x, area.x2()]. We keep the
+  // index of the segments that end/start just in the area border to
+  // join them with the new segments.
+  std::vector<int> hEnd(area.h + 1, -1), hStart(area.h + 1, -1);
+  std::vector<int> vEnd(area.w + 1, -1), vStart(area.w + 1, -1);
+
+  list_type segs;
+  segs.reserve(m_segs.size());
+
+  for (const Segment& seg : m_segs) {
+    const gfx::Rect& rc = seg.bounds();
+
+    if (seg.horizontal()) {
+      if (rc.y < area.y || rc.y > area.y2()) {
+        segs.push_back(seg);
+        continue;
+      }
+      const int i = rc.y - area.y;
+      if (rc.x2() <= area.x || rc.x >= area.x2()) {
+        segs.push_back(seg);
+        if (rc.x2() == area.x)
+          hEnd[i] = int(segs.size() - 1);
+        else if (rc.x == area.x2())
+          hStart[i] = int(segs.size() - 1);
+        continue;
+      }
+      if (rc.x < area.x) {
+        segs.push_back(Segment(seg.open(), gfx::Rect(rc.x, rc.y, area.x - rc.x, 0)));
+        hEnd[i] = int(segs.size() - 1);
+      }
+      if (rc.x2() > area.x2()) {
+        segs.push_back(Segment(seg.open(), gfx::Rect(area.x2(), rc.y, rc.x2() - area.x2(), 0)));
+        hStart[i] = int(segs.size() - 1);
+      }
+    }
+    else {
+      if (rc.x < area.x || rc.x > area.x2()) {
+        segs.push_back(seg);
+        continue;
+      }
+      const int i = rc.x - area.x;
+      if (rc.y2() <= area.y || rc.y >= area.y2()) {
+        segs.push_back(seg);
+        if (rc.y2() == area.y)
+          vEnd[i] = int(segs.size() - 1);
+        else if (rc.y == area.y2())
+          vStart[i] = int(segs.size() - 1);
+        continue;
+      }
+      if (rc.y < area.y) {
+        segs.push_back(Segment(seg.open(), gfx::Rect(rc.x, rc.y, 0, area.y - rc.y)));
+        vEnd[i] = int(segs.size() - 1);
+      }
+      if (rc.y2() > area.y2()) {
+        segs.push_back(Segment(seg.open(), gfx::Rect(rc.x, area.y2(), 0, rc.y2() - area.y2())));
+        vStart[i] = int(segs.size() - 1);
+      }
+    }
+  }
+
+  // Adds a new run of edges, joining it with the segments at both
+  // sides of the area when possible. Joined segments at the end of
+  // the run are marked as empty to be removed.
+  auto addRun = [&segs](const bool open,
+                        const gfx::Rect& run,
+                        int& prev,
+                        int& next,
+                        const bool touchesPrev,
+                        const bool touchesNext) {
+    const bool horz = (run.h == 0);
+    int i;
+    if (touchesPrev && prev >= 0 && segs[prev].open() == open) {
+      i = prev;
+      if (horz)
+        segs[i].m_bounds.w += run.w;
+      else
+        segs[i].m_bounds.h += run.h;
+    }
+    else {
+      segs.push_back(Segment(open, run));
+      i = int(segs.size() - 1);
+    }
+    if (touchesNext && next >= 0 && segs[next].open() == open) {
+      if (horz)
+        segs[i].m_bounds.w += segs[next].m_bounds.w;
+      else
+        segs[i].m_bounds.h += segs[next].m_bounds.h;
+      segs[next].m_bounds = gfx::Rect();
+      next = -1;
+    }
+  };
+
+  // New horizontal segments
+  for (int y = area.y; y <= area.y2(); ++y) {
+    int start = 0;
+    bool inRun = false;
+    bool open = false;
+    for (int x = area.x; x <= area.x2(); ++x) {
+      int edge = -1; // -1 = no edge, 0 = closed, 1 = open
+      if (x < area.x2()) {
+        const bool above = selected(x, y - 1);
+        const bool below = selected(x, y);
+        if (above != below)
+          edge = (below ? 1 : 0);
+      }
+      if (inRun && edge != int(open)) {
+        addRun(open,
+               gfx::Rect(start, y, x - start, 0),
+               hEnd[y - area.y],
+               hStart[y - area.y],
+               start == area.x,
+               x == area.x2());
+        inRun = false;
+      }
+      if (edge >= 0 && !inRun) {
+        inRun = true;
+        start = x;
+        open = (edge == 1);
+      }
+    }
+  }
+
+  // New vertical segments
+  for (int x = area.x; x <= area.x2(); ++x) {
+    int start = 0;
+    bool inRun = false;
+    bool open = false;
+    for (int y = area.y; y <= area.y2(); ++y) {
+      int edge = -1;
+      if (y < area.y2()) {
+        const bool left = selected(x - 1, y);
+        const bool right = selected(x, y);
+        if (left != right)
+          edge = (right ? 1 : 0);
+      }
+      if (inRun && edge != int(open)) {
+        addRun(open,
+               gfx::Rect(x, start, 0, y - start),
+               vEnd[x - area.x],
+               vStart[x - area.x],
+               start == area.y,
+               y == area.y2());
+        inRun = false;
+      }
+      if (edge >= 0 && !inRun) {
+        inRun = true;
+        start = y;
+        open = (edge == 1);
+      }
+    }
+  }
+
+  // Remove joined segments
+  segs.erase(std::remove_if(segs.begin(),
+                            segs.end(),
+                            [](const Segment& seg) {
+                              return (seg.bounds().w == 0 && seg.bounds().h == 0);
+                            }),
+             segs.end());
+
+  m_segs = std::move(segs);
+  if (!m_path.isEmpty())
+    m_path.rewind();
+}
+
 void MaskBoundaries::offset(int x, int y)
 {
   for (Segment& seg : m_segs)
     seg.offset(x, y);
 
   m_path.offset(x, y);
+  m_cacheBounds.offset(x, y);
 }
 
 void MaskBoundaries::createPathIfNeeeded()
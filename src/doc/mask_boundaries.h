@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2020 Igara Studio S.A.
+// Copyright (c) 2020-2025 Igara Studio S.A.
 // Copyright (c) 2001-2015 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -9,6 +9,7 @@
 #define DOC_MASK_BOUNDARIES_H_INCLUDED
 #pragma once
 
+#include "doc/image_ref.h"
 #include "gfx/path.h"
 #include "gfx/rect.h"
 
@@ -16,6 +17,7 @@
 
 namespace doc {
 class Image;
+class Mask;
 
 class MaskBoundaries {
 public:
@@ -46,6 +48,12 @@ public:
   void reset();
   void regen(const Image* bitmap);
 
+  // Regenerates the boundaries of the given mask (in sprite
+  // coordinates). The mask bitmap is compared with the one used in
+  // the previous call, and only the segments around the modified
+  // area are calculated again.
+  void regen(const Mask* mask);
+
   const_iterator begin() const { return m_segs.begin(); }
   const_iterator end() const { return m_segs.end(); }
   iterator begin() { return m_segs.begin(); }
@@ -57,8 +65,16 @@ public:
   void createPathIfNeeeded();
 
 private:
+  void regenArea(const Mask* mask, const gfx::Rect& area);
+  void resetCache();
+
   list_type m_segs;
   gfx::Path m_path;
+
+  // Copy of the mask bitmap (and its bounds) used in the last call
+  // to regen(const Mask*), i.e. the bitmap that generated m_segs.
+  ImageRef m_cacheBitmap;
+  gfx::Rect m_cacheBounds;
 };
 
 } // namespace doc
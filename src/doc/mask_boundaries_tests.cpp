@@ -0,0 +1,80 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#include "gtest/gtest.h"
+
+#include "doc/mask.h"
+#include "doc/mask_boundaries.h"
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+using namespace doc;
+using namespace gfx;
+
+using Segs = std::vector<std::tuple<int, int, int, int, bool>>;
+
+static Segs sorted_segs(const MaskBoundaries& boundaries)
+{
+  Segs segs;
+  for (const auto& seg : boundaries) {
+    const Rect& rc = seg.bounds();
+    segs.emplace_back(rc.x, rc.y, rc.w, rc.h, seg.open());
+  }
+  std::sort(segs.begin(), segs.end());
+  return segs;
+}
+
+static void expect_same_as_full_regen(const MaskBoundaries& boundaries, const Mask& mask)
+{
+  MaskBoundaries full;
+  full.regen(mask.bitmap());
+  full.offset(mask.bounds().x, mask.bounds().y);
+  EXPECT_EQ(sorted_segs(full), sorted_segs(boundaries));
+}
+
+TEST(MaskBoundaries, IncrementalRegen)
+{
+  Mask mask;
+  mask.replace(Rect(10, 10, 40, 30));
+  mask.subtract(Rect(20, 15, 5, 5));
+
+  MaskBoundaries boundaries;
+  boundaries.regen(&mask);
+  expect_same_as_full_regen(boundaries, mask);
+
+  // Small modifications inside the mask bounds
+  mask.add(Rect(20, 15, 2, 2));
+  boundaries.regen(&mask);
+  expect_same_as_full_regen(boundaries, mask);
+
+  mask.subtract(Rect(30, 20, 3, 1));
+  boundaries.regen(&mask);
+  expect_same_as_full_regen(boundaries, mask);
+
+  // Modifications in the border that expand the mask bounds
+  mask.add(Rect(8, 12, 4, 3));
+  boundaries.regen(&mask);
+  expect_same_as_full_regen(boundaries, mask);
+
+  mask.subtract(Rect(10, 10, 1, 1));
+  boundaries.regen(&mask);
+  expect_same_as_full_regen(boundaries, mask);
+
+  // Moved boundaries
+  boundaries.offset(3, 4);
+  mask.offsetOrigin(3, 4);
+  mask.add(Rect(40, 40, 1, 1));
+  boundaries.regen(&mask);
+  expect_same_as_full_regen(boundaries, mask);
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
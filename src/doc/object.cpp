@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (C) 2019-2022  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2016  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -13,15 +13,36 @@
 
 #include "base/debug.h"
 
-#include <map>
+#include <array>
+#include <atomic>
 #include <mutex>
+#include <unordered_map>
 
 namespace doc {
 
-static std::mutex g_mutex;
-static ObjectId newId = 0;
-// TODO Profile this and see if an unordered_map is better
-static std::map<ObjectId, Object*> objects;
+namespace {
+
+// The registry of objects is split in several shards (each one with
+// its own mutex) so threads creating/destroying objects at the same
+// time (e.g. loading files in parallel) don't compete for the same
+// lock. IDs are sequential, so consecutive objects go to different
+// shards.
+constexpr int kShards = 64;
+
+struct Shard {
+  std::mutex mutex;
+  std::unordered_map<ObjectId, Object*> objects;
+};
+
+std::atomic<ObjectId> newId(0);
+std::array<Shard, kShards> shards;
+
+Shard& shard_for(ObjectId id)
+{
+  return shards[id & (kShards - 1)];
+}
+
+} // anonymous namespace
 
 Object::Object(ObjectType type) : m_type(type), m_id(0), m_version(0)
 {
@@ -50,28 +71,33 @@ const ObjectId Object::id() const
   // The first time the ID is request, we store the object in the
   // "objects" hash table.
   if (!m_id) {
-    const std::lock_guard lock(g_mutex);
-    m_id = ++newId;
-    objects.insert(std::make_pair(m_id, const_cast<Object*>(this)));
+    const ObjectId id = ++newId;
+    Shard& shard = shard_for(id);
+    const std::lock_guard lock(shard.mutex);
+    shard.objects.insert(std::make_pair(id, const_cast<Object*>(this)));
+    m_id = id;
   }
   return m_id;
 }
 
 void Object::setId(ObjectId id)
 {
-  const std::lock_guard lock(g_mutex);
-
   if (m_id) {
-    auto it = objects.find(m_id);
-    ASSERT(it != objects.end());
+    Shard& shard = shard_for(m_id);
+    const std::lock_guard lock(shard.mutex);
+    auto it = shard.objects.find(m_id);
+    ASSERT(it != shard.objects.end());
     ASSERT(it->second == this);
-    if (it != objects.end())
-      objects.erase(it);
+    if (it != shard.objects.end())
+      shard.objects.erase(it);
   }
 
   m_id = id;
 
   if (m_id) {
+    Shard& shard = shard_for(m_id);
+    const std::lock_guard lock(shard.mutex);
+    auto& objects = shard.objects;
 #ifdef _DEBUG
     if (objects.find(m_id) != objects.end()) {
       Object* obj = objects.find(m_id)->second;
@@ -101,9 +127,10 @@ void Object::setVersion(ObjectVersion version)
 
 Object* get_object(ObjectId id)
 {
-  const std::lock_guard lock(g_mutex);
-  auto it = objects.find(id);
-  if (it != objects.end())
+  Shard& shard = shard_for(id);
+  const std::lock_guard lock(shard.mutex);
+  auto it = shard.objects.find(id);
+  if (it != shard.objects.end())
     return it->second;
   else
     return nullptr;
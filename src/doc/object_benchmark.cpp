@@ -0,0 +1,60 @@
+// Aseprite Document Library
+// Copyright (c) 2025 Igara Studio S.A.
+//
+// This file is released under the terms of the MIT license.
+// Read LICENSE.txt for more information.
+
+#ifdef HAVE_CONFIG_H
+  #include "config.h"
+#endif
+
+#include "doc/object.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+using namespace doc;
+
+class TestObject : public Object {
+public:
+  TestObject() : Object(ObjectType::Image) {}
+};
+
+// Creates/destroys objects registering them (as it happens when
+// images are loaded or undone).
+void BM_CreateObjects(benchmark::State& state)
+{
+  const int n = state.range(0);
+  std::vector<std::unique_ptr<TestObject>> objs(n);
+  while (state.KeepRunning()) {
+    for (auto& obj : objs) {
+      obj = std::make_unique<TestObject>();
+      obj->id();
+    }
+    for (auto& obj : objs)
+      obj.reset();
+  }
+}
+
+void BM_GetObject(benchmark::State& state)
+{
+  const int n = state.range(0);
+  std::vector<std::unique_ptr<TestObject>> objs(n);
+  std::vector<ObjectId> ids(n);
+  for (int i = 0; i < n; ++i) {
+    objs[i] = std::make_unique<TestObject>();
+    ids[i] = objs[i]->id();
+  }
+  while (state.KeepRunning()) {
+    for (ObjectId id : ids)
+      benchmark::DoNotOptimize(get_object(id));
+  }
+}
+
+BENCHMARK(BM_CreateObjects)->Arg(1024)->Arg(65536)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK(BM_GetObject)->Arg(1024)->Arg(65536)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
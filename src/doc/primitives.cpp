@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2018-2023 Igara Studio S.A.
+// Copyright (c) 2018-2025 Igara Studio S.A.
 // Copyright (c) 2001-2016 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -546,6 +546,80 @@ void remap_image(Image* image, const Remap& remap)
   }
 }
 
+template<typename ImageTraits>
+static void replace_color_templ(Image* image, const gfx::Rect& bounds, color_t from, color_t to)
+{
+  using pixel_t = typename ImageTraits::pixel_t;
+  const pixel_t f = pixel_t(from);
+  const pixel_t t = pixel_t(to);
+  const int w = bounds.w;
+
+#if defined(__x86_64__) || defined(_WIN64)
+  // Use SSE2 (with unaligned loads as rows are not aligned)
+  __m128i vf, vt;
+  if constexpr (ImageTraits::bytes_per_pixel == 4) {
+    vf = _mm_set1_epi32(int(f));
+    vt = _mm_set1_epi32(int(t));
+  }
+  else if constexpr (ImageTraits::bytes_per_pixel == 2) {
+    vf = _mm_set1_epi16(short(f));
+    vt = _mm_set1_epi16(short(t));
+  }
+  else {
+    vf = _mm_set1_epi8(char(f));
+    vt = _mm_set1_epi8(char(t));
+  }
+  constexpr int kPixelsPerVector = 16 / ImageTraits::bytes_per_pixel;
+#endif
+
+  for (int y = bounds.y; y < bounds.y2(); ++y) {
+    auto p = (pixel_t*)image->getPixelAddress(bounds.x, y);
+    int x = 0;
+
+#if defined(__x86_64__) || defined(_WIN64)
+    for (; x + kPixelsPerVector <= w; x += kPixelsPerVector, p += kPixelsPerVector) {
+      const __m128i v = _mm_loadu_si128((const __m128i*)p);
+      __m128i m;
+      if constexpr (ImageTraits::bytes_per_pixel == 4)
+        m = _mm_cmpeq_epi32(v, vf);
+      else if constexpr (ImageTraits::bytes_per_pixel == 2)
+        m = _mm_cmpeq_epi16(v, vf);
+      else
+        m = _mm_cmpeq_epi8(v, vf);
+
+      if (_mm_movemask_epi8(m))
+        _mm_storeu_si128((__m128i*)p, _mm_or_si128(_mm_and_si128(m, vt), _mm_andnot_si128(m, v)));
+    }
+#endif
+
+    for (; x < w; ++x, ++p) {
+      if (*p == f)
+        *p = t;
+    }
+  }
+}
+
+void replace_color(Image* image, const gfx::Rect& _bounds, color_t from, color_t to)
+{
+  const gfx::Rect bounds = (_bounds & image->bounds());
+  if (bounds.isEmpty() || from == to)
+    return;
+
+  switch (image->pixelFormat()) {
+    case IMAGE_RGB:       replace_color_templ<RgbTraits>(image, bounds, from, to); break;
+    case IMAGE_GRAYSCALE: replace_color_templ<GrayscaleTraits>(image, bounds, from, to); break;
+    case IMAGE_INDEXED:   replace_color_templ<IndexedTraits>(image, bounds, from, to); break;
+    case IMAGE_TILEMAP:   replace_color_templ<TilemapTraits>(image, bounds, from, to); break;
+    case IMAGE_BITMAP:
+      // A bitmap has only two values (0 and 1), so if "from" is one
+      // of them, all pixels will be "to" (the "from" pixels plus
+      // the "to" pixels).
+      if (from == 0 || from == 1)
+        fill_rect(image, bounds, to);
+      break;
+  }
+}
+
 // TODO test this hash routine and find a better alternative
 
 template<typename ImageTraits, uint32_t Mask>
@@ -73,6 +73,10 @@ bool is_same_image_slow(const Image* i1, const Image* i2);
 
 void remap_image(Image* image, const Remap& remap);
 
+// Replaces all pixels with the exact "from" value with the "to" value
+// inside the given bounds (clipped to the image bounds).
+void replace_color(Image* image, const gfx::Rect& bounds, color_t from, color_t to);
+
 uint32_t calculate_image_hash(const Image* image, const gfx::Rect& bounds);
 
 // Sets RGB values to 0 when alpha=0 (to match images with alpha=0
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2023 Igara Studio S.A.
+// Copyright (c) 2023-2025 Igara Studio S.A.
 // Copyright (c) 2001-2015 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -17,6 +17,10 @@ class Image;
 template<typename ImageTraits>
 class ImageImpl;
 
+// These functions access the rows of the image directly, so a
+// compact image must be expanded before using them (see
+// Image::expand()).
+
 template<class Traits>
 inline typename Traits::address_t get_pixel_address_fast(const Image* image, int x, int y)
 {
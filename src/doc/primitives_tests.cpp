@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (c) 2023  Igara Studio S.A.
+// Copyright (c) 2023-2025  Igara Studio S.A.
 //
 // This file is released under the terms of the MIT license.
 // Read LICENSE.txt for more information.
@@ -81,6 +81,49 @@ TYPED_TEST(Primitives, IsSameImage)
   }
 }
 
+TYPED_TEST(Primitives, ReplaceColor)
+{
+  using ImageTraits = TypeParam;
+
+  for (int h = 1; h < 40; h += 7) {
+    for (int w = 1; w < 70; w += 3) {
+      ImageRef a(Image::create(ImageTraits::pixel_format, w, h));
+      for (int v = 0; v < h; ++v)
+        for (int u = 0; u < w; ++u)
+          put_pixel_fast<ImageTraits>(a.get(), u, v, (u + v) % 2);
+
+      const gfx::Rect bounds(1, 0, w, h - 1);
+      ImageRef b(Image::createCopy(a.get()));
+      replace_color(b.get(), bounds, 1, 0);
+
+      for (int v = 0; v < h; ++v) {
+        for (int u = 0; u < w; ++u) {
+          const color_t expected = (bounds.contains(gfx::Point(u, v)) ?
+                                      0 :
+                                      get_pixel_fast<ImageTraits>(a.get(), u, v));
+          ASSERT_EQ(expected, get_pixel_fast<ImageTraits>(b.get(), u, v));
+        }
+      }
+    }
+  }
+}
+
+TEST(Primitives, ReplaceColorBitmap)
+{
+  ImageRef a(Image::create(IMAGE_BITMAP, 9, 5));
+  for (int v = 0; v < a->height(); ++v)
+    for (int u = 0; u < a->width(); ++u)
+      put_pixel_fast<BitmapTraits>(a.get(), u, v, (u + v) % 2);
+
+  // A value that is not in the bitmap doesn't change anything
+  ImageRef b(Image::createCopy(a.get()));
+  replace_color(b.get(), b->bounds(), 2, 1);
+  EXPECT_TRUE(is_same_image(a.get(), b.get()));
+
+  replace_color(b.get(), b->bounds(), 0, 1);
+  EXPECT_TRUE(is_plain_image(b.get(), 1));
+}
+
 int main(int argc, char** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -276,7 +276,7 @@ int Sprite::getMemSize() const
   std::vector<ImageRef> images;
   getImages(images);
   for (const ImageRef& image : images)
-    size += image->rowBytes() * image->height();
+    size += image->getMemSize();
 
   return size;
 }
@@ -460,22 +460,38 @@ RgbMap* Sprite::rgbMap(const frame_t frame,
 
 void Sprite::addFrame(frame_t newFrame)
 {
-  setTotalFrames(m_frames + 1);
+  addFrames(newFrame, 1);
+}
+
+void Sprite::addFrames(frame_t newFrame, frame_t count)
+{
+  ASSERT(count > 0);
+  setTotalFrames(m_frames + count);
+
+  for (frame_t i = m_frames - 1; i >= newFrame + count; --i)
+    setFrameDuration(i, frameDuration(i - count));
 
-  frame_t to = std::max(1, newFrame);
-  for (frame_t i = m_frames - 1; i >= to; --i)
-    setFrameDuration(i, frameDuration(i - 1));
+  // New frames use the duration of the previous frame
+  const int duration = frameDuration(std::max(0, newFrame - 1));
+  for (frame_t i = newFrame; i < newFrame + count; ++i)
+    setFrameDuration(i, duration);
 
-  root()->displaceFrames(newFrame, +1);
+  root()->displaceFrames(newFrame, count);
 }
 
 void Sprite::removeFrame(frame_t frame)
 {
-  root()->displaceFrames(frame, -1);
+  removeFrames(frame, 1);
+}
+
+void Sprite::removeFrames(frame_t frame, frame_t count)
+{
+  ASSERT(count > 0);
+  root()->displaceFrames(frame, -count);
 
-  frame_t newTotal = m_frames - 1;
+  frame_t newTotal = m_frames - count;
   for (frame_t i = frame; i < newTotal; ++i)
-    setFrameDuration(i, frameDuration(i + 1));
+    setFrameDuration(i, frameDuration(i + count));
   setTotalFrames(newTotal);
 }
 
@@ -492,6 +508,21 @@ void Sprite::setTotalFrames(frame_t frames)
   m_frames = frames;
 }
 
+void Sprite::reorderFrames(const std::vector<frame_t>& order)
+{
+  ASSERT(frame_t(order.size()) == m_frames);
+
+  std::vector<int> frlens(m_frames);
+  std::vector<frame_t> newFrames(m_frames);
+  for (frame_t i = 0; i < m_frames; ++i) {
+    frlens[i] = m_frlens[order[i]];
+    newFrames[order[i]] = i;
+  }
+  m_frlens = std::move(frlens);
+
+  root()->remapFrames(newFrames);
+}
+
 int Sprite::frameDuration(frame_t frame) const
 {
   if (frame >= 0 && frame < m_frames)
@@ -1,5 +1,5 @@
 // Aseprite Document Library
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -136,6 +136,9 @@ public:
       m_gridBounds.h = 1;
   }
 
+  // Memory used by the images of the sprite. It includes the
+  // Image object of each image, and compact images count their
+  // compressed runs instead of the full width*height pixels.
   virtual int getMemSize() const override;
 
   ////////////////////////////////////////
@@ -176,9 +179,15 @@ public:
   frame_t lastFrame() const { return m_frames - 1; }
 
   void addFrame(frame_t newFrame);
+  void addFrames(frame_t newFrame, frame_t count);
   void removeFrame(frame_t frame);
+  void removeFrames(frame_t frame, frame_t count);
   void setTotalFrames(frame_t frames);
 
+  // Reorders all frames (durations and cels). "order[i]" is the old
+  // frame that will be in the position "i".
+  void reorderFrames(const std::vector<frame_t>& order);
+
   int frameDuration(frame_t frame) const;
   int totalAnimationDuration() const;
   void setFrameDuration(frame_t frame, int msecs);
@@ -207,6 +207,96 @@ TEST(Sprite, CelsRange)
   EXPECT_EQ(3, i);
 }
 
+TEST(Sprite, ReorderFrames)
+{
+  std::shared_ptr<Sprite> sprPtr(std::make_shared<Sprite>(ImageSpec(ColorMode::RGB, 32, 32), 256));
+  Sprite* spr = sprPtr.get();
+  spr->setTotalFrames(4);
+  for (frame_t i = 0; i < 4; ++i)
+    spr->setFrameDuration(i, 100 * (i + 1));
+
+  LayerImage* lay1 = new LayerImage(spr);
+  spr->root()->addLayer(lay1);
+
+  ImageRef img(Image::create(IMAGE_RGB, 32, 32));
+  Cel* cel0 = new Cel(frame_t(0), img);
+  Cel* cel2 = Cel::MakeLink(frame_t(2), cel0);
+  Cel* cel3 = Cel::MakeLink(frame_t(3), cel0);
+  lay1->addCel(cel0);
+  lay1->addCel(cel2);
+  lay1->addCel(cel3);
+
+  // Frames [0 1 2 3] -> [3 0 2 1]
+  spr->reorderFrames({ 3, 0, 2, 1 });
+
+  EXPECT_EQ(400, spr->frameDuration(0));
+  EXPECT_EQ(100, spr->frameDuration(1));
+  EXPECT_EQ(300, spr->frameDuration(2));
+  EXPECT_EQ(200, spr->frameDuration(3));
+  EXPECT_EQ(cel3, lay1->cel(0));
+  EXPECT_EQ(cel0, lay1->cel(1));
+  EXPECT_EQ(cel2, lay1->cel(2));
+  EXPECT_EQ(nullptr, lay1->cel(3));
+
+  // Displace frames [1, 2] by +1
+  spr->setTotalFrames(5);
+  lay1->displaceFrames(1, +1);
+  EXPECT_EQ(cel3, lay1->cel(0));
+  EXPECT_EQ(nullptr, lay1->cel(1));
+  EXPECT_EQ(cel0, lay1->cel(2));
+  EXPECT_EQ(cel2, lay1->cel(3));
+}
+
+TEST(Sprite, AddRemoveFrames)
+{
+  std::shared_ptr<Sprite> sprPtr(std::make_shared<Sprite>(ImageSpec(ColorMode::RGB, 32, 32), 256));
+  Sprite* spr = sprPtr.get();
+  spr->setTotalFrames(4);
+  for (frame_t i = 0; i < 4; ++i)
+    spr->setFrameDuration(i, 100 * (i + 1));
+
+  LayerImage* lay1 = new LayerImage(spr);
+  spr->root()->addLayer(lay1);
+
+  ImageRef img(Image::create(IMAGE_RGB, 32, 32));
+  Cel* cel0 = new Cel(frame_t(0), img);
+  Cel* cel1 = Cel::MakeLink(frame_t(1), cel0);
+  Cel* cel3 = Cel::MakeLink(frame_t(3), cel0);
+  lay1->addCel(cel0);
+  lay1->addCel(cel1);
+  lay1->addCel(cel3);
+
+  // Insert 3 frames before frame 1: [0 + + + 1 2 3]
+  spr->addFrames(1, 3);
+  EXPECT_EQ(7, spr->totalFrames());
+  EXPECT_EQ(100, spr->frameDuration(0));
+  EXPECT_EQ(100, spr->frameDuration(1));
+  EXPECT_EQ(100, spr->frameDuration(2));
+  EXPECT_EQ(100, spr->frameDuration(3));
+  EXPECT_EQ(200, spr->frameDuration(4));
+  EXPECT_EQ(300, spr->frameDuration(5));
+  EXPECT_EQ(400, spr->frameDuration(6));
+  EXPECT_EQ(cel0, lay1->cel(0));
+  EXPECT_EQ(nullptr, lay1->cel(1));
+  EXPECT_EQ(nullptr, lay1->cel(3));
+  EXPECT_EQ(cel1, lay1->cel(4));
+  EXPECT_EQ(cel3, lay1->cel(6));
+
+  // Remove the cel of frame 4 and then frames [2, 5): [0 + 3]
+  lay1->removeCel(cel1);
+  delete cel1;
+  spr->removeFrames(2, 3);
+  EXPECT_EQ(4, spr->totalFrames());
+  EXPECT_EQ(100, spr->frameDuration(0));
+  EXPECT_EQ(100, spr->frameDuration(1));
+  EXPECT_EQ(300, spr->frameDuration(2));
+  EXPECT_EQ(400, spr->frameDuration(3));
+  EXPECT_EQ(cel0, lay1->cel(0));
+  EXPECT_EQ(nullptr, lay1->cel(1));
+  EXPECT_EQ(nullptr, lay1->cel(2));
+  EXPECT_EQ(cel3, lay1->cel(3));
+}
+
 int main(int argc, char** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -1,5 +1,5 @@
 // Aseprite
-// Copyright (C) 2019-2023  Igara Studio S.A.
+// Copyright (C) 2019-2025  Igara Studio S.A.
 // Copyright (C) 2001-2016  David Capello
 //
 // This program is distributed under the terms of
@@ -14,6 +14,7 @@
 #include "app/console.h"
 #include "app/resource_finder.h"
 #include "app/send_crash.h"
+#include "app/startup_profiler.h"
 #include "base/exception.h"
 #include "base/memory.h"
 #include "base/system_console.h"
@@ -124,6 +125,8 @@ int app_main(int argc, char* argv[])
     MemLeak memleak;
     base::SystemConsole systemConsole;
     app::AppOptions options(argc, const_cast<const char**>(argv));
+    if (options.startupProfile() || !options.startupTraceFilename().empty())
+      app::StartupProfiler::start();
     os::SystemRef system(os::make_system());
     doc::Palette::initBestfit();
     app::App app;
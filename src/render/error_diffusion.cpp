@@ -1,5 +1,5 @@
 // Aseprite Render Library
-// Copyright (c) 2019-2022  Igara Studio S.A
+// Copyright (c) 2019-2025  Igara Studio S.A
 // Copyright (c) 2017 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -28,6 +28,7 @@ void ErrorDiffusionDither::start(const doc::Image* srcImage,
                                  const double factor)
 {
   m_srcImage = srcImage;
+  m_srcImage->expand(); // Pixels are read with get_pixel_fast()
   m_width = 2 + srcImage->width();
   for (int i = 0; i < kChannels; ++i)
     m_err[i].resize(m_width * 2, 0);
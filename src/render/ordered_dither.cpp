@@ -1,5 +1,5 @@
 // Aseprite Render Library
-// Copyright (c) 2019-2022  Igara Studio S.A.
+// Copyright (c) 2019-2025  Igara Studio S.A.
 // Copyright (c) 2017 David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -228,6 +228,7 @@ void dither_rgb_image_to_indexed(DitheringAlgorithmBase& algorithm,
   const int h = srcImage->height();
 
   algorithm.start(srcImage, dstImage, dithering.factor());
+  dstImage->expand();
 
   if (algorithm.dimensions() == 1) {
     const doc::LockImageBits<doc::RgbTraits> srcBits(srcImage);
@@ -341,6 +341,9 @@ void composite_image_general(Image* dst,
   if (!area.clip(dst->width(), dst->height(), sx * src->width(), sy * src->height()))
     return;
 
+  dst->expand();
+  src->expand();
+
   BlenderHelper<DstTraits, SrcTraits> blender(dst, src, pal, blendMode, newBlend);
 
   gfx::Rect dstBounds(area.dstBounds().x,
@@ -416,6 +419,9 @@ void composite_image_general_with_tile_flags(Image* dst,
   if (!area.clip(dst->width(), dst->height(), sx * src->width(), sy * src->height()))
     return;
 
+  dst->expand();
+  src->expand();
+
   BlenderHelper<DstTraits, SrcTraits> blender(dst, src, pal, blendMode, newBlend);
 
   gfx::Rect dstBounds(area.dstBounds().x,
@@ -1,4 +1,5 @@
 // Aseprite UI Library
+// Copyright (C) 2025  Igara Studio S.A.
 // Copyright (C) 2001-2017  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -9,6 +10,7 @@
 #pragma once
 
 #include "gfx/color.h"
+#include "gfx/fwd.h"
 #include "ui/base.h"
 
 namespace os {
@@ -34,6 +36,10 @@ void removeWidget(Widget* widget);
 void reinitThemeForAllWidgets();
 int old_guiscale();
 
+// widget.cpp
+
+bool merge_paint_rects(const gfx::Region& region, const gfx::Rect& bounds);
+
 } // namespace details
 
 } // namespace ui
@@ -1,5 +1,5 @@
 // Aseprite UI Library
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -35,13 +35,22 @@
 #include "ui/ui.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <limits>
 #include <list>
+#include <map>
 #include <memory>
 #include <thread>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
+#if !defined(_MSC_VER)
+  #include <cstdlib>
+  #include <cxxabi.h>
+#endif
+
 #if defined(_WIN32) && defined(DEBUG_PAINT_MESSAGES)
   #define WIN32_LEAN_AND_MEAN
   #include <windows.h>
@@ -105,6 +114,46 @@ static Widget* capture_widget; // The widget that captures the mouse
 
 static bool first_time = true; // true when we don't enter in poll yet
 
+// Paint profiling (see Manager::setPaintProfiling())
+static bool paint_profiling = false;
+static Manager::PaintStatsByType paint_stats;
+
+// Returns a readable name of the widget class (e.g. "ui::Button"
+// instead of the mangled "N2ui6ButtonE" returned by GCC/Clang). Names
+// are cached by the std::type_info name pointer, so we demangle each
+// type only once.
+static const std::string& widget_type_name(const Widget* widget)
+{
+  static std::map<const char*, std::string> names;
+
+  const char* name = typeid(*widget).name();
+  auto it = names.find(name);
+  if (it != names.end())
+    return it->second;
+
+  std::string result;
+#if !defined(_MSC_VER)
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (demangled && status == 0)
+    result = demangled;
+  else
+    result = name;
+  std::free(demangled);
+#else
+  // MSVC names are already readable but include the "class " or
+  // "struct " prefix.
+  result = name;
+  for (const char* prefix : { "class ", "struct " }) {
+    if (result.compare(0, std::strlen(prefix), prefix) == 0) {
+      result.erase(0, std::strlen(prefix));
+      break;
+    }
+  }
+#endif
+  return names.emplace(name, std::move(result)).first->second;
+}
+
 // Don't adjust window positions automatically when it's false. Used
 // when Screen/UI scaling is changed to avoid adjusting windows as
 // when the os::Display is resized by the user.
@@ -316,6 +365,26 @@ void Manager::updateAllDisplays(int scale, bool gpu)
   onNewDisplayConfiguration(&m_display);
 }
 
+// static
+void Manager::setPaintProfiling(const bool state)
+{
+  paint_profiling = state;
+  if (state)
+    paint_stats.clear();
+}
+
+// static
+bool Manager::isPaintProfiling()
+{
+  return paint_profiling;
+}
+
+// static
+const Manager::PaintStatsByType& Manager::paintStats()
+{
+  return paint_stats;
+}
+
 bool Manager::generateMessages()
 {
   ASSERT(manager_thread == std::this_thread::get_id());
@@ -1922,7 +1991,18 @@ bool Manager::sendMessageToWidget(Message* msg, Widget* widget)
 #endif
 
       // Call the message handler
-      used = widget->sendMessage(msg);
+      if (paint_profiling) {
+        const auto t0 = std::chrono::steady_clock::now();
+        used = widget->sendMessage(msg);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - t0;
+
+        PaintStats& stats = paint_stats[widget_type_name(widget)];
+        ++stats.count;
+        stats.seconds += elapsed.count();
+      }
+      else {
+        used = widget->sendMessage(msg);
+      }
     }
 
     // Restore clip region for paint messages.
@@ -1,5 +1,5 @@
 // Aseprite UI Library
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2017  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -17,6 +17,9 @@
 #include "ui/pointer_type.h"
 #include "ui/widget.h"
 
+#include <map>
+#include <string>
+
 namespace os {
 class EventQueue;
 class Window;
@@ -43,6 +46,18 @@ public:
   // Executes the main message loop.
   void run();
 
+  // Time spent processing kPaintMessages for each type of widget
+  // (only recorded when the paint profiling is enabled).
+  struct PaintStats {
+    int count = 0;        // Number of processed paint messages
+    double seconds = 0.0; // Total time painting
+  };
+  using PaintStatsByType = std::map<std::string, PaintStats>;
+
+  static void setPaintProfiling(bool state);
+  static bool isPaintProfiling();
+  static const PaintStatsByType& paintStats();
+
   // Refreshes all real displays with the UI content.
   void flipAllDisplays();
 
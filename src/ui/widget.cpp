@@ -1,5 +1,5 @@
 // Aseprite UI Library
-// Copyright (C) 2018-2024  Igara Studio S.A.
+// Copyright (C) 2018-2025  Igara Studio S.A.
 // Copyright (C) 2001-2018  David Capello
 //
 // This file is released under the terms of the MIT license.
@@ -40,6 +40,7 @@
 #include <algorithm>
 #include <cctype>
 #include <cstdarg>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <limits>
@@ -50,6 +51,26 @@ namespace ui {
 
 using namespace gfx;
 
+// If an invalid region has more rectangles than this, its bounds can
+// be painted with a bigger waste of pixels (see merge_paint_rects()).
+static const std::size_t kMaxPaintRects = 8;
+
+// Returns true if it's better to paint the bounds of the region with
+// only one kPaintMessage (one onPaint() call) instead of one paint
+// message for each rectangle of the region. This happens e.g. when a
+// widget is invalidated several times in the same frame (like the
+// hot/active cels of the timeline while dragging), where repainting
+// some extra pixels is cheaper than calling onPaint() several times.
+bool details::merge_paint_rects(const Region& region, const gfx::Rect& bounds)
+{
+  int64_t area = 0;
+  for (const gfx::Rect& rc : region)
+    area += int64_t(rc.w) * rc.h;
+
+  const int64_t boundsArea = int64_t(bounds.w) * bounds.h;
+  return (boundsArea <= 2 * area || (region.size() > kMaxPaintRects && boundsArea <= 4 * area));
+}
+
 WidgetType register_widget_type()
 {
   static int type = (int)kFirstUserWidget;
@@ -1107,6 +1128,17 @@ void Widget::flushRedraw()
         Region drawable;
         widget->getDrawableRegion(drawable, kCutTopWindows);
         widget->m_updateRegion &= drawable;
+
+        // Merge all rectangles in just one paint message if the
+        // bounds are completely visible (we cannot paint over
+        // windows that are on top of this widget).
+        if (widget->m_updateRegion.size() > 1) {
+          const gfx::Rect bounds = widget->m_updateRegion.bounds();
+          if (details::merge_paint_rects(widget->m_updateRegion, bounds) &&
+              drawable.contains(bounds) == Region::In) {
+            widget->m_updateRegion = Region(bounds);
+          }
+        }
       }
 
       std::size_t c, nrects = widget->m_updateRegion.size();
@@ -1,5 +1,5 @@
 // Aseprite UI Library
-// Copyright (C) 2022  Igara Studio S.A.
+// Copyright (C) 2022-2025  Igara Studio S.A.
 //
 // This file is released under the terms of the MIT license.
 // Read LICENSE.txt for more information.
@@ -7,6 +7,9 @@
 #define TEST_GUI
 #include "tests/app_test.h"
 
+#include "gfx/region.h"
+#include "ui/intern.h"
+
 using namespace ui;
 
 TEST(Widget, ParentIndex)
@@ -55,3 +58,34 @@ TEST(Widget, ParentIndex)
   EXPECT_EQ(2, d.parentIndex());
   EXPECT_EQ(3, c.parentIndex());
 }
+
+TEST(Widget, MergePaintRects)
+{
+  using gfx::Rect;
+  using gfx::Region;
+
+  auto merge = [](const Region& rgn) { return details::merge_paint_rects(rgn, rgn.bounds()); };
+
+  // Near rectangles (bounds <= 2 * area)
+  Region rgn(Rect(0, 0, 10, 10));
+  rgn |= Region(Rect(0, 15, 10, 10));
+  EXPECT_TRUE(merge(rgn));
+
+  // Far rectangles
+  rgn = Region(Rect(0, 0, 10, 10));
+  rgn |= Region(Rect(90, 90, 10, 10));
+  EXPECT_FALSE(merge(rgn));
+
+  // A row of rectangles with bounds between 2 and 4 times its area,
+  // merged only when there are too many rectangles
+  rgn.clear();
+  for (int i = 0; i < 5; ++i)
+    rgn |= Region(Rect(30 * i, 0, 10, 10));
+  EXPECT_EQ(5u, rgn.size());
+  EXPECT_FALSE(merge(rgn));
+
+  for (int i = 5; i < 9; ++i)
+    rgn |= Region(Rect(30 * i, 0, 10, 10));
+  EXPECT_EQ(9u, rgn.size());
+  EXPECT_TRUE(merge(rgn));
+}
@@ -0,0 +1,75 @@
+-- Copyright (C) 2025  Igara Studio S.A.
+--
+-- This file is released under the terms of the MIT license.
+-- Read LICENSE.txt for more information.
+
+-- Items are processed in other processes
+do
+  local items = { 1, "b", { x=2, list={ 3, 4 } }, 2.5 }
+  local results, errors = app.parallel(items, function(item, i)
+    if type(item) == "table" then
+      return { i=i, sum=item.x + item.list[1] + item.list[2] }
+    end
+    return { i=i, value=item }
+  end, { jobs=2 })
+
+  assert(#results == 4)
+  assert(next(errors) == nil)
+  assert(results[1].i == 1 and results[1].value == 1)
+  assert(results[2].i == 2 and results[2].value == "b")
+  assert(results[3].i == 3 and results[3].sum == 9)
+  assert(results[4].i == 4 and results[4].value == 2.5)
+end
+
+-- Items are split in slices, one for each job
+do
+  local items = {}
+  for i = 1, 10 do items[i] = i * 10 end
+  local results, errors = app.parallel(items, function(item, i)
+    return item + i
+  end, { jobs=3 })
+
+  assert(#results == 10)
+  assert(next(errors) == nil)
+  for i = 1, 10 do
+    assert(results[i] == i * 11)
+  end
+end
+
+-- Each call has its own documents
+do
+  local results = app.parallel({ 16, 32, 64 }, function(size)
+    local spr = Sprite(size, size)
+    return { w=spr.width, sprites=#app.sprites }
+  end, { jobs=1 })
+  assert(results[1].w == 16 and results[1].sprites == 1)
+  assert(results[2].w == 32 and results[2].sprites == 1)
+  assert(results[3].w == 64 and results[3].sprites == 1)
+end
+
+-- Errors are reported by item
+do
+  local results, errors = app.parallel({ 1, 2, 3 }, function(item)
+    if item == 2 then error("failed item") end
+    return item
+  end, { jobs=1 })
+  assert(results[1] == 1)
+  assert(results[2] == nil)
+  assert(results[3] == 3)
+  assert(errors[1] == nil)
+  assert(errors[2]:find("failed item"))
+  assert(errors[3] == nil)
+end
+
+-- Functions cannot use local variables from outside
+do
+  local n = 5
+  assert(not pcall(app.parallel, { 1 }, function(item) return item + n end))
+end
+
+-- Only plain values can be used as items (the error can be caught)
+do
+  local ok, msg = pcall(app.parallel, { print }, function(item) return 1 end)
+  assert(not ok)
+  assert(msg:find("cannot be passed"))
+end
@@ -1,4 +1,4 @@
--- Copyright (C) 2021  Igara Studio S.A.
+-- Copyright (C) 2021-2025  Igara Studio S.A.
 --
 -- This file is released under the terms of the MIT license.
 -- Read LICENSE.txt for more information.
@@ -91,6 +91,87 @@ do
   expect_eq(2, bi)
 end
 
+-- Coalesced listeners (in batch mode they are called for each
+-- change, as there is no UI loop, but with the summary fields)
+do
+  local spr = Sprite(32, 32)
+  local cel = spr.cels[1]
+  local n, last = 0, nil
+  function onChange(ev)
+    n = n + 1
+    last = ev
+  end
+  spr.events:on('change', onChange, { coalesce=true })
+
+  cel.position = Point(2, 3)
+  expect_eq(1, n)
+  expect_eq(1, last.count)
+  expect_eq(false, last.fromUndo)
+  expect_eq(1, #last.layers)
+  expect_eq(spr.layers[1], last.layers[1])
+  expect_eq(1, #last.frames)
+  expect_eq(1, last.frames[1].frameNumber)
+  expect_eq(Rectangle(2, 3, 32, 32), last.bounds)
+
+  app.undo()
+  expect_eq(2, n)
+  expect_eq(true, last.fromUndo)
+
+  spr.events:off(onChange)
+  app.redo()
+  expect_eq(2, n)
+end
+
+-- Coalesced listeners receive the frames that were moved
+do
+  local spr = Sprite(32, 32)
+  spr:newFrame()
+  spr:newFrame()
+  spr.cels[3].position = Point(4, 5)
+  local last = nil
+  function onChange(ev) last = ev end
+  spr.events:on('change', onChange, { coalesce=true })
+
+  app.frame = spr.frames[2]
+  app.range.frames = { 2, 3 }
+  app.command.ReverseFrames()
+  assert(last ~= nil)
+  local frames = {}
+  for _,frame in ipairs(last.frames) do
+    frames[frame.frameNumber] = true
+  end
+  assert(frames[2])
+  assert(frames[3])
+  expect_eq(1, #last.layers)
+  expect_eq(Rectangle(0, 0, 36, 37), last.bounds)
+
+  spr.events:off(onChange)
+end
+
+-- Changes made by a coalesced listener are reported in the next call
+-- (and not mixed with the changes that are being reported)
+do
+  local spr = Sprite(32, 32)
+  spr.cels[1].position = Point(2, 3)
+  local calls = {}
+  function onChange(ev)
+    table.insert(calls, ev)
+    if #calls == 1 then
+      spr.cels[1].position = Point(4, 5)
+    end
+  end
+  spr.events:on('change', onChange, { coalesce=true })
+
+  app.undo()
+  expect_eq(2, #calls)
+  expect_eq(true, calls[1].fromUndo)
+  expect_eq(false, calls[2].fromUndo)
+  expect_eq(1, #calls[2].layers)
+  expect_eq(1, #calls[2].frames)
+
+  spr.events:off(onChange)
+end
+
 -- Avoid removing invalid listener when we use Events:off(function)
 do
   local spr = Sprite(2, 2)
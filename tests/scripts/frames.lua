@@ -1,4 +1,4 @@
--- Copyright (C) 2018  Igara Studio S.A.
+-- Copyright (C) 2018-2025  Igara Studio S.A.
 -- Copyright (C) 2018  David Capello
 --
 -- This file is released under the terms of the MIT license.
@@ -93,3 +93,32 @@ do
   assert(fr3 == a.frames[2])
   assert(fr3.next == a.frames[3])
 end
+
+-- Remove a selection of frames (two ranges of consecutive frames)
+do
+  local s = Sprite(32, 32)
+  for i=2,6 do s:newEmptyFrame() end
+  for i=1,6 do s.frames[i].duration = i/10 end
+  local cel = s:newCel(s.layers[1], 6)
+  cel.position = Point(6, 0)
+  local tag = s:newTag(2, 5)
+  assert(#s.frames == 6)
+
+  app.frame = s.frames[1]
+  app.range.frames = { 2, 4, 5 }
+  app.command.RemoveFrame()
+  assert(#s.frames == 3)
+  assert(s.frames[1].duration == 0.1)
+  assert(s.frames[2].duration == 0.3)
+  assert(s.frames[3].duration == 0.6)
+  assert(s.layers[1]:cel(3) == cel)
+  assert(tag.fromFrame.frameNumber == 2)
+  assert(tag.toFrame.frameNumber == 2)
+
+  app.undo()
+  assert(#s.frames == 6)
+  for i=1,6 do assert(s.frames[i].duration == i/10) end
+  assert(s.layers[1]:cel(6).position == Point(6, 0))
+  assert(tag.fromFrame.frameNumber == 2)
+  assert(tag.toFrame.frameNumber == 5)
+end
@@ -561,3 +561,118 @@ do
                     2, 3 })
 
 end
+
+-- Bulk pixel functions
+do
+  local img = Image(3, 2, ColorMode.INDEXED)
+  img:setPixels({ 1, 2, 3,
+                  4, 5, 6 })
+  expect_img(img, { 1, 2, 3,
+                    4, 5, 6 })
+  local pixels = img:getPixels(Rectangle(1, 0, 2, 2))
+  assert(#pixels == 4)
+  for i,c in ipairs({ 2, 3, 5, 6 }) do
+    expect_eq(c, pixels[i])
+  end
+
+  -- Only the given area is modified
+  img:setPixels({ 7, 8 }, Rectangle(0, 1, 2, 1))
+  expect_img(img, { 1, 2, 3,
+                    7, 8, 6 })
+
+  -- Invalid tables don't modify the image
+  assert(not pcall(function() img:setPixels({ 1, 2 }) end))
+  assert(not pcall(function() img:setPixels({ 1, 2, 3, 4, 5, "a" }) end))
+  assert(not pcall(function() img:setPixels({ 1, 2, 3, 4, 5, 6.5 }) end))
+  expect_img(img, { 1, 2, 3,
+                    7, 8, 6 })
+  img:setPixels({ 1, 2, 3, 4, 5, 6.0 }) -- Floats with integer values are valid
+  expect_img(img, { 1, 2, 3,
+                    4, 5, 6 })
+
+  -- Lookup table (missing entries keep the pixel)
+  img:mapPixels({ [1]=10, [6]=60 })
+  expect_img(img, { 10, 2, 3,
+                     4, 5, 60 })
+
+  -- Function (nil keeps the pixel)
+  img:mapPixels(function(c, x, y)
+    if y == 1 then return c + x end
+  end)
+  expect_img(img, { 10, 2, 3,
+                     4, 6, 62 })
+  assert(not pcall(function() img:mapPixels(function(c) return "a" end) end))
+  assert(not pcall(function() img:mapPixels({ [2]=true }) end))
+
+  img:replaceColor(2, 20)
+  expect_img(img, { 10, 20, 3,
+                     4,  6, 62 })
+
+  local bytes = img:getBytes(Rectangle(0, 0, 2, 1))
+  assert(#bytes == 2)
+  assert(string.byte(bytes, 1) == 10)
+  assert(string.byte(bytes, 2) == 20)
+  img:setBytes(string.char(1, 2), Rectangle(1, 1, 2, 1))
+  expect_img(img, { 10, 20, 3,
+                     4,  1, 2 })
+end
+
+-- Bulk pixel functions in bitmap images
+do
+  local img = Image(ImageSpec{ width=10, height=2, colorMode=3 }) -- Bitmap
+  img:setPixels({ 1, 0, 1, 1, 0, 0, 0, 0, 1, 1,
+                  0, 1, 0, 0, 1, 1, 1, 1, 0, 0 })
+  local pixels = img:getPixels(Rectangle(7, 0, 3, 2))
+  assert(#pixels == 6)
+  for i,c in ipairs({ 0, 1, 1, 1, 0, 0 }) do
+    expect_eq(c, pixels[i])
+  end
+  img:mapPixels({ [0]=1, [1]=0 }, Rectangle(8, 1, 2, 1))
+  expect_eq(1, img:getPixel(8, 1))
+  expect_eq(1, img:getPixel(9, 1))
+  expect_eq(1, img:getPixel(8, 0))
+  assert(not pcall(function() img:getBytes() end))
+  assert(not pcall(function() img:setBytes(string.char(0, 0)) end))
+end
+
+-- Bulk pixel functions in cel images can be undone
+do
+  local spr = Sprite(8, 8, ColorMode.INDEXED)
+  local cel = spr.cels[1]
+  cel.image:clear(1)
+  local img = cel.image
+  img:setPixels({ 2, 3,
+                  4, 5 }, Rectangle(3, 4, 2, 2))
+  expect_eq(2, img:getPixel(3, 4))
+  expect_eq(5, img:getPixel(4, 5))
+  expect_eq(1, img:getPixel(2, 4))
+
+  -- The function receives image coordinates
+  cel.image:mapPixels(function(c, x, y)
+    if x == 4 and y == 5 then return 9 end
+  end, Rectangle(4, 5, 2, 2))
+  expect_eq(9, cel.image:getPixel(4, 5))
+  expect_eq(1, cel.image:getPixel(5, 6))
+
+  app.undo()
+  app.undo()
+  local pixels = cel.image:getPixels()
+  for i=1,#pixels do
+    expect_eq(1, pixels[i])
+  end
+end
+
+-- replaceColor() in RGB images
+do
+  local img = Image(2, 2)
+  local r = rgba(255, 0, 0)
+  local b = rgba(0, 0, 255)
+  array_to_pixels({ r, b,
+                    b, r }, img)
+  img:replaceColor(r, b, Rectangle(0, 0, 2, 1))
+  expect_img(img, { b, b,
+                    b, r })
+  img:replaceColor(Color(0, 0, 255), Color(255, 0, 0))
+  expect_img(img, { r, r,
+                    r, r })
+end
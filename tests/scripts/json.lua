@@ -1,4 +1,4 @@
--- Copyright (C) 2023  Igara Studio S.A.
+-- Copyright (C) 2023-2025  Igara Studio S.A.
 --
 -- This file is released under the terms of the MIT license.
 -- Read LICENSE.txt for more information.
@@ -101,3 +101,54 @@ do
 
   assert(tostring(o) == '{"a": [10, 20, 30, 40], "b": {"c": 1, "d": 2}}')
 end
+
+-- Encode Lua tables with sorted keys and integers
+do
+  assert(json.encode({ b=1, a={ 2.5, "x\n" }, [3]=true }) ==
+         '{"3": true, "a": [2.5, "x\\n"], "b": 1}')
+  assert(json.encode({}) == '[]')
+end
+
+-- Incremental reader
+do
+  local r = json.reader('{"frames":[{"i":1},{"i":2}],"meta":{"app":"x"},"n":5}')
+  assert(r:next() == "object")
+  local t, k = r:next()
+  assert(t == "key" and k == "frames")
+  assert(r:next() == "array")
+  local n = 0
+  for i,frame in r:items() do
+    n = n + 1
+    assert(i == n)
+    assert(frame.i == n)
+  end
+  assert(n == 2)
+
+  t, k = r:next()
+  assert(t == "key" and k == "meta")
+  r:skip()
+  t, k = r:next()
+  assert(t == "key" and k == "n")
+  assert(r:value() == 5)
+  assert(r:next() == "endobject")
+  assert(r:next() == nil)
+
+  -- Syntax errors
+  local bad = json.reader('[1, 2,]')
+  assert(not pcall(function() while bad:next() do end end))
+
+  -- Strings with NUL characters
+  local z = json.reader('{"a\\u0000b":"c\\u0000d"}')
+  assert(z:next() == "object")
+  t, k = z:next()
+  assert(t == "key" and k == "a\0b")
+  assert(z:value() == "c\0d")
+
+  -- Values nested too deep are not read recursively forever
+  local deep = json.reader(string.rep('[', 1000) .. string.rep(']', 1000))
+  assert(deep:next() == "array")
+  assert(not pcall(function() return deep:value() end))
+  local ok = json.reader(string.rep('[', 10) .. '1' .. string.rep(']', 10))
+  assert(ok:next() == "array")
+  assert(ok:value()[1][1][1][1][1][1][1][1][1] == 1)
+end